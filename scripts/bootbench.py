@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Boot the kernel headless in QEMU repeatedly and report boot-phase times.
+
+Each run boots a BOOTBENCH build, which writes its boot-phase timestamps
+to the debugcon port (0xE9) at the end of init and then leaves QEMU
+through isa-debug-exit. Phase durations are the differences between
+consecutive timestamps; "firmware" is everything from CPU reset to the
+first one. Every variant is a label and the QEMU arguments that boot it,
+and gets its own table of medians and percentiles.
+
+Usage: bootbench.py [-n runs] [--qemu path] [--cpu model] [--smp n]
+                    label=qemu-args [label=qemu-args ...]
+"""
+
+import argparse
+import os
+import shlex
+import subprocess
+import sys
+import tempfile
+import time
+
+# isa-debug-exit exits with (value << 1) | 1, the kernel writes 0
+EXIT_STATUS = 1
+PERCENTILES = (50, 90, 99)
+
+
+def boot_once(qemu, args, timeout):
+    """Return (TSC Hz, [(phase, tsc)], wall seconds) of one boot."""
+    with tempfile.TemporaryDirectory() as tmp:
+        log = os.path.join(tmp, "debugcon.log")
+        cmd = [qemu, "-display", "none", "-serial", "null",
+               "-debugcon", "file:" + log,
+               "-device", "isa-debug-exit,iobase=0xf4,iosize=0x04"] + args
+        start = time.monotonic()
+        status = subprocess.run(cmd, timeout=timeout).returncode
+        wall = time.monotonic() - start
+        with open(log, errors="replace") as f:
+            lines = f.read().splitlines()
+
+    if status != EXIT_STATUS:
+        raise RuntimeError("QEMU exited with %d, not a BOOTBENCH build?" % status)
+
+    hz, marks = None, []
+    for line in lines:
+        fields = line.split()
+        if len(fields) != 3 or fields[0] != "boottime:":
+            continue
+        if fields[1] == "begin":
+            hz, marks = int(fields[2]), []
+        else:
+            marks.append((fields[1], int(fields[2])))
+    if hz is None or not marks or marks[-1][0] != "end":
+        raise RuntimeError("no complete boot-phase report")
+    return hz, marks, wall
+
+
+def phases(marks):
+    """Turn phase start marks into (phase, cycles) durations."""
+    out = [("firmware", marks[0][1])]
+    for (name, tsc), (_, next_tsc) in zip(marks, marks[1:]):
+        out.append((name, next_tsc - tsc))
+    out.append(("total", marks[-1][1]))
+    return out
+
+
+def percentile(values, p):
+    """Nearest-rank percentile."""
+    values = sorted(values)
+    rank = max(1, -(-p * len(values) // 100))
+    return values[rank - 1]
+
+
+def report(label, runs):
+    """Print one variant's table, in microseconds when the TSC rate is known."""
+    hz = runs[0][0]
+    unit, scale = ("us", 1e6 / hz) if hz else ("kcycles", 1e-3)
+    order, samples = [], {}
+    for _, marks, _ in runs:
+        for name, cycles in phases(marks):
+            if name not in samples:
+                order.append(name)
+                samples[name] = []
+            samples[name].append(cycles * scale)
+    samples["qemu wall"] = [wall * 1e6 if hz else wall * 1e3 for _, _, wall in runs]
+    order.append("qemu wall")
+
+    print("%s: %d runs, %s" % (label, len(runs), "us" if hz else
+                                "kcycles (qemu wall in ms), no invariant TSC"))
+    print("  %-18s" % "phase" + "".join("%12s" % ("p%d" % p) for p in PERCENTILES))
+    for name in order:
+        print("  %-18s" % name + "".join(
+            "%12.1f" % percentile(samples[name], p) for p in PERCENTILES))
+    print()
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-n", "--runs", type=int, default=20)
+    parser.add_argument("--qemu", default="qemu-system-i386")
+    parser.add_argument("--cpu", default="max,+invtsc")
+    parser.add_argument("--smp", default="4")
+    parser.add_argument("--timeout", type=float, default=60)
+    parser.add_argument("variants", nargs="+", metavar="label=qemu-args")
+    opts = parser.parse_args(argv[1:])
+
+    for variant in opts.variants:
+        label, _, args = variant.partition("=")
+        args = ["-cpu", opts.cpu, "-smp", opts.smp] + shlex.split(args)
+        try:
+            runs = [boot_once(opts.qemu, args, opts.timeout) for _ in range(opts.runs)]
+        except (RuntimeError, subprocess.TimeoutExpired) as err:
+            sys.stderr.write("%s: %s\n" % (label, err))
+            return 1
+        report(label, runs)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
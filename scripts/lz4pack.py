@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Compress the kernel's load image for the boot unpack stub.
+
+Lays out the file-backed bytes of every PT_LOAD segment of the kernel
+ELF as one flat image starting at the lowest physical address, compresses
+it as a single raw LZ4 block and writes an include file for unpack.asm
+with the addresses the stub needs. .bss is not part of the image; the
+stub zeroes it up to the end of the highest segment.
+
+Usage: lz4pack.py <kernel.elf> <kernel.lz4> <kernel_layout.inc>
+"""
+
+import struct
+import sys
+
+PT_LOAD = 1
+MIN_MATCH = 4
+MAX_OFFSET = 0xFFFF
+# The block format ends with at least 5 literals, and the last match
+# starts at least 12 bytes before the end
+LAST_LITERALS = 5
+MF_LIMIT = 12
+HASH_BITS = 16
+
+
+def load_image(path):
+    """Return (entry, load address, flat image, end of .bss)."""
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF":
+        raise ValueError("%s is not an ELF file" % path)
+
+    entry, phoff = struct.unpack_from("<II", elf, 24)
+    phentsize, phnum = struct.unpack_from("<HH", elf, 42)
+    segments = []
+    for i in range(phnum):
+        ptype, offset, _, paddr, filesz, memsz = struct.unpack_from(
+            "<IIIIII", elf, phoff + i * phentsize)
+        if ptype == PT_LOAD and memsz:
+            segments.append((paddr, elf[offset:offset + filesz], memsz))
+
+    base = min(s[0] for s in segments)
+    end = max(s[0] + s[2] for s in segments)
+    image = bytearray(max(s[0] + len(s[1]) for s in segments if s[1]) - base)
+    for paddr, data, _ in segments:
+        image[paddr - base:paddr - base + len(data)] = data
+    return entry, base, bytes(image), end
+
+
+def put_length(out, length):
+    """Append the extension bytes for a length above the nibble."""
+    length -= 15
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+
+def put_sequence(out, literals, offset=0, match_len=0):
+    """Append one sequence; offset 0 makes it the literals-only last one."""
+    lit_len = len(literals)
+    ml = match_len - MIN_MATCH if offset else 0
+    out.append((min(lit_len, 15) << 4) | min(ml, 15))
+    if lit_len >= 15:
+        put_length(out, lit_len)
+    out += literals
+    if offset:
+        out += struct.pack("<H", offset)
+        if ml >= 15:
+            put_length(out, ml)
+
+
+def compress(data):
+    """Greedy LZ4 block compression with a single-entry hash table."""
+    out = bytearray()
+    table = {}
+    anchor = pos = 0
+    limit = len(data) - MF_LIMIT
+    while pos < limit:
+        key = data[pos:pos + MIN_MATCH]
+        cand = table.get(key, -1)
+        table[key] = pos
+        if cand < 0 or pos - cand > MAX_OFFSET:
+            pos += 1
+            continue
+
+        end = pos + MIN_MATCH
+        match_end = len(data) - LAST_LITERALS
+        while end < match_end and data[end] == data[cand + end - pos]:
+            end += 1
+        put_sequence(out, data[anchor:pos], pos - cand, end - pos)
+        # Keep the table warm inside the match without scanning every byte
+        for p in range(pos + 1, min(end, limit), max(1, (end - pos) // 16)):
+            table[data[p:p + MIN_MATCH]] = p
+        pos = anchor = end
+    put_sequence(out, data[anchor:])
+    return bytes(out)
+
+
+def main(argv):
+    if len(argv) != 4:
+        sys.stderr.write(__doc__)
+        return 1
+
+    entry, base, image, end = load_image(argv[1])
+    packed = compress(image)
+    with open(argv[2], "wb") as f:
+        f.write(packed)
+    with open(argv[3], "w") as f:
+        f.write("; Generated by lz4pack.py from %s\n" % argv[1])
+        f.write("kernel_entry        equ 0x%08X\n" % entry)
+        f.write("kernel_load_addr    equ 0x%08X\n" % base)
+        f.write("kernel_image_size   equ %d\n" % len(image))
+        f.write("kernel_end          equ 0x%08X\n" % end)
+    sys.stderr.write("lz4pack: %d -> %d bytes\n" % (len(image), len(packed)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""Turn a kernel profile dump into folded stacks for flamegraph.pl.
+
+Reads the serial log written by profile_dump(), symbolizes every address
+with addr2line against the kernel ELF and prints one
+"outer;...;inner count" line per unique stack.
+
+Usage: profile_fold.py <serial.log> <kernel.elf> [addr2line]
+"""
+
+import collections
+import subprocess
+import sys
+
+
+def read_samples(path):
+    """Return the stacks from the last complete dump, outermost first."""
+    stacks, current = [], None
+    with open(path, errors="replace") as log:
+        for line in log:
+            line = line.strip()
+            if line.startswith("profile: begin"):
+                current = []
+            elif line == "profile: end" and current is not None:
+                stacks, current = current, None
+            elif current is not None and line.startswith("P "):
+                addrs = [int(a, 16) for a in line.split()[1:]]
+                # Return addresses point after the call; step back into it
+                addrs = addrs[:1] + [a - 1 for a in addrs[1:]]
+                current.append(tuple(reversed(addrs)))
+    return stacks
+
+
+def symbolize(addrs, elf, addr2line):
+    """Map each address to a function name with one addr2line run."""
+    addrs = sorted(addrs)
+    out = subprocess.run(
+        [addr2line, "-f", "-e", elf] + ["%x" % a for a in addrs],
+        check=True, capture_output=True, text=True).stdout.splitlines()
+    names = {}
+    for i, addr in enumerate(addrs):
+        name = out[2 * i] if 2 * i < len(out) else "??"
+        names[addr] = name if name != "??" else "0x%x" % addr
+    return names
+
+
+def main(argv):
+    if len(argv) < 3:
+        sys.stderr.write(__doc__)
+        return 1
+
+    addr2line = argv[3] if len(argv) > 3 else "addr2line"
+    stacks = read_samples(argv[1])
+    if not stacks:
+        sys.stderr.write("no complete profile dump in %s\n" % argv[1])
+        return 1
+
+    names = symbolize({a for s in stacks for a in s}, argv[2], addr2line)
+    folded = collections.Counter(
+        ";".join(names[a] for a in stack) for stack in stacks)
+    for stack, count in sorted(folded.items()):
+        print("%s %d" % (stack, count))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,610 @@
+#include <stddef.h>
+
+#include "bcache.h"
+#include "../cpu/spinlock.h"
+#include "../lib/mem.h"
+#include "../lib/printf.h"
+#include "../sched/sched.h"
+#include "../time/clocksource.h"
+#include "../utils.h"
+
+/* Buffer flags */
+#define BUF_VALID               0x01    /* Data matches or is newer than the disk */
+#define BUF_DIRTY               0x02    /* Data is newer than the disk */
+#define BUF_IO                  0x04    /* A read or write is in flight */
+#define BUF_READAHEAD           0x08    /* Read ahead and not asked for yet */
+
+/**
+ * BCACHE_NO_BLOCK - Block number of a buffer that holds nothing
+ */
+#define BCACHE_NO_BLOCK         0xFFFFFFFF
+
+/**
+ * struct bcache_waiter_t - A thread waiting for a buffer's I/O
+ * @thread: Blocked thread
+ * @next: Next waiter on the same buffer
+ */
+typedef struct bcache_waiter_t {
+    thread_t *thread;
+    struct bcache_waiter_t *next;
+} bcache_waiter_t;
+
+/**
+ * struct bcache_buf_t - One cached block
+ * @block: Block number, BCACHE_NO_BLOCK if unused
+ * @flags: BUF_ flags
+ * @refs: Callers using the buffer, which keeps it from being reused
+ * @error: Non-zero if the last I/O failed
+ * @data: BCACHE_BLOCK_SIZE bytes
+ * @hash_next: Next buffer in the same hash bucket
+ * @lru_prev: Next more recently used buffer
+ * @lru_next: Next less recently used buffer
+ * @waiters: Threads waiting for BUF_IO to clear
+ * @req: Disk request for the I/O in flight
+ */
+typedef struct bcache_buf_t {
+    uint32_t block;
+    uint32_t flags;
+    uint32_t refs;
+    int error;
+    uint8_t *data;
+    struct bcache_buf_t *hash_next;
+    struct bcache_buf_t *lru_prev;
+    struct bcache_buf_t *lru_next;
+    bcache_waiter_t *waiters;
+    ata_request_t req;
+} bcache_buf_t;
+
+/**
+ * bcache_lock - Protects the buffers, the lookup table, the LRU list and
+ * the statistics; also taken from the disk interrupt
+ */
+static spinlock_t bcache_lock = SPINLOCK_INIT("bcache");
+
+/**
+ * block_data - Backing memory of the buffers
+ */
+static uint8_t block_data[BCACHE_NUM_BUFFERS][BCACHE_BLOCK_SIZE] __attribute__((aligned(BCACHE_BLOCK_SIZE)));
+
+/**
+ * bufs - The buffers
+ */
+static bcache_buf_t bufs[BCACHE_NUM_BUFFERS];
+
+/**
+ * hash - Buffers by block number
+ */
+static bcache_buf_t *hash[BCACHE_HASH_SIZE];
+
+/**
+ * lru - List head; lru.lru_next is the most and lru.lru_prev the least
+ * recently used buffer
+ */
+static bcache_buf_t lru;
+
+/**
+ * disk_blocks - Blocks on the disk, the last one may be partial
+ */
+static uint32_t disk_blocks;
+
+/**
+ * num_dirty - Buffers with BUF_DIRTY set
+ */
+static uint32_t num_dirty;
+
+/**
+ * last_block - Block the previous read ended in, for readahead
+ */
+static uint32_t last_block = BCACHE_NO_BLOCK;
+
+/**
+ * flush_thread - Thread that writes dirty blocks back
+ */
+static thread_t *flush_thread;
+
+/**
+ * stats - Counters
+ */
+static bcache_stats_t stats;
+
+/**
+ * lru_remove - Take a buffer off the LRU list, bcache_lock held
+ * @buf: Buffer
+ *
+ * Return: Nothing
+ */
+static void lru_remove(bcache_buf_t *buf) {
+    buf->lru_prev->lru_next = buf->lru_next;
+    buf->lru_next->lru_prev = buf->lru_prev;
+}
+
+/**
+ * lru_touch - Make a buffer the most recently used, bcache_lock held
+ * @buf: Buffer
+ *
+ * Return: Nothing
+ */
+static void lru_touch(bcache_buf_t *buf) {
+    lru_remove(buf);
+    buf->lru_prev = &lru;
+    buf->lru_next = lru.lru_next;
+    lru.lru_next->lru_prev = buf;
+    lru.lru_next = buf;
+}
+
+/**
+ * hash_bucket - Lookup table slot of a block
+ * @block: Block number
+ *
+ * Return: Bucket head
+ */
+static bcache_buf_t **hash_bucket(uint32_t block) {
+    return &hash[block & (BCACHE_HASH_SIZE - 1)];
+}
+
+/**
+ * hash_find - Find the buffer of a block, bcache_lock held
+ * @block: Block number
+ *
+ * Return: Buffer, or NULL if the block is not cached
+ */
+static bcache_buf_t *hash_find(uint32_t block) {
+    for (bcache_buf_t *buf = *hash_bucket(block); buf; buf = buf->hash_next) {
+        if (buf->block == block)
+            return buf;
+    }
+    return NULL;
+}
+
+/**
+ * hash_remove - Remove a buffer from the lookup table, bcache_lock held
+ * @buf: Buffer holding a block
+ *
+ * Return: Nothing
+ */
+static void hash_remove(bcache_buf_t *buf) {
+    bcache_buf_t **link = hash_bucket(buf->block);
+
+    while (*link != buf)
+        link = &(*link)->hash_next;
+    *link = buf->hash_next;
+}
+
+/**
+ * bcache_evict - Reuse the least recently used idle buffer for a block,
+ * bcache_lock held
+ * @block: Block number, not cached yet
+ *
+ * Buffers in use, in flight or dirty are passed over.
+ * Return: Buffer with no flags, or NULL if every buffer is busy
+ */
+static bcache_buf_t *bcache_evict(uint32_t block) {
+    bcache_buf_t *buf;
+
+    for (buf = lru.lru_prev; buf != &lru; buf = buf->lru_prev) {
+        if (!buf->refs && !(buf->flags & (BUF_IO | BUF_DIRTY)))
+            break;
+    }
+    if (buf == &lru)
+        return NULL;
+
+    if (buf->block != BCACHE_NO_BLOCK)
+        hash_remove(buf);
+    buf->block = block;
+    buf->flags = 0;
+    buf->error = 0;
+    buf->hash_next = *hash_bucket(block);
+    *hash_bucket(block) = buf;
+    lru_touch(buf);
+    return buf;
+}
+
+/**
+ * bcache_io_done - Disk request callback of a buffer
+ * @req: Finished request
+ *
+ * Runs from the disk interrupt.
+ * Return: Nothing
+ */
+static void bcache_io_done(ata_request_t *req) {
+    bcache_buf_t *buf = req->ctx;
+    uint32_t flags = spin_lock_irqsave(&bcache_lock);
+
+    if (req->status == -1) {
+        buf->error = 1;
+        stats.errors++;
+    } else if (req->op == ATA_OP_READ) {
+        buf->flags |= BUF_VALID;
+    } else {
+        /* Writers wait for BUF_IO, so the data did not change meanwhile */
+        buf->flags &= ~BUF_DIRTY;
+        num_dirty--;
+        stats.writebacks++;
+    }
+    buf->flags &= ~BUF_IO;
+
+    /* Each waiter takes bcache_lock before it returns, so its entry stays valid */
+    for (bcache_waiter_t *waiter = buf->waiters; waiter; waiter = waiter->next)
+        thread_wake(waiter->thread);
+    buf->waiters = NULL;
+    spin_unlock_irqrestore(&bcache_lock, flags);
+}
+
+/**
+ * bcache_io_prepare - Set up a buffer's disk request, bcache_lock held
+ * @buf: Buffer not in flight
+ * @op: ATA_OP_READ or ATA_OP_WRITE
+ *
+ * The last block of the disk may be short; a read zero-fills the rest.
+ * Return: Request to pass to ata_submit() after dropping bcache_lock
+ */
+static ata_request_t *bcache_io_prepare(bcache_buf_t *buf, ata_op_t op) {
+    uint32_t lba = buf->block * BCACHE_BLOCK_SECTORS;
+    uint32_t count = ata_sectors() - lba;
+
+    if (count > BCACHE_BLOCK_SECTORS)
+        count = BCACHE_BLOCK_SECTORS;
+    if (op == ATA_OP_READ && count < BCACHE_BLOCK_SECTORS)
+        kmemset(buf->data + count * ATA_SECTOR_SIZE, 0, (BCACHE_BLOCK_SECTORS - count) * ATA_SECTOR_SIZE);
+
+    buf->flags |= BUF_IO;
+    buf->error = 0;
+    buf->req.op = op;
+    buf->req.lba = lba;
+    buf->req.count = count;
+    buf->req.buf = buf->data;
+    buf->req.done = bcache_io_done;
+    buf->req.ctx = buf;
+    return &buf->req;
+}
+
+/**
+ * bcache_wait - Wait until a buffer has no I/O in flight, bcache_lock held
+ * @buf: Buffer with a reference or in flight
+ * @flags: Value returned by spin_lock_irqsave()
+ *
+ * bcache_lock is dropped while waiting. The idle thread, which must not
+ * sleep, spins with interrupts enabled instead.
+ * Return: EFLAGS for spin_unlock_irqrestore(), bcache_lock held again
+ */
+static uint32_t bcache_wait(bcache_buf_t *buf, uint32_t flags) {
+    while (buf->flags & BUF_IO) {
+        if (thread_can_block()) {
+            bcache_waiter_t self = { .thread = thread_current(), .next = buf->waiters };
+            buf->waiters = &self;
+
+            /* Blocked before the lock is dropped, so an early wake-up is not lost */
+            self.thread->state = THREAD_BLOCKED;
+            spin_unlock(&bcache_lock);
+            schedule();
+            spin_lock(&bcache_lock);
+
+            /* A stray wake-up leaves the entry queued */
+            for (bcache_waiter_t **link = &buf->waiters; *link; link = &(*link)->next) {
+                if (*link == &self) {
+                    *link = self.next;
+                    break;
+                }
+            }
+        } else {
+            spin_unlock_irqrestore(&bcache_lock, flags);
+            cpu_relax();
+            flags = spin_lock_irqsave(&bcache_lock);
+        }
+    }
+    return flags;
+}
+
+/**
+ * bcache_readahead - Queue reads of the blocks after a sequential
+ * reader, bcache_lock held
+ * @block: Block the reader asked for
+ * @reqs: Filled in with the requests to submit
+ *
+ * Only idle buffers are used; readahead never waits.
+ * Return: Number of requests in @reqs
+ */
+static uint32_t bcache_readahead(uint32_t block, ata_request_t **reqs) {
+    uint32_t n = 0;
+
+    for (uint32_t next = block + 1; next <= block + BCACHE_READAHEAD && next < disk_blocks; next++) {
+        if (hash_find(next))
+            continue;
+
+        bcache_buf_t *buf = bcache_evict(next);
+        if (!buf)
+            break;
+        buf->flags |= BUF_READAHEAD;
+        reqs[n++] = bcache_io_prepare(buf, ATA_OP_READ);
+        stats.readahead++;
+    }
+    return n;
+}
+
+/**
+ * bcache_writeback - Queue writes of all dirty blocks not in flight,
+ * bcache_lock held
+ * @reqs: Filled in with the requests to submit, BCACHE_NUM_BUFFERS entries
+ *
+ * Return: Number of requests in @reqs
+ */
+static uint32_t bcache_writeback(ata_request_t **reqs) {
+    uint32_t n = 0;
+
+    for (uint32_t i = 0; i < BCACHE_NUM_BUFFERS; i++) {
+        bcache_buf_t *buf = &bufs[i];
+        if ((buf->flags & (BUF_DIRTY | BUF_IO)) == BUF_DIRTY)
+            reqs[n++] = bcache_io_prepare(buf, ATA_OP_WRITE);
+    }
+    return n;
+}
+
+/**
+ * bcache_submit - Hand queued requests to the disk
+ * @reqs: Requests
+ * @n: Number of requests
+ *
+ * Must be called without bcache_lock, whose holder the completion takes.
+ * Return: Nothing
+ */
+static void bcache_submit(ata_request_t **reqs, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++)
+        ata_submit(reqs[i]);
+}
+
+/**
+ * bcache_account - Add a block lookup to the statistics, bcache_lock held
+ * @hit: Non-zero if the lookup hit
+ * @ns: How long the lookup took
+ *
+ * Return: Nothing
+ */
+static void bcache_account(int hit, uint64_t ns) {
+    if (hit) {
+        stats.hits++;
+        stats.hit_ns += ns;
+        if (ns > stats.hit_ns_max)
+            stats.hit_ns_max = ns;
+    } else {
+        stats.misses++;
+        stats.miss_ns += ns;
+        if (ns > stats.miss_ns_max)
+            stats.miss_ns_max = ns;
+    }
+}
+
+/**
+ * bcache_get - Get a block's buffer with valid data
+ * @block: Block number, on the disk
+ * @fill: Non-zero to read the block if it is not cached, zero if the
+ *        caller overwrites all of it
+ * @flags: Set to the EFLAGS for spin_unlock_irqrestore()
+ *
+ * On success bcache_lock is held, the buffer is referenced and not in
+ * flight. Reading a block sequentially after the previous one starts
+ * readahead.
+ * Return: Buffer, or NULL on a drive error or with every buffer busy
+ */
+static bcache_buf_t *bcache_get(uint32_t block, int fill, uint32_t *flags) {
+    ata_request_t *reqs[BCACHE_READAHEAD + 1];
+    uint64_t start = clock_monotonic_ns();
+    uint32_t n = 0;
+    int synced = 0;
+
+    *flags = spin_lock_irqsave(&bcache_lock);
+    bcache_buf_t *buf = hash_find(block);
+    int hit = buf && (buf->flags & (BUF_VALID | BUF_IO));
+
+    while (!buf) {
+        buf = bcache_evict(block);
+        if (buf)
+            break;
+
+        /* Every buffer is dirty or busy, write them back once and retry */
+        spin_unlock_irqrestore(&bcache_lock, *flags);
+        if (synced)
+            return NULL;
+        bcache_sync();
+        synced = 1;
+        *flags = spin_lock_irqsave(&bcache_lock);
+        buf = hash_find(block);
+    }
+
+    buf->refs++;
+    lru_touch(buf);
+    if (buf->flags & BUF_READAHEAD) {
+        buf->flags &= ~BUF_READAHEAD;
+        stats.readahead_hits++;
+    }
+
+    if (fill) {
+        if (!(buf->flags & (BUF_VALID | BUF_IO)))
+            reqs[n++] = bcache_io_prepare(buf, ATA_OP_READ);
+        if (block == last_block + 1)
+            n += bcache_readahead(block, reqs + n);
+        last_block = block;
+    }
+
+    if (n) {
+        spin_unlock_irqrestore(&bcache_lock, *flags);
+        bcache_submit(reqs, n);
+        *flags = spin_lock_irqsave(&bcache_lock);
+    }
+    *flags = bcache_wait(buf, *flags);
+
+    if (fill && !(buf->flags & BUF_VALID)) {
+        buf->refs--;
+        spin_unlock_irqrestore(&bcache_lock, *flags);
+        return NULL;
+    }
+
+    bcache_account(hit, clock_monotonic_ns() - start);
+    return buf;
+}
+
+/**
+ * bcache_check - Check that a byte range lies on the disk
+ * @pos: Byte offset
+ * @len: Bytes
+ *
+ * Return: 0 if it does, -1 otherwise
+ */
+static int bcache_check(uint64_t pos, uint32_t len) {
+    return pos + len > (uint64_t)ata_sectors() * ATA_SECTOR_SIZE ? -1 : 0;
+}
+
+/**
+ * flush_run - Write dirty blocks back every BCACHE_FLUSH_NS
+ * @arg: Unused
+ *
+ * Writers crossing BCACHE_DIRTY_HIGH wake it early.
+ * Return: Does not return
+ */
+static void flush_run(void *arg) {
+    (void)arg;
+
+    while (1) {
+        thread_sleep_ns(BCACHE_FLUSH_NS);
+        if (num_dirty)
+            bcache_sync();
+    }
+}
+
+int bcache_init(void) {
+    lru.lru_prev = lru.lru_next = &lru;
+    for (uint32_t i = 0; i < BCACHE_NUM_BUFFERS; i++) {
+        bufs[i].block = BCACHE_NO_BLOCK;
+        bufs[i].data = block_data[i];
+        bufs[i].lru_prev = bufs[i].lru_next = &bufs[i];
+        lru_touch(&bufs[i]);
+    }
+
+    if (ata_init() == -1)
+        return -1;
+    disk_blocks = (ata_sectors() + BCACHE_BLOCK_SECTORS - 1) / BCACHE_BLOCK_SECTORS;
+
+    flush_thread = thread_create("bcache-flush", flush_run, NULL, SCHED_DEFAULT_PRIORITY);
+    if (!flush_thread)
+        panic("Error: could not start buffer cache flush thread");
+    return 0;
+}
+
+int bcache_read(uint64_t pos, void *dst, uint32_t len) {
+    uint8_t *out = dst;
+
+    if (bcache_check(pos, len) == -1)
+        return -1;
+
+    while (len) {
+        uint32_t within = (uint32_t)(pos % BCACHE_BLOCK_SIZE);
+        uint32_t chunk = BCACHE_BLOCK_SIZE - within;
+        uint32_t flags;
+
+        if (chunk > len)
+            chunk = len;
+
+        bcache_buf_t *buf = bcache_get((uint32_t)(pos / BCACHE_BLOCK_SIZE), 1, &flags);
+        if (!buf)
+            return -1;
+        kmemcpy(out, buf->data + within, chunk);
+        buf->refs--;
+        spin_unlock_irqrestore(&bcache_lock, flags);
+
+        pos += chunk;
+        out += chunk;
+        len -= chunk;
+    }
+
+    return 0;
+}
+
+int bcache_write(uint64_t pos, const void *src, uint32_t len) {
+    const uint8_t *in = src;
+
+    if (bcache_check(pos, len) == -1)
+        return -1;
+
+    while (len) {
+        uint32_t within = (uint32_t)(pos % BCACHE_BLOCK_SIZE);
+        uint32_t chunk = BCACHE_BLOCK_SIZE - within;
+        uint32_t flags;
+
+        if (chunk > len)
+            chunk = len;
+
+        /* A partly written block is read first */
+        bcache_buf_t *buf = bcache_get((uint32_t)(pos / BCACHE_BLOCK_SIZE), chunk != BCACHE_BLOCK_SIZE, &flags);
+        if (!buf)
+            return -1;
+
+        /* Copied under the lock, so no write-back can start halfway */
+        kmemcpy(buf->data + within, in, chunk);
+        buf->flags |= BUF_VALID;
+        if (!(buf->flags & BUF_DIRTY)) {
+            buf->flags |= BUF_DIRTY;
+            num_dirty++;
+        }
+        buf->refs--;
+        int kick = num_dirty >= BCACHE_DIRTY_HIGH;
+        spin_unlock_irqrestore(&bcache_lock, flags);
+
+        if (kick)
+            thread_wake(flush_thread);
+
+        pos += chunk;
+        in += chunk;
+        len -= chunk;
+    }
+
+    return 0;
+}
+
+int bcache_sync(void) {
+    ata_request_t *reqs[BCACHE_NUM_BUFFERS];
+    int ret = 0;
+
+    uint32_t flags = spin_lock_irqsave(&bcache_lock);
+    uint32_t n = bcache_writeback(reqs);
+    spin_unlock_irqrestore(&bcache_lock, flags);
+    bcache_submit(reqs, n);
+
+    /* Wait for the writes, including ones started by an earlier sync */
+    flags = spin_lock_irqsave(&bcache_lock);
+    for (uint32_t i = 0; i < BCACHE_NUM_BUFFERS; i++) {
+        bcache_buf_t *buf = &bufs[i];
+        if (!(buf->flags & BUF_DIRTY))
+            continue;
+
+        flags = bcache_wait(buf, flags);
+        if (buf->error)
+            ret = -1;
+    }
+    spin_unlock_irqrestore(&bcache_lock, flags);
+
+    if (ata_flush() == -1)
+        ret = -1;
+    return ret;
+}
+
+const bcache_stats_t *bcache_get_stats(void) {
+    return &stats;
+}
+
+void bcache_report(void) {
+    bcache_stats_t snap;
+
+    uint32_t flags = spin_lock_irqsave(&bcache_lock);
+    snap = stats;
+    uint32_t dirty = num_dirty;
+    spin_unlock_irqrestore(&bcache_lock, flags);
+
+    uint64_t lookups = snap.hits + snap.misses;
+    kprintf("bcache: %llu lookups, %llu hits (%llu%%), %llu misses, %u of %u blocks dirty\n",
+            lookups, snap.hits, lookups ? snap.hits * 100 / lookups : 0, snap.misses,
+            dirty, BCACHE_NUM_BUFFERS);
+    kprintf("bcache: hit avg %llu ns max %llu ns, miss avg %llu ns max %llu ns\n",
+            snap.hits ? snap.hit_ns / snap.hits : 0, snap.hit_ns_max,
+            snap.misses ? snap.miss_ns / snap.misses : 0, snap.miss_ns_max);
+    kprintf("bcache: %llu read ahead, %llu used, %llu written back, %llu errors\n",
+            snap.readahead, snap.readahead_hits, snap.writebacks, snap.errors);
+}
@@ -0,0 +1,128 @@
+#ifndef BCACHE_H
+#define BCACHE_H
+
+#include <stdint.h>
+
+#include "../drivers/ata.h"
+
+/**
+ * BCACHE_BLOCK_SIZE - Bytes per cached block, one page
+ */
+#define BCACHE_BLOCK_SIZE       4096
+
+/**
+ * BCACHE_BLOCK_SECTORS - Disk sectors per cached block
+ */
+#define BCACHE_BLOCK_SECTORS    (BCACHE_BLOCK_SIZE / ATA_SECTOR_SIZE)
+
+/**
+ * BCACHE_NUM_BUFFERS - Blocks the cache holds (256 KiB)
+ */
+#define BCACHE_NUM_BUFFERS      64
+
+/**
+ * BCACHE_HASH_SIZE - Buckets of the block lookup table, a power of two
+ */
+#define BCACHE_HASH_SIZE        64
+
+/**
+ * BCACHE_READAHEAD - Blocks read ahead of a sequential reader
+ */
+#define BCACHE_READAHEAD        8
+
+/**
+ * BCACHE_DIRTY_HIGH - Dirty blocks at which writers wake the flush thread
+ */
+#define BCACHE_DIRTY_HIGH       (BCACHE_NUM_BUFFERS / 2)
+
+/**
+ * BCACHE_FLUSH_NS - Longest a dirty block waits for the flush thread
+ */
+#define BCACHE_FLUSH_NS         1000000000ULL
+
+/**
+ * BCACHE_REPORT_SCANCODE - F4 make code, prints the cache statistics
+ */
+#define BCACHE_REPORT_SCANCODE  0x3E
+
+/**
+ * struct bcache_stats_t - Buffer cache counters
+ * @hits: Block lookups that found the block cached or already being read
+ * @misses: Block lookups that had to read the disk
+ * @readahead: Blocks read ahead of a sequential reader
+ * @readahead_hits: Read-ahead blocks a reader asked for later
+ * @writebacks: Dirty blocks written to the disk
+ * @errors: Reads and writes the drive failed
+ * @hit_ns: Total time of block lookups that hit
+ * @hit_ns_max: Longest block lookup that hit
+ * @miss_ns: Total time of block lookups that missed, including the read
+ * @miss_ns_max: Longest block lookup that missed
+ */
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t readahead;
+    uint64_t readahead_hits;
+    uint64_t writebacks;
+    uint64_t errors;
+    uint64_t hit_ns;
+    uint64_t hit_ns_max;
+    uint64_t miss_ns;
+    uint64_t miss_ns_max;
+} bcache_stats_t;
+
+/**
+ * bcache_init - Bring up the boot disk and start the flush thread
+ *
+ * Needs the scheduler.
+ * Return: 0 on success, -1 if there is no disk
+ */
+int bcache_init(void);
+
+/**
+ * bcache_read - Read bytes from the boot disk through the cache
+ * @pos: Byte offset on the disk
+ * @dst: Destination
+ * @len: Bytes to read
+ *
+ * Blocks missing from the cache are read with the caller waiting. When
+ * the reader moves on to the block after the one it read last, the
+ * following BCACHE_READAHEAD blocks are requested without waiting.
+ * Return: 0 on success, -1 on a drive error or a range past the disk
+ */
+int bcache_read(uint64_t pos, void *dst, uint32_t len);
+
+/**
+ * bcache_write - Write bytes to the boot disk through the cache
+ * @pos: Byte offset on the disk
+ * @src: Source
+ * @len: Bytes to write
+ *
+ * Only the cache is updated. The flush thread writes dirty blocks back
+ * within BCACHE_FLUSH_NS, or sooner once BCACHE_DIRTY_HIGH are dirty.
+ * Return: 0 on success, -1 on a drive error or a range past the disk
+ */
+int bcache_write(uint64_t pos, const void *src, uint32_t len);
+
+/**
+ * bcache_sync - Write all dirty blocks back and flush the drive's cache
+ *
+ * Return: 0 on success, -1 if a block could not be written
+ */
+int bcache_sync(void);
+
+/**
+ * bcache_get_stats - Get the buffer cache counters
+ *
+ * Return: Pointer to the counters
+ */
+const bcache_stats_t *bcache_get_stats(void);
+
+/**
+ * bcache_report - Print the hit rate and lookup latencies to the debug console
+ *
+ * Return: Nothing
+ */
+void bcache_report(void);
+
+#endif
@@ -5,7 +5,25 @@ extern kmain
 code_segment equ 0x08
 data_segment equ 0x10
 
+; Multiboot header, so a Multiboot loader (qemu -kernel, GRUB) can load
+; kernel.elf directly; the linker puts it in the first 8 KiB of the file
+multiboot_magic equ 0x1BADB002
+multiboot_flags equ 0x00000002  ; Ask for the memory map
+
+section .multiboot
+align 4
+    dd multiboot_magic
+    dd multiboot_flags
+    dd -(multiboot_magic + multiboot_flags)
+
+section .text
 start:
+    ; A Multiboot loader leaves its own GDT, with other selectors, so load
+    ; the same flat segments sboot uses on both paths
+    lgdt [gdt_descriptor]
+    jmp code_segment:.reload
+
+.reload:
     mov ax, data_segment
 	mov ds, ax
 	mov es, ax
@@ -15,8 +33,24 @@ start:
 	mov ebp, 0x004FFFFF
 	mov esp, ebp
 
+    ; kmain(magic, info): EAX and EBX as a Multiboot loader leaves them,
+    ; sboot never puts the magic in EAX
+    push ebx
+    push eax
     call kmain
 	jmp $
 
 .hang:
-	jmp .hang
\ No newline at end of file
+	jmp .hang
+
+section .data
+align 8
+gdt_start:
+    dq 0x0000000000000000       ; Null descriptor
+    dq 0x00CF9A000000FFFF       ; Kernel code (0x08)
+    dq 0x00CF92000000FFFF       ; Kernel data (0x10)
+gdt_end:
+
+gdt_descriptor:
+    dw gdt_end - gdt_start - 1
+    dd gdt_start
@@ -1,9 +1,36 @@
+#include <stddef.h>
+
+#include "multiboot.h"
+#include "../block/bcache.h"
+#include "../cpu/fpu.h"
+#include "../cpu/lockstat.h"
+#include "../cpu/smp.h"
 #include "../drivers/vga.h"
+#include "../drivers/pit.h"
+#include "../drivers/keyboard.h"
+#include "../drivers/serial.h"
 #include "../interrupts/idt.h"
 #include "../interrupts/pic.h"
+#include "../interrupts/apic.h"
+#include "../interrupts/softirq.h"
+#include "../interrupts/irqstats.h"
+#include "../interrupts/syscall.h"
+#include "../debug/boottime.h"
+#include "../debug/profile.h"
+#include "../exec/exec.h"
+#include "../lib/mem.h"
+#include "../lib/printf.h"
+#include "../time/ktimer.h"
+#include "../time/clocksource.h"
+#include "../time/clockevent.h"
+#include "../time/vdso.h"
+#include "../sched/sched.h"
+#include "../sched/task.h"
+#include "../sched/ipc.h"
 #include "../memory/falloc.h"
 #include "../memory/paging.h"
 #include "../memory/mmap.h"
+#include "../utils.h"
 
 /**
  * BLACK - Black vga color definition
@@ -33,44 +60,166 @@ void terminal_init(void) {
 
 /**
  * kernel_init - Initialize core kernel subsystems
+ * @magic: MULTIBOOT_BOOTLOADER_MAGIC if a Multiboot loader started us
+ * @info: Multiboot boot information, valid with @magic
  *
  * Return: Nothing
  */
-void kernel_init(void) {
-    /* Terminal */
+void kernel_init(uint32_t magic, const multiboot_info_t *info) {
+    /* Per-CPU data and GDT, so cpu_id() works from here on */
+    boottime_mark("smp_early_init");
+    smp_early_init();
+
+    /* Terminal and serial debug console */
+    boottime_mark("terminal_init");
     terminal_init();
+    serial_init();
     vga_print_string(0, 0, "Initialized terminal", WHITE, BLACK);
 
     /* Interrupts */
+    boottime_mark("idt_init");
     idt_init();
+    irqstats_init();
     vga_print_string(1, 0, "Initialized IDT", WHITE, BLACK);
 
+    boottime_mark("pic_init");
     pic_init(0x20, 0x28);
-    irq_clear_mask(0);                  /* Enable timer (IRQ0) */
-    irq_clear_mask(1);                  /* Enable keyboard (IRQ1) */
+    pit_init();                         /* One-shot timer (IRQ0) */
+    ktimer_subsys_init();               /* Timer wheel for tick timeouts */
+    boottime_mark("clocksource_init");
+    if (clocksource_init() == 0)        /* TSC time, if invariant */
+        kprintf("clocksource: TSC at %llu Hz\n", clocksource_tsc_hz());
+    else
+        kprintf("clocksource: no invariant TSC, using the clock event device\n");
+    boottime_mark("keyboard_init");
+    keyboard_init();                    /* Keyboard (IRQ1) */
+    keyboard_register_hotkey(IRQSTATS_DUMP_SCANCODE, irqstats_dump);
+    keyboard_register_hotkey(PROFILE_TOGGLE_SCANCODE, profile_toggle);
+    keyboard_register_hotkey(PROFILE_DUMP_SCANCODE, profile_dump);
+    keyboard_register_hotkey(LOCKSTAT_REPORT_SCANCODE, lockstat_report);
     __asm__ volatile ("sti");               /* Enable interrupts */
     vga_print_string(2, 0, "Initialized PIC", WHITE, BLACK);
 
-    /* Memory */
-    mmap_init(&mmap);
+    /* Memory: the loader's map if there is one, else the fixed layout */
+    boottime_mark("mmap_init");
+    if (magic == MULTIBOOT_BOOTLOADER_MAGIC && (info->flags & MULTIBOOT_INFO_MMAP))
+        mmap_init_multiboot(&mmap, (const void *)(uintptr_t)info->mmap_addr, info->mmap_length);
+    else
+        mmap_init(&mmap);
     vga_print_string(3, 0, "Initialized global memory map", WHITE, BLACK);
 
+    boottime_mark("falloc_init");
     falloc_init(&mmap);
     vga_print_string(4, 0, "Initialized page frame allocator", WHITE, BLACK);
 
+    boottime_mark("paging_init");
     paging_init(&mmap);
     vga_print_string(5, 0, "Initialized paging", WHITE, BLACK);
+    boottime_mark("vdso_init");
+    vdso_init();                        /* Time page readable from ring 3 */
+
+    /* FPU/SSE with lazy state switching (needs the #NM vector) */
+    boottime_mark("fpu_init");
+    if (fpu_init() == 0)
+        vga_print_string(8, 0, "Initialized FPU and SSE", WHITE, BLACK);
+    else
+        vga_print_string(8, 0, "No FXSR/SSE, FPU disabled", WHITE, BLACK);
+    mem_init(mem_detect());             /* String routines for this CPU */
+
+    /* Interrupt controller (needs paging for MMIO) */
+    boottime_mark("apic_init");
+    if (apic_init() == 0 && lapic_timer_init() == 0)
+        vga_print_string(6, 0, "Initialized APIC and LAPIC timer", WHITE, BLACK);
+    else
+        vga_print_string(6, 0, "Using PIC and PIT one-shot timer", WHITE, BLACK);
+
+    /* Threads (needs paging for stacks and a clock for time slices) */
+    boottime_mark("sched_init");
+    sched_init();
+    vga_print_string(9, 0, "Initialized scheduler", WHITE, BLACK);
+
+    /* System calls (before the APs, which program their own MSRs) */
+    boottime_mark("syscall_init");
+    syscall_init();
+    keyboard_register_hotkey(SYSCALL_BENCH_SCANCODE, syscall_bench);
+
+    /* Application processors (need the scheduler for their idle threads) */
+    boottime_mark("smp_init");
+    uint32_t cpus = smp_init();
+    kprintf("smp: %u CPU(s) online\n", cpus);
+    vga_print_string(10, 0, "CPUs online: ", WHITE, BLACK);
+    vga_print_hex(10, 13, cpus, WHITE, BLACK);
+
+    /* Work-stealing tasks across the online CPUs */
+    boottime_mark("task_init");
+    task_init();
+    keyboard_register_hotkey(TASK_BENCH_SCANCODE, task_bench);
+
+    /* Message passing between threads */
+    boottime_mark("ipc_init");
+    ipc_init();
+    keyboard_register_hotkey(IPC_BENCH_SCANCODE, ipc_bench);
+
+    /* Boot disk behind the buffer cache (needs threads for the flush thread) */
+    boottime_mark("bcache_init");
+    if (bcache_init() == 0)
+        kprintf("bcache: %u sectors on the boot disk\n", ata_sectors());
+    keyboard_register_hotkey(BCACHE_REPORT_SCANCODE, bcache_report);
+
+    /* First user program, paged in from the boot disk as it runs */
+    boottime_mark("exec_init");
+    if (exec_init() == 0)
+        vga_print_string(11, 0, "Started init", WHITE, BLACK);
+    keyboard_register_hotkey(EXEC_REPORT_SCANCODE, exec_report);
 }
 
 /**
- * kmain - Kernel entry point
+ * report_irq_off_time - Show the worst interrupts-off span when it changes
+ *
+ * Return: Nothing
+ */
+static void report_irq_off_time(void) {
+    static uint64_t reported;
+    uint64_t cycles = softirq_get_stats()->irq_off_max_cycles;
+
+    if (cycles == reported)
+        return;
+
+    reported = cycles;
+    vga_print_string(7, 0, "Max IRQ-off cycles: ", WHITE, BLACK);
+    vga_print_hex(7, 20, (uint32_t)cycles, WHITE, BLACK);
+}
+
+/**
+ * stats_thread - Refresh on-screen statistics ten times a second
+ * @arg: Unused
  *
  * Return: Does not return
  */
-void kmain(void) {
-    kernel_init();
+static void stats_thread(void *arg) {
+    (void)arg;
 
-    while(1) {
-        ;
+    while (1) {
+        report_irq_off_time();
+        thread_sleep_ns(NSEC_PER_SEC / 10);
     }
-}
\ No newline at end of file
+}
+
+/**
+ * kmain - Kernel entry point
+ * @magic: EAX at entry, MULTIBOOT_BOOTLOADER_MAGIC from a Multiboot loader
+ * @info: EBX at entry, the Multiboot boot information
+ *
+ * After initialization the boot context is the idle thread of CPU 0.
+ * Return: Does not return
+ */
+void kmain(uint32_t magic, const multiboot_info_t *info) {
+    boottime_init(magic != MULTIBOOT_BOOTLOADER_MAGIC);
+    kernel_init(magic, info);
+    boottime_report();
+
+    if (!thread_create("stats", stats_thread, NULL, SCHED_DEFAULT_PRIORITY))
+        panic("Error: could not start stats thread");
+
+    sched_idle();
+}
@@ -0,0 +1,73 @@
+#ifndef MULTIBOOT_H
+#define MULTIBOOT_H
+
+#include <stdint.h>
+
+/**
+ * MULTIBOOT_HEADER_MAGIC - Magic number of the header in kernel.asm
+ */
+#define MULTIBOOT_HEADER_MAGIC          0x1BADB002
+
+/**
+ * MULTIBOOT_BOOTLOADER_MAGIC - Value a Multiboot loader leaves in EAX,
+ * passed on to kmain()
+ */
+#define MULTIBOOT_BOOTLOADER_MAGIC      0x2BADB002
+
+/**
+ * MULTIBOOT_INFO_MEMORY - multiboot_info_t.mem_lower/mem_upper are valid
+ */
+#define MULTIBOOT_INFO_MEMORY           0x00000001
+
+/**
+ * MULTIBOOT_INFO_MMAP - multiboot_info_t.mmap_length/mmap_addr are valid
+ */
+#define MULTIBOOT_INFO_MMAP             0x00000040
+
+/**
+ * MULTIBOOT_MEMORY_AVAILABLE - Memory map entry type of usable RAM, every
+ * other type is reserved
+ */
+#define MULTIBOOT_MEMORY_AVAILABLE      1
+
+/**
+ * struct multiboot_info_t - Boot information a Multiboot loader passes in EBX
+ * @flags: MULTIBOOT_INFO_* flags, which of the fields below are valid
+ * @mem_lower: KiB of memory from 0
+ * @mem_upper: KiB of memory from 1 MiB
+ * @boot_device: BIOS disk the kernel was loaded from
+ * @cmdline: Physical address of the command line
+ * @mods_count: Number of boot modules
+ * @mods_addr: Physical address of the module list
+ * @syms: Symbol table information
+ * @mmap_length: Bytes of memory map entries
+ * @mmap_addr: Physical address of the first memory map entry
+ */
+typedef struct {
+    uint32_t flags;
+    uint32_t mem_lower;
+    uint32_t mem_upper;
+    uint32_t boot_device;
+    uint32_t cmdline;
+    uint32_t mods_count;
+    uint32_t mods_addr;
+    uint32_t syms[4];
+    uint32_t mmap_length;
+    uint32_t mmap_addr;
+} __attribute__((packed)) multiboot_info_t;
+
+/**
+ * struct multiboot_mmap_entry_t - Memory map entry from the BIOS (E820)
+ * @size: Bytes in the entry after this field, the next one follows
+ * @addr: Physical start address
+ * @len: Length in bytes
+ * @type: MULTIBOOT_MEMORY_AVAILABLE or a reserved type
+ */
+typedef struct {
+    uint32_t size;
+    uint64_t addr;
+    uint64_t len;
+    uint32_t type;
+} __attribute__((packed)) multiboot_mmap_entry_t;
+
+#endif
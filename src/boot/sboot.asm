@@ -1,6 +1,8 @@
 org 0x7C00
 bits 16
 
+boot_tsc_addr       equ 0x0500  ; TSC at sboot entry, must match BOOT_TSC_ADDR
+
 start:
     cld
 
@@ -12,9 +14,20 @@ start:
     mov ss, ax
     mov sp, 0x7C00
 
+    ; Boot timestamp for the kernel's boot-phase report
+    rdtsc
+    mov [boot_tsc_addr], eax
+    mov [boot_tsc_addr + 4], edx
+
 	; Enable A20 line
-    call enable_a20
+	in al, 0x92
+	test al, 2
+	jnz after
+	or al, 2
+	and al, 0xFE
+	out 0x92, al
 
+after:
     ; Disable NMI
     in al, 0x70
     or al, 0x80
@@ -32,17 +45,6 @@ start:
     ; Make cs register hold the newly defined selector
     jmp code_segment:protected
 
-enable_a20:
-	in al, 0x92
-	test al, 2
-	jnz after
-	or al, 2
-	and al, 0xFE
-	out 0x92, al
-
-after:
-	ret
-
 gdt_descriptor:
     ; gdt_descriptor size
     dw gdt_end - gdt_start - 1
@@ -63,18 +65,8 @@ gdt_kernel_data_segment:
     ; Kernel mode data segment (Offset: 0x0010) - 4GB limit so kernel can access 0xB8000 (VGA)
     dq 0x00CF92000000FFFF
 
-gdt_user_code_segment:
-    ; User mode code segment (Offset: 0x0018)
-    dq 0x00CFFA000000FFFF
-
-gdt_user_data_segment:
-    ; User mode data segment (Offset: 0x0020)
-    dq 0x00CFF2000000FFFF
-
-gdt_task_state_segment:
-    ; Task state segment(?) (Offset: 0x0028)
-    ; Needs to be set using C code due to usage of sizeof(TSS) for limit
-    dq 0x0000000000000000
+; User and task state segments are left to gdt_init_cpu(), which installs
+; the kernel's own GDT before anything runs in ring 3
 
 gdt_end:
 
@@ -91,107 +83,257 @@ protected:
     
     ; Load the kernel
     call load_kernel
-    
-    ; Jump to kernel
-    jmp code_segment:0x00100000
 
-; Read kernel_num_sectors sectors starting from LBA 2 into 0x00100000
-load_kernel:
-    pushad
-    
-    mov edi, 0x00100000         ; Destination address
-    mov eax, 2                  ; Starting LBA (third sector)
-    mov ecx, kernel_num_sectors ; Number of sectors to read
-    
-.read_loop:
-    push eax                    ; Save current LBA
-    push ecx                    ; Save remaining sector count
-    
-    ; Wait for drive to be ready
-    mov dx, 0x1F7               ; Status port
+    ; Jump to the kernel's ELF entry point
+    jmp [elf_header + elf_entry]
+
+;
+; ATA primary bus, master drive, polled PIO
+;
+ata_data            equ 0x1F0
+ata_sector_count    equ 0x1F2
+ata_status          equ 0x1F7   ; Also the command register
+ata_alt_status      equ 0x3F6
+ata_status_err      equ 0x21    ; ERR or DF
+ata_status_drq      equ 0x08
+ata_status_rdy      equ 0x40
+ata_status_bsy      equ 0x80
+ata_cmd_read        equ 0x20    ; READ SECTORS
+ata_cmd_read_mult   equ 0xC4    ; READ MULTIPLE
+ata_cmd_set_mult    equ 0xC6    ; SET MULTIPLE MODE
+ata_cmd_identify    equ 0xEC    ; IDENTIFY DEVICE
+ata_max_sectors     equ 256     ; Per command, a count of 0 means 256
+kernel_lba          equ 2       ; Kernel ELF file starts at the third sector
 
-.wait_ready:
+;
+; ELF32 file and program header fields
+;
+elf_header          equ 0x8000  ; First sector of the kernel file, read here
+elf_magic           equ 0x464C457F
+elf_entry           equ 24
+elf_phoff           equ 28
+elf_phnum           equ 44
+elf_phdr_size       equ 32
+elf_pt_load         equ 1
+elf_p_offset        equ 4
+elf_p_paddr         equ 12
+elf_p_filesz        equ 16
+elf_p_memsz         equ 20
+
+; Wait until the drive is not busy and has the status bits in AH set
+; Returns with CF set on a drive error; clobbers AL and DX
+ata_wait:
+    ; Status is not valid for 400 ns after a command or a data block
+    mov dx, ata_alt_status
     in al, dx
-    test al, 0x80               ; Test BSY bit
-    jnz .wait_ready
-    test al, 0x40               ; Test RDY bit
-    jz .wait_ready
-    
-    pop ecx                     ; Restore sector count
-    pop eax                     ; Restore current LBA
+    in al, dx
+    in al, dx
+    in al, dx
+    mov dx, ata_status
+
+.poll:
+    in al, dx
+    test al, ata_status_bsy
+    jnz .poll
+    test al, ata_status_err
+    jnz .error
+    and al, ah
+    cmp al, ah
+    jne .poll
+    clc
+    ret
+
+.error:
+    stc
+    ret
+
+; Issue command BH for BL sectors starting at the LBA in EAX
+; Clobbers DX
+ata_command:
     push eax
-    push ecx
-    
-    ; Select drive and set LBA mode (bits 24-27 of LBA)
-    mov dx, 0x1F6               ; Drive/Head port
-    mov ebx, eax
-    shr ebx, 24
-    and bl, 0x0F                ; Keep only lower 4 bits
-    or bl, 0xE0                 ; Set LBA mode, master drive
+    mov ah, ata_status_rdy
+    call ata_wait
+    mov dx, ata_sector_count
     mov al, bl
     out dx, al
-    
-    ; Write sector count (1 sector at a time)
-    mov dx, 0x1F2               ; Sector count port
-    mov al, 1
-    out dx, al
-    
-    pop ecx
     pop eax
     push eax
-    push ecx
-    
-    ; Write LBA address (bits 0-7)
-    mov dx, 0x1F3               ; LBA low byte
+
+    ; LBA bits 0-23 go to 0x1F3-0x1F5, bits 24-27 to the drive register
+    inc dx
     out dx, al
-    
-    ; LBA bits 8-15
-    mov dx, 0x1F4               ; LBA mid byte
-    mov ebx, eax
-    shr ebx, 8
-    mov al, bl
+    shr eax, 8
+    inc dx
+    out dx, al
+    shr eax, 8
+    inc dx
+    out dx, al
+    shr eax, 8
+    and al, 0x0F
+    or al, 0xE0                 ; LBA mode, master drive
+    inc dx
+    out dx, al
+
+    inc dx
+    mov al, bh
     out dx, al
-    
-    pop ecx
     pop eax
+    ret
+
+; Switch to READ MULTIPLE with the largest block the drive supports,
+; staying with READ SECTORS if it has none or refuses
+ata_init_multiple:
+    pushad
+    xor eax, eax
+    mov bh, ata_cmd_identify
+    call ata_command
+    mov ah, ata_status_drq
+    call ata_wait
+    jc .done
+
+    ; The ELF header overwrites the identify data later
+    mov edi, elf_header
+    mov ecx, 256
+    mov dx, ata_data
+    rep insw
+
+    ; Word 47 bits 0-7: most sectors per READ MULTIPLE block
+    movzx ebx, byte [elf_header + 47 * 2]
+    test ebx, ebx
+    jz .done
+    push ebx
+    xor eax, eax
+    mov bh, ata_cmd_set_mult
+    call ata_command
+    mov ah, ata_status_rdy
+    call ata_wait
+    pop ebx
+    jc .done
+
+    mov [block_sectors], ebx
+    mov byte [read_command], ata_cmd_read_mult
+
+.done:
+    popad
+    ret
+
+; Read ESI sectors starting at the LBA in EAX to EDI, up to ata_max_sectors
+; per command and block_sectors per data transfer
+ata_read:
+    pushad
+
+.command:
+    test esi, esi
+    jz .done
+
+    ; ECX = sectors for this command
+    mov ecx, ata_max_sectors
+    cmp esi, ecx
+    jae .issue
+    mov ecx, esi
+
+.issue:
+    mov bl, cl
+    mov bh, [read_command]
+    call ata_command
+    add eax, ecx
+    sub esi, ecx
+
+.block:
     push eax
+    mov ah, ata_status_drq
+    call ata_wait
+    pop eax
+    jc boot_error
+
+    ; EBX = sectors in this block
+    mov ebx, [block_sectors]
+    cmp ebx, ecx
+    jbe .transfer
+    mov ebx, ecx
+
+.transfer:
+    sub ecx, ebx
     push ecx
-    
-    ; LBA bits 16-23
-    mov dx, 0x1F5               ; LBA high byte
-    mov ebx, eax
-    shr ebx, 16
-    mov al, bl
-    out dx, al
-    
-    ; Send READ SECTORS command
-    mov dx, 0x1F7               ; Command port
-    mov al, 0x20                ; READ SECTORS command
-    out dx, al
-    
-    ; Wait for data to be ready
+    mov ecx, ebx
+    shl ecx, 8                  ; 256 words per sector
+    mov dx, ata_data
+    rep insw
+    pop ecx
+    test ecx, ecx
+    jnz .block
+    jmp .command
 
-.wait_data:
-    in al, dx
-    test al, 0x08               ; Test DRQ (Data Request) bit
-    jz .wait_data
-    
-    ; Read 256 words (512 bytes) from data port
-    mov dx, 0x1F0               ; Data port
-    mov ecx, 256                ; 256 words = 512 bytes
-    rep insw                    ; Read words into [EDI]
-    
-    ; Move to next sector
-    pop ecx                     ; Restore sector count
-    pop eax                     ; Restore LBA
-    inc eax                     ; Next LBA
-    dec ecx                     ; One less sector to read
-    jnz .read_loop              ; Continue if more sectors to read
-    
+.done:
     popad
     ret
 
-kernel_num_sectors equ 100
+; Load the kernel ELF file: read the file-backed bytes of each PT_LOAD
+; segment to its physical address and zero the rest of it (.bss)
+load_kernel:
+    pushad
+    call ata_init_multiple
+
+    ; The linker keeps the program headers in the first sector
+    xor esi, esi
+    inc esi
+    lea eax, [esi + kernel_lba - 1]
+    mov edi, elf_header
+    call ata_read
+    cmp dword [elf_header], elf_magic
+    jne boot_error
+
+    movzx ecx, word [elf_header + elf_phnum]
+    mov ebp, [elf_header + elf_phoff]
+    add ebp, elf_header
+    jecxz .done
+
+.segment:
+    cmp dword [ebp], elf_pt_load
+    jne .next
+
+    ; Segments start on a page in the file, so whole sectors can be read
+    mov eax, [ebp + elf_p_offset]
+    test eax, 511
+    jnz boot_error
+    shr eax, 9
+    add eax, kernel_lba
+    mov edi, [ebp + elf_p_paddr]
+    mov ebx, [ebp + elf_p_filesz]
+    lea esi, [ebx + 511]
+    shr esi, 9
+    call ata_read
+
+    ; Zero from the end of the file bytes to the end of the segment
+    push ecx
+    add edi, ebx
+    mov ecx, [ebp + elf_p_memsz]
+    sub ecx, ebx
+    add ecx, 3
+    shr ecx, 2
+    xor eax, eax
+    rep stosd
+    pop ecx
+
+.next:
+    add ebp, elf_phdr_size
+    loop .segment
+
+.done:
+    popad
+    ret
+
+boot_error:
+    mov word [0xB8000], 0x4F45  ; White on red 'E'
+    hlt
+    jmp boot_error
+
+block_sectors:
+    dd 1
+
+read_command:
+    db ata_cmd_read
+
 code_segment equ gdt_kernel_code_segment - gdt_start
 data_segment equ gdt_kernel_data_segment - gdt_start
 
@@ -0,0 +1,60 @@
+; Boot unpack stub
+;
+; With COMPRESS=1 the disk holds this ELF instead of the kernel, and sboot
+; loads it like any other. It expands the LZ4-compressed kernel image to
+; its load address, zeroes .bss and jumps to the kernel entry point.
+bits 32
+
+; Defines kernel_entry, kernel_load_addr, kernel_image_size and kernel_end,
+; generated by lz4pack.py next to kernel.lz4
+%include "kernel_layout.inc"
+
+unpack_tsc_addr equ 0x0508      ; Must match BOOT_UNPACK_TSC_ADDR
+
+global unpack_start
+global kernel_end
+extern lz4_decompress
+
+section .text
+unpack_start:
+    ; Timestamp for the kernel's boot-phase report
+    rdtsc
+    mov [unpack_tsc_addr], eax
+    mov [unpack_tsc_addr + 4], edx
+
+    ; The kernel may grow over sboot's stack, use one out of its way
+    mov esp, unpack_stack_top
+
+    ; lz4_decompress(payload, payload size, load address, image size)
+    push kernel_image_size
+    push kernel_load_addr
+    push payload_end - payload
+    push payload
+    call lz4_decompress
+    add esp, 16
+    cmp eax, kernel_image_size
+    jne .error
+
+    ; Zero .bss, which is not part of the image
+    mov edi, kernel_load_addr + kernel_image_size
+    mov ecx, (kernel_end - kernel_load_addr - kernel_image_size + 3) / 4
+    xor eax, eax
+    rep stosd
+
+    mov eax, kernel_entry
+    jmp eax
+
+.error:
+    mov word [0xB8000], 0x4F45  ; White on red 'E', as in sboot
+    cli
+    hlt
+    jmp .error
+
+section .rodata
+payload:
+    incbin "kernel.lz4"
+payload_end:
+
+section .bss
+    resb 4096
+unpack_stack_top:
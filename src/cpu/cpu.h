@@ -0,0 +1,250 @@
+#ifndef CPU_H
+#define CPU_H
+
+#include <stdint.h>
+
+/**
+ * MAX_CPUS - Maximum number of CPUs with per-CPU state
+ */
+#define MAX_CPUS            8
+
+/**
+ * EFLAGS_IF - Interrupt enable flag in EFLAGS
+ */
+#define EFLAGS_IF           0x200
+
+/**
+ * EFLAGS_TF - Single-step trap flag in EFLAGS
+ */
+#define EFLAGS_TF           0x100
+
+/**
+ * CPUID_EDX_APIC - CPUID.1:EDX bit for an on-chip local APIC
+ */
+#define CPUID_EDX_APIC      (1U << 9)
+
+/**
+ * CPUID_EDX_SEP - SYSENTER/SYSEXIT supported
+ */
+#define CPUID_EDX_SEP       (1U << 11)
+
+/**
+ * CPUID_EDX_FXSR - CPUID.1:EDX bit for FXSAVE/FXRSTOR
+ */
+#define CPUID_EDX_FXSR      (1U << 24)
+
+/**
+ * CPUID_EDX_SSE - CPUID.1:EDX bit for SSE
+ */
+#define CPUID_EDX_SSE       (1U << 25)
+
+/**
+ * CPUID_EDX_SSE2 - CPUID.1:EDX bit for SSE2
+ */
+#define CPUID_EDX_SSE2      (1U << 26)
+
+/**
+ * CPUID_EBX7_ERMSB - CPUID.7:EBX bit for enhanced rep movsb/stosb
+ */
+#define CPUID_EBX7_ERMSB    (1U << 9)
+
+/**
+ * CR0_MP - Monitor coprocessor (wait/fwait honour CR0.TS)
+ */
+#define CR0_MP              (1U << 1)
+
+/**
+ * CR0_EM - x87 emulation (FPU instructions raise #NM)
+ */
+#define CR0_EM              (1U << 2)
+
+/**
+ * CR0_TS - Task switched (next FPU/SIMD instruction raises #NM)
+ */
+#define CR0_TS              (1U << 3)
+
+/**
+ * CR0_NE - Native x87 error reporting through #MF
+ */
+#define CR0_NE              (1U << 5)
+
+/**
+ * CR4_OSFXSR - OS supports FXSAVE/FXRSTOR (enables SSE)
+ */
+#define CR4_OSFXSR          (1U << 9)
+
+/**
+ * CR4_OSXMMEXCPT - OS handles unmasked SIMD exceptions through #XM
+ */
+#define CR4_OSXMMEXCPT      (1U << 10)
+
+/**
+ * PERCPU_CPU_OFFSET - Offset of the CPU index in the per-CPU data block
+ */
+#define PERCPU_CPU_OFFSET   4
+
+/**
+ * barrier - Compiler memory barrier
+ */
+#define barrier()           __asm__ volatile ("" : : : "memory")
+
+/**
+ * cpu_id - Get the index of the executing CPU
+ *
+ * Reads the per-CPU data block that the gs segment points at.
+ *
+ * Return: CPU index (0 to MAX_CPUS - 1)
+ */
+static inline uint32_t cpu_id(void) {
+    uint32_t cpu;
+    __asm__ volatile ("movl %%gs:%c1, %0" : "=r"(cpu) : "i"(PERCPU_CPU_OFFSET));
+    return cpu;
+}
+
+/**
+ * cpu_relax - Tell the CPU it is in a spin-wait loop
+ *
+ * pause saves power and avoids the memory-order flush when the loop exits.
+ * Return: Nothing
+ */
+static inline void cpu_relax(void) {
+    __asm__ volatile ("pause" : : : "memory");
+}
+
+/**
+ * rdtsc - Read the time stamp counter
+ *
+ * Return: Current TSC value
+ */
+static inline uint64_t rdtsc(void) {
+    uint32_t low, high;
+    __asm__ volatile ("rdtsc" : "=a"(low), "=d"(high));
+    return ((uint64_t)high << 32) | low;
+}
+
+/**
+ * cpuid - Execute the CPUID instruction
+ * @leaf: Value of EAX on input
+ * @eax: Output EAX
+ * @ebx: Output EBX
+ * @ecx: Output ECX
+ * @edx: Output EDX
+ *
+ * Return: Nothing
+ */
+static inline void cpuid(uint32_t leaf, uint32_t *eax, uint32_t *ebx, uint32_t *ecx, uint32_t *edx) {
+    __asm__ volatile ("cpuid"
+                      : "=a"(*eax), "=b"(*ebx), "=c"(*ecx), "=d"(*edx)
+                      : "a"(leaf), "c"(0));
+}
+
+/**
+ * rdmsr - Read a model-specific register
+ * @msr: MSR index
+ *
+ * Return: MSR value
+ */
+static inline uint64_t rdmsr(uint32_t msr) {
+    uint32_t low, high;
+    __asm__ volatile ("rdmsr" : "=a"(low), "=d"(high) : "c"(msr));
+    return ((uint64_t)high << 32) | low;
+}
+
+/**
+ * wrmsr - Write a model-specific register
+ * @msr: MSR index
+ * @value: Value to write
+ *
+ * Return: Nothing
+ */
+static inline void wrmsr(uint32_t msr, uint64_t value) {
+    __asm__ volatile ("wrmsr" : : "c"(msr), "a"((uint32_t)value), "d"((uint32_t)(value >> 32)));
+}
+
+/**
+ * read_cr0 - Read control register 0
+ *
+ * Return: CR0 value
+ */
+static inline uint32_t read_cr0(void) {
+    uint32_t value;
+    __asm__ volatile ("mov %%cr0, %0" : "=r"(value));
+    return value;
+}
+
+/**
+ * write_cr0 - Write control register 0
+ * @value: New CR0 value
+ *
+ * Return: Nothing
+ */
+static inline void write_cr0(uint32_t value) {
+    __asm__ volatile ("mov %0, %%cr0" : : "r"(value) : "memory");
+}
+
+/**
+ * read_cr3 - Read control register 3
+ *
+ * Return: Physical address of the page directory
+ */
+static inline uint32_t read_cr3(void) {
+    uint32_t value;
+    __asm__ volatile ("mov %%cr3, %0" : "=r"(value));
+    return value;
+}
+
+/**
+ * write_cr3 - Write control register 3
+ * @value: Page directory physical address
+ *
+ * Also flushes every TLB entry that is not global.
+ * Return: Nothing
+ */
+static inline void write_cr3(uint32_t value) {
+    __asm__ volatile ("mov %0, %%cr3" : : "r"(value) : "memory");
+}
+
+/**
+ * read_cr4 - Read control register 4
+ *
+ * Return: CR4 value
+ */
+static inline uint32_t read_cr4(void) {
+    uint32_t value;
+    __asm__ volatile ("mov %%cr4, %0" : "=r"(value));
+    return value;
+}
+
+/**
+ * write_cr4 - Write control register 4
+ * @value: New CR4 value
+ *
+ * Return: Nothing
+ */
+static inline void write_cr4(uint32_t value) {
+    __asm__ volatile ("mov %0, %%cr4" : : "r"(value) : "memory");
+}
+
+/**
+ * irq_save - Disable interrupts and return the previous EFLAGS
+ *
+ * Return: EFLAGS before interrupts were disabled
+ */
+static inline uint32_t irq_save(void) {
+    uint32_t flags;
+    __asm__ volatile ("pushf; pop %0; cli" : "=r"(flags) : : "memory");
+    return flags;
+}
+
+/**
+ * irq_restore - Re-enable interrupts if they were enabled in @flags
+ * @flags: EFLAGS returned by irq_save()
+ *
+ * Return: Nothing
+ */
+static inline void irq_restore(uint32_t flags) {
+    if (flags & EFLAGS_IF)
+        __asm__ volatile ("sti" : : : "memory");
+}
+
+#endif
@@ -0,0 +1,202 @@
+#include <stddef.h>
+
+#include "fpu.h"
+#include "cpu.h"
+#include "../interrupts/idt.h"
+
+/**
+ * init_state - Clean state captured right after fninit
+ */
+static fpu_state_t init_state;
+
+/**
+ * boot_state - State of each CPU's boot context
+ */
+static fpu_state_t boot_state[MAX_CPUS];
+
+/**
+ * enabled - Set once fpu_init() succeeded
+ */
+static int enabled;
+
+/**
+ * owner - Context whose state is loaded in each CPU's registers, or NULL
+ */
+static fpu_state_t *owner[MAX_CPUS];
+
+/**
+ * current - State of the context running on each CPU
+ */
+static fpu_state_t *current[MAX_CPUS];
+
+/**
+ * kernel_depth - Open kernel FPU sections on each CPU
+ */
+static uint32_t kernel_depth[MAX_CPUS];
+
+/**
+ * sse2 - Non-zero if SSE2 is usable
+ */
+static int sse2;
+
+/**
+ * fxsave - Save the FPU/SIMD registers
+ * @state: Destination
+ *
+ * Return: Nothing
+ */
+static inline void fxsave(fpu_state_t *state) {
+    __asm__ volatile ("fxsave %0" : "=m"(*state));
+}
+
+/**
+ * fxrstor - Load the FPU/SIMD registers
+ * @state: Source
+ *
+ * Return: Nothing
+ */
+static inline void fxrstor(const fpu_state_t *state) {
+    __asm__ volatile ("fxrstor %0" : : "m"(*state));
+}
+
+/**
+ * clts - Clear CR0.TS so FPU/SIMD instructions run
+ *
+ * Return: Nothing
+ */
+static inline void clts(void) {
+    __asm__ volatile ("clts" : : : "memory");
+}
+
+/**
+ * stts - Set CR0.TS so the next FPU/SIMD instruction raises #NM
+ *
+ * Return: Nothing
+ */
+static inline void stts(void) {
+    write_cr0(read_cr0() | CR0_TS);
+}
+
+/**
+ * fpu_nm_handler - Device-not-available (#NM) handler
+ * @frame: Pointer to interrupt stack frame
+ *
+ * Swaps the previous owner's registers out and the current context's in,
+ * then retries the faulting instruction.
+ * Return: Nothing
+ */
+static void fpu_nm_handler(interrupt_frame_t *frame) {
+    (void)frame;
+    uint32_t cpu = cpu_id();
+
+    clts();
+    if (owner[cpu] == current[cpu])
+        return;
+
+    if (owner[cpu])
+        fxsave(owner[cpu]);
+    fxrstor(current[cpu]);
+    owner[cpu] = current[cpu];
+}
+
+/**
+ * fpu_reset - Enable the FPU and SSE on the executing CPU and reset them
+ *
+ * Return: Nothing
+ */
+static void fpu_reset(void) {
+    /* Native FPU with #MF error reporting, wait/fwait honour TS */
+    write_cr0((read_cr0() & ~(CR0_EM | CR0_TS)) | CR0_MP | CR0_NE);
+    write_cr4(read_cr4() | CR4_OSFXSR | CR4_OSXMMEXCPT);
+
+    uint32_t mxcsr = FPU_MXCSR_DEFAULT;
+    __asm__ volatile ("fninit; ldmxcsr %0" : : "m"(mxcsr));
+}
+
+int fpu_init(void) {
+    uint32_t eax, ebx, ecx, edx;
+
+    cpuid(1, &eax, &ebx, &ecx, &edx);
+    if (!(edx & CPUID_EDX_FXSR) || !(edx & CPUID_EDX_SSE))
+        return -1;
+    sse2 = (edx & CPUID_EDX_SSE2) != 0;
+
+    fpu_reset();
+    fxsave(&init_state);
+    enabled = 1;
+
+    /* The boot context owns the freshly reset registers */
+    uint32_t cpu = cpu_id();
+    boot_state[cpu] = init_state;
+    current[cpu] = &boot_state[cpu];
+    owner[cpu] = &boot_state[cpu];
+
+    exception_register(FPU_VECTOR_NM, fpu_nm_handler);
+    return 0;
+}
+
+int fpu_init_cpu(void) {
+    if (!enabled)
+        return -1;
+
+    fpu_reset();
+
+    uint32_t cpu = cpu_id();
+    boot_state[cpu] = init_state;
+    current[cpu] = &boot_state[cpu];
+    owner[cpu] = &boot_state[cpu];
+    return 0;
+}
+
+int fpu_has_sse2(void) {
+    return sse2;
+}
+
+void fpu_state_init(fpu_state_t *state) {
+    *state = init_state;
+}
+
+void fpu_switch(fpu_state_t *next) {
+    uint32_t cpu = cpu_id();
+
+    current[cpu] = next;
+    if (owner[cpu] == next)
+        clts();
+    else
+        stts();
+}
+
+void fpu_release(fpu_state_t *state) {
+    uint32_t flags = irq_save();
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++)
+        if (owner[cpu] == state)
+            owner[cpu] = NULL;
+    irq_restore(flags);
+}
+
+uint32_t kernel_fpu_begin(void) {
+    uint32_t flags = irq_save();
+    uint32_t cpu = cpu_id();
+
+    /* Only the outermost section parks the owner's registers */
+    if (kernel_depth[cpu]++)
+        return flags;
+
+    /* The owner reloads them lazily after _end() */
+    clts();
+    if (owner[cpu]) {
+        fxsave(owner[cpu]);
+        owner[cpu] = NULL;
+    }
+    return flags;
+}
+
+void kernel_fpu_end(uint32_t flags) {
+    if (--kernel_depth[cpu_id()] == 0)
+        stts();
+    irq_restore(flags);
+}
+
+int kernel_fpu_busy(void) {
+    return kernel_depth[cpu_id()] != 0;
+}
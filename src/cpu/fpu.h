@@ -0,0 +1,115 @@
+#ifndef FPU_H
+#define FPU_H
+
+#include <stdint.h>
+
+/**
+ * FPU_STATE_SIZE - Size of an FXSAVE area
+ */
+#define FPU_STATE_SIZE      512
+
+/**
+ * FPU_MXCSR_DEFAULT - MXCSR with every SIMD exception masked
+ */
+#define FPU_MXCSR_DEFAULT   0x1F80
+
+/**
+ * FPU_VECTOR_NM - Device-not-available exception vector
+ */
+#define FPU_VECTOR_NM       7
+
+/**
+ * struct fpu_state_t - Saved x87/MMX/SSE register state of one context
+ * @area: FXSAVE image (must be 16-byte aligned)
+ */
+typedef struct {
+    uint8_t area[FPU_STATE_SIZE];
+} __attribute__((aligned(16))) fpu_state_t;
+
+/**
+ * fpu_init - Enable the FPU and SSE and arm lazy state switching
+ *
+ * Sets CR4.OSFXSR/OSXMMEXCPT, resets the FPU, captures a clean state
+ * for new contexts and installs the #NM handler. The boot context
+ * becomes the current context.
+ *
+ * Return: 0 on success, -1 if the CPU lacks FXSR or SSE
+ */
+int fpu_init(void);
+
+/**
+ * fpu_init_cpu - Enable the FPU and SSE on an application processor
+ *
+ * Resets the executing CPU's FPU and makes its boot context current.
+ * The #NM handler and clean state come from fpu_init().
+ *
+ * Return: 0 on success, -1 if fpu_init() did not succeed
+ */
+int fpu_init_cpu(void);
+
+/**
+ * fpu_has_sse2 - Check whether SSE2 instructions may be used
+ *
+ * Return: Non-zero after a successful fpu_init() on an SSE2 CPU
+ */
+int fpu_has_sse2(void);
+
+/**
+ * fpu_state_init - Give a context the clean initial state
+ * @state: State to initialize
+ *
+ * Return: Nothing
+ */
+void fpu_state_init(fpu_state_t *state);
+
+/**
+ * fpu_switch - Make @next the current context's state
+ * @next: State of the context being switched to
+ *
+ * Called on context switch with interrupts disabled. No registers are
+ * saved or loaded here; CR0.TS is set unless @next already owns the
+ * FPU, so the first FPU/SIMD instruction of @next traps to #NM which
+ * swaps the state in.
+ *
+ * Return: Nothing
+ */
+void fpu_switch(fpu_state_t *next);
+
+/**
+ * fpu_release - Forget @state if it owns the FPU
+ * @state: State of a context that is going away
+ *
+ * Return: Nothing
+ */
+void fpu_release(fpu_state_t *state);
+
+/**
+ * kernel_fpu_begin - Allow FPU/SIMD use in kernel code
+ *
+ * Saves the owning context's registers and disables interrupts until
+ * kernel_fpu_end(). Kernel FPU sections must not sleep and must not
+ * fault: a page fault handler that uses the FPU would clobber the
+ * section's registers. Sections nest, only the outermost one saves the
+ * owner's registers and sets CR0.TS again; code reachable from a
+ * fault checks kernel_fpu_busy() and stays off the FPU instead.
+ *
+ * Return: Flags to pass to kernel_fpu_end()
+ */
+uint32_t kernel_fpu_begin(void);
+
+/**
+ * kernel_fpu_end - End a kernel FPU/SIMD section
+ * @flags: Value returned by kernel_fpu_begin()
+ *
+ * Return: Nothing
+ */
+void kernel_fpu_end(uint32_t flags);
+
+/**
+ * kernel_fpu_busy - Check whether this CPU is inside a kernel FPU section
+ *
+ * Return: Non-zero if the FPU registers belong to an open section
+ */
+int kernel_fpu_busy(void);
+
+#endif
@@ -0,0 +1,95 @@
+#include <stddef.h>
+
+#include "gdt.h"
+#include "cpu.h"
+
+/**
+ * GDT_FLAGS_FLAT - 4 KiB granularity, 32-bit segment
+ */
+#define GDT_FLAGS_FLAT      0xC
+
+/**
+ * GDT_FLAGS_BYTE - Byte granularity, 32-bit segment
+ */
+#define GDT_FLAGS_BYTE      0x4
+
+/**
+ * gdts - One GDT per CPU, so each gs descriptor can have its own base
+ */
+static gdt_entry_t gdts[MAX_CPUS][GDT_ENTRIES];
+
+/**
+ * gdtrs - GDT pointers for lgdt
+ */
+static gdtr_t gdtrs[MAX_CPUS];
+
+/**
+ * tss - One TSS per CPU, each holding that CPU's ring 0 stack
+ */
+static tss_t tss[MAX_CPUS];
+
+_Static_assert(sizeof(tss_t) == 104, "TSS layout is fixed by the CPU");
+
+/**
+ * gdt_set_entry - Fill one segment descriptor
+ * @entry: Descriptor
+ * @base: Segment base
+ * @limit: 20-bit segment limit
+ * @access: Access byte
+ * @flags: Granularity flags
+ *
+ * Return: Nothing
+ */
+static void gdt_set_entry(gdt_entry_t *entry, uint32_t base, uint32_t limit, uint8_t access, uint8_t flags) {
+    entry->limit_low   = limit & 0xFFFF;
+    entry->base_low    = base & 0xFFFF;
+    entry->base_mid    = (base >> 16) & 0xFF;
+    entry->access      = access;
+    entry->granularity = (uint8_t)((flags << 4) | ((limit >> 16) & 0x0F));
+    entry->base_high   = (base >> 24) & 0xFF;
+}
+
+void gdt_init_cpu(uint32_t cpu, void *percpu, uint32_t size) {
+    gdt_entry_t *gdt = gdts[cpu];
+
+    gdt_set_entry(&gdt[0], 0, 0, 0, 0);
+    gdt_set_entry(&gdt[GDT_KERNEL_CODE / 8], 0, 0xFFFFF, 0x9A, GDT_FLAGS_FLAT);
+    gdt_set_entry(&gdt[GDT_KERNEL_DATA / 8], 0, 0xFFFFF, 0x92, GDT_FLAGS_FLAT);
+    gdt_set_entry(&gdt[GDT_USER_CODE / 8], 0, 0xFFFFF, 0xFA, GDT_FLAGS_FLAT);
+    gdt_set_entry(&gdt[GDT_USER_DATA / 8], 0, 0xFFFFF, 0xF2, GDT_FLAGS_FLAT);
+    gdt_set_entry(&gdt[GDT_TSS / 8], (uint32_t)(uintptr_t)&tss[cpu], sizeof(tss_t) - 1, 0x89, GDT_FLAGS_BYTE);
+    gdt_set_entry(&gdt[GDT_PERCPU / 8], (uint32_t)(uintptr_t)percpu, size - 1, 0x92, GDT_FLAGS_BYTE);
+
+    tss[cpu].ss0 = GDT_KERNEL_DATA;
+    tss[cpu].iomap_base = sizeof(tss_t);
+
+    gdtrs[cpu].base = (uint32_t)(uintptr_t)gdt;
+    gdtrs[cpu].limit = (uint16_t)(sizeof(gdt_entry_t) * GDT_ENTRIES - 1);
+
+    /* A far jump reloads cs; the data segments are reloaded by hand */
+    uint16_t data = GDT_KERNEL_DATA;
+    uint16_t percpu_sel = GDT_PERCPU;
+    uint16_t tss_sel = GDT_TSS;
+    __asm__ volatile (
+        "lgdt %0\n"
+        "ljmp %1, $1f\n"
+        "1:\n"
+        "movw %2, %%ds\n"
+        "movw %2, %%es\n"
+        "movw %2, %%fs\n"
+        "movw %2, %%ss\n"
+        "movw %3, %%gs\n"
+        "ltr %4\n"
+        :
+        : "m"(gdtrs[cpu]), "i"(GDT_KERNEL_CODE), "r"(data), "r"(percpu_sel), "r"(tss_sel)
+        : "memory"
+    );
+}
+
+void tss_set_esp0(uint32_t esp0) {
+    tss[cpu_id()].esp0 = esp0;
+}
+
+uint32_t *tss_esp0_slot(uint32_t cpu) {
+    return &tss[cpu].esp0;
+}
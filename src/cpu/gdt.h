@@ -0,0 +1,125 @@
+#ifndef GDT_H
+#define GDT_H
+
+#include <stdint.h>
+
+/**
+ * GDT_KERNEL_CODE - Kernel code segment selector
+ */
+#define GDT_KERNEL_CODE     0x08
+
+/**
+ * GDT_KERNEL_DATA - Kernel data segment selector
+ */
+#define GDT_KERNEL_DATA     0x10
+
+/**
+ * GDT_USER_CODE - User code segment selector (without RPL)
+ */
+#define GDT_USER_CODE       0x18
+
+/**
+ * GDT_USER_DATA - User data segment selector (without RPL)
+ */
+#define GDT_USER_DATA       0x20
+
+/**
+ * GDT_TSS - Task state segment selector, the CPU's own TSS
+ */
+#define GDT_TSS             0x28
+
+/**
+ * GDT_PERCPU - Selector loaded into gs, based at the CPU's per-CPU data
+ */
+#define GDT_PERCPU          0x30
+
+/**
+ * GDT_ENTRIES - Descriptors in each CPU's GDT
+ */
+#define GDT_ENTRIES         7
+
+/**
+ * struct gdt_entry_t - 32-bit segment descriptor
+ * @limit_low: Bits 0-15 of the limit
+ * @base_low: Bits 0-15 of the base
+ * @base_mid: Bits 16-23 of the base
+ * @access: Present, privilege level and type
+ * @granularity: Flags in the high nibble, limit bits 16-19 in the low one
+ * @base_high: Bits 24-31 of the base
+ */
+typedef struct {
+    uint16_t limit_low;
+    uint16_t base_low;
+    uint8_t  base_mid;
+    uint8_t  access;
+    uint8_t  granularity;
+    uint8_t  base_high;
+} __attribute__((packed)) gdt_entry_t;
+
+/**
+ * struct gdtr_t - Pointer structure for lgdt instruction
+ * @limit: Byte size of the GDT - 1
+ * @base: Address of the first descriptor
+ */
+typedef struct {
+    uint16_t limit;
+    uint32_t base;
+} __attribute__((packed)) gdtr_t;
+
+/**
+ * GDT_RPL_USER - Requested privilege level bits of ring 3 selectors
+ */
+#define GDT_RPL_USER        0x3
+
+/**
+ * struct tss_t - 32-bit task state segment
+ * @link: Previous task link (unused)
+ * @esp0: Stack pointer loaded on a switch to ring 0
+ * @ss0: Stack segment loaded on a switch to ring 0
+ * @unused: Hardware task switching state, never used
+ * @trap: Debug trap on task switch (unused)
+ * @iomap_base: Offset of the I/O permission bitmap; past the limit means none
+ *
+ * Only the ring 0 stack is used: the CPU switches to it when an
+ * interrupt or exception arrives in ring 3.
+ */
+typedef struct {
+    uint32_t link;
+    uint32_t esp0;
+    uint32_t ss0;
+    uint32_t unused[22];
+    uint16_t trap;
+    uint16_t iomap_base;
+} tss_t;
+
+/**
+ * gdt_init_cpu - Build and load the executing CPU's GDT
+ * @cpu: CPU index
+ * @percpu: Address of the CPU's per-CPU data
+ * @size: Size of the per-CPU data in bytes
+ *
+ * The flat segments match the ones the boot loader and the AP trampoline
+ * use, so only gs changes meaning. Reloads every segment register and
+ * loads the CPU's TSS.
+ * Return: Nothing
+ */
+void gdt_init_cpu(uint32_t cpu, void *percpu, uint32_t size);
+
+/**
+ * tss_set_esp0 - Set the stack the executing CPU enters ring 0 on
+ * @esp0: Top of a kernel stack
+ *
+ * Return: Nothing
+ */
+void tss_set_esp0(uint32_t esp0);
+
+/**
+ * tss_esp0_slot - Address of a CPU's TSS esp0 field
+ * @cpu: CPU index
+ *
+ * SYSENTER starts on this address and loads the real stack from it.
+ * Return: Address of the field
+ */
+uint32_t *tss_esp0_slot(uint32_t cpu);
+
+#endif
@@ -0,0 +1,358 @@
+#include <stddef.h>
+
+#include "lockstat.h"
+#ifndef TEST
+#include "../lib/printf.h"
+#include "../sched/sched.h"
+#endif
+
+/**
+ * LOCKSTAT_UNNAMED - Class of locks initialized without a name
+ */
+#define LOCKSTAT_UNNAMED    "(unnamed)"
+
+/**
+ * classes - Lock classes; a slot is claimed by swapping in its name
+ */
+static lock_class_t classes[LOCK_MAX_CLASSES];
+
+#ifdef LOCKDEP
+/**
+ * deps - Bit j of deps[i] set once class j was taken while holding class i
+ */
+static volatile uint32_t deps[LOCK_MAX_CLASSES];
+
+/**
+ * recursion_reported - Classes already reported for recursive acquisition
+ */
+static volatile uint32_t recursion_reported;
+
+/**
+ * violations - Lock-order problems reported
+ */
+static volatile uint32_t violations;
+
+/**
+ * boot_held - Held locks of contexts that are not a thread yet
+ */
+static lockdep_held_t boot_held[MAX_CPUS];
+#endif
+
+#ifndef TEST
+static inline uint32_t lock_cpu(void) {
+    return cpu_id();
+}
+
+static inline uint32_t lock_irq_save(void) {
+    return irq_save();
+}
+
+static inline void lock_irq_restore(uint32_t flags) {
+    irq_restore(flags);
+}
+#else
+/* Host tests run on one simulated CPU and cannot touch EFLAGS.IF */
+static inline uint32_t lock_cpu(void) {
+    return 0;
+}
+
+static inline uint32_t lock_irq_save(void) {
+    return 0;
+}
+
+static inline void lock_irq_restore(uint32_t flags) {
+    (void)flags;
+}
+#endif
+
+/**
+ * names_equal - Compare two class names
+ * @a: Name
+ * @b: Name
+ *
+ * Return: Non-zero if equal
+ */
+static int names_equal(const char *a, const char *b) {
+    if (a == b)
+        return 1;
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+/**
+ * class_find - Look up a class without creating it
+ * @name: Class name
+ *
+ * Return: Class, or NULL if no lock with that name was used
+ */
+static lock_class_t *class_find(const char *name) {
+    for (uint32_t i = 0; i < LOCK_MAX_CLASSES; i++) {
+        const char *slot = __atomic_load_n(&classes[i].name, __ATOMIC_ACQUIRE);
+        if (!slot)
+            return NULL;
+        if (names_equal(slot, name))
+            return &classes[i];
+    }
+    return NULL;
+}
+
+lock_class_t *lock_class_get(const char *name) {
+    if (!name)
+        name = LOCKSTAT_UNNAMED;
+
+    /* Slots fill in order, so the first free one ends the search */
+    for (uint32_t i = 0; i < LOCK_MAX_CLASSES; i++) {
+        const char *slot = __atomic_load_n(&classes[i].name, __ATOMIC_ACQUIRE);
+        if (!slot && __atomic_compare_exchange_n(&classes[i].name, &slot, name, 0,
+                                                 __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            return &classes[i];
+        if (names_equal(slot, name))
+            return &classes[i];
+    }
+    return &classes[LOCK_MAX_CLASSES - 1];
+}
+
+#ifdef LOCKDEP
+/**
+ * held_locks - Held-lock stack of the current context
+ *
+ * Locks follow the thread, so a thread preempted while holding a lock
+ * does not lend it to the next thread on the CPU.
+ * Return: Stack
+ */
+static lockdep_held_t *held_locks(void) {
+#ifndef TEST
+    thread_t *thread = thread_current();
+    if (thread)
+        return &thread->held_locks;
+#endif
+    return &boot_held[lock_cpu()];
+}
+
+/**
+ * lockdep_reaches - Check for a path in the dependency graph
+ * @from: Class index
+ * @to: Class index
+ *
+ * Return: Non-zero if @to was ever taken, directly or transitively,
+ * while holding @from
+ */
+static int lockdep_reaches(uint32_t from, uint32_t to) {
+    uint32_t seen = 1U << from;
+    uint32_t frontier = seen;
+
+    while (frontier) {
+        uint32_t next = 0;
+        for (uint32_t i = 0; i < LOCK_MAX_CLASSES; i++) {
+            if (frontier & (1U << i))
+                next |= deps[i];
+        }
+        if (next & (1U << to))
+            return 1;
+        frontier = next & ~seen;
+        seen |= next;
+    }
+    return 0;
+}
+
+/**
+ * lockdep_report - Print a lock-order problem and the locks held
+ * @what: Problem
+ * @taking: Class being acquired
+ * @holding: Class already held
+ * @held: Held-lock stack of the current context
+ *
+ * Return: Nothing
+ */
+static void lockdep_report(const char *what, lock_class_t *taking, lock_class_t *holding,
+                           lockdep_held_t *held) {
+    __atomic_add_fetch(&violations, 1, __ATOMIC_RELAXED);
+#ifndef TEST
+    kprintf("lockdep: %s: taking %s while holding %s on CPU %u\n",
+            what, taking->name, holding->name, lock_cpu());
+    for (uint32_t i = 0; i < held->depth && i < LOCKDEP_MAX_HELD; i++)
+        kprintf("lockdep:   #%u %s\n", i, classes[held->classes[i]].name);
+#else
+    (void)what;
+    (void)taking;
+    (void)holding;
+    (void)held;
+#endif
+}
+#endif
+
+void lock_acquire(lock_class_t *class, uint32_t flags) {
+#ifdef LOCKDEP
+    uint32_t irq = lock_irq_save();
+    lockdep_held_t *held = held_locks();
+    uint32_t c = (uint32_t)(class - classes);
+    uint32_t depth = held->depth < LOCKDEP_MAX_HELD ? held->depth : LOCKDEP_MAX_HELD;
+
+    /* A trylock cannot deadlock, so it neither adds nor checks an order */
+    for (uint32_t i = 0; i < depth && !(flags & LOCK_ACQ_TRY); i++) {
+        uint32_t h = held->classes[i];
+
+        if (h == c) {
+            if (!(flags & LOCK_ACQ_READ) &&
+                !(__atomic_fetch_or(&recursion_reported, 1U << c, __ATOMIC_RELAXED) & (1U << c)))
+                lockdep_report("recursive locking", class, class, held);
+        } else if (!(deps[h] & (1U << c))) {
+            /* Record the order even if it is bad, so each inversion is reported once */
+            if (lockdep_reaches(c, h))
+                lockdep_report("lock order inversion", class, &classes[h], held);
+            __atomic_or_fetch(&deps[h], 1U << c, __ATOMIC_RELAXED);
+        }
+    }
+
+    if (held->depth < LOCKDEP_MAX_HELD)
+        held->classes[held->depth] = (uint8_t)c;
+    held->depth++;
+    lock_irq_restore(irq);
+#else
+    (void)class;
+    (void)flags;
+#endif
+}
+
+void lock_contended(lock_class_t *class, uint64_t cycles) {
+#ifdef LOCK_STAT
+    uint32_t irq = lock_irq_save();
+    lock_stats_t *stats = &class->stats[lock_cpu()];
+
+    stats->contended++;
+    stats->spin_cycles += cycles;
+    if (cycles > stats->max_spin_cycles)
+        stats->max_spin_cycles = cycles;
+    lock_irq_restore(irq);
+#else
+    (void)class;
+    (void)cycles;
+#endif
+}
+
+void lock_acquired(lock_class_t *class) {
+#ifdef LOCK_STAT
+    uint32_t irq = lock_irq_save();
+    class->stats[lock_cpu()].acquisitions++;
+    lock_irq_restore(irq);
+#else
+    (void)class;
+#endif
+}
+
+void lock_release(lock_class_t *class, uint64_t hold_cycles) {
+    uint32_t irq = lock_irq_save();
+
+#ifdef LOCK_STAT
+    lock_stats_t *stats = &class->stats[lock_cpu()];
+    stats->hold_cycles += hold_cycles;
+    if (hold_cycles > stats->max_hold_cycles)
+        stats->max_hold_cycles = hold_cycles;
+#else
+    (void)hold_cycles;
+#endif
+
+#ifdef LOCKDEP
+    /* Usually the innermost lock, but unlock order is not enforced */
+    lockdep_held_t *held = held_locks();
+    uint32_t c = (uint32_t)(class - classes);
+    uint32_t depth = held->depth < LOCKDEP_MAX_HELD ? held->depth : LOCKDEP_MAX_HELD;
+
+    if (held->depth > LOCKDEP_MAX_HELD) {
+        held->depth--;
+    } else {
+        for (uint32_t i = depth; i-- > 0;) {
+            if (held->classes[i] != c)
+                continue;
+            for (; i + 1 < depth; i++)
+                held->classes[i] = held->classes[i + 1];
+            held->depth--;
+            break;
+        }
+    }
+#else
+    (void)class;
+#endif
+
+    lock_irq_restore(irq);
+}
+
+int lockstat_get(const char *name, lock_stats_t *stats) {
+    lock_class_t *class = class_find(name ? name : LOCKSTAT_UNNAMED);
+    if (!class)
+        return -1;
+
+    *stats = (lock_stats_t){ 0 };
+    for (uint32_t cpu = 0; cpu < MAX_CPUS; cpu++) {
+        lock_stats_t *s = &class->stats[cpu];
+        stats->acquisitions += s->acquisitions;
+        stats->contended += s->contended;
+        stats->spin_cycles += s->spin_cycles;
+        stats->hold_cycles += s->hold_cycles;
+        if (s->max_spin_cycles > stats->max_spin_cycles)
+            stats->max_spin_cycles = s->max_spin_cycles;
+        if (s->max_hold_cycles > stats->max_hold_cycles)
+            stats->max_hold_cycles = s->max_hold_cycles;
+    }
+    return 0;
+}
+
+void lockstat_reset(void) {
+    uint32_t irq = lock_irq_save();
+    for (uint32_t i = 0; i < LOCK_MAX_CLASSES; i++) {
+        for (uint32_t cpu = 0; cpu < MAX_CPUS; cpu++)
+            classes[i].stats[cpu] = (lock_stats_t){ 0 };
+    }
+    lock_irq_restore(irq);
+}
+
+uint32_t lockdep_violations(void) {
+#ifdef LOCKDEP
+    return violations;
+#else
+    return 0;
+#endif
+}
+
+#ifndef TEST
+void lockstat_report(void) {
+#ifdef LOCK_STAT
+    lock_stats_t totals[LOCK_MAX_CLASSES];
+    uint32_t order[LOCK_MAX_CLASSES];
+    uint32_t count = 0;
+
+    /* Rank by cycles lost spinning, the cost contention adds */
+    for (uint32_t i = 0; i < LOCK_MAX_CLASSES && classes[i].name; i++) {
+        lockstat_get(classes[i].name, &totals[i]);
+
+        uint32_t pos = count++;
+        while (pos > 0 && totals[order[pos - 1]].spin_cycles < totals[i].spin_cycles) {
+            order[pos] = order[pos - 1];
+            pos--;
+        }
+        order[pos] = i;
+    }
+
+    kprintf("lockstat: %u classes, ranked by cycles spent spinning\n", count);
+    kprintf("  acquired  contended   spin-total   spin-max   hold-avg   hold-max name\n");
+    for (uint32_t i = 0; i < count; i++) {
+        lock_stats_t *s = &totals[order[i]];
+
+        /* 32-bit average keeps libgcc's 64-bit division off this path */
+        uint32_t avg = s->hold_cycles >> 32 || s->acquisitions >> 32 ? UINT32_MAX
+                     : (uint32_t)s->hold_cycles / ((uint32_t)s->acquisitions ? (uint32_t)s->acquisitions : 1);
+        kprintf("%10llu %10llu %12llu %10llu %10u %10llu %s\n",
+                s->acquisitions, s->contended, s->spin_cycles, s->max_spin_cycles,
+                avg, s->max_hold_cycles, classes[order[i]].name);
+    }
+#else
+    kprintf("lockstat: built without LOCK_STAT\n");
+#endif
+#ifdef LOCKDEP
+    kprintf("lockdep: %u violation(s)\n", violations);
+#endif
+}
+#endif
@@ -0,0 +1,201 @@
+#ifndef LOCKSTAT_H
+#define LOCKSTAT_H
+
+#include <stdint.h>
+
+#include "cpu.h"
+
+/*
+ * Build with -DLOCK_STAT for contention statistics and -DLOCKDEP for
+ * lock-order checking (make LOCK_STAT=1 LOCKDEP=1). Without either, locks
+ * carry no extra state and every hook below compiles to nothing.
+ */
+#if defined(LOCK_STAT) || defined(LOCKDEP)
+#define LOCK_TRACKING
+#endif
+
+/**
+ * LOCK_MAX_CLASSES - Distinct lock names tracked; later names share the
+ * last class
+ */
+#define LOCK_MAX_CLASSES            32
+
+/**
+ * LOCKDEP_MAX_HELD - Locks one context can hold at once and be checked
+ */
+#define LOCKDEP_MAX_HELD            16
+
+/**
+ * LOCK_ACQ_READ - lock_acquire() flag for shared (reader) acquisitions
+ */
+#define LOCK_ACQ_READ               0x01
+
+/**
+ * LOCK_ACQ_TRY - lock_acquire() flag for trylocks, which cannot deadlock
+ */
+#define LOCK_ACQ_TRY                0x02
+
+/**
+ * LOCKSTAT_REPORT_SCANCODE - F8 make code, prints the lock report
+ */
+#define LOCKSTAT_REPORT_SCANCODE    0x42
+
+/**
+ * struct lock_stats_t - Contention counters of one lock class
+ * @acquisitions: Times the lock was taken
+ * @contended: Acquisitions that had to spin
+ * @spin_cycles: Cycles spent spinning, summed
+ * @max_spin_cycles: Longest single spin
+ * @hold_cycles: Cycles the lock was held exclusively, summed
+ * @max_hold_cycles: Longest exclusive hold
+ */
+typedef struct {
+    uint64_t acquisitions;
+    uint64_t contended;
+    uint64_t spin_cycles;
+    uint64_t max_spin_cycles;
+    uint64_t hold_cycles;
+    uint64_t max_hold_cycles;
+} lock_stats_t;
+
+/**
+ * struct lock_class_t - All locks sharing a name, e.g. every run queue lock
+ * @name: Name, NULL while the slot is free
+ * @stats: Counters per CPU, so accounting never bounces a cache line
+ */
+typedef struct {
+    const char *volatile name;
+    lock_stats_t stats[MAX_CPUS];
+} lock_class_t;
+
+/**
+ * struct lock_map_t - Tracking state embedded in each lock
+ * @name: Class name given at initialization
+ * @class: Class, looked up from @name on first use
+ */
+typedef struct {
+    const char *name;
+    lock_class_t *class;
+} lock_map_t;
+
+/**
+ * struct lockdep_held_t - Locks held by one thread, innermost last
+ * @depth: Entries in use
+ * @classes: Class indices
+ */
+typedef struct {
+    uint32_t depth;
+    uint8_t classes[LOCKDEP_MAX_HELD];
+} lockdep_held_t;
+
+/**
+ * LOCK_MAP_INIT - Initializer for a lock_map_t
+ * @n: Class name
+ */
+#define LOCK_MAP_INIT(n)            { .name = (n), .class = 0 }
+
+/**
+ * lock_class_get - Find or create the class for a name
+ * @name: Class name, NULL for unnamed locks
+ *
+ * Lock-free, so it is safe from any lock hook.
+ * Return: Class
+ */
+lock_class_t *lock_class_get(const char *name);
+
+/**
+ * lock_acquire - Note that the current context is about to take a lock
+ * @class: Class of the lock
+ * @flags: LOCK_ACQ_* flags
+ *
+ * With LOCKDEP, reports an acquisition order that inverts one seen
+ * before, or a non-reader lock taken twice, before the caller spins.
+ * Return: Nothing
+ */
+void lock_acquire(lock_class_t *class, uint32_t flags);
+
+/**
+ * lock_contended - Account a spin that ended in an acquisition
+ * @class: Class of the lock
+ * @cycles: Cycles spent spinning
+ *
+ * Return: Nothing
+ */
+void lock_contended(lock_class_t *class, uint64_t cycles);
+
+/**
+ * lock_acquired - Account an acquisition
+ * @class: Class of the lock
+ *
+ * Return: Nothing
+ */
+void lock_acquired(lock_class_t *class);
+
+/**
+ * lock_release - Note that the current context dropped a lock
+ * @class: Class of the lock
+ * @hold_cycles: Cycles the lock was held exclusively, 0 for readers
+ *
+ * Return: Nothing
+ */
+void lock_release(lock_class_t *class, uint64_t hold_cycles);
+
+/**
+ * lockstat_get - Sum a class's counters over all CPUs
+ * @name: Class name
+ * @stats: Output
+ *
+ * Return: 0 on success, -1 if no lock with that name was used
+ */
+int lockstat_get(const char *name, lock_stats_t *stats);
+
+/**
+ * lockstat_reset - Clear all counters
+ *
+ * Return: Nothing
+ */
+void lockstat_reset(void);
+
+#ifndef TEST
+/**
+ * lockstat_report - Print lock classes ranked by cycles lost spinning
+ *
+ * Return: Nothing
+ */
+void lockstat_report(void);
+#endif
+
+/**
+ * lockdep_violations - Count of lock-order problems reported
+ *
+ * Return: Violations seen, 0 without LOCKDEP
+ */
+uint32_t lockdep_violations(void);
+
+/**
+ * lock_map_class - Class of a tracked lock
+ * @map: Lock's tracking state
+ *
+ * Racing first users resolve the same name to the same class.
+ * Return: Class
+ */
+static inline lock_class_t *lock_map_class(lock_map_t *map) {
+    if (!map->class)
+        map->class = lock_class_get(map->name);
+    return map->class;
+}
+
+/**
+ * lock_now - Timestamp for spin and hold times
+ *
+ * Return: TSC value, or 0 when statistics are compiled out
+ */
+static inline uint64_t lock_now(void) {
+#ifdef LOCK_STAT
+    return rdtsc();
+#else
+    return 0;
+#endif
+}
+
+#endif
@@ -0,0 +1,268 @@
+#ifndef RWLOCK_H
+#define RWLOCK_H
+
+#include <stdint.h>
+
+#include "cpu.h"
+#include "lockstat.h"
+
+/**
+ * RWLOCK_WRITER - Lock word bit owned by the writer holding or waiting
+ * for the lock; the bits below count readers
+ */
+#define RWLOCK_WRITER       0x80000000U
+
+/**
+ * struct rwlock_t - Reader-writer spinlock
+ * @value: RWLOCK_WRITER plus the number of readers inside
+ * @map: Class for statistics and lock-order checking (LOCK_TRACKING)
+ * @acquired_tsc: When the writer took the lock (LOCK_TRACKING)
+ *
+ * A writer claims RWLOCK_WRITER first, which keeps new readers out,
+ * then waits for the readers inside to leave. Writers cannot be starved
+ * by a steady stream of readers; readers wait for at most the writers
+ * that arrived before them.
+ */
+typedef struct {
+    volatile uint32_t value;
+#ifdef LOCK_TRACKING
+    lock_map_t map;
+    uint64_t acquired_tsc;
+#endif
+} rwlock_t;
+
+/**
+ * RWLOCK_INIT - Initializer for an unlocked reader-writer lock
+ * @name: Class name in lock reports
+ */
+#ifdef LOCK_TRACKING
+#define RWLOCK_INIT(name)   { .value = 0, .map = LOCK_MAP_INIT(name) }
+#else
+#define RWLOCK_INIT(name)   { .value = 0 }
+#endif
+
+#ifdef LOCK_TRACKING
+static inline void rw_acquire(rwlock_t *lock, uint32_t flags) {
+    lock_acquire(lock_map_class(&lock->map), flags);
+}
+
+static inline void rw_contended(rwlock_t *lock, uint64_t start) {
+    lock_contended(lock_map_class(&lock->map), lock_now() - start);
+}
+
+static inline void rw_acquired(rwlock_t *lock, int writer) {
+    lock_acquired(lock_map_class(&lock->map));
+    if (writer)
+        lock->acquired_tsc = lock_now();
+}
+
+static inline void rw_release(rwlock_t *lock, int writer) {
+    lock_release(lock_map_class(&lock->map), writer ? lock_now() - lock->acquired_tsc : 0);
+}
+#else
+/* Tracking hooks, compiled out */
+static inline void rw_acquire(rwlock_t *lock, uint32_t flags) { (void)lock; (void)flags; }
+static inline void rw_contended(rwlock_t *lock, uint64_t start) { (void)lock; (void)start; }
+static inline void rw_acquired(rwlock_t *lock, int writer) { (void)lock; (void)writer; }
+static inline void rw_release(rwlock_t *lock, int writer) { (void)lock; (void)writer; }
+#endif
+
+/**
+ * rwlock_init - Initialize an unlocked reader-writer lock
+ * @lock: Lock
+ * @name: Class name in lock reports
+ *
+ * Return: Nothing
+ */
+static inline void rwlock_init(rwlock_t *lock, const char *name) {
+    (void)name;
+    *lock = (rwlock_t)RWLOCK_INIT(name);
+}
+
+/**
+ * read_trylock_raw - Enter as a reader if no writer holds or waits
+ * @lock: Lock
+ *
+ * Return: 1 on success, 0 otherwise
+ */
+static inline int read_trylock_raw(rwlock_t *lock) {
+    uint32_t value = __atomic_load_n(&lock->value, __ATOMIC_RELAXED);
+    if (value & RWLOCK_WRITER)
+        return 0;
+    return __atomic_compare_exchange_n(&lock->value, &value, value + 1, 0,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+/**
+ * write_claim_raw - Take RWLOCK_WRITER if no other writer has it
+ * @lock: Lock
+ *
+ * Return: 1 on success, 0 otherwise
+ */
+static inline int write_claim_raw(rwlock_t *lock) {
+    uint32_t value = __atomic_load_n(&lock->value, __ATOMIC_RELAXED);
+    if (value & RWLOCK_WRITER)
+        return 0;
+    return __atomic_compare_exchange_n(&lock->value, &value, value | RWLOCK_WRITER, 0,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+/**
+ * read_lock - Acquire a reader-writer lock shared
+ * @lock: Lock
+ *
+ * Return: Nothing
+ */
+static inline void read_lock(rwlock_t *lock) {
+    rw_acquire(lock, LOCK_ACQ_READ);
+
+    if (!read_trylock_raw(lock)) {
+        uint64_t start = lock_now();
+        while (!read_trylock_raw(lock))
+            cpu_relax();
+        rw_contended(lock, start);
+    }
+
+    rw_acquired(lock, 0);
+}
+
+/**
+ * read_trylock - Acquire a reader-writer lock shared without waiting
+ * @lock: Lock
+ *
+ * Return: 1 if taken, 0 if a writer holds or waits for it
+ */
+static inline int read_trylock(rwlock_t *lock) {
+    if (!read_trylock_raw(lock))
+        return 0;
+
+    rw_acquire(lock, LOCK_ACQ_READ | LOCK_ACQ_TRY);
+    rw_acquired(lock, 0);
+    return 1;
+}
+
+/**
+ * read_unlock - Release a shared hold
+ * @lock: Lock held shared by the caller
+ *
+ * Return: Nothing
+ */
+static inline void read_unlock(rwlock_t *lock) {
+    rw_release(lock, 0);
+    __atomic_sub_fetch(&lock->value, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * write_lock - Acquire a reader-writer lock exclusively
+ * @lock: Lock
+ *
+ * Return: Nothing
+ */
+static inline void write_lock(rwlock_t *lock) {
+    uint64_t start = 0;
+    int contended = 0;
+
+    rw_acquire(lock, 0);
+
+    /* Keep new readers out first, then wait for the ones inside to leave */
+    if (!write_claim_raw(lock)) {
+        start = lock_now();
+        contended = 1;
+        while (!write_claim_raw(lock))
+            cpu_relax();
+    }
+    if (__atomic_load_n(&lock->value, __ATOMIC_ACQUIRE) != RWLOCK_WRITER) {
+        if (!contended)
+            start = lock_now();
+        contended = 1;
+        while (__atomic_load_n(&lock->value, __ATOMIC_ACQUIRE) != RWLOCK_WRITER)
+            cpu_relax();
+    }
+    if (contended)
+        rw_contended(lock, start);
+
+    rw_acquired(lock, 1);
+}
+
+/**
+ * write_trylock - Acquire a reader-writer lock exclusively without waiting
+ * @lock: Lock
+ *
+ * Return: 1 if taken, 0 if anyone holds it
+ */
+static inline int write_trylock(rwlock_t *lock) {
+    uint32_t value = 0;
+
+    if (!__atomic_compare_exchange_n(&lock->value, &value, RWLOCK_WRITER, 0,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return 0;
+
+    rw_acquire(lock, LOCK_ACQ_TRY);
+    rw_acquired(lock, 1);
+    return 1;
+}
+
+/**
+ * write_unlock - Release an exclusive hold
+ * @lock: Lock held exclusively by the caller
+ *
+ * Readers cannot enter while RWLOCK_WRITER is set, so the word is
+ * exactly RWLOCK_WRITER here.
+ * Return: Nothing
+ */
+static inline void write_unlock(rwlock_t *lock) {
+    rw_release(lock, 1);
+    __atomic_store_n(&lock->value, 0, __ATOMIC_RELEASE);
+}
+
+#ifndef TEST
+/**
+ * read_lock_irqsave - Disable interrupts, then acquire shared
+ * @lock: Lock
+ *
+ * Return: EFLAGS to pass to read_unlock_irqrestore()
+ */
+static inline uint32_t read_lock_irqsave(rwlock_t *lock) {
+    uint32_t flags = irq_save();
+    read_lock(lock);
+    return flags;
+}
+
+/**
+ * read_unlock_irqrestore - Release a shared hold, then restore interrupts
+ * @lock: Lock held shared by the caller
+ * @flags: Value returned by read_lock_irqsave()
+ *
+ * Return: Nothing
+ */
+static inline void read_unlock_irqrestore(rwlock_t *lock, uint32_t flags) {
+    read_unlock(lock);
+    irq_restore(flags);
+}
+
+/**
+ * write_lock_irqsave - Disable interrupts, then acquire exclusively
+ * @lock: Lock
+ *
+ * Return: EFLAGS to pass to write_unlock_irqrestore()
+ */
+static inline uint32_t write_lock_irqsave(rwlock_t *lock) {
+    uint32_t flags = irq_save();
+    write_lock(lock);
+    return flags;
+}
+
+/**
+ * write_unlock_irqrestore - Release an exclusive hold, then restore interrupts
+ * @lock: Lock held exclusively by the caller
+ * @flags: Value returned by write_lock_irqsave()
+ *
+ * Return: Nothing
+ */
+static inline void write_unlock_irqrestore(rwlock_t *lock, uint32_t flags) {
+    write_unlock(lock);
+    irq_restore(flags);
+}
+#endif
+
+#endif
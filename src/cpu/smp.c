@@ -0,0 +1,291 @@
+#include <stddef.h>
+
+#include "smp.h"
+#include "fpu.h"
+#include "gdt.h"
+#include "spinlock.h"
+#include "../interrupts/apic.h"
+#include "../interrupts/idt.h"
+#include "../interrupts/syscall.h"
+#include "../lib/mem.h"
+#include "../lib/printf.h"
+#include "../sched/sched.h"
+#include "../time/clocksource.h"
+#include "../utils.h"
+
+_Static_assert(offsetof(percpu_t, cpu) == PERCPU_CPU_OFFSET, "cpu_id() reads a fixed offset");
+
+extern uint8_t trampoline_start[];
+extern uint8_t trampoline_params[];
+extern uint8_t trampoline_end[];
+extern void irq_stub_ipi_resched(void);
+extern void irq_stub_ipi_call(void);
+
+/**
+ * struct trampoline_params_t - Values the trampoline hands to an AP
+ * @cr3: Page directory to enable paging with
+ * @stack: Initial stack pointer
+ * @entry: C function to call
+ * @cpu: CPU index passed to @entry
+ *
+ * Must match the layout at trampoline_params in trampoline.asm.
+ */
+typedef struct {
+    uint32_t cr3;
+    uint32_t stack;
+    uint32_t entry;
+    uint32_t cpu;
+} trampoline_params_t;
+
+/**
+ * struct smp_call_t - The cross-CPU call in flight
+ * @fn: Function to run
+ * @arg: Argument for @fn
+ * @pending: CPUs that have not run @fn yet
+ */
+typedef struct {
+    smp_call_fn_t fn;
+    void *arg;
+    volatile uint32_t pending;
+} smp_call_t;
+
+/**
+ * percpu - Per-CPU data blocks, each the base of its CPU's gs segment
+ */
+static percpu_t percpu[MAX_CPUS];
+
+/**
+ * online_mask - Bit n set once CPU n runs its idle thread
+ */
+static volatile uint32_t online_mask;
+
+/**
+ * ap_idle - Idle thread of the AP being started
+ */
+static thread_t *ap_idle;
+
+/**
+ * call_lock - Serializes smp_call_others() callers
+ */
+static spinlock_t call_lock = SPINLOCK_INIT("smp_call");
+
+/**
+ * call - Current cross-CPU call, valid while call_lock is held
+ */
+static smp_call_t call;
+
+/**
+ * percpu_setup - Fill in a CPU's per-CPU data and load its GDT
+ * @cpu: CPU index, must be the executing CPU
+ *
+ * Return: Nothing
+ */
+static void percpu_setup(uint32_t cpu) {
+    percpu[cpu].self = &percpu[cpu];
+    percpu[cpu].cpu = cpu;
+    gdt_init_cpu(cpu, &percpu[cpu], sizeof(percpu_t));
+}
+
+/**
+ * smp_call_poll - Run the pending cross-CPU call if it targets this CPU
+ *
+ * Must be called with interrupts disabled.
+ * Return: Nothing
+ */
+static void smp_call_poll(void) {
+    uint32_t self = 1U << cpu_id();
+
+    if (!(__atomic_load_n(&call.pending, __ATOMIC_ACQUIRE) & self))
+        return;
+
+    call.fn(call.arg);
+    __atomic_and_fetch(&call.pending, ~self, __ATOMIC_RELEASE);
+}
+
+/**
+ * ipi_call - IPI_CALL_VECTOR handler
+ * @frame: Interrupt frame
+ * @ctx: Unused
+ *
+ * Return: Nothing
+ */
+static void ipi_call(interrupt_frame_t *frame, void *ctx) {
+    (void)frame;
+    (void)ctx;
+    smp_call_poll();
+}
+
+/**
+ * ipi_resched - IPI_RESCHED_VECTOR handler
+ * @frame: Interrupt frame
+ * @ctx: Unused
+ *
+ * The waker already set need_resched; irq_exit() does the switch.
+ * Return: Nothing
+ */
+static void ipi_resched(interrupt_frame_t *frame, void *ctx) {
+    (void)frame;
+    (void)ctx;
+}
+
+/**
+ * delay_ns - Busy-wait on the TSC clocksource
+ * @ns: Duration
+ *
+ * Return: Nothing
+ */
+static void delay_ns(uint64_t ns) {
+    uint64_t end = clock_monotonic_ns() + ns;
+    while (clock_monotonic_ns() < end)
+        cpu_relax();
+}
+
+/**
+ * ap_entry - First C code an application processor runs
+ * @cpu: CPU index chosen by smp_init()
+ *
+ * Called by the trampoline on the stack of ap_idle, with paging on and
+ * interrupts disabled.
+ * Return: Does not return
+ */
+static void ap_entry(uint32_t cpu) {
+    percpu_setup(cpu);
+    idt_load();
+    lapic_init_cpu();
+    fpu_init_cpu();
+    syscall_init_cpu();
+
+    if (lapic_timer_init_cpu() == -1)
+        panic("Error: AP has no clock event device");
+
+    sched_init_cpu(ap_idle);
+    __atomic_or_fetch(&online_mask, 1U << cpu, __ATOMIC_RELEASE);
+    sched_idle();
+}
+
+/**
+ * boot_ap - Start one application processor and wait for it
+ * @cpu: CPU index to give it
+ * @apic_id: Its local APIC ID
+ *
+ * Return: 0 once the AP is online, -1 on failure
+ */
+static int boot_ap(uint32_t cpu, uint8_t apic_id) {
+    trampoline_params_t *params = (trampoline_params_t *)(uintptr_t)
+        (SMP_TRAMPOLINE_ADDR + (uint32_t)(trampoline_params - trampoline_start));
+
+    ap_idle = sched_create_idle();
+    if (!ap_idle)
+        return -1;
+
+    percpu[cpu].apic_id = apic_id;
+    params->cr3 = read_cr3();
+    params->stack = ap_idle->stack_top;
+    params->entry = (uint32_t)(uintptr_t)ap_entry;
+    params->cpu = cpu;
+
+    /* INIT, then up to two startup IPIs as the MP specification asks */
+    lapic_send_ipi(apic_id, LAPIC_ICR_INIT | LAPIC_ICR_ASSERT);
+    delay_ns(SMP_INIT_DELAY_NS);
+    for (int i = 0; i < 2 && !(online_mask & (1U << cpu)); i++) {
+        lapic_send_ipi(apic_id, LAPIC_ICR_STARTUP | LAPIC_ICR_ASSERT | (SMP_TRAMPOLINE_ADDR >> 12));
+        delay_ns(SMP_STARTUP_DELAY_NS);
+    }
+
+    uint64_t deadline = clock_monotonic_ns() + SMP_ONLINE_TIMEOUT_NS;
+    while (!(online_mask & (1U << cpu))) {
+        if (clock_monotonic_ns() > deadline) {
+            /* Park it again so it cannot wake up on a reused index later */
+            lapic_send_ipi(apic_id, LAPIC_ICR_INIT | LAPIC_ICR_ASSERT);
+            return -1;
+        }
+        cpu_relax();
+    }
+    return 0;
+}
+
+void smp_early_init(void) {
+    percpu_setup(0);
+    online_mask = 1;
+}
+
+uint32_t smp_init(void) {
+    const apic_config_t *config = apic_get_config();
+
+    /* APs keep time with the TSC and their own LAPIC timer */
+    if (!lapic_timer_enabled() || !clocksource_tsc_enabled())
+        return smp_num_online();
+
+    percpu[0].apic_id = lapic_id();
+    idt_set_descriptor(IPI_RESCHED_VECTOR, irq_stub_ipi_resched, 0x8E);
+    idt_set_descriptor(IPI_CALL_VECTOR, irq_stub_ipi_call, 0x8E);
+    if (irq_register_vector(IPI_RESCHED_VECTOR, ipi_resched, NULL) == -1 ||
+        irq_register_vector(IPI_CALL_VECTOR, ipi_call, NULL) == -1)
+        return smp_num_online();
+
+    kmemcpy((void *)(uintptr_t)SMP_TRAMPOLINE_ADDR, trampoline_start,
+            (uint32_t)(trampoline_end - trampoline_start));
+
+    uint32_t cpu = 1;
+    for (uint32_t i = 0; i < config->num_cpus && cpu < MAX_CPUS; i++) {
+        uint8_t apic_id = config->cpu_apic_ids[i];
+        if (apic_id == percpu[0].apic_id)
+            continue;
+
+        if (boot_ap(cpu, apic_id) == 0)
+            cpu++;
+        else
+            kprintf("smp: CPU with APIC ID %u did not start\n", apic_id);
+    }
+
+    return smp_num_online();
+}
+
+uint32_t smp_online_mask(void) {
+    return __atomic_load_n(&online_mask, __ATOMIC_ACQUIRE);
+}
+
+uint32_t smp_num_online(void) {
+    return (uint32_t)__builtin_popcount(smp_online_mask());
+}
+
+void smp_call_others(smp_call_fn_t fn, void *arg) {
+    uint32_t flags = irq_save();
+
+    /* Run the holder's call while waiting, it may be waiting for us */
+    while (!spin_trylock(&call_lock)) {
+        smp_call_poll();
+        cpu_relax();
+    }
+
+    uint32_t self = cpu_id();
+    uint32_t targets = smp_online_mask() & ~(1U << self);
+    if (targets) {
+        call.fn = fn;
+        call.arg = arg;
+        __atomic_store_n(&call.pending, targets, __ATOMIC_RELEASE);
+
+        for (uint32_t cpu = 0; cpu < MAX_CPUS; cpu++) {
+            if (targets & (1U << cpu))
+                lapic_send_ipi(percpu[cpu].apic_id, LAPIC_ICR_ASSERT | IPI_CALL_VECTOR);
+        }
+
+        while (__atomic_load_n(&call.pending, __ATOMIC_ACQUIRE))
+            cpu_relax();
+    }
+
+    spin_unlock(&call_lock);
+    irq_restore(flags);
+}
+
+void smp_call_all(smp_call_fn_t fn, void *arg) {
+    smp_call_others(fn, arg);
+
+    uint32_t flags = irq_save();
+    fn(arg);
+    irq_restore(flags);
+}
+
+void smp_send_resched(uint32_t cpu) {
+    lapic_send_ipi(percpu[cpu].apic_id, LAPIC_ICR_ASSERT | IPI_RESCHED_VECTOR);
+}
@@ -0,0 +1,139 @@
+#ifndef SMP_H
+#define SMP_H
+
+#include <stdint.h>
+
+#include "cpu.h"
+
+/**
+ * SMP_TRAMPOLINE_ADDR - Low page the AP startup code is copied to
+ *
+ * Must match trampoline.asm. The startup IPI encodes it as a page number.
+ */
+#define SMP_TRAMPOLINE_ADDR     0x8000
+
+/**
+ * IPI_RESCHED_VECTOR - Interrupt asking a CPU to look at its run queue
+ */
+#define IPI_RESCHED_VECTOR      0xF0
+
+/**
+ * IPI_CALL_VECTOR - Interrupt asking a CPU to run smp_call_others() work
+ */
+#define IPI_CALL_VECTOR         0xF1
+
+/**
+ * SMP_INIT_DELAY_NS - Wait after the INIT IPI
+ */
+#define SMP_INIT_DELAY_NS       10000000ULL
+
+/**
+ * SMP_STARTUP_DELAY_NS - Wait after each startup IPI
+ */
+#define SMP_STARTUP_DELAY_NS    200000ULL
+
+/**
+ * SMP_ONLINE_TIMEOUT_NS - Time an AP gets to come online
+ */
+#define SMP_ONLINE_TIMEOUT_NS   100000000ULL
+
+/**
+ * struct percpu_t - Data private to one CPU, reached through gs
+ * @self: Address of this block, for turning gs into a pointer
+ * @cpu: CPU index (at PERCPU_CPU_OFFSET, read by cpu_id())
+ * @apic_id: Local APIC ID
+ */
+typedef struct percpu_t {
+    struct percpu_t *self;
+    uint32_t cpu;
+    uint8_t apic_id;
+} percpu_t;
+
+/**
+ * smp_call_fn_t - Function run on other CPUs
+ * @arg: Argument given to smp_call_all() or smp_call_others()
+ *
+ * Runs with interrupts disabled, from an IPI or from a CPU that is
+ * itself waiting to send one.
+ */
+typedef void (*smp_call_fn_t)(void *arg);
+
+/**
+ * this_cpu - Get the executing CPU's per-CPU data
+ *
+ * Return: Per-CPU data
+ */
+static inline percpu_t *this_cpu(void) {
+    percpu_t *self;
+    __asm__ volatile ("movl %%gs:0, %0" : "=r"(self));
+    return self;
+}
+
+/**
+ * smp_early_init - Set up the bootstrap CPU's per-CPU data and GDT
+ *
+ * Must run before anything calls cpu_id().
+ * Return: Nothing
+ */
+void smp_early_init(void);
+
+/**
+ * smp_init - Start the application processors
+ *
+ * Each AP listed by the interrupt controller tables is sent INIT and
+ * startup IPIs, switches to protected mode in the trampoline, loads its
+ * own GDT and IDT, enables its local APIC, FPU and timer, and becomes
+ * the idle thread of its own run queue. APs are started one at a time.
+ *
+ * APs need the TSC clocksource and the LAPIC timer; without them only
+ * the bootstrap CPU runs. Requires sched_init().
+ * Return: Number of CPUs online
+ */
+uint32_t smp_init(void);
+
+/**
+ * smp_online_mask - Get the CPUs that finished starting up
+ *
+ * Return: Bit n set if CPU n is online
+ */
+uint32_t smp_online_mask(void);
+
+/**
+ * smp_num_online - Count the CPUs that finished starting up
+ *
+ * Return: Number of CPUs online
+ */
+uint32_t smp_num_online(void);
+
+/**
+ * smp_call_others - Run a function on every other online CPU and wait
+ * @fn: Function to run
+ * @arg: Argument for @fn
+ *
+ * May be called with interrupts disabled, but not with a spinlock held:
+ * a CPU spinning on that lock with interrupts disabled would never run
+ * @fn. Waiting callers run other CPUs' calls, so two CPUs calling at
+ * once cannot deadlock.
+ * Return: Nothing
+ */
+void smp_call_others(smp_call_fn_t fn, void *arg);
+
+/**
+ * smp_call_all - Run a function on every online CPU and wait
+ * @fn: Function to run
+ * @arg: Argument for @fn
+ *
+ * Same rules as smp_call_others(); the calling CPU runs @fn last.
+ * Return: Nothing
+ */
+void smp_call_all(smp_call_fn_t fn, void *arg);
+
+/**
+ * smp_send_resched - Interrupt a CPU so it reschedules
+ * @cpu: Online CPU index
+ *
+ * Return: Nothing
+ */
+void smp_send_resched(uint32_t cpu);
+
+#endif
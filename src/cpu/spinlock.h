@@ -0,0 +1,188 @@
+#ifndef SPINLOCK_H
+#define SPINLOCK_H
+
+#include <stdint.h>
+
+#include "cpu.h"
+#include "lockstat.h"
+
+/**
+ * struct spinlock_t - Ticket spinlock
+ * @owner: Ticket currently holding the lock
+ * @next: Next ticket to hand out
+ * @word: Both tickets, for spin_trylock()
+ * @map: Class for statistics and lock-order checking (LOCK_TRACKING)
+ * @acquired_tsc: When the holder took the lock (LOCK_TRACKING)
+ *
+ * Waiters take a ticket and spin until @owner reaches it, so the lock
+ * is granted in arrival order and no CPU starves.
+ */
+typedef struct {
+    union {
+        struct {
+            volatile uint16_t owner;
+            volatile uint16_t next;
+        };
+        uint32_t word;
+    };
+#ifdef LOCK_TRACKING
+    lock_map_t map;
+    uint64_t acquired_tsc;
+#endif
+} spinlock_t;
+
+/**
+ * SPINLOCK_INIT - Initializer for an unlocked spinlock
+ * @name: Class name in lock reports
+ */
+#ifdef LOCK_TRACKING
+#define SPINLOCK_INIT(name) { .word = 0, .map = LOCK_MAP_INIT(name) }
+#else
+#define SPINLOCK_INIT(name) { .word = 0 }
+#endif
+
+#ifdef LOCK_TRACKING
+static inline void spin_acquire(spinlock_t *lock, uint32_t flags) {
+    lock_acquire(lock_map_class(&lock->map), flags);
+}
+
+static inline void spin_contended(spinlock_t *lock, uint64_t start) {
+    lock_contended(lock_map_class(&lock->map), lock_now() - start);
+}
+
+static inline void spin_acquired(spinlock_t *lock) {
+    lock_acquired(lock_map_class(&lock->map));
+    lock->acquired_tsc = lock_now();
+}
+
+static inline void spin_release(spinlock_t *lock) {
+    lock_release(lock_map_class(&lock->map), lock_now() - lock->acquired_tsc);
+}
+#else
+/* Tracking hooks, compiled out */
+static inline void spin_acquire(spinlock_t *lock, uint32_t flags) { (void)lock; (void)flags; }
+static inline void spin_contended(spinlock_t *lock, uint64_t start) { (void)lock; (void)start; }
+static inline void spin_acquired(spinlock_t *lock) { (void)lock; }
+static inline void spin_release(spinlock_t *lock) { (void)lock; }
+#endif
+
+/**
+ * spin_lock_init - Initialize an unlocked spinlock
+ * @lock: Lock
+ * @name: Class name in lock reports
+ *
+ * Return: Nothing
+ */
+static inline void spin_lock_init(spinlock_t *lock, const char *name) {
+    (void)name;
+    *lock = (spinlock_t)SPINLOCK_INIT(name);
+}
+
+/**
+ * spin_lock - Acquire a spinlock
+ * @lock: Lock
+ *
+ * Return: Nothing
+ */
+static inline void spin_lock(spinlock_t *lock) {
+    spin_acquire(lock, 0);
+
+    uint16_t ticket = __atomic_fetch_add(&lock->next, 1, __ATOMIC_RELAXED);
+    if (__atomic_load_n(&lock->owner, __ATOMIC_ACQUIRE) != ticket) {
+        uint64_t start = lock_now();
+        while (__atomic_load_n(&lock->owner, __ATOMIC_ACQUIRE) != ticket)
+            cpu_relax();
+        spin_contended(lock, start);
+    }
+
+    spin_acquired(lock);
+}
+
+/**
+ * spin_trylock - Acquire a spinlock if nobody holds or waits for it
+ * @lock: Lock
+ *
+ * Return: 1 if the lock was taken, 0 otherwise
+ */
+static inline int spin_trylock(spinlock_t *lock) {
+    spinlock_t old, new;
+
+    old.word = __atomic_load_n(&lock->word, __ATOMIC_RELAXED);
+    if (old.owner != old.next)
+        return 0;
+
+    new.word = old.word;
+    new.next++;
+    if (!__atomic_compare_exchange_n(&lock->word, &old.word, new.word, 0,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return 0;
+
+    spin_acquire(lock, LOCK_ACQ_TRY);
+    spin_acquired(lock);
+    return 1;
+}
+
+/**
+ * spin_unlock - Release a spinlock
+ * @lock: Lock held by the caller
+ *
+ * Only the holder writes @owner, so a release store is enough.
+ * Return: Nothing
+ */
+static inline void spin_unlock(spinlock_t *lock) {
+    spin_release(lock);
+    __atomic_store_n(&lock->owner, (uint16_t)(lock->owner + 1), __ATOMIC_RELEASE);
+}
+
+/**
+ * spin_is_locked - Check whether a spinlock is held
+ * @lock: Lock
+ *
+ * Return: Non-zero if held
+ */
+static inline int spin_is_locked(spinlock_t *lock) {
+    spinlock_t snap;
+    snap.word = __atomic_load_n(&lock->word, __ATOMIC_RELAXED);
+    return snap.owner != snap.next;
+}
+
+#ifndef TEST
+/**
+ * spin_lock_irqsave - Disable interrupts, then acquire a spinlock
+ * @lock: Lock
+ *
+ * Required for locks also taken from interrupt handlers, which would
+ * otherwise spin forever on a lock held by the code they interrupted.
+ * Return: EFLAGS to pass to spin_unlock_irqrestore()
+ */
+static inline uint32_t spin_lock_irqsave(spinlock_t *lock) {
+    uint32_t flags = irq_save();
+    spin_lock(lock);
+    return flags;
+}
+
+/**
+ * spin_unlock_irqrestore - Release a spinlock, then restore interrupts
+ * @lock: Lock held by the caller
+ * @flags: Value returned by spin_lock_irqsave()
+ *
+ * Return: Nothing
+ */
+static inline void spin_unlock_irqrestore(spinlock_t *lock, uint32_t flags) {
+    spin_unlock(lock);
+    irq_restore(flags);
+}
+#else
+/* Host tests cannot touch EFLAGS.IF */
+static inline uint32_t spin_lock_irqsave(spinlock_t *lock) {
+    spin_lock(lock);
+    return 0;
+}
+
+static inline void spin_unlock_irqrestore(spinlock_t *lock, uint32_t flags) {
+    (void)flags;
+    spin_unlock(lock);
+}
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+bits 16
+global trampoline_start
+global trampoline_params
+global trampoline_end
+
+; Application processors start in real mode at the page named by the
+; startup IPI. smp_init() copies this code to SMP_TRAMPOLINE_ADDR, so
+; every absolute address is computed relative to that copy.
+SMP_TRAMPOLINE_ADDR equ 0x8000
+
+%define TRAMPOLINE(x) (SMP_TRAMPOLINE_ADDR + ((x) - trampoline_start))
+
+code_segment equ 0x08
+data_segment equ 0x10
+
+section .text
+
+trampoline_start:
+    cli
+    cld
+    xor ax, ax
+    mov ds, ax
+    lgdt [TRAMPOLINE(trampoline_gdt_descriptor)]
+    mov eax, cr0
+    or al, 1              ; Set PE (Protection Enable)
+    mov cr0, eax
+    jmp dword code_segment:TRAMPOLINE(trampoline_protected)
+
+bits 32
+trampoline_protected:
+    mov ax, data_segment
+    mov ds, ax
+    mov es, ax
+    mov fs, ax
+    mov gs, ax
+    mov ss, ax
+
+    ; Share the bootstrap CPU's page directory, then enable paging and CR0.WP
+    mov eax, [TRAMPOLINE(trampoline_cr3)]
+    mov cr3, eax
+    mov eax, cr0
+    or eax, 0x80010000
+    mov cr0, eax
+
+    ; Run ap_entry(cpu) on the idle thread stack prepared for this CPU
+    mov esp, [TRAMPOLINE(trampoline_stack)]
+    xor ebp, ebp
+    push dword [TRAMPOLINE(trampoline_cpu)]
+    call [TRAMPOLINE(trampoline_entry)]
+
+.hang:
+    hlt
+    jmp .hang
+
+align 8
+trampoline_gdt:
+    dq 0x0000000000000000 ; Null descriptor
+    dq 0x00CF9A000000FFFF ; Kernel code segment (Offset: 0x0008)
+    dq 0x00CF92000000FFFF ; Kernel data segment (Offset: 0x0010)
+
+trampoline_gdt_descriptor:
+    dw trampoline_gdt_descriptor - trampoline_gdt - 1
+    dd TRAMPOLINE(trampoline_gdt)
+
+; Filled in by smp_init() before each startup IPI (trampoline_params_t)
+align 4
+trampoline_params:
+trampoline_cr3:
+    dd 0
+trampoline_stack:
+    dd 0
+trampoline_entry:
+    dd 0
+trampoline_cpu:
+    dd 0
+
+trampoline_end:
@@ -0,0 +1,83 @@
+#include "boottime.h"
+#include "../io.h"
+#include "../cpu/cpu.h"
+#include "../lib/printf.h"
+#include "../time/clocksource.h"
+
+/**
+ * marks - Phase starts in the order they happened
+ */
+static boottime_mark_t marks[BOOTTIME_MAX_PHASES];
+
+/**
+ * num_marks - Valid entries in marks
+ */
+static uint32_t num_marks;
+
+/**
+ * add_mark - Append a timestamp
+ * @name: Phase name
+ * @tsc: TSC at its start
+ *
+ * Return: Nothing
+ */
+static void add_mark(const char *name, uint64_t tsc) {
+    if (num_marks < BOOTTIME_MAX_PHASES) {
+        marks[num_marks].name = name;
+        marks[num_marks].tsc = tsc;
+        num_marks++;
+    }
+}
+
+/**
+ * debug_write - Write a string to the debug port
+ * @s: String
+ *
+ * Return: Nothing
+ */
+static void debug_write(const char *s) {
+    while (*s)
+        outb(BOOTTIME_DEBUG_PORT, (uint8_t)*s++);
+}
+
+void boottime_init(int from_sboot) {
+    uint64_t now = rdtsc();
+
+    num_marks = 0;
+    if (from_sboot) {
+        uint64_t sboot = *(volatile uint64_t *)BOOT_TSC_ADDR;
+        uint64_t unpack = *(volatile uint64_t *)BOOT_UNPACK_TSC_ADDR;
+
+        /* Nothing clears the stub's slot when there is no stub */
+        add_mark("sboot", sboot);
+        if (unpack > sboot && unpack < now)
+            add_mark("unpack", unpack);
+        *(volatile uint64_t *)BOOT_UNPACK_TSC_ADDR = 0;
+    }
+    add_mark("kmain", now);
+}
+
+void boottime_mark(const char *name) {
+    add_mark(name, rdtsc());
+}
+
+void boottime_report(void) {
+    char line[80];
+
+    /* Keep a slot for the end mark */
+    if (num_marks == BOOTTIME_MAX_PHASES)
+        num_marks--;
+    boottime_mark("end");
+    ksnprintf(line, sizeof(line), "boottime: begin %llu\n", clocksource_tsc_hz());
+    debug_write(line);
+    for (uint32_t i = 0; i + 1 < num_marks; i++) {
+        ksnprintf(line, sizeof(line), "boottime: %s %llu\n", marks[i].name, marks[i].tsc);
+        debug_write(line);
+    }
+    ksnprintf(line, sizeof(line), "boottime: end %llu\n", marks[num_marks - 1].tsc);
+    debug_write(line);
+
+#ifdef BOOTBENCH
+    outb(BOOTTIME_EXIT_PORT, 0);
+#endif
+}
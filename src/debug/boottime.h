@@ -0,0 +1,75 @@
+#ifndef BOOTTIME_H
+#define BOOTTIME_H
+
+#include <stdint.h>
+
+/**
+ * BOOT_TSC_ADDR - Where sboot stores the TSC at its entry, must match
+ * boot_tsc_addr in sboot.asm
+ */
+#define BOOT_TSC_ADDR           0x0500
+
+/**
+ * BOOT_UNPACK_TSC_ADDR - Where the unpack stub stores the TSC at its
+ * entry, must match unpack_tsc_addr in unpack.asm
+ */
+#define BOOT_UNPACK_TSC_ADDR    0x0508
+
+/**
+ * BOOTTIME_MAX_PHASES - Timestamps kept, later marks are dropped
+ */
+#define BOOTTIME_MAX_PHASES     48
+
+/**
+ * BOOTTIME_DEBUG_PORT - Port the report is written to, QEMU's debugcon
+ */
+#define BOOTTIME_DEBUG_PORT     0xE9
+
+/**
+ * BOOTTIME_EXIT_PORT - QEMU isa-debug-exit port, written after the report
+ * in BOOTBENCH builds so each benchmark run ends at the end of init
+ */
+#define BOOTTIME_EXIT_PORT      0xF4
+
+/**
+ * struct boottime_mark_t - Start of one boot phase
+ * @name: Phase name, usually the init function about to run
+ * @tsc: TSC of the boot CPU when the phase started
+ */
+typedef struct {
+    const char *name;
+    uint64_t tsc;
+} boottime_mark_t;
+
+/**
+ * boottime_init - Start recording boot phases, first thing in kmain()
+ * @from_sboot: sboot (and the unpack stub, if any) left their timestamps
+ * at BOOT_TSC_ADDR, which is not true after a Multiboot loader
+ *
+ * Must run before anything reuses low memory.
+ * Return: Nothing
+ */
+void boottime_init(int from_sboot);
+
+/**
+ * boottime_mark - Record the start of a boot phase
+ * @name: Phase name, must stay valid
+ *
+ * Boot CPU only, while kernel_init() runs.
+ * Return: Nothing
+ */
+void boottime_mark(const char *name);
+
+/**
+ * boottime_report - Mark the end of init and write every phase to
+ * BOOTTIME_DEBUG_PORT
+ *
+ * One "boottime: <name> <tsc>" line per phase, between a "boottime: begin
+ * <TSC Hz>" line and a "boottime: end <tsc>" line. TSC Hz is 0 without an
+ * invariant TSC. scripts/bootbench.py turns this into phase durations.
+ *
+ * Return: Nothing
+ */
+void boottime_report(void);
+
+#endif
@@ -0,0 +1,149 @@
+#include <stddef.h>
+
+#include "profile.h"
+#include "../cpu/cpu.h"
+#include "../interrupts/idt.h"
+#include "../lib/printf.h"
+#include "../memory/falloc.h"
+#include "../sched/sched.h"
+#include "../time/clockevent.h"
+#include "../time/hrtimer.h"
+
+/**
+ * samples - Preallocated sample ring
+ */
+static profile_sample_t samples[PROFILE_RING_SIZE];
+
+/**
+ * head - Total samples taken since profile_start(); the ring holds the
+ * last PROFILE_RING_SIZE of them
+ */
+static volatile uint32_t head;
+
+/**
+ * missed - Timer expiries that did not interrupt an IRQ-enabled context
+ */
+static volatile uint32_t missed;
+
+/**
+ * period_ns - Sampling period
+ */
+static uint64_t period_ns;
+
+/**
+ * running - Non-zero while sampling
+ */
+static volatile int running;
+
+/**
+ * sample_timer - Drives sampling
+ */
+static hrtimer_t sample_timer;
+
+/**
+ * frame_valid - Check a saved frame pointer before dereferencing it
+ * @ebp: Candidate frame pointer
+ * @prev: Previous frame pointer (frames grow toward higher addresses)
+ * @low: Lowest address of the interrupted stack
+ * @high: End of the interrupted stack
+ *
+ * Only the mapped interrupted stack is walked, so a corrupt chain cannot
+ * fault.
+ * Return: Non-zero if @ebp can be followed
+ */
+static inline int frame_valid(uint32_t ebp, uint32_t prev, uint32_t low, uint32_t high) {
+    return !(ebp & 3) && ebp > prev && ebp >= low && ebp + 8 <= high;
+}
+
+/**
+ * sample - Record the interrupted context
+ * @timer: Sampling timer
+ *
+ * Return: Nothing
+ */
+static void sample(hrtimer_t *timer) {
+    interrupt_frame_t *frame = irq_get_regs();
+
+    if (frame) {
+        profile_sample_t *s = &samples[head & (PROFILE_RING_SIZE - 1)];
+        uint32_t ebp = frame->ebp;
+        uint32_t depth = 0;
+        uint32_t low = ADDR_KERNEL_START;
+        uint32_t high = ADDR_KERNEL_END;
+
+        /* Kernel threads run on their own stacks; the boot stack has no stack_top */
+        thread_t *thread = thread_current();
+        if (thread && thread->stack_top) {
+            high = thread->stack_top;
+            low = high - THREAD_STACK_PAGES * PAGE_SIZE;
+        }
+
+        s->eip = frame->eip;
+        for (uint32_t prev = 0; depth < PROFILE_MAX_DEPTH && frame_valid(ebp, prev, low, high); ) {
+            uint32_t *fp = (uint32_t *)ebp;
+            s->stack[depth++] = fp[1];
+            prev = ebp;
+            ebp = fp[0];
+        }
+        s->depth = depth;
+        head++;
+    } else {
+        missed++;
+    }
+
+    if (running)
+        hrtimer_start(timer, timer->expires_ns + period_ns);
+}
+
+int profile_start(uint32_t hz) {
+    if (!hz)
+        return -1;
+
+    profile_stop();
+    head = 0;
+    missed = 0;
+    period_ns = NSEC_PER_SEC / hz;
+    running = 1;
+
+    hrtimer_init(&sample_timer, sample, NULL);
+    hrtimer_start(&sample_timer, ktime_get_ns() + period_ns);
+    kprintf("profile: sampling at %u Hz\n", hz);
+    return 0;
+}
+
+void profile_stop(void) {
+    running = 0;
+    hrtimer_cancel(&sample_timer);
+}
+
+void profile_toggle(void) {
+    if (running) {
+        profile_stop();
+        kprintf("profile: stopped, %u samples\n", head);
+    } else {
+        profile_start(PROFILE_DEFAULT_HZ);
+    }
+}
+
+void profile_dump(void) {
+    /* Freeze the ring so the dump is consistent */
+    int was_running = running;
+    profile_stop();
+
+    uint32_t count = head < PROFILE_RING_SIZE ? head : PROFILE_RING_SIZE;
+    kprintf("profile: begin %u %u\n", count, head - count + missed);
+
+    for (uint32_t i = head - count; i != head; i++) {
+        profile_sample_t *s = &samples[i & (PROFILE_RING_SIZE - 1)];
+        char line[16 + 9 * PROFILE_MAX_DEPTH];
+        int len = ksnprintf(line, sizeof(line), "P %08x", s->eip);
+
+        for (uint32_t d = 0; d < s->depth; d++)
+            len += ksnprintf(line + len, sizeof(line) - len, " %08x", s->stack[d]);
+        kprintf("%s\n", line);
+    }
+    kprintf("profile: end\n");
+
+    if (was_running)
+        profile_start((uint32_t)(NSEC_PER_SEC / period_ns));
+}
@@ -0,0 +1,81 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+/**
+ * PROFILE_RING_SIZE - Samples kept before the oldest are overwritten
+ * (power of two)
+ */
+#define PROFILE_RING_SIZE       2048
+
+/**
+ * PROFILE_MAX_DEPTH - Return addresses recorded per sample
+ */
+#define PROFILE_MAX_DEPTH       8
+
+/**
+ * PROFILE_DEFAULT_HZ - Sampling rate, kept off round numbers so it does
+ * not beat against periodic kernel work
+ */
+#define PROFILE_DEFAULT_HZ      4999
+
+/**
+ * PROFILE_TOGGLE_SCANCODE - F11 make code, starts or stops sampling
+ */
+#define PROFILE_TOGGLE_SCANCODE 0x57
+
+/**
+ * PROFILE_DUMP_SCANCODE - F10 make code, dumps the ring to serial
+ */
+#define PROFILE_DUMP_SCANCODE   0x44
+
+/**
+ * struct profile_sample_t - One profiler sample
+ * @eip: Interrupted instruction pointer
+ * @depth: Valid entries in @stack
+ * @stack: Return addresses from the frame-pointer chain, innermost first
+ */
+typedef struct {
+    uint32_t eip;
+    uint32_t depth;
+    uint32_t stack[PROFILE_MAX_DEPTH];
+} profile_sample_t;
+
+/**
+ * profile_start - Start sampling
+ * @hz: Samples per second
+ *
+ * Samples are taken from an hrtimer, so the rate is independent of the
+ * scheduler tick. The ring is cleared first.
+ *
+ * Return: 0 on success, -1 if @hz is zero
+ */
+int profile_start(uint32_t hz);
+
+/**
+ * profile_stop - Stop sampling
+ *
+ * Return: Nothing
+ */
+void profile_stop(void);
+
+/**
+ * profile_toggle - Start at PROFILE_DEFAULT_HZ, or stop if running
+ *
+ * Return: Nothing
+ */
+void profile_toggle(void);
+
+/**
+ * profile_dump - Write the samples to serial
+ *
+ * Output is "profile: begin <count> <lost>", one "P <eip> <ret>..." line
+ * per sample in hex, then "profile: end". scripts/profile_fold.py turns
+ * it into folded stacks.
+ *
+ * Return: Nothing
+ */
+void profile_dump(void);
+
+#endif
@@ -0,0 +1,392 @@
+#include <stddef.h>
+
+#include "ata.h"
+#include "../io.h"
+#include "../cpu/spinlock.h"
+#include "../interrupts/idt.h"
+#include "../sched/sched.h"
+
+/**
+ * struct ata_sync_t - A synchronous caller waiting for its request
+ * @lock: Orders @done against the waiter going to sleep
+ * @thread: Sleeping thread, NULL if the caller spins
+ * @done: Set once the request finished
+ */
+typedef struct {
+    spinlock_t lock;
+    thread_t *thread;
+    volatile int done;
+} ata_sync_t;
+
+/**
+ * ata_lock - Protects the request queue and the bus registers
+ */
+static spinlock_t ata_lock = SPINLOCK_INIT("ata");
+
+/**
+ * disk_sectors - Size of the drive from IDENTIFY, 0 without one
+ */
+static uint32_t disk_sectors;
+
+/**
+ * queue_head - Request the drive is working on, followed by the waiting ones
+ */
+static ata_request_t *queue_head;
+
+/**
+ * queue_tail - Last queued request
+ */
+static ata_request_t *queue_tail;
+
+/**
+ * ata_wait - Wait for the drive to finish the previous step
+ * @mask: Status bits that must be set once BSY clears
+ *
+ * Return: 0 when ready, -1 on a drive error
+ */
+static int ata_wait(uint8_t mask) {
+    uint8_t status;
+
+    /* The status is not valid for 400 ns after a command, read it four times */
+    for (int i = 0; i < 4; i++)
+        inb(ATA_PRIMARY_CTRL);
+
+    do {
+        status = inb(ATA_PRIMARY_IO + ATA_REG_STATUS);
+        if (status & (ATA_STATUS_ERR | ATA_STATUS_DF))
+            return -1;
+        cpu_relax();
+    } while ((status & ATA_STATUS_BSY) || (status & mask) != mask);
+
+    return 0;
+}
+
+/**
+ * ata_command - Issue a command, ata_lock held
+ * @cmd: Command
+ * @lba: First sector
+ * @count: Sectors, ATA_MAX_REQUEST_SECTORS is sent as 0
+ *
+ * Return: 0 on success, -1 if the drive is not ready
+ */
+static int ata_command(uint8_t cmd, uint32_t lba, uint32_t count) {
+    if (ata_wait(ATA_STATUS_RDY) == -1)
+        return -1;
+
+    outb(ATA_PRIMARY_IO + ATA_REG_DRIVE, (uint8_t)(ATA_DRIVE_MASTER_LBA | ((lba >> 24) & 0x0F)));
+    outb(ATA_PRIMARY_IO + ATA_REG_SECTOR_COUNT, (uint8_t)count);
+    outb(ATA_PRIMARY_IO + ATA_REG_LBA_LOW, (uint8_t)lba);
+    outb(ATA_PRIMARY_IO + ATA_REG_LBA_MID, (uint8_t)(lba >> 8));
+    outb(ATA_PRIMARY_IO + ATA_REG_LBA_HIGH, (uint8_t)(lba >> 16));
+    outb(ATA_PRIMARY_IO + ATA_REG_COMMAND, cmd);
+    return 0;
+}
+
+/**
+ * ata_start - Start the request at the head of the queue, ata_lock held
+ *
+ * A write hands over its first sector here; the drive interrupts once it
+ * has taken each one.
+ * Return: 0 if the drive is working on it, -1 if it failed to start
+ */
+static int ata_start(void) {
+    ata_request_t *req = queue_head;
+
+    req->sectors_done = 0;
+    switch (req->op) {
+    case ATA_OP_READ:
+        return ata_command(ATA_CMD_READ_SECTORS, req->lba, req->count);
+    case ATA_OP_WRITE:
+        if (ata_command(ATA_CMD_WRITE_SECTORS, req->lba, req->count) == -1 ||
+            ata_wait(ATA_STATUS_DRQ) == -1)
+            return -1;
+        outsw(ATA_PRIMARY_IO + ATA_REG_DATA, req->buf, ATA_SECTOR_SIZE / 2);
+        return 0;
+    case ATA_OP_FLUSH:
+        return ata_command(ATA_CMD_CACHE_FLUSH, 0, 0);
+    }
+    return -1;
+}
+
+/**
+ * ata_finish - Take the head request off the queue and start the next
+ * one, ata_lock held
+ * @status: Result of the head request
+ * @done: List the finished requests are added to, for ata_complete()
+ *
+ * Requests that fail to start are finished as well.
+ * Return: Nothing
+ */
+static void ata_finish(int status, ata_request_t **done) {
+    while (queue_head) {
+        ata_request_t *req = queue_head;
+
+        req->status = status;
+        queue_head = req->next;
+        if (!queue_head)
+            queue_tail = NULL;
+        req->next = *done;
+        *done = req;
+
+        if (!queue_head || ata_start() == 0)
+            return;
+        status = -1;
+    }
+}
+
+/**
+ * ata_complete - Run the done callbacks of finished requests
+ * @done: List from ata_finish()
+ *
+ * Return: Nothing
+ */
+static void ata_complete(ata_request_t *done) {
+    while (done) {
+        ata_request_t *next = done->next;
+        done->next = NULL;
+        done->done(done);
+        done = next;
+    }
+}
+
+/**
+ * ata_irq - IRQ14 handler, moves one sector of the request in flight
+ * @frame: Unused
+ * @ctx: Unused
+ *
+ * Reading the status register acknowledges the drive's interrupt.
+ * Return: Nothing
+ */
+static void ata_irq(interrupt_frame_t *frame, void *ctx) {
+    ata_request_t *done = NULL;
+    (void)frame;
+    (void)ctx;
+
+    spin_lock(&ata_lock);
+    uint8_t status = inb(ATA_PRIMARY_IO + ATA_REG_STATUS);
+    ata_request_t *req = queue_head;
+
+    if (!req || (status & ATA_STATUS_BSY)) {
+        spin_unlock(&ata_lock);
+        return;
+    }
+
+    if (status & (ATA_STATUS_ERR | ATA_STATUS_DF)) {
+        ata_finish(-1, &done);
+    } else if (req->op == ATA_OP_READ) {
+        if (status & ATA_STATUS_DRQ) {
+            insw(ATA_PRIMARY_IO + ATA_REG_DATA,
+                 (uint8_t *)req->buf + req->sectors_done * ATA_SECTOR_SIZE, ATA_SECTOR_SIZE / 2);
+            if (++req->sectors_done == req->count)
+                ata_finish(0, &done);
+        }
+    } else if (req->op == ATA_OP_WRITE) {
+        if (++req->sectors_done == req->count)
+            ata_finish(0, &done);
+        else if (!(status & ATA_STATUS_DRQ))
+            ata_finish(-1, &done);
+        else
+            outsw(ATA_PRIMARY_IO + ATA_REG_DATA,
+                  (const uint8_t *)req->buf + req->sectors_done * ATA_SECTOR_SIZE, ATA_SECTOR_SIZE / 2);
+    } else {
+        ata_finish(0, &done);
+    }
+    spin_unlock(&ata_lock);
+
+    ata_complete(done);
+}
+
+/**
+ * ata_sync_done - Done callback of the synchronous calls
+ * @req: Finished request
+ *
+ * Return: Nothing
+ */
+static void ata_sync_done(ata_request_t *req) {
+    ata_sync_t *sync = req->ctx;
+
+    uint32_t flags = spin_lock_irqsave(&sync->lock);
+    sync->done = 1;
+    if (sync->thread)
+        thread_wake(sync->thread);
+    spin_unlock_irqrestore(&sync->lock, flags);
+}
+
+/**
+ * ata_sync - Submit a request and wait for it
+ * @op: Operation
+ * @lba: First sector
+ * @count: Sectors, at most ATA_MAX_REQUEST_SECTORS
+ * @buf: Data
+ *
+ * Return: 0 on success, -1 on a drive error
+ */
+static int ata_sync(ata_op_t op, uint32_t lba, uint32_t count, void *buf) {
+    ata_sync_t sync = { .thread = NULL, .done = 0 };
+    ata_request_t req = {
+        .op = op, .lba = lba, .count = count, .buf = buf,
+        .done = ata_sync_done, .ctx = &sync,
+    };
+
+    spin_lock_init(&sync.lock, "ata_sync");
+    ata_submit(&req);
+
+    /* Blocked before the lock is dropped, so an early wake-up is not lost */
+    uint32_t flags = spin_lock_irqsave(&sync.lock);
+    while (!sync.done) {
+        if (thread_can_block()) {
+            sync.thread = thread_current();
+            sync.thread->state = THREAD_BLOCKED;
+            spin_unlock(&sync.lock);
+            schedule();
+            spin_lock(&sync.lock);
+        } else {
+            spin_unlock_irqrestore(&sync.lock, flags);
+            cpu_relax();
+            flags = spin_lock_irqsave(&sync.lock);
+        }
+    }
+
+    /* Holding the lock once more means the waker is done with @sync */
+    spin_unlock_irqrestore(&sync.lock, flags);
+    return req.status;
+}
+
+/**
+ * ata_transfer - Split a synchronous read or write into requests
+ * @op: ATA_OP_READ or ATA_OP_WRITE
+ * @lba: First sector
+ * @count: Number of sectors
+ * @buf: Data, @count * ATA_SECTOR_SIZE bytes
+ *
+ * Return: 0 on success, -1 on a drive error or a range past the disk
+ */
+static int ata_transfer(ata_op_t op, uint32_t lba, uint32_t count, uint8_t *buf) {
+    if (lba >= disk_sectors || count > disk_sectors - lba)
+        return -1;
+
+    while (count) {
+        uint32_t n = count < ATA_MAX_REQUEST_SECTORS ? count : ATA_MAX_REQUEST_SECTORS;
+        if (ata_sync(op, lba, n, buf) == -1)
+            return -1;
+        lba += n;
+        count -= n;
+        buf += n * ATA_SECTOR_SIZE;
+    }
+
+    return 0;
+}
+
+/**
+ * ata_init - Identify the boot disk on the primary bus and switch the
+ * driver to interrupt-driven transfers
+ *
+ * Return: 0 if a drive answers, -1 otherwise
+ */
+int ata_init(void) {
+    uint16_t id[ATA_SECTOR_SIZE / 2];
+
+    /* A bus with nothing attached floats high, a drive-less one reads 0 */
+    uint8_t status = inb(ATA_PRIMARY_IO + ATA_REG_STATUS);
+    if (status == 0xFF || status == 0)
+        return -1;
+
+    /* IDENTIFY is polled, with the drive's interrupt off */
+    outb(ATA_PRIMARY_CTRL, ATA_CTRL_NIEN);
+    uint32_t flags = spin_lock_irqsave(&ata_lock);
+    int ret = ata_command(ATA_CMD_IDENTIFY, 0, 0);
+    if (ret == 0)
+        ret = ata_wait(ATA_STATUS_DRQ);
+    if (ret == 0)
+        insw(ATA_PRIMARY_IO + ATA_REG_DATA, id, ATA_SECTOR_SIZE / 2);
+    spin_unlock_irqrestore(&ata_lock, flags);
+    if (ret == -1)
+        return -1;
+
+    /* Words 60-61: sectors addressable with LBA28 */
+    uint32_t sectors = id[60] | ((uint32_t)id[61] << 16);
+    if (sectors == 0 || sectors > ATA_MAX_LBA)
+        return -1;
+    if (irq_register(ATA_PRIMARY_IRQ, ata_irq, NULL) == -1)
+        return -1;
+
+    disk_sectors = sectors;
+    outb(ATA_PRIMARY_CTRL, 0);
+    return 0;
+}
+
+/**
+ * ata_sectors - Size of the boot disk
+ *
+ * Return: Addressable sectors, 0 without a drive
+ */
+uint32_t ata_sectors(void) {
+    return disk_sectors;
+}
+
+/**
+ * ata_submit - Queue a request without waiting for it
+ * @req: Request, owned by the driver until @req->done runs
+ *
+ * Return: Nothing
+ */
+void ata_submit(ata_request_t *req) {
+    ata_request_t *done = NULL;
+
+    req->next = NULL;
+    if (!disk_sectors || (req->op != ATA_OP_FLUSH &&
+        (req->count == 0 || req->count > ATA_MAX_REQUEST_SECTORS ||
+         req->lba >= disk_sectors || req->count > disk_sectors - req->lba))) {
+        req->status = -1;
+        req->done(req);
+        return;
+    }
+
+    uint32_t flags = spin_lock_irqsave(&ata_lock);
+    if (queue_tail) {
+        queue_tail->next = req;
+        queue_tail = req;
+    } else {
+        queue_head = queue_tail = req;
+        if (ata_start() == -1)
+            ata_finish(-1, &done);
+    }
+    spin_unlock_irqrestore(&ata_lock, flags);
+
+    ata_complete(done);
+}
+
+/**
+ * ata_read - Read sectors from the boot disk
+ * @lba: First sector
+ * @count: Number of sectors
+ * @buf: Destination, @count * ATA_SECTOR_SIZE bytes
+ *
+ * Return: 0 on success, -1 on a drive error
+ */
+int ata_read(uint32_t lba, uint32_t count, void *buf) {
+    return ata_transfer(ATA_OP_READ, lba, count, buf);
+}
+
+/**
+ * ata_write - Write sectors to the boot disk
+ * @lba: First sector
+ * @count: Number of sectors
+ * @buf: Source, @count * ATA_SECTOR_SIZE bytes
+ *
+ * Return: 0 on success, -1 on a drive error
+ */
+int ata_write(uint32_t lba, uint32_t count, const void *buf) {
+    return ata_transfer(ATA_OP_WRITE, lba, count, (uint8_t *)buf);
+}
+
+/**
+ * ata_flush - Wait until the drive has written its cache to the medium
+ *
+ * Return: 0 on success, -1 on a drive error
+ */
+int ata_flush(void) {
+    if (!disk_sectors)
+        return -1;
+    return ata_sync(ATA_OP_FLUSH, 0, 0, NULL);
+}
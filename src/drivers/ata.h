@@ -0,0 +1,164 @@
+#ifndef ATA_H
+#define ATA_H
+
+#include <stdint.h>
+
+/**
+ * ATA_PRIMARY_IO - I/O base of the primary ATA bus
+ */
+#define ATA_PRIMARY_IO          0x1F0
+
+/**
+ * ATA_PRIMARY_CTRL - Device control / alternate status port of the primary bus
+ */
+#define ATA_PRIMARY_CTRL        0x3F6
+
+/* Register offsets from the I/O base */
+#define ATA_REG_DATA            0
+#define ATA_REG_ERROR           1
+#define ATA_REG_SECTOR_COUNT    2
+#define ATA_REG_LBA_LOW         3
+#define ATA_REG_LBA_MID         4
+#define ATA_REG_LBA_HIGH        5
+#define ATA_REG_DRIVE           6
+#define ATA_REG_STATUS          7
+#define ATA_REG_COMMAND         7
+
+/**
+ * ATA_PRIMARY_IRQ - Interrupt line of the primary bus
+ */
+#define ATA_PRIMARY_IRQ         14
+
+/* Status register bits */
+#define ATA_STATUS_ERR          0x01
+#define ATA_STATUS_DRQ          0x08
+#define ATA_STATUS_DF           0x20
+#define ATA_STATUS_RDY          0x40
+#define ATA_STATUS_BSY          0x80
+
+/* Commands (PIO, LBA28) */
+#define ATA_CMD_READ_SECTORS    0x20
+#define ATA_CMD_WRITE_SECTORS   0x30
+#define ATA_CMD_CACHE_FLUSH     0xE7
+#define ATA_CMD_IDENTIFY        0xEC
+
+/**
+ * ATA_CTRL_NIEN - Device control bit that keeps the drive from raising
+ * its interrupt
+ */
+#define ATA_CTRL_NIEN           0x02
+
+/**
+ * ATA_DRIVE_MASTER_LBA - Drive register value: master, LBA addressing
+ */
+#define ATA_DRIVE_MASTER_LBA    0xE0
+
+/**
+ * ATA_SECTOR_SIZE - Bytes per sector
+ */
+#define ATA_SECTOR_SIZE         512
+
+/**
+ * ATA_MAX_LBA - First sector LBA28 cannot address
+ */
+#define ATA_MAX_LBA             0x10000000
+
+/**
+ * ATA_MAX_REQUEST_SECTORS - Most sectors one command transfers
+ */
+#define ATA_MAX_REQUEST_SECTORS 256
+
+/**
+ * enum ata_op_t - What a request does
+ * @ATA_OP_READ: Read sectors into the buffer
+ * @ATA_OP_WRITE: Write sectors from the buffer
+ * @ATA_OP_FLUSH: Flush the drive's write cache to the medium
+ */
+typedef enum {
+    ATA_OP_READ,
+    ATA_OP_WRITE,
+    ATA_OP_FLUSH
+} ata_op_t;
+
+/**
+ * struct ata_request_t - One command for the drive
+ * @op: Operation
+ * @lba: First sector
+ * @count: Sectors, 1 to ATA_MAX_REQUEST_SECTORS (unused for a flush)
+ * @buf: Data, @count * ATA_SECTOR_SIZE bytes
+ * @done: Called once the request finished, from the IRQ handler or from
+ *        ata_submit() itself, never with ata_lock held
+ * @ctx: For @done
+ * @status: 0 on success, -1 on a drive error, valid in @done
+ * @sectors_done: Sectors transferred so far (driver)
+ * @next: Queue link (driver)
+ */
+typedef struct ata_request {
+    ata_op_t op;
+    uint32_t lba;
+    uint32_t count;
+    void *buf;
+    void (*done)(struct ata_request *req);
+    void *ctx;
+    int status;
+    uint32_t sectors_done;
+    struct ata_request *next;
+} ata_request_t;
+
+/**
+ * ata_init - Identify the boot disk on the primary bus and switch the
+ * driver to interrupt-driven transfers
+ *
+ * Return: 0 if a drive answers, -1 otherwise
+ */
+int ata_init(void);
+
+/**
+ * ata_sectors - Size of the boot disk
+ *
+ * Return: Addressable sectors, 0 without a drive
+ */
+uint32_t ata_sectors(void);
+
+/**
+ * ata_submit - Queue a request without waiting for it
+ * @req: Request, owned by the driver until @req->done runs
+ *
+ * The drive works through the queue in order. It raises IRQ14 for every
+ * sector, and the handler moves the data and starts the next request.
+ * Return: Nothing
+ */
+void ata_submit(ata_request_t *req);
+
+/**
+ * ata_read - Read sectors from the boot disk
+ * @lba: First sector
+ * @count: Number of sectors
+ * @buf: Destination, @count * ATA_SECTOR_SIZE bytes
+ *
+ * The calling thread sleeps while the drive works. The idle thread,
+ * which must not sleep, spins with interrupts enabled instead.
+ * Return: 0 on success, -1 on a drive error
+ */
+int ata_read(uint32_t lba, uint32_t count, void *buf);
+
+/**
+ * ata_write - Write sectors to the boot disk
+ * @lba: First sector
+ * @count: Number of sectors
+ * @buf: Source, @count * ATA_SECTOR_SIZE bytes
+ *
+ * Waits like ata_read(). The data may sit in the drive's write cache
+ * until ata_flush().
+ * Return: 0 on success, -1 on a drive error
+ */
+int ata_write(uint32_t lba, uint32_t count, const void *buf);
+
+/**
+ * ata_flush - Wait until the drive has written its cache to the medium
+ *
+ * Return: 0 on success, -1 on a drive error
+ */
+int ata_flush(void);
+
+#endif
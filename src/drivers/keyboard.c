@@ -0,0 +1,96 @@
+#include <stddef.h>
+
+#include "keyboard.h"
+#include "vga.h"
+#include "../io.h"
+#include "../interrupts/idt.h"
+#include "../interrupts/softirq.h"
+#include "../utils.h"
+
+/**
+ * keyboard_row - Row to print scancodes
+ */
+static uint8_t keyboard_row = 10;
+
+/**
+ * struct keyboard_hotkey_t - Scancode bound to a callback
+ * @scancode: Make code that triggers @fn
+ * @fn: Callback, NULL if the slot is free
+ */
+typedef struct {
+    uint8_t scancode;
+    keyboard_hotkey_fn_t fn;
+} keyboard_hotkey_t;
+
+/**
+ * keyboard_hotkeys - Registered hotkeys
+ */
+static keyboard_hotkey_t keyboard_hotkeys[KEYBOARD_MAX_HOTKEYS];
+
+/**
+ * keyboard_print - Print a scancode (deferred from keyboard_irq)
+ * @arg: Scancode
+ *
+ * Return: Nothing
+ */
+static void keyboard_print(void *arg) {
+    uint8_t scancode = (uint8_t)(uintptr_t)arg;
+
+    for (int i = 0; i < KEYBOARD_MAX_HOTKEYS; i++) {
+        if (keyboard_hotkeys[i].fn && keyboard_hotkeys[i].scancode == scancode) {
+            keyboard_hotkeys[i].fn();
+            return;
+        }
+    }
+
+    /* Print scancode as hex for now */
+    char hex[] = "0x00";
+    hex[2] = "0123456789ABCDEF"[scancode >> 4];
+    hex[3] = "0123456789ABCDEF"[scancode & 0x0F];
+    vga_print_string(keyboard_row, 0, hex, WHITE, BLACK);
+    keyboard_row++;
+    if (keyboard_row > 24) keyboard_row = 10;
+}
+
+/**
+ * keyboard_irq - Keyboard interrupt handler
+ * @frame: Pointer to interrupt stack frame
+ * @ctx: Unused
+ *
+ * Reads the scancode to acknowledge the controller and defers printing.
+ * Return: Nothing
+ */
+static void keyboard_irq(interrupt_frame_t *frame, void *ctx) {
+    (void)frame;
+    (void)ctx;
+    uint8_t scancode = inb(KEYBOARD_DATA_PORT);
+    softirq_raise(keyboard_print, (void *)(uintptr_t)scancode);
+}
+
+/**
+ * keyboard_register_hotkey - Run a callback when a key is pressed
+ * @scancode: Make code of the key (set 1)
+ * @fn: Callback, run with interrupts enabled
+ *
+ * Return: 0 on success, -1 if the table is full
+ */
+int keyboard_register_hotkey(uint8_t scancode, keyboard_hotkey_fn_t fn) {
+    for (int i = 0; i < KEYBOARD_MAX_HOTKEYS; i++) {
+        if (!keyboard_hotkeys[i].fn) {
+            keyboard_hotkeys[i].scancode = scancode;
+            keyboard_hotkeys[i].fn = fn;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * keyboard_init - Attach the scancode handler to the keyboard interrupt line
+ *
+ * Return: Nothing
+ */
+void keyboard_init(void) {
+    if (irq_register(KEYBOARD_IRQ, keyboard_irq, NULL) == -1)
+        panic("Error: keyboard IRQ already registered");
+}
@@ -0,0 +1,42 @@
+#ifndef KEYBOARD_H
+#define KEYBOARD_H
+
+#include <stdint.h>
+
+/**
+ * KEYBOARD_IRQ - IRQ line of the PS/2 keyboard
+ */
+#define KEYBOARD_IRQ        1
+
+/**
+ * KEYBOARD_DATA_PORT - PS/2 controller data port
+ */
+#define KEYBOARD_DATA_PORT  0x60
+
+/**
+ * KEYBOARD_MAX_HOTKEYS - Scancodes that can be bound to a callback
+ */
+#define KEYBOARD_MAX_HOTKEYS 12
+
+/**
+ * keyboard_hotkey_fn_t - Hotkey callback, run from the keyboard bottom half
+ */
+typedef void (*keyboard_hotkey_fn_t)(void);
+
+/**
+ * keyboard_register_hotkey - Run a callback when a key is pressed
+ * @scancode: Make code of the key (set 1)
+ * @fn: Callback, run with interrupts enabled
+ *
+ * Return: 0 on success, -1 if the table is full
+ */
+int keyboard_register_hotkey(uint8_t scancode, keyboard_hotkey_fn_t fn);
+
+/**
+ * keyboard_init - Attach the scancode handler to the keyboard interrupt line
+ *
+ * Return: Nothing
+ */
+void keyboard_init(void);
+
+#endif
@@ -0,0 +1,130 @@
+#include <stddef.h>
+
+#include "pit.h"
+#include "../io.h"
+#include "../interrupts/idt.h"
+#include "../time/clockevent.h"
+#include "../utils.h"
+
+/**
+ * programmed - Count loaded by the last pit_set_next_event()
+ */
+static uint32_t programmed;
+
+/**
+ * ns_to_ticks - Fixed-point factor converting nanoseconds to PIT ticks
+ */
+static uint64_t ns_to_ticks;
+
+/**
+ * ticks_to_ns - Fixed-point factor converting PIT ticks to nanoseconds
+ */
+static uint64_t ticks_to_ns;
+
+/**
+ * pit_set_next_event - Arm channel 0 for one interrupt
+ * @delta_ns: Delay until the interrupt
+ *
+ * Return: Nothing
+ */
+static void pit_set_next_event(uint64_t delta_ns) {
+    uint32_t count = (uint32_t)((delta_ns * ns_to_ticks) >> CLOCKEVENT_SHIFT);
+    if (count == 0)
+        count = 1;
+    if (count > PIT_MAX_COUNT)
+        count = PIT_MAX_COUNT;
+
+    programmed = count;
+    outb(PIT_COMMAND, PIT_CMD_CH0_ONESHOT);
+    outb(PIT_CHANNEL0, count & 0xFF);
+    outb(PIT_CHANNEL0, count >> 8);
+}
+
+/**
+ * pit_elapsed_ns - Time since channel 0 was last armed
+ *
+ * In mode 0 the counter keeps decrementing (wrapping past zero) after
+ * the interrupt fires, so time past expiry is still accounted for.
+ * Return: Nanoseconds
+ */
+static uint64_t pit_elapsed_ns(void) {
+    outb(PIT_COMMAND, PIT_CMD_READBACK_0);
+    uint8_t status = inb(PIT_CHANNEL0);
+    uint32_t count = inb(PIT_CHANNEL0);
+    count |= (uint32_t)inb(PIT_CHANNEL0) << 8;
+
+    uint32_t ticks;
+    if (status & PIT_STATUS_OUT)
+        ticks = programmed + ((0x10000 - count) & 0xFFFF);
+    else
+        ticks = programmed - count;
+
+    return ((uint64_t)ticks * ticks_to_ns) >> CLOCKEVENT_SHIFT;
+}
+
+/**
+ * pit_clockevent - PIT channel 0 clock event device
+ */
+static clockevent_t pit_clockevent = {
+    .name           = "PIT",
+    .set_next_event = pit_set_next_event,
+    .elapsed_ns     = pit_elapsed_ns,
+};
+
+/**
+ * pit_irq - PIT channel 0 interrupt handler
+ * @frame: Pointer to interrupt stack frame
+ * @ctx: Unused
+ *
+ * Return: Nothing
+ */
+static void pit_irq(interrupt_frame_t *frame, void *ctx) {
+    (void)frame;
+    (void)ctx;
+    clockevent_handle();
+}
+
+/**
+ * pit_init - Register PIT channel 0 as a one-shot clock event device
+ *
+ * Return: Nothing
+ */
+void pit_init(void) {
+    ns_to_ticks = clockevent_calc_mult(NSEC_PER_SEC, PIT_FREQUENCY);
+    ticks_to_ns = clockevent_calc_mult(PIT_FREQUENCY, NSEC_PER_SEC);
+    pit_clockevent.min_delta_ns = ((uint64_t)2 * ticks_to_ns) >> CLOCKEVENT_SHIFT;
+    pit_clockevent.max_delta_ns = ((uint64_t)PIT_MAX_COUNT * ticks_to_ns) >> CLOCKEVENT_SHIFT;
+
+    if (irq_register(PIT_IRQ, pit_irq, NULL) == -1)
+        panic("Error: PIT IRQ already registered");
+
+    clockevent_register(&pit_clockevent);
+}
+
+/**
+ * pit_shutdown - Stop taking PIT interrupts once another device took over
+ *
+ * Return: Nothing
+ */
+void pit_shutdown(void) {
+    irq_unregister(PIT_IRQ);
+}
+
+/**
+ * pit_wait - Busy-wait on PIT channel 2
+ * @count: Number of PIT input clock ticks to wait (at most PIT_MAX_COUNT)
+ *
+ * Return: Nothing
+ */
+void pit_wait(uint16_t count) {
+    /* Gate and speaker off while loading the count */
+    outb(PIT_GATE, inb(PIT_GATE) & ~0x03);
+
+    outb(PIT_COMMAND, PIT_CMD_CH2_ONESHOT);
+    outb(PIT_CHANNEL2, count & 0xFF);
+    outb(PIT_CHANNEL2, count >> 8);
+
+    outb(PIT_GATE, inb(PIT_GATE) | 0x01);
+    while (!(inb(PIT_GATE) & 0x20))
+        ;
+}
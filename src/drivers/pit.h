@@ -0,0 +1,74 @@
+#ifndef PIT_H
+#define PIT_H
+
+#include <stdint.h>
+
+/**
+ * PIT_IRQ - IRQ line of PIT channel 0
+ */
+#define PIT_IRQ             0
+
+/**
+ * PIT_FREQUENCY - PIT input clock in Hz
+ */
+#define PIT_FREQUENCY       1193182
+
+/**
+ * PIT_CHANNEL0 - Channel 0 data port (IRQ0)
+ */
+#define PIT_CHANNEL0        0x40
+
+/**
+ * PIT_CHANNEL2 - Channel 2 data port (speaker, gated by port 0x61)
+ */
+#define PIT_CHANNEL2        0x42
+
+/**
+ * PIT_COMMAND - Mode/command register
+ */
+#define PIT_COMMAND         0x43
+
+/**
+ * PIT_GATE - Port 0x61: bit 0 gates channel 2, bit 5 reads its output
+ */
+#define PIT_GATE            0x61
+
+/* Command bytes */
+#define PIT_CMD_CH0_ONESHOT 0x30    /* Channel 0, lobyte/hibyte, mode 0 */
+#define PIT_CMD_CH2_ONESHOT 0xB0    /* Channel 2, lobyte/hibyte, mode 0 */
+#define PIT_CMD_READBACK_0  0xC2    /* Read-back count and status of channel 0 */
+
+/**
+ * PIT_STATUS_OUT - Read-back status bit: output pin is high (count expired)
+ */
+#define PIT_STATUS_OUT      0x80
+
+/**
+ * PIT_MAX_COUNT - Largest programmable count
+ */
+#define PIT_MAX_COUNT       0xFFFF
+
+/**
+ * pit_init - Register PIT channel 0 as a one-shot clock event device
+ *
+ * Return: Nothing
+ */
+void pit_init(void);
+
+/**
+ * pit_shutdown - Stop taking PIT interrupts once another device took over
+ *
+ * Return: Nothing
+ */
+void pit_shutdown(void);
+
+/**
+ * pit_wait - Busy-wait on PIT channel 2
+ * @count: Number of PIT input clock ticks to wait (at most PIT_MAX_COUNT)
+ *
+ * Used to calibrate other timers; channel 0 is left untouched.
+ * Return: Nothing
+ */
+void pit_wait(uint16_t count);
+
+#endif
@@ -0,0 +1,44 @@
+#include "serial.h"
+#include "../io.h"
+
+/**
+ * serial_init - Configure COM1 for 115200 8N1 polled output
+ *
+ * Return: Nothing
+ */
+void serial_init(void) {
+    outb(SERIAL_COM1 + SERIAL_INTERRUPT_ENABLE, 0x00);     /* No interrupts */
+    outb(SERIAL_COM1 + SERIAL_LINE_CONTROL, 0x80);         /* DLAB on */
+    outb(SERIAL_COM1 + SERIAL_DATA, SERIAL_BAUD_DIVISOR & 0xFF);
+    outb(SERIAL_COM1 + SERIAL_INTERRUPT_ENABLE, SERIAL_BAUD_DIVISOR >> 8);
+    outb(SERIAL_COM1 + SERIAL_LINE_CONTROL, 0x03);         /* 8N1, DLAB off */
+    outb(SERIAL_COM1 + SERIAL_FIFO_CONTROL, 0xC7);         /* FIFO on, cleared, 14-byte threshold */
+    outb(SERIAL_COM1 + SERIAL_MODEM_CONTROL, 0x03);        /* DTR, RTS */
+}
+
+/**
+ * serial_putc - Write one byte to COM1
+ * @c: Byte to write
+ *
+ * Return: Nothing
+ */
+void serial_putc(char c) {
+    while (!(inb(SERIAL_COM1 + SERIAL_LINE_STATUS) & SERIAL_LSR_THR_EMPTY))
+        ;
+    outb(SERIAL_COM1 + SERIAL_DATA, (uint8_t)c);
+}
+
+/**
+ * serial_write - Write a buffer to COM1
+ * @buf: Bytes to write
+ * @len: Number of bytes
+ *
+ * Return: Nothing
+ */
+void serial_write(const char *buf, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        if (buf[i] == '\n')
+            serial_putc('\r');
+        serial_putc(buf[i]);
+    }
+}
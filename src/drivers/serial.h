@@ -0,0 +1,53 @@
+#ifndef SERIAL_H
+#define SERIAL_H
+
+#include <stdint.h>
+
+/**
+ * SERIAL_COM1 - I/O base of the first serial port (debug channel)
+ */
+#define SERIAL_COM1             0x3F8
+
+/* Register offsets from the port base */
+#define SERIAL_DATA             0
+#define SERIAL_INTERRUPT_ENABLE 1
+#define SERIAL_FIFO_CONTROL     2
+#define SERIAL_LINE_CONTROL     3
+#define SERIAL_MODEM_CONTROL    4
+#define SERIAL_LINE_STATUS      5
+
+/**
+ * SERIAL_LSR_THR_EMPTY - Line status bit: transmit holding register empty
+ */
+#define SERIAL_LSR_THR_EMPTY    0x20
+
+/**
+ * SERIAL_BAUD_DIVISOR - Divisor of the 115200 Hz base clock (115200 baud)
+ */
+#define SERIAL_BAUD_DIVISOR     1
+
+/**
+ * serial_init - Configure COM1 for 115200 8N1 polled output
+ *
+ * Return: Nothing
+ */
+void serial_init(void);
+
+/**
+ * serial_putc - Write one byte to COM1
+ * @c: Byte to write
+ *
+ * Return: Nothing
+ */
+void serial_putc(char c);
+
+/**
+ * serial_write - Write a buffer to COM1
+ * @buf: Bytes to write
+ * @len: Number of bytes
+ *
+ * Return: Nothing
+ */
+void serial_write(const char *buf, uint32_t len);
+
+#endif
@@ -1,4 +1,5 @@
 #include "vga.h"
+#include "../lib/mem.h"
 
 /**
  * vga_print_char - Write a character to the VGA text buffer
@@ -47,9 +48,23 @@ void vga_print_string(int row, int col, const char* str, unsigned char fcolor, u
  * Return: Nothing
  */
 void vga_clear_screen(unsigned char color) {
-    for (int row = 0; row < VGA_HEIGHT; row++) {
-        for (int col = 0; col < VGA_WIDTH; col++) {
-            vga_print_char(row, col, ' ', color, color);
-        }
-    }
-}
\ No newline at end of file
+    uint16_t cell = (uint16_t)' ' | ((uint16_t)((color << 4) | (color & 0x0F)) << 8);
+    kmemset16((uint16_t *)VGA_ADDR, cell, VGA_WIDTH * VGA_HEIGHT);
+}
+
+/**
+ * vga_print_hex - Write a 32-bit value as 0xXXXXXXXX
+ * @row: Row position
+ * @col: Column position
+ * @value: Value to write
+ * @fcolor: Foreground color
+ * @bcolor: Background color
+ *
+ * Return: Nothing
+ */
+void vga_print_hex(int row, int col, uint32_t value, unsigned char fcolor, unsigned char bcolor) {
+    char hex[] = "0x00000000";
+    for (int i = 0; i < 8; i++)
+        hex[9 - i] = "0123456789ABCDEF"[(value >> (i * 4)) & 0x0F];
+    vga_print_string(row, col, hex, fcolor, bcolor);
+}
@@ -1,6 +1,8 @@
 #ifndef VGA_H
 #define VGA_H
 
+#include <stdint.h>
+
 /**
  * VGA_ADDR - VGA text mode memory-mapped I/O base address
  */
@@ -40,6 +42,18 @@ void vga_print_char(int row, int col, char c, unsigned char fcolor, unsigned cha
  */
 void vga_print_string(int row, int col, const char* str, unsigned char fcolor, unsigned char bcolor);
 
+/**
+ * vga_print_hex - Write a 32-bit value as 0xXXXXXXXX
+ * @row: Row position
+ * @col: Column position
+ * @value: Value to write
+ * @fcolor: Foreground color
+ * @bcolor: Background color
+ *
+ * Return: Nothing
+ */
+void vga_print_hex(int row, int col, uint32_t value, unsigned char fcolor, unsigned char bcolor);
+
 /**
  * vga_clear_screen - Clear the screen with a single color
  * @color: Color to fill the screen with
@@ -0,0 +1,252 @@
+#include <stddef.h>
+
+#include "elf.h"
+#include "../memory/paging.h"
+#include "../utils.h"
+#ifndef TEST
+#include "../block/bcache.h"
+#include "../cpu/spinlock.h"
+#include "../lib/mem.h"
+#include "../memory/falloc.h"
+#include "../time/clocksource.h"
+#endif
+
+/**
+ * ELF_PAGE_MASK - Offset bits of an address within its page
+ */
+#define ELF_PAGE_MASK           (PAGE_SIZE - 1)
+
+/**
+ * segment_page_start - First page a segment touches
+ * @seg: Segment
+ *
+ * Return: Page-aligned address
+ */
+static uint32_t segment_page_start(const elf_segment_t *seg) {
+    return seg->vaddr & ~(uint32_t)ELF_PAGE_MASK;
+}
+
+/**
+ * segment_page_end - End (exclusive) of the last page a segment touches
+ * @seg: Segment
+ *
+ * Return: Page-aligned address
+ */
+static uint32_t segment_page_end(const elf_segment_t *seg) {
+    return (uint32_t)get_upper_alignment((uint64_t)seg->vaddr + seg->memsz, PAGE_SIZE);
+}
+
+int elf_parse(const void *hdr, uint32_t hdr_size, uint32_t file_size, elf_image_t *image) {
+    const elf_header_t *eh = hdr;
+
+    if (hdr_size < sizeof(elf_header_t) || hdr_size > file_size)
+        return -1;
+    if (*(const uint32_t *)eh->e_ident != ELF_MAGIC ||
+        eh->e_ident[ELF_EI_CLASS] != ELF_CLASS_32 ||
+        eh->e_ident[ELF_EI_DATA] != ELF_DATA_LSB ||
+        eh->e_ident[ELF_EI_VERSION] != ELF_VERSION_CURRENT)
+        return -1;
+    if (eh->e_type != ELF_ET_EXEC || eh->e_machine != ELF_EM_386)
+        return -1;
+    if (eh->e_phentsize != sizeof(elf_phdr_t) || eh->e_phnum == 0 ||
+        eh->e_phoff > hdr_size || eh->e_phnum > (hdr_size - eh->e_phoff) / sizeof(elf_phdr_t))
+        return -1;
+
+    const elf_phdr_t *phdrs = (const elf_phdr_t *)((const uint8_t *)hdr + eh->e_phoff);
+    uint32_t num_segments = 0;
+    uint32_t pages_total = 0;
+    int entry_found = 0;
+
+    for (uint32_t i = 0; i < eh->e_phnum; i++) {
+        const elf_phdr_t *ph = &phdrs[i];
+        if (ph->p_type != ELF_PT_LOAD || ph->p_memsz == 0)
+            continue;
+        if (num_segments == ELF_MAX_SEGMENTS)
+            return -1;
+
+        /* Bounds in 64 bits so a huge size cannot wrap around */
+        if (ph->p_filesz > ph->p_memsz ||
+            (uint64_t)ph->p_offset + ph->p_filesz > file_size ||
+            ph->p_vaddr < ADDR_USER_START ||
+            (uint64_t)ph->p_vaddr + ph->p_memsz > ADDR_USER_END)
+            return -1;
+
+        elf_segment_t *seg = &image->segments[num_segments];
+        seg->vaddr = ph->p_vaddr;
+        seg->memsz = ph->p_memsz;
+        seg->filesz = ph->p_filesz;
+        seg->offset = ph->p_offset;
+        seg->flags = PG_FLAG_USER | ((ph->p_flags & ELF_PF_W) ? PG_FLAG_RW : 0);
+
+        /* A page gets one set of permissions, so segments may not share one */
+        if (num_segments && segment_page_start(seg) < segment_page_end(seg - 1))
+            return -1;
+
+        if ((ph->p_flags & ELF_PF_X) && eh->e_entry >= seg->vaddr && eh->e_entry - seg->vaddr < seg->memsz)
+            entry_found = 1;
+        pages_total += (segment_page_end(seg) - segment_page_start(seg)) / PAGE_SIZE;
+        num_segments++;
+    }
+
+    if (!entry_found)
+        return -1;
+
+    image->entry = eh->e_entry;
+    image->file_size = file_size;
+    image->num_segments = num_segments;
+    image->pages_total = pages_total;
+    return 0;
+}
+
+#ifndef TEST
+/**
+ * images - Images whose pages elf_fault() fills in
+ */
+static elf_image_t *images[ELF_MAX_IMAGES];
+
+/**
+ * images_lock - Protects images
+ */
+static spinlock_t images_lock = SPINLOCK_INIT("elf_images");
+
+/**
+ * elf_read - Read part of an image's file
+ * @image: Image
+ * @offset: File offset
+ * @dst: Destination
+ * @len: Bytes to read
+ *
+ * Return: 0 on success, -1 on an I/O error
+ */
+static int elf_read(const elf_image_t *image, uint32_t offset, uint8_t *dst, uint32_t len) {
+    return bcache_read((uint64_t)image->lba * ATA_SECTOR_SIZE + offset, dst, len);
+}
+
+/**
+ * elf_find - Find the image segment covering an address
+ * @vaddr: Address
+ * @image: Set to the image on success
+ *
+ * Return: Segment, or NULL if no mapped image covers @vaddr
+ */
+static const elf_segment_t *elf_find(uint32_t vaddr, elf_image_t **image) {
+    const elf_segment_t *found = NULL;
+    uint32_t flags = spin_lock_irqsave(&images_lock);
+
+    for (uint32_t i = 0; i < ELF_MAX_IMAGES && !found; i++) {
+        if (!images[i])
+            continue;
+        for (uint32_t j = 0; j < images[i]->num_segments; j++) {
+            const elf_segment_t *seg = &images[i]->segments[j];
+            if (vaddr >= segment_page_start(seg) && vaddr < segment_page_end(seg)) {
+                *image = images[i];
+                found = seg;
+                break;
+            }
+        }
+    }
+
+    spin_unlock_irqrestore(&images_lock, flags);
+    return found;
+}
+
+/**
+ * elf_fault - Fill in a page of a mapped image (page_fault_fn_t)
+ * @vaddr: Faulting address
+ * @err_code: Unused
+ *
+ * The frame is mapped for the kernel only while it is filled, then opened
+ * up to ring 3 with the segment's permissions.
+ * Return: 0 if the page is now mapped, -1 if @vaddr is not in an image
+ */
+static int elf_fault(uint32_t vaddr, uint32_t err_code) {
+    elf_image_t *image;
+    const elf_segment_t *seg = elf_find(vaddr, &image);
+    uint32_t page = vaddr & ~(uint32_t)ELF_PAGE_MASK;
+    uint32_t frame;
+    (void)err_code;
+
+    if (!seg)
+        return -1;
+
+    uint64_t start = clock_monotonic_ns();
+    if (fallocate(&frame) == -1)
+        return -1;
+    if (map(page, frame, PG_FLAG_RW) == -1) {
+        ffree(frame);
+        return -1;
+    }
+    kmemset((void *)(uintptr_t)page, 0, PAGE_SIZE);
+
+    /* Only the part of the page that overlaps the file bytes comes from the disk */
+    uint32_t from = page > seg->vaddr ? page : seg->vaddr;
+    uint32_t to = page + PAGE_SIZE;
+    if (to > seg->vaddr + seg->filesz)
+        to = seg->vaddr + seg->filesz;
+    if (from < to && elf_read(image, seg->offset + (from - seg->vaddr), (uint8_t *)(uintptr_t)from, to - from) == -1) {
+        unmap(page);
+        ffree(frame);
+        return -1;
+    }
+
+    protect(page, seg->flags);
+    __atomic_add_fetch(&image->pages_loaded, 1, __ATOMIC_RELAXED);
+    image->load_ns += clock_monotonic_ns() - start;
+    return 0;
+}
+
+/**
+ * elf_overlaps - Check whether an image overlaps one already mapped
+ * @image: Image to check
+ *
+ * Must be called with images_lock held.
+ * Return: Non-zero on overlap
+ */
+static int elf_overlaps(const elf_image_t *image) {
+    for (uint32_t i = 0; i < ELF_MAX_IMAGES; i++) {
+        if (!images[i])
+            continue;
+        for (uint32_t j = 0; j < images[i]->num_segments; j++) {
+            const elf_segment_t *a = &images[i]->segments[j];
+            for (uint32_t k = 0; k < image->num_segments; k++) {
+                const elf_segment_t *b = &image->segments[k];
+                if (segment_page_start(a) < segment_page_end(b) && segment_page_start(b) < segment_page_end(a))
+                    return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+void elf_init(void) {
+    if (page_fault_register(elf_fault) == -1)
+        panic("Error: page fault resolver already installed");
+}
+
+int elf_load(uint32_t lba, uint32_t num_sectors, elf_image_t *image) {
+    uint8_t hdr[ATA_SECTOR_SIZE];
+
+    if (num_sectors == 0 || bcache_read((uint64_t)lba * ATA_SECTOR_SIZE, hdr, sizeof(hdr)) == -1)
+        return -1;
+    if (elf_parse(hdr, sizeof(hdr), num_sectors * ATA_SECTOR_SIZE, image) == -1)
+        return -1;
+
+    image->lba = lba;
+    image->pages_loaded = 0;
+    image->load_ns = 0;
+
+    uint32_t flags = spin_lock_irqsave(&images_lock);
+    int ret = -1;
+    if (!elf_overlaps(image)) {
+        for (uint32_t i = 0; i < ELF_MAX_IMAGES; i++) {
+            if (!images[i]) {
+                images[i] = image;
+                ret = 0;
+                break;
+            }
+        }
+    }
+    spin_unlock_irqrestore(&images_lock, flags);
+    return ret;
+}
+#endif
@@ -0,0 +1,158 @@
+#ifndef ELF_H
+#define ELF_H
+
+#include <stdint.h>
+
+/**
+ * ELF_MAGIC - e_ident[0..3] as a little-endian word ("\x7fELF")
+ */
+#define ELF_MAGIC               0x464C457F
+
+/* e_ident indices and the values this loader accepts */
+#define ELF_EI_CLASS            4
+#define ELF_EI_DATA             5
+#define ELF_EI_VERSION          6
+#define ELF_CLASS_32            1
+#define ELF_DATA_LSB            1
+#define ELF_VERSION_CURRENT     1
+
+/**
+ * ELF_ET_EXEC - e_type of a statically linked executable
+ */
+#define ELF_ET_EXEC             2
+
+/**
+ * ELF_EM_386 - e_machine for i386
+ */
+#define ELF_EM_386              3
+
+/**
+ * ELF_PT_LOAD - p_type of a segment to map
+ */
+#define ELF_PT_LOAD             1
+
+/* p_flags bits */
+#define ELF_PF_X                0x1
+#define ELF_PF_W                0x2
+#define ELF_PF_R                0x4
+
+/**
+ * ELF_MAX_SEGMENTS - Loadable segments per image
+ */
+#define ELF_MAX_SEGMENTS        4
+
+/**
+ * ELF_MAX_IMAGES - Images mapped at the same time
+ */
+#define ELF_MAX_IMAGES          4
+
+/**
+ * struct elf_header_t - ELF32 file header
+ */
+typedef struct {
+    uint8_t e_ident[16];
+    uint16_t e_type;
+    uint16_t e_machine;
+    uint32_t e_version;
+    uint32_t e_entry;
+    uint32_t e_phoff;
+    uint32_t e_shoff;
+    uint32_t e_flags;
+    uint16_t e_ehsize;
+    uint16_t e_phentsize;
+    uint16_t e_phnum;
+    uint16_t e_shentsize;
+    uint16_t e_shnum;
+    uint16_t e_shstrndx;
+} __attribute__((packed)) elf_header_t;
+
+/**
+ * struct elf_phdr_t - ELF32 program header
+ */
+typedef struct {
+    uint32_t p_type;
+    uint32_t p_offset;
+    uint32_t p_vaddr;
+    uint32_t p_paddr;
+    uint32_t p_filesz;
+    uint32_t p_memsz;
+    uint32_t p_flags;
+    uint32_t p_align;
+} __attribute__((packed)) elf_phdr_t;
+
+/**
+ * struct elf_segment_t - A loadable segment, filled in page by page on first touch
+ * @vaddr: Address of the first byte
+ * @memsz: Bytes in memory; the part past @filesz is zero
+ * @filesz: Bytes backed by the file
+ * @offset: File offset of the first byte
+ * @flags: Final page flags, PG_FLAG_USER and PG_FLAG_RW if writable
+ */
+typedef struct {
+    uint32_t vaddr;
+    uint32_t memsz;
+    uint32_t filesz;
+    uint32_t offset;
+    uint32_t flags;
+} elf_segment_t;
+
+/**
+ * struct elf_image_t - An executable mapped from the disk
+ * @entry: Entry point
+ * @lba: First sector of the file
+ * @file_size: Bytes available from @lba on
+ * @num_segments: Entries used in @segments, in ascending address order
+ * @segments: Loadable segments
+ * @pages_total: Pages the segments span
+ * @pages_loaded: Pages faulted in so far
+ * @load_ns: Time spent filling pages
+ */
+typedef struct {
+    uint32_t entry;
+    uint32_t lba;
+    uint32_t file_size;
+    uint32_t num_segments;
+    elf_segment_t segments[ELF_MAX_SEGMENTS];
+    uint32_t pages_total;
+    volatile uint32_t pages_loaded;
+    uint64_t load_ns;
+} elf_image_t;
+
+/**
+ * elf_parse - Validate an executable's headers and collect its segments
+ * @hdr: Start of the file
+ * @hdr_size: Bytes available at @hdr, must cover the program headers
+ * @file_size: Size of the file, segments must lie inside it
+ * @image: Filled in on success (@lba and the counters are left alone)
+ *
+ * Accepts 32-bit little-endian i386 executables whose loadable segments
+ * lie in the user range, in ascending order, without sharing a page.
+ * Return: 0 on success, -1 if the file cannot be loaded
+ */
+int elf_parse(const void *hdr, uint32_t hdr_size, uint32_t file_size, elf_image_t *image);
+
+#ifndef TEST
+/**
+ * elf_init - Install the page fault resolver for mapped images
+ *
+ * Return: Nothing
+ */
+void elf_init(void);
+
+/**
+ * elf_load - Map an executable stored on the boot disk
+ * @lba: First sector of the file
+ * @num_sectors: Sectors reserved for the file
+ * @image: Filled in; must stay valid while mapped
+ *
+ * Only the headers are read. Pages are read from the disk when first
+ * touched, so untouched code and data cost neither I/O nor memory.
+ * Pages are filled on the faulting thread; an image is meant to be run
+ * by a single thread.
+ * Return: 0 on success, -1 on a bad file, an I/O error or an overlap
+ * with an image already mapped
+ */
+int elf_load(uint32_t lba, uint32_t num_sectors, elf_image_t *image);
+#endif
+
+#endif
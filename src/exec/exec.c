@@ -0,0 +1,72 @@
+#include <stddef.h>
+
+#include "exec.h"
+#include "elf.h"
+#include "../drivers/ata.h"
+#include "../interrupts/syscall.h"
+#include "../lib/printf.h"
+#include "../memory/paging.h"
+#include "../sched/sched.h"
+#include "../time/clocksource.h"
+
+/**
+ * init_image - The init program
+ */
+static elf_image_t init_image;
+
+/**
+ * init_start - Entry of the init program's user thread
+ */
+static user_start_t init_start;
+
+/**
+ * init_map_ns - Time taken to read init's headers and map it
+ */
+static uint64_t init_map_ns;
+
+/**
+ * init_started - Non-zero once init was started
+ */
+static int init_started;
+
+int exec_init(void) {
+    uint32_t stack_base = EXEC_STACK_TOP - EXEC_STACK_PAGES * PAGE_SIZE;
+
+    if (ata_sectors() == 0) {
+        kprintf("exec: no boot disk\n");
+        return -1;
+    }
+    elf_init();
+
+    uint64_t start = clock_monotonic_ns();
+    if (elf_load(EXEC_INIT_LBA, EXEC_INIT_SECTORS, &init_image) == -1) {
+        kprintf("exec: init is not a loadable executable\n");
+        return -1;
+    }
+    if (map_anon(stack_base, EXEC_STACK_PAGES, PG_FLAG_RW | PG_FLAG_USER) == -1) {
+        kprintf("exec: could not map the init stack\n");
+        return -1;
+    }
+    init_map_ns = clock_monotonic_ns() - start;
+
+    init_start.eip = init_image.entry;
+    init_start.esp = EXEC_STACK_TOP;
+    if (!thread_create("init", user_thread, &init_start, SCHED_DEFAULT_PRIORITY)) {
+        kprintf("exec: could not start init\n");
+        return -1;
+    }
+
+    init_started = 1;
+    return 0;
+}
+
+void exec_report(void) {
+    if (!init_started) {
+        kprintf("exec: init not running\n");
+        return;
+    }
+
+    kprintf("exec: init mapped in %llu us, %u of %u pages loaded in %llu us\n",
+            init_map_ns / 1000, init_image.pages_loaded, init_image.pages_total,
+            init_image.load_ns / 1000);
+}
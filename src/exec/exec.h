@@ -0,0 +1,52 @@
+#ifndef EXEC_H
+#define EXEC_H
+
+#include <stdint.h>
+
+#include "../memory/paging.h"
+
+/**
+ * EXEC_INIT_LBA - Disk sector of the init program (INIT_LBA in the Makefile)
+ */
+#define EXEC_INIT_LBA           514
+
+/**
+ * EXEC_INIT_SECTORS - Sectors reserved for the init program (INIT_SECTORS in the Makefile)
+ */
+#define EXEC_INIT_SECTORS       128
+
+/**
+ * EXEC_STACK_PAGES - Size of a user stack; pages get a frame on first write
+ */
+#define EXEC_STACK_PAGES        16
+
+/**
+ * EXEC_STACK_TOP - Initial user stack pointer
+ */
+#define EXEC_STACK_TOP          ADDR_USER_END
+
+/**
+ * EXEC_REPORT_SCANCODE - F6 make code, prints how much of init was loaded
+ */
+#define EXEC_REPORT_SCANCODE    0x40
+
+/**
+ * exec_init - Map the init program from the boot disk and start it in ring 3
+ *
+ * Call after syscall_init() and bcache_init().
+ *
+ * Return: 0 if init was started, -1 otherwise
+ */
+int exec_init(void);
+
+/**
+ * exec_report - Print the init program's lazy loading statistics
+ *
+ * Pages loaded against pages mapped, time spent reading them, and the
+ * time it took to read the headers and map the program.
+ *
+ * Return: Nothing
+ */
+void exec_report(void);
+
+#endif
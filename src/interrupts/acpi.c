@@ -0,0 +1,183 @@
+#include <stddef.h>
+
+#include "acpi.h"
+#include "../memory/paging.h"
+
+/**
+ * checksum_ok - Check that a firmware structure sums to zero
+ * @data: Start of the structure
+ * @length: Length in bytes
+ *
+ * Return: 1 if the checksum is valid, 0 otherwise
+ */
+static int checksum_ok(const void* data, uint32_t length) {
+    const uint8_t* bytes = data;
+    uint8_t sum = 0;
+    for (uint32_t i = 0; i < length; i++)
+        sum += bytes[i];
+    return sum == 0;
+}
+
+/**
+ * signature_equal - Compare a fixed-length table signature
+ * @signature: Signature in the table
+ * @expected: Expected signature
+ * @length: Number of bytes to compare
+ *
+ * Return: 1 if equal, 0 otherwise
+ */
+static int signature_equal(const char* signature, const char* expected, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        if (signature[i] != expected[i])
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * find_rsdp - Search a physical range for the RSDP
+ * @start: Start address (16-byte aligned, identity mapped)
+ * @end: End address (exclusive)
+ *
+ * Return: Pointer to the RSDP, or NULL if not found
+ */
+static const acpi_rsdp_t* find_rsdp(uint32_t start, uint32_t end) {
+    for (uint32_t addr = start; addr + sizeof(acpi_rsdp_t) <= end; addr += 16) {
+        const acpi_rsdp_t* rsdp = (const acpi_rsdp_t*)(uintptr_t)addr;
+        if (signature_equal(rsdp->signature, "RSD PTR ", 8) && checksum_ok(rsdp, sizeof(acpi_rsdp_t)))
+            return rsdp;
+    }
+    return NULL;
+}
+
+/**
+ * peek_table - Read the header of a system description table
+ * @paddr: Physical address of the table
+ * @header: Filled in with the header
+ *
+ * The temporary mapping is released, so its pages are reused.
+ * Return: 0 on success, -1 on failure
+ */
+static int peek_table(uint32_t paddr, acpi_sdt_header_t* header) {
+    const acpi_sdt_header_t* mapped = map_phys(paddr, sizeof(acpi_sdt_header_t), 0);
+    if (!mapped)
+        return -1;
+
+    *header = *mapped;
+    unmap_phys(mapped, sizeof(acpi_sdt_header_t));
+    return 0;
+}
+
+/**
+ * map_table - Map a system description table and validate it
+ * @paddr: Physical address of the table
+ *
+ * Only the full table stays mapped, over the pages the header peek used.
+ * Return: Mapped table, or NULL on failure
+ */
+static const acpi_sdt_header_t* map_table(uint32_t paddr) {
+    acpi_sdt_header_t peek;
+    if (peek_table(paddr, &peek) == -1 || peek.length < sizeof(acpi_sdt_header_t))
+        return NULL;
+
+    const acpi_sdt_header_t* header = map_phys(paddr, peek.length, 0);
+    if (!header)
+        return NULL;
+    if (!checksum_ok(header, peek.length)) {
+        unmap_phys(header, peek.length);
+        return NULL;
+    }
+
+    return header;
+}
+
+/**
+ * parse_madt - Walk the MADT entries
+ * @madt: Mapped MADT
+ * @config: Configuration to fill
+ *
+ * Return: Nothing
+ */
+static void parse_madt(const acpi_madt_t* madt, apic_config_t* config) {
+    config->lapic_paddr = madt->lapic_address;
+
+    const uint8_t* entry = (const uint8_t*)(madt + 1);
+    const uint8_t* end = (const uint8_t*)madt + madt->header.length;
+    while (entry + sizeof(madt_entry_t) <= end) {
+        const madt_entry_t* header = (const madt_entry_t*)entry;
+        if (header->length < sizeof(madt_entry_t))
+            break;
+
+        switch (header->type) {
+        case MADT_LAPIC: {
+            const madt_lapic_t* lapic = (const madt_lapic_t*)entry;
+            if (lapic->flags & MADT_LAPIC_ENABLED)
+                apic_add_cpu(config, lapic->apic_id);
+            break;
+        }
+        case MADT_IOAPIC: {
+            const madt_ioapic_t* ioapic = (const madt_ioapic_t*)entry;
+            apic_add_ioapic(config, ioapic->ioapic_id, ioapic->address, ioapic->gsi_base);
+            break;
+        }
+        case MADT_ISO: {
+            const madt_iso_t* iso = (const madt_iso_t*)entry;
+            if (iso->bus == 0)
+                apic_add_isa_irq(config, iso->source, iso->gsi, iso->flags);
+            break;
+        }
+        case MADT_LAPIC_OVERRIDE: {
+            const madt_lapic_override_t* override = (const madt_lapic_override_t*)entry;
+            if (override->address >> 32 == 0)
+                config->lapic_paddr = (uint32_t)override->address;
+            break;
+        }
+        default:
+            break;
+        }
+
+        entry += header->length;
+    }
+}
+
+int acpi_parse_madt(apic_config_t* config) {
+    uint32_t ebda = (uint32_t)(*(volatile uint16_t*)ACPI_EBDA_SEGMENT_PTR) << 4;
+    const acpi_rsdp_t* rsdp = NULL;
+    if (ebda)
+        rsdp = find_rsdp(ebda, ebda + 1024);
+    if (!rsdp)
+        rsdp = find_rsdp(ACPI_BIOS_START, ACPI_BIOS_END);
+    if (!rsdp)
+        return -1;
+
+    const acpi_sdt_header_t* rsdt = map_table(rsdp->rsdt_address);
+    if (!rsdt)
+        return -1;
+    if (!signature_equal(rsdt->signature, "RSDT", 4)) {
+        unmap_phys(rsdt, rsdt->length);
+        return -1;
+    }
+
+    const uint32_t* entries = (const uint32_t*)(rsdt + 1);
+    uint32_t num_entries = (rsdt->length - sizeof(acpi_sdt_header_t)) / sizeof(uint32_t);
+    for (uint32_t i = 0; i < num_entries; i++) {
+        /* Peek at the signature before mapping the whole table */
+        acpi_sdt_header_t header;
+        if (peek_table(entries[i], &header) == -1 || !signature_equal(header.signature, "APIC", 4))
+            continue;
+
+        /* Everything is copied into @config, so both tables go, newest first */
+        const acpi_madt_t* madt = (const acpi_madt_t*)map_table(entries[i]);
+        int ret = -1;
+        if (madt) {
+            parse_madt(madt, config);
+            unmap_phys(madt, madt->header.length);
+            ret = 0;
+        }
+        unmap_phys(rsdt, rsdt->length);
+        return ret;
+    }
+
+    unmap_phys(rsdt, rsdt->length);
+    return -1;
+}
@@ -0,0 +1,147 @@
+#ifndef ACPI_H
+#define ACPI_H
+
+#include <stdint.h>
+
+#include "apic.h"
+
+/**
+ * ACPI_EBDA_SEGMENT_PTR - BIOS data area word holding the EBDA segment
+ */
+#define ACPI_EBDA_SEGMENT_PTR   0x040E
+
+/**
+ * ACPI_BIOS_START - Start of the BIOS read-only area searched for the RSDP
+ */
+#define ACPI_BIOS_START         0x000E0000
+
+/**
+ * ACPI_BIOS_END - End (exclusive) of the BIOS read-only area
+ */
+#define ACPI_BIOS_END           0x00100000
+
+/* MADT entry types */
+#define MADT_LAPIC              0
+#define MADT_IOAPIC             1
+#define MADT_ISO                2
+#define MADT_LAPIC_OVERRIDE     5
+
+/**
+ * MADT_LAPIC_ENABLED - Processor LAPIC entry flag: processor is usable
+ */
+#define MADT_LAPIC_ENABLED      0x01
+
+/**
+ * struct acpi_rsdp_t - Root System Description Pointer (ACPI 1.0 part)
+ * @signature: "RSD PTR "
+ * @checksum: Bytes of the structure sum to zero
+ * @oem_id: OEM identifier
+ * @revision: ACPI revision
+ * @rsdt_address: Physical address of the RSDT
+ */
+typedef struct {
+    char signature[8];
+    uint8_t checksum;
+    char oem_id[6];
+    uint8_t revision;
+    uint32_t rsdt_address;
+} __attribute__((packed)) acpi_rsdp_t;
+
+/**
+ * struct acpi_sdt_header_t - Header shared by all system description tables
+ * @signature: Table signature
+ * @length: Length of the whole table in bytes
+ * @revision: Table revision
+ * @checksum: Bytes of the table sum to zero
+ * @oem_id: OEM identifier
+ * @oem_table_id: OEM table identifier
+ * @oem_revision: OEM revision
+ * @creator_id: Table creator
+ * @creator_revision: Table creator revision
+ */
+typedef struct {
+    char signature[4];
+    uint32_t length;
+    uint8_t revision;
+    uint8_t checksum;
+    char oem_id[6];
+    char oem_table_id[8];
+    uint32_t oem_revision;
+    uint32_t creator_id;
+    uint32_t creator_revision;
+} __attribute__((packed)) acpi_sdt_header_t;
+
+/**
+ * struct acpi_madt_t - Multiple APIC Description Table
+ * @header: Common table header ("APIC")
+ * @lapic_address: Physical address of the local APICs
+ * @flags: MADT flags
+ *
+ * Variable-length entries follow the fixed part.
+ */
+typedef struct {
+    acpi_sdt_header_t header;
+    uint32_t lapic_address;
+    uint32_t flags;
+} __attribute__((packed)) acpi_madt_t;
+
+/**
+ * struct madt_entry_t - Header of a MADT entry
+ * @type: Entry type
+ * @length: Entry length in bytes
+ */
+typedef struct {
+    uint8_t type;
+    uint8_t length;
+} __attribute__((packed)) madt_entry_t;
+
+/**
+ * struct madt_lapic_t - Processor local APIC entry
+ */
+typedef struct {
+    madt_entry_t entry;
+    uint8_t processor_id;
+    uint8_t apic_id;
+    uint32_t flags;
+} __attribute__((packed)) madt_lapic_t;
+
+/**
+ * struct madt_ioapic_t - I/O APIC entry
+ */
+typedef struct {
+    madt_entry_t entry;
+    uint8_t ioapic_id;
+    uint8_t reserved;
+    uint32_t address;
+    uint32_t gsi_base;
+} __attribute__((packed)) madt_ioapic_t;
+
+/**
+ * struct madt_iso_t - Interrupt source override entry
+ */
+typedef struct {
+    madt_entry_t entry;
+    uint8_t bus;
+    uint8_t source;
+    uint32_t gsi;
+    uint16_t flags;
+} __attribute__((packed)) madt_iso_t;
+
+/**
+ * struct madt_lapic_override_t - 64-bit local APIC address override entry
+ */
+typedef struct {
+    madt_entry_t entry;
+    uint16_t reserved;
+    uint64_t address;
+} __attribute__((packed)) madt_lapic_override_t;
+
+/**
+ * acpi_parse_madt - Fill @config from the ACPI MADT
+ * @config: Configuration to fill
+ *
+ * Return: 0 on success, -1 if no MADT was found
+ */
+int acpi_parse_madt(apic_config_t *config);
+
+#endif
@@ -0,0 +1,378 @@
+#include <stddef.h>
+
+#include "apic.h"
+#include "acpi.h"
+#include "mptable.h"
+#include "pic.h"
+#include "../io.h"
+#include "../drivers/pit.h"
+#include "../memory/paging.h"
+#include "../time/clockevent.h"
+
+/**
+ * IMCR_SELECT - Port selecting the IMCR on MP systems with a PIC mode
+ */
+#define IMCR_SELECT     0x22
+
+/**
+ * IMCR_DATA - IMCR data port
+ */
+#define IMCR_DATA       0x23
+
+extern void apic_spurious_stub(void);
+extern void irq_stub_lapic_timer(void);
+
+/**
+ * config - Interrupt controller topology
+ */
+static apic_config_t config;
+
+/**
+ * lapic - Mapped local APIC registers
+ */
+static volatile uint32_t* lapic;
+
+/**
+ * timer_programmed - Count loaded by the last lapic_timer_set_next_event(), per CPU
+ */
+static uint32_t timer_programmed[MAX_CPUS];
+
+/**
+ * timer_enabled - Set once lapic_timer_init() made the timer the clock event device
+ */
+static int timer_enabled;
+
+/**
+ * timer_ns_to_ticks - Fixed-point factor converting nanoseconds to timer ticks
+ */
+static uint64_t timer_ns_to_ticks;
+
+/**
+ * timer_ticks_to_ns - Fixed-point factor converting timer ticks to nanoseconds
+ */
+static uint64_t timer_ticks_to_ns;
+
+uint32_t lapic_read(uint32_t reg) {
+    return lapic[reg / sizeof(uint32_t)];
+}
+
+void lapic_write(uint32_t reg, uint32_t value) {
+    lapic[reg / sizeof(uint32_t)] = value;
+}
+
+uint8_t lapic_id(void) {
+    return (uint8_t)(lapic_read(LAPIC_ID) >> 24);
+}
+
+void lapic_eoi(void) {
+    lapic_write(LAPIC_EOI, 0);
+}
+
+void lapic_init_cpu(void) {
+    wrmsr(APIC_BASE_MSR, rdmsr(APIC_BASE_MSR) | APIC_BASE_ENABLE);
+    lapic_write(LAPIC_TPR, 0);
+    lapic_write(LAPIC_SVR, LAPIC_SVR_ENABLE | LAPIC_SPURIOUS_VECTOR);
+}
+
+void lapic_send_ipi(uint8_t apic_id, uint32_t icr) {
+    /* An interrupt sending its own IPI must not split the ICR writes */
+    uint32_t flags = irq_save();
+    while (lapic_read(LAPIC_ICR_LOW) & LAPIC_ICR_PENDING)
+        cpu_relax();
+
+    lapic_write(LAPIC_ICR_HIGH, (uint32_t)apic_id << 24);
+    lapic_write(LAPIC_ICR_LOW, icr);
+    irq_restore(flags);
+}
+
+/**
+ * ioapic_read - Read an I/O APIC register
+ * @ioapic: I/O APIC
+ * @reg: Register index
+ *
+ * Return: Register value
+ */
+static uint32_t ioapic_read(const ioapic_t* ioapic, uint8_t reg) {
+    ioapic->regs[IOAPIC_REGSEL / sizeof(uint32_t)] = reg;
+    return ioapic->regs[IOAPIC_WINDOW / sizeof(uint32_t)];
+}
+
+/**
+ * ioapic_write - Write an I/O APIC register
+ * @ioapic: I/O APIC
+ * @reg: Register index
+ * @value: Value to write
+ *
+ * Return: Nothing
+ */
+static void ioapic_write(const ioapic_t* ioapic, uint8_t reg, uint32_t value) {
+    ioapic->regs[IOAPIC_REGSEL / sizeof(uint32_t)] = reg;
+    ioapic->regs[IOAPIC_WINDOW / sizeof(uint32_t)] = value;
+}
+
+/**
+ * ioapic_for_irq - Find the I/O APIC pin an ISA IRQ is wired to
+ * @irq: ISA IRQ line
+ * @pin: On success, set to the redirection entry index
+ *
+ * Return: I/O APIC, or NULL if the IRQ is not routed
+ */
+static const ioapic_t* ioapic_for_irq(uint8_t irq, uint32_t* pin) {
+    uint32_t gsi = config.isa_irqs[irq].gsi;
+
+    for (uint32_t i = 0; i < config.num_ioapics; i++) {
+        const ioapic_t* ioapic = &config.ioapics[i];
+        if (gsi >= ioapic->gsi_base && gsi < ioapic->gsi_base + ioapic->num_pins) {
+            *pin = gsi - ioapic->gsi_base;
+            return ioapic;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * ioapic_route_isa_irq - Program the redirection entry of an ISA IRQ
+ * @irq: ISA IRQ line
+ * @dest: Local APIC ID to deliver to
+ *
+ * The entry is left masked with vector 32 + @irq.
+ * Return: Nothing
+ */
+static void ioapic_route_isa_irq(uint8_t irq, uint8_t dest) {
+    uint32_t pin;
+    const ioapic_t* ioapic = ioapic_for_irq(irq, &pin);
+    if (!ioapic)
+        return;
+
+    uint16_t flags = config.isa_irqs[irq].flags;
+    uint32_t low = (32 + irq) | IOAPIC_MASKED;
+    if ((flags & INTI_POLARITY_MASK) == INTI_POLARITY_LOW)
+        low |= IOAPIC_ACTIVE_LOW;
+    if ((flags & INTI_TRIGGER_MASK) == INTI_TRIGGER_LEVEL)
+        low |= IOAPIC_LEVEL_TRIGGERED;
+
+    ioapic_write(ioapic, IOAPIC_REG_REDIRECTION + pin * 2 + 1, (uint32_t)dest << 24);
+    ioapic_write(ioapic, IOAPIC_REG_REDIRECTION + pin * 2, low);
+}
+
+/**
+ * ioapic_set_masked - Mask or unmask the pin of an ISA IRQ
+ * @irq: ISA IRQ line
+ * @masked: Non-zero to mask
+ *
+ * Return: Nothing
+ */
+static void ioapic_set_masked(uint8_t irq, int masked) {
+    uint32_t pin;
+    const ioapic_t* ioapic = ioapic_for_irq(irq, &pin);
+    if (!ioapic)
+        return;
+
+    uint8_t reg = IOAPIC_REG_REDIRECTION + pin * 2;
+    uint32_t low = ioapic_read(ioapic, reg);
+    if (masked)
+        low |= IOAPIC_MASKED;
+    else
+        low &= ~IOAPIC_MASKED;
+    ioapic_write(ioapic, reg, low);
+}
+
+static void apic_eoi(uint8_t irq) {
+    (void)irq;
+    lapic_eoi();
+}
+
+static void apic_mask(uint8_t irq) {
+    ioapic_set_masked(irq, 1);
+}
+
+static void apic_unmask(uint8_t irq) {
+    ioapic_set_masked(irq, 0);
+}
+
+static int apic_spurious(uint8_t irq) {
+    /* Local APIC spurious interrupts arrive on their own vector */
+    (void)irq;
+    return 0;
+}
+
+const irqchip_t apic_chip = {
+    .name     = "I/O APIC",
+    .eoi      = apic_eoi,
+    .mask     = apic_mask,
+    .unmask   = apic_unmask,
+    .spurious = apic_spurious,
+};
+
+void apic_add_cpu(apic_config_t* cfg, uint8_t apic_id) {
+    if (cfg->num_cpus < MAX_CPUS)
+        cfg->cpu_apic_ids[cfg->num_cpus++] = apic_id;
+}
+
+int apic_add_ioapic(apic_config_t* cfg, uint8_t id, uint32_t paddr, uint32_t gsi_base) {
+    if (cfg->num_ioapics >= MAX_IOAPICS)
+        return -1;
+
+    ioapic_t* ioapic = &cfg->ioapics[cfg->num_ioapics];
+    ioapic->regs = map_phys(paddr, IOAPIC_WINDOW + sizeof(uint32_t), PG_FLAG_RW | PG_FLAG_NOCACHE);
+    if (!ioapic->regs)
+        return -1;
+
+    ioapic->id = id;
+    ioapic->paddr = paddr;
+    ioapic->num_pins = ((ioapic_read(ioapic, IOAPIC_REG_VERSION) >> 16) & 0xFF) + 1;
+
+    if (gsi_base == IOAPIC_GSI_AUTO) {
+        gsi_base = 0;
+        for (uint32_t i = 0; i < cfg->num_ioapics; i++)
+            gsi_base += cfg->ioapics[i].num_pins;
+    }
+    ioapic->gsi_base = gsi_base;
+
+    cfg->num_ioapics++;
+    return 0;
+}
+
+void apic_add_isa_irq(apic_config_t* cfg, uint8_t irq, uint32_t gsi, uint16_t flags) {
+    if (irq >= IRQ_NUM_LINES)
+        return;
+
+    for (uint8_t other = 0; other < IRQ_NUM_LINES; other++) {
+        if (other != irq && cfg->isa_irqs[other].gsi == gsi)
+            cfg->isa_irqs[other].gsi = ISA_IRQ_UNROUTED;
+    }
+
+    cfg->isa_irqs[irq].gsi = gsi;
+    cfg->isa_irqs[irq].flags = flags;
+}
+
+static void lapic_timer_set_next_event(uint64_t delta_ns) {
+    uint64_t ticks = (delta_ns * timer_ns_to_ticks) >> CLOCKEVENT_SHIFT;
+    if (ticks == 0)
+        ticks = 1;
+    if (ticks > LAPIC_TIMER_MAX_TICKS)
+        ticks = LAPIC_TIMER_MAX_TICKS;
+
+    timer_programmed[cpu_id()] = (uint32_t)ticks;
+    lapic_write(LAPIC_TIMER_INITIAL, (uint32_t)ticks);
+}
+
+static uint64_t lapic_timer_elapsed_ns(void) {
+    /* The count stops at zero once the interrupt fired */
+    uint32_t ticks = timer_programmed[cpu_id()] - lapic_read(LAPIC_TIMER_CURRENT);
+    return ((uint64_t)ticks * timer_ticks_to_ns) >> CLOCKEVENT_SHIFT;
+}
+
+static clockevent_t lapic_clockevent = {
+    .name           = "LAPIC timer",
+    .set_next_event = lapic_timer_set_next_event,
+    .elapsed_ns     = lapic_timer_elapsed_ns,
+};
+
+static void lapic_timer_irq(interrupt_frame_t* frame, void* ctx) {
+    (void)frame;
+    (void)ctx;
+    clockevent_handle();
+}
+
+int lapic_timer_init(void) {
+    if (!lapic)
+        return -1;
+
+    /* Count down from the maximum for a fixed number of PIT ticks */
+    uint32_t flags = irq_save();
+    lapic_write(LAPIC_TIMER_DIVIDE, LAPIC_TIMER_DIVIDE_16);
+    lapic_write(LAPIC_LVT_TIMER, LAPIC_LVT_MASKED | LAPIC_TIMER_VECTOR);
+    lapic_write(LAPIC_TIMER_INITIAL, 0xFFFFFFFF);
+    pit_wait(LAPIC_CALIBRATE_PIT_TICKS);
+    uint32_t counted = 0xFFFFFFFF - lapic_read(LAPIC_TIMER_CURRENT);
+    lapic_write(LAPIC_TIMER_INITIAL, 0);
+    irq_restore(flags);
+
+    if (counted == 0)
+        return -1;
+
+    uint64_t frequency = (uint64_t)counted * PIT_FREQUENCY / LAPIC_CALIBRATE_PIT_TICKS;
+    timer_ns_to_ticks = clockevent_calc_mult(NSEC_PER_SEC, frequency);
+    timer_ticks_to_ns = clockevent_calc_mult(frequency, NSEC_PER_SEC);
+    lapic_clockevent.min_delta_ns = ((uint64_t)2 * timer_ticks_to_ns) >> CLOCKEVENT_SHIFT;
+    lapic_clockevent.max_delta_ns = ((uint64_t)LAPIC_TIMER_MAX_TICKS * timer_ticks_to_ns) >> CLOCKEVENT_SHIFT;
+
+    idt_set_descriptor(LAPIC_TIMER_VECTOR, irq_stub_lapic_timer, 0x8E);
+    if (irq_register_vector(LAPIC_TIMER_VECTOR, lapic_timer_irq, NULL) == -1)
+        return -1;
+
+    /* One-shot mode, unmasked */
+    lapic_write(LAPIC_LVT_TIMER, LAPIC_TIMER_VECTOR);
+    clockevent_register(&lapic_clockevent);
+    pit_shutdown();
+    timer_enabled = 1;
+    return 0;
+}
+
+int lapic_timer_init_cpu(void) {
+    if (!lapic_timer_enabled())
+        return -1;
+
+    uint32_t flags = irq_save();
+    lapic_write(LAPIC_TIMER_DIVIDE, LAPIC_TIMER_DIVIDE_16);
+    lapic_write(LAPIC_TIMER_INITIAL, 0);
+    lapic_write(LAPIC_LVT_TIMER, LAPIC_TIMER_VECTOR);
+    clockevent_register(&lapic_clockevent);
+    irq_restore(flags);
+    return 0;
+}
+
+int lapic_timer_enabled(void) {
+    return timer_enabled;
+}
+
+const apic_config_t* apic_get_config(void) {
+    return &config;
+}
+
+int apic_init(void) {
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(1, &eax, &ebx, &ecx, &edx);
+    if (!(edx & CPUID_EDX_APIC))
+        return -1;
+
+    /* ISA IRQs are identity-mapped to GSIs unless a table says otherwise */
+    for (uint8_t irq = 0; irq < IRQ_NUM_LINES; irq++) {
+        config.isa_irqs[irq].gsi = irq;
+        config.isa_irqs[irq].flags = 0;
+    }
+
+    if (acpi_parse_madt(&config) == -1 && mptable_parse(&config) == -1)
+        return -1;
+
+    if (config.num_ioapics == 0)
+        return -1;
+
+    lapic = map_phys(config.lapic_paddr, PAGE_SIZE, PG_FLAG_RW | PG_FLAG_NOCACHE);
+    if (!lapic)
+        return -1;
+
+    uint32_t flags = irq_save();
+
+    /* Enable the local APIC and accept every priority */
+    idt_set_descriptor(LAPIC_SPURIOUS_VECTOR, apic_spurious_stub, 0x8E);
+    lapic_init_cpu();
+
+    /* Route interrupts through the APIC instead of the PIC */
+    if (config.imcr_present) {
+        outb(IMCR_SELECT, 0x70);
+        outb(IMCR_DATA, 0x01);
+    }
+
+    uint8_t bsp = lapic_id();
+    for (uint8_t irq = 0; irq < IRQ_NUM_LINES; irq++)
+        ioapic_route_isa_irq(irq, bsp);
+
+    irqchip_set(&apic_chip);
+    pic_disable();
+
+    irq_restore(flags);
+    return 0;
+}
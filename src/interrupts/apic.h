@@ -0,0 +1,295 @@
+#ifndef APIC_H
+#define APIC_H
+
+#include <stdint.h>
+
+#include "idt.h"
+#include "irqchip.h"
+#include "../cpu/cpu.h"
+
+/**
+ * APIC_BASE_MSR - IA32_APIC_BASE model-specific register
+ */
+#define APIC_BASE_MSR               0x1B
+
+/**
+ * APIC_BASE_ENABLE - Global enable bit in IA32_APIC_BASE
+ */
+#define APIC_BASE_ENABLE            (1U << 11)
+
+/**
+ * LAPIC_SPURIOUS_VECTOR - Vector of local APIC spurious interrupts
+ */
+#define LAPIC_SPURIOUS_VECTOR       0xFF
+
+/**
+ * LAPIC_TIMER_VECTOR - Vector of the local APIC timer
+ */
+#define LAPIC_TIMER_VECTOR          0xEF
+
+/* Local APIC register offsets */
+#define LAPIC_ID                    0x020
+#define LAPIC_VERSION               0x030
+#define LAPIC_TPR                   0x080
+#define LAPIC_EOI                   0x0B0
+#define LAPIC_SVR                   0x0F0
+#define LAPIC_ICR_LOW               0x300
+#define LAPIC_ICR_HIGH              0x310
+#define LAPIC_LVT_TIMER             0x320
+#define LAPIC_LVT_LINT0             0x350
+#define LAPIC_LVT_LINT1             0x360
+#define LAPIC_TIMER_INITIAL         0x380
+#define LAPIC_TIMER_CURRENT         0x390
+#define LAPIC_TIMER_DIVIDE          0x3E0
+
+/**
+ * LAPIC_SVR_ENABLE - APIC software enable bit in the spurious vector register
+ */
+#define LAPIC_SVR_ENABLE            0x100
+
+/**
+ * LAPIC_LVT_MASKED - LVT entry mask bit
+ */
+#define LAPIC_LVT_MASKED            (1U << 16)
+
+/**
+ * LAPIC_ICR_INIT - ICR delivery mode resetting the target to wait for a startup IPI
+ */
+#define LAPIC_ICR_INIT              (5U << 8)
+
+/**
+ * LAPIC_ICR_STARTUP - ICR delivery mode starting the target at vector * 4 KiB
+ */
+#define LAPIC_ICR_STARTUP           (6U << 8)
+
+/**
+ * LAPIC_ICR_PENDING - ICR delivery status, set until the IPI was accepted
+ */
+#define LAPIC_ICR_PENDING           (1U << 12)
+
+/**
+ * LAPIC_ICR_ASSERT - ICR level bit, required for everything but INIT de-assert
+ */
+#define LAPIC_ICR_ASSERT            (1U << 14)
+
+/**
+ * LAPIC_TIMER_DIVIDE_16 - Divide configuration value for bus clock / 16
+ */
+#define LAPIC_TIMER_DIVIDE_16       0x3
+
+/**
+ * LAPIC_TIMER_MAX_TICKS - Longest one-shot count, bounded so that tick to
+ * nanosecond conversion cannot overflow 64 bits
+ */
+#define LAPIC_TIMER_MAX_TICKS       (1U << 29)
+
+/**
+ * LAPIC_CALIBRATE_PIT_TICKS - PIT ticks (~10 ms) used to calibrate the timer
+ */
+#define LAPIC_CALIBRATE_PIT_TICKS   11932
+
+/* I/O APIC registers */
+#define IOAPIC_REGSEL               0x00
+#define IOAPIC_WINDOW               0x10
+#define IOAPIC_REG_ID               0x00
+#define IOAPIC_REG_VERSION          0x01
+#define IOAPIC_REG_REDIRECTION      0x10
+
+/* I/O APIC redirection entry bits */
+#define IOAPIC_ACTIVE_LOW           (1U << 13)
+#define IOAPIC_LEVEL_TRIGGERED      (1U << 15)
+#define IOAPIC_MASKED               (1U << 16)
+
+/* MPS INTI flags, shared by ACPI MADT overrides and MP table entries */
+#define INTI_POLARITY_MASK          0x03
+#define INTI_POLARITY_LOW           0x03
+#define INTI_TRIGGER_MASK           0x0C
+#define INTI_TRIGGER_LEVEL          0x0C
+
+/**
+ * MAX_IOAPICS - Maximum number of I/O APICs tracked
+ */
+#define MAX_IOAPICS                 4
+
+/**
+ * IOAPIC_GSI_AUTO - apic_add_ioapic() should compute the GSI base
+ */
+#define IOAPIC_GSI_AUTO             0xFFFFFFFF
+
+/**
+ * ISA_IRQ_UNROUTED - isa_irq_t.gsi of an ISA IRQ with no I/O APIC pin
+ */
+#define ISA_IRQ_UNROUTED            0xFFFFFFFF
+
+/**
+ * struct ioapic_t - One I/O APIC
+ * @id: I/O APIC ID
+ * @paddr: Physical MMIO base
+ * @gsi_base: First global system interrupt handled by this I/O APIC
+ * @num_pins: Number of redirection entries
+ * @regs: Mapped MMIO base
+ */
+typedef struct {
+    uint8_t id;
+    uint32_t paddr;
+    uint32_t gsi_base;
+    uint32_t num_pins;
+    volatile uint32_t *regs;
+} ioapic_t;
+
+/**
+ * struct isa_irq_t - Routing of one ISA IRQ line
+ * @gsi: Global system interrupt the line is wired to
+ * @flags: MPS INTI polarity and trigger flags (0 = ISA defaults)
+ */
+typedef struct {
+    uint32_t gsi;
+    uint16_t flags;
+} isa_irq_t;
+
+/**
+ * struct apic_config_t - Interrupt controller topology found in firmware tables
+ * @lapic_paddr: Physical MMIO base of the local APICs
+ * @num_cpus: Number of enabled processors
+ * @cpu_apic_ids: Local APIC ID of each enabled processor
+ * @num_ioapics: Number of I/O APICs
+ * @ioapics: I/O APICs
+ * @isa_irqs: Routing of ISA IRQs 0-15
+ * @imcr_present: Non-zero if the IMCR must be switched to APIC mode
+ */
+typedef struct {
+    uint32_t lapic_paddr;
+    uint32_t num_cpus;
+    uint8_t cpu_apic_ids[MAX_CPUS];
+    uint32_t num_ioapics;
+    ioapic_t ioapics[MAX_IOAPICS];
+    isa_irq_t isa_irqs[IRQ_NUM_LINES];
+    int imcr_present;
+} apic_config_t;
+
+/**
+ * apic_init - Switch interrupt delivery from the 8259 PIC to the APICs
+ *
+ * Discovers the local and I/O APICs through the ACPI MADT, falling back
+ * to the MP tables. Must be called after paging_init(). On failure the
+ * PIC stays in charge.
+ *
+ * Return: 0 on success, -1 if no usable APIC was found
+ */
+int apic_init(void);
+
+/**
+ * apic_get_config - Get the topology found by apic_init()
+ *
+ * Return: Pointer to the APIC configuration
+ */
+const apic_config_t *apic_get_config(void);
+
+/**
+ * lapic_read - Read a local APIC register
+ * @reg: Register offset
+ *
+ * Return: Register value
+ */
+uint32_t lapic_read(uint32_t reg);
+
+/**
+ * lapic_write - Write a local APIC register
+ * @reg: Register offset
+ * @value: Value to write
+ */
+void lapic_write(uint32_t reg, uint32_t value);
+
+/**
+ * lapic_id - Get the local APIC ID of the executing CPU
+ *
+ * Return: Local APIC ID
+ */
+uint8_t lapic_id(void);
+
+/**
+ * lapic_eoi - Signal end of interrupt to the local APIC
+ */
+void lapic_eoi(void);
+
+/**
+ * lapic_timer_init - Calibrate the local APIC timer and make it the clock event device
+ *
+ * Must be called after apic_init() succeeded and pit_init(). Stops the
+ * PIT interrupt once the local APIC timer has taken over.
+ *
+ * Return: 0 on success, -1 if the timer could not be calibrated
+ */
+int lapic_timer_init(void);
+
+/**
+ * lapic_init_cpu - Enable the executing CPU's local APIC
+ *
+ * Accepts every priority and sets the spurious vector. apic_init() does
+ * this for the bootstrap CPU; application processors call it themselves.
+ * Return: Nothing
+ */
+void lapic_init_cpu(void);
+
+/**
+ * lapic_send_ipi - Send an inter-processor interrupt
+ * @apic_id: Local APIC ID of the target
+ * @icr: Low ICR word: vector, delivery mode and level
+ *
+ * Waits for the previous IPI to be accepted first.
+ * Return: Nothing
+ */
+void lapic_send_ipi(uint8_t apic_id, uint32_t icr);
+
+/**
+ * lapic_timer_init_cpu - Make the executing CPU's timer its clock event device
+ *
+ * Reuses the calibration of lapic_timer_init(), since every local APIC
+ * timer runs off the same bus clock.
+ * Return: 0 on success, -1 if the timer was never calibrated
+ */
+int lapic_timer_init_cpu(void);
+
+/**
+ * lapic_timer_enabled - Check whether lapic_timer_init() succeeded
+ *
+ * Return: Non-zero if the local APIC timer is the clock event device
+ */
+int lapic_timer_enabled(void);
+
+/**
+ * apic_add_cpu - Record an enabled processor found in firmware tables
+ * @config: Configuration being filled
+ * @apic_id: Local APIC ID of the processor
+ */
+void apic_add_cpu(apic_config_t *config, uint8_t apic_id);
+
+/**
+ * apic_add_ioapic - Record and map an I/O APIC found in firmware tables
+ * @config: Configuration being filled
+ * @id: I/O APIC ID
+ * @paddr: Physical MMIO base
+ * @gsi_base: First GSI of the I/O APIC, or IOAPIC_GSI_AUTO to place it
+ *            after the previously added ones
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int apic_add_ioapic(apic_config_t *config, uint8_t id, uint32_t paddr, uint32_t gsi_base);
+
+/**
+ * apic_add_isa_irq - Record the routing of an ISA IRQ found in firmware tables
+ * @config: Configuration being filled
+ * @irq: ISA IRQ line (0-15)
+ * @gsi: Global system interrupt the line is wired to
+ * @flags: MPS INTI polarity and trigger flags
+ *
+ * Any other ISA IRQ still identity-mapped to @gsi loses its routing.
+ */
+void apic_add_isa_irq(apic_config_t *config, uint8_t irq, uint32_t gsi, uint16_t flags);
+
+/**
+ * apic_chip - I/O APIC interrupt controller operations
+ */
+extern const irqchip_t apic_chip;
+
+#endif
@@ -1,7 +1,13 @@
+#include <stddef.h>
+
 #include "idt.h"
 #include "pic.h"
+#include "softirq.h"
+#include "../sched/sched.h"
+#include "../cpu/cpu.h"
 #include "../io.h"
 #include "../drivers/vga.h"
+#include "../lib/printf.h"
 #include "../utils.h"
 
 /**
@@ -48,8 +54,13 @@ static const char* exception_messages[] = {
     "Reserved"
 };
 
+/**
+ * exception_handlers - Registered handlers for CPU exceptions (vectors 0-31)
+ */
+static exception_handler_t exception_handlers[32];
+
 __attribute__((noreturn))
-void exception_handler(interrupt_frame_t* frame)
+void exception_panic(interrupt_frame_t* frame)
 {
     vga_clear_screen(BLACK);
     
@@ -59,32 +70,165 @@ void exception_handler(interrupt_frame_t* frame)
     } else {
         vga_print_string(0, 0, "Unknown Exception", RED, BLACK);
     }
+
+    vga_print_string(1, 0, "EIP: ", RED, BLACK);
+    vga_print_hex(1, 5, frame->eip, RED, BLACK);
+    vga_print_string(2, 0, "ERR: ", RED, BLACK);
+    vga_print_hex(2, 5, frame->err_code, RED, BLACK);
+
+    if (frame->int_no == 14) {
+        uint32_t cr2;
+        __asm__ volatile ("mov %%cr2, %0" : "=r"(cr2));
+        vga_print_string(3, 0, "CR2: ", RED, BLACK);
+        vga_print_hex(3, 5, cr2, RED, BLACK);
+    }
     
     __asm__ volatile ("cli; hlt");
     while (1);
 }
 
-volatile uint64_t timer_ticks = 0;
-static uint8_t keyboard_row = 10;  /* Row to print scancodes */
+void exception_unhandled(interrupt_frame_t* frame)
+{
+    /* NMI, #DF and #MC report the machine, not the program that ran */
+    uint32_t vector = frame->int_no;
+    int program_fault = vector < 32 && vector != 2 && vector != 8 && vector != 18;
+
+    if ((frame->cs & 3) == 3 && program_fault) {
+        kprintf("idt: %s raised %s at %x, killed\n",
+                thread_current()->name, exception_messages[vector], frame->eip);
+        thread_exit();
+    }
+
+    exception_panic(frame);
+}
+
+void exception_handler(interrupt_frame_t* frame)
+{
+    if (frame->int_no < 32 && exception_handlers[frame->int_no]) {
+        exception_handlers[frame->int_no](frame);
+        return;
+    }
+
+    exception_unhandled(frame);
+}
+
+void exception_register(uint8_t vector, exception_handler_t handler)
+{
+    if (vector < 32)
+        exception_handlers[vector] = handler;
+}
+
+/**
+ * irq_actions - Registered handlers, indexed by vector - 32
+ */
+static irq_action_t irq_actions[IRQ_NUM_VECTORS];
+
+/**
+ * irqchip - Interrupt controller delivering the legacy IRQ lines
+ */
+static const irqchip_t* irqchip = &pic_chip;
+
+/**
+ * irq_regs - Frame of the IRQ each CPU is handling, NULL outside one
+ */
+static interrupt_frame_t* irq_regs[MAX_CPUS];
 
 void irq_handler(interrupt_frame_t* frame) {
+    uint64_t start = rdtsc();
     uint8_t irq = frame->int_no - 32;
-    
-    if (irq == 0) {
-        timer_ticks++;
-    } else if (irq == 1) {
-        uint8_t scancode = inb(0x60);
-
-        /* Print scancode as hex for now */
-        char hex[] = "0x00";
-        hex[2] = "0123456789ABCDEF"[scancode >> 4];
-        hex[3] = "0123456789ABCDEF"[scancode & 0x0F];
-        vga_print_string(keyboard_row, 0, hex, 0x0F, 0x00);
-        keyboard_row++;
-        if (keyboard_row > 24) keyboard_row = 10;
+
+    /* Spurious interrupts get no handler and no EOI */
+    if (irq < IRQ_NUM_LINES && irqchip->spurious(irq))
+        return;
+
+    irq_action_t* action = &irq_actions[irq];
+    irq_regs[cpu_id()] = frame;
+    if (action->handler)
+        action->handler(frame, action->ctx);
+    irq_regs[cpu_id()] = NULL;
+
+    /* Vectors past the legacy lines only exist under the APIC, whose EOI ignores @irq */
+    irqchip->eoi(irq);
+    softirq_account_irq_off(rdtsc() - start);
+}
+
+interrupt_frame_t* irq_get_regs(void) {
+    return irq_regs[cpu_id()];
+}
+
+void irq_exit(void) {
+    /* Bottom halves run with interrupts enabled before returning */
+    softirq_run();
+
+    /* Preempt, unless this interrupt landed inside another CPU-local softirq drain */
+    if (sched_need_resched() && !softirq_running())
+        schedule();
+}
+
+int irq_register(uint8_t irq, irq_handler_t handler, void* ctx) {
+    if (irq >= IRQ_NUM_LINES || !handler)
+        return -1;
+
+    if (irq_actions[irq].handler)
+        return -1;
+
+    irq_actions[irq].ctx = ctx;
+    irq_actions[irq].handler = handler;
+    irq_clear_mask(irq);
+    return 0;
+}
+
+int irq_register_vector(uint8_t vector, irq_handler_t handler, void* ctx) {
+    if (vector < 32 + IRQ_NUM_LINES || vector == 0xFF || !handler)
+        return -1;
+
+    irq_action_t* action = &irq_actions[vector - 32];
+    if (action->handler)
+        return -1;
+
+    action->ctx = ctx;
+    action->handler = handler;
+    return 0;
+}
+
+void irq_unregister(uint8_t irq) {
+    if (irq >= IRQ_NUM_LINES)
+        return;
+
+    irq_set_mask(irq);
+    irq_actions[irq].handler = NULL;
+    irq_actions[irq].ctx = NULL;
+}
+
+void irq_set_mask(uint8_t irq) {
+    if (irq < IRQ_NUM_LINES)
+        irqchip->mask(irq);
+}
+
+void irq_clear_mask(uint8_t irq) {
+    if (irq < IRQ_NUM_LINES)
+        irqchip->unmask(irq);
+}
+
+void irqchip_set(const irqchip_t* chip) {
+    uint32_t flags = irq_save();
+
+    for (uint8_t irq = 0; irq < IRQ_NUM_LINES; irq++) {
+        if (irq_actions[irq].handler)
+            irqchip->mask(irq);
     }
-    
-    pic_send_eoi(irq);
+
+    irqchip = chip;
+    for (uint8_t irq = 0; irq < IRQ_NUM_LINES; irq++) {
+        if (irq_actions[irq].handler)
+            irqchip->unmask(irq);
+    }
+
+    irq_restore(flags);
+}
+
+const irqchip_t* irqchip_get(void) {
+    return irqchip;
 }
 
 void idt_set_descriptor(uint8_t vector, void* isr, uint8_t flags)
@@ -107,10 +251,15 @@ void idt_init(void)
     for (uint8_t vector = 0; vector < 32; vector++)
         idt_set_descriptor(vector, isr_stub_table[vector], 0x8E);
 
-    /* IRQ handlers (32-33 for now) */
-    idt_set_descriptor(32, irq_stub_table[0], 0x8E);  // IRQ0 - timer
-    idt_set_descriptor(33, irq_stub_table[1], 0x8E);  // IRQ1 - keyboard
+    /* IRQ handlers (vectors 32-47) */
+    for (uint8_t irq = 0; irq < IRQ_NUM_LINES; irq++)
+        idt_set_descriptor(32 + irq, irq_stub_table[irq], 0x8E);
 
-    __asm__ volatile ("lidt %0" : : "m"(idtr)); /* Load IDTR */
+    idt_load();
     /* Note: Caller should enable interrupts with sti after PIC is initialized */
 }
+
+void idt_load(void)
+{
+    __asm__ volatile ("lidt %0" : : "m"(idtr)); /* Load IDTR */
+}
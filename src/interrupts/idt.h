@@ -8,6 +8,16 @@
  */
 #define IDT_MAX_DESCRIPTORS 256
 
+/**
+ * IRQ_NUM_LINES - Number of legacy IRQ lines (vectors 32-47)
+ */
+#define IRQ_NUM_LINES 16
+
+/**
+ * IRQ_NUM_VECTORS - Number of external interrupt vectors (32-255)
+ */
+#define IRQ_NUM_VECTORS (IDT_MAX_DESCRIPTORS - 32)
+
 /**
  * struct idt_entry_t - 32-bit IDT entry
  * @isr_low: Lower 16 bits of ISR address
@@ -58,9 +68,32 @@ typedef struct {
 } interrupt_frame_t;
 
 /**
- * timer_ticks - Global tick counter incremented by timer IRQ
+ * exception_handler_t - Handler for a CPU exception vector
+ * @frame: Pointer to interrupt stack frame
+ *
+ * Returning resumes the faulting context via iret.
+ */
+typedef void (*exception_handler_t)(interrupt_frame_t *frame);
+
+/**
+ * irq_handler_t - Device handler for an IRQ line
+ * @frame: Pointer to interrupt stack frame
+ * @ctx: Context pointer given to irq_register()
+ *
+ * Runs with interrupts disabled and should only acknowledge the device;
+ * longer work belongs in softirq_raise(). EOI is sent by the dispatcher.
+ */
+typedef void (*irq_handler_t)(interrupt_frame_t *frame, void *ctx);
+
+/**
+ * struct irq_action_t - Registered handler for one IRQ line
+ * @handler: Device handler, or NULL if the line is unused
+ * @ctx: Context pointer passed to @handler
  */
-extern volatile uint64_t timer_ticks;
+typedef struct {
+    irq_handler_t handler;
+    void *ctx;
+} irq_action_t;
 
 /**
  * idt_init - Initialize the Interrupt Descriptor Table
@@ -70,6 +103,13 @@ extern volatile uint64_t timer_ticks;
  */
 void idt_init(void);
 
+/**
+ * idt_load - Load the shared IDT on the executing CPU
+ *
+ * For application processors; idt_init() loads it on the bootstrap CPU.
+ */
+void idt_load(void);
+
 /**
  * idt_set_descriptor - Set up an IDT entry
  * @vector: Interrupt vector number (0-255)
@@ -82,17 +122,105 @@ void idt_set_descriptor(uint8_t vector, void* isr, uint8_t flags);
  * exception_handler - CPU exception handler
  * @frame: Pointer to interrupt stack frame
  *
- * Called by ISR stubs for vectors 0-31. Displays error and halts.
+ * Called by ISR stubs for vectors 0-31. Dispatches to the handler
+ * registered with exception_register(), or to exception_unhandled().
  */
 void exception_handler(interrupt_frame_t* frame);
 
+/**
+ * exception_unhandled - Deal with an exception no handler resolved
+ * @frame: Pointer to interrupt stack frame
+ *
+ * An exception raised by ring 3 code kills the running thread; one
+ * raised by the kernel, or NMI, #DF and #MC, halts in exception_panic().
+ */
+__attribute__((noreturn))
+void exception_unhandled(interrupt_frame_t* frame);
+
+/**
+ * exception_register - Install a handler for a CPU exception
+ * @vector: Exception vector (0-31)
+ * @handler: Handler to call, or NULL to restore exception_unhandled()
+ */
+void exception_register(uint8_t vector, exception_handler_t handler);
+
+/**
+ * exception_panic - Display an unrecoverable exception and halt
+ * @frame: Pointer to interrupt stack frame
+ */
+__attribute__((noreturn))
+void exception_panic(interrupt_frame_t* frame);
+
 /**
  * irq_handler - Hardware interrupt handler
  * @frame: Pointer to interrupt stack frame
  *
- * Called by IRQ stubs for vectors 32+. Dispatches to appropriate
- * device handler and sends EOI to PIC.
+ * Called by IRQ stubs for vectors 32+. Dispatches to the handler
+ * registered for the line and sends EOI to the active interrupt
+ * controller. Spurious interrupts are dropped without calling a
+ * handler or sending EOI.
  */
 void irq_handler(interrupt_frame_t* frame);
 
+/**
+ * irq_get_regs - Frame of the IRQ being handled on this CPU
+ *
+ * Lets code reached indirectly from an IRQ handler (hrtimer callbacks,
+ * for one) see the interrupted context.
+ *
+ * Return: Interrupt frame, or NULL outside an IRQ handler
+ */
+interrupt_frame_t* irq_get_regs(void);
+
+/**
+ * irq_exit - Work done on the way out of every IRQ
+ *
+ * Called by the IRQ stubs after irq_handler() and the statistics
+ * update. Runs deferred work queued with softirq_raise(), then switches
+ * threads if a reschedule is pending. The preempted thread resumes here
+ * and returns through its own interrupt frame.
+ */
+void irq_exit(void);
+
+/**
+ * irq_register - Attach a handler to an IRQ line and unmask it
+ * @irq: IRQ line (0-15)
+ * @handler: Handler to call when the line fires
+ * @ctx: Context pointer passed to @handler
+ *
+ * Return: 0 on success, -1 if @irq is invalid or already taken
+ */
+int irq_register(uint8_t irq, irq_handler_t handler, void* ctx);
+
+/**
+ * irq_register_vector - Attach a handler to a local interrupt vector
+ * @vector: Vector above the legacy IRQ range (48-254)
+ * @handler: Handler to call when the vector fires
+ * @ctx: Context pointer passed to @handler
+ *
+ * For interrupts raised by the local APIC (timer, IPIs). The caller
+ * installs the IDT descriptor for the vector's stub.
+ *
+ * Return: 0 on success, -1 if @vector is invalid or already taken
+ */
+int irq_register_vector(uint8_t vector, irq_handler_t handler, void* ctx);
+
+/**
+ * irq_unregister - Mask an IRQ line and detach its handler
+ * @irq: IRQ line (0-15)
+ */
+void irq_unregister(uint8_t irq);
+
+/**
+ * irq_set_mask - Mask an IRQ line on the active interrupt controller
+ * @irq: IRQ line (0-15)
+ */
+void irq_set_mask(uint8_t irq);
+
+/**
+ * irq_clear_mask - Unmask an IRQ line on the active interrupt controller
+ * @irq: IRQ line (0-15)
+ */
+void irq_clear_mask(uint8_t irq);
+
 #endif
@@ -0,0 +1,39 @@
+#ifndef IRQCHIP_H
+#define IRQCHIP_H
+
+#include <stdint.h>
+
+/**
+ * struct irqchip_t - Interrupt controller operations for legacy IRQ lines
+ * @name: Controller name
+ * @eoi: Signal end of interrupt for an IRQ line
+ * @mask: Prevent an IRQ line from generating interrupts
+ * @unmask: Allow an IRQ line to generate interrupts
+ * @spurious: Return non-zero if a delivered IRQ was spurious (and must
+ *            be dropped without calling a handler or @eoi)
+ */
+typedef struct {
+    const char *name;
+    void (*eoi)(uint8_t irq);
+    void (*mask)(uint8_t irq);
+    void (*unmask)(uint8_t irq);
+    int (*spurious)(uint8_t irq);
+} irqchip_t;
+
+/**
+ * irqchip_set - Switch legacy IRQ delivery to another controller
+ * @chip: New interrupt controller
+ *
+ * Masks every registered line on the old controller and unmasks it on
+ * the new one.
+ */
+void irqchip_set(const irqchip_t *chip);
+
+/**
+ * irqchip_get - Get the active interrupt controller
+ *
+ * Return: Active interrupt controller
+ */
+const irqchip_t *irqchip_get(void);
+
+#endif
@@ -0,0 +1,176 @@
+#include <stddef.h>
+
+#include "irqstats.h"
+#include "../cpu/cpu.h"
+#include "../lib/printf.h"
+
+/**
+ * irqstats - Per-CPU, per-vector counters, only written by their own CPU
+ */
+static irqstats_vector_t irqstats[MAX_CPUS][IRQSTATS_NUM_VECTORS];
+
+/**
+ * irqstats_enabled - Non-zero once irqstats_init() has run
+ */
+static volatile int irqstats_enabled;
+
+/**
+ * rdtsc_overhead - Cycles two back-to-back rdtsc reads add to a measurement
+ */
+static uint32_t rdtsc_overhead;
+
+/**
+ * account_cycles - Cycles irqstats_account() itself costs per interrupt
+ */
+static uint32_t account_cycles;
+
+/**
+ * irqstats_bucket - log2 histogram bucket for a duration
+ * @cycles: Duration in cycles
+ *
+ * Return: Bucket index
+ */
+static inline uint32_t irqstats_bucket(uint32_t cycles) {
+    return cycles ? 31 - __builtin_clz(cycles) : 0;
+}
+
+/**
+ * irqstats_record - Update this CPU's counters for one interrupt
+ * @vector: Interrupt vector
+ * @entry: Stub entry timestamp
+ * @exit: Timestamp after the handler returned
+ *
+ * Return: Non-zero if the vector's storm window just crossed the threshold
+ */
+static int irqstats_record(uint8_t vector, uint64_t entry, uint64_t exit) {
+    irqstats_vector_t *s = &irqstats[cpu_id()][vector];
+    uint64_t delta = exit - entry;
+    uint32_t cycles;
+
+    /* Clamp to 32 bits; anything longer is a stall worth seeing as max */
+    delta = delta > rdtsc_overhead ? delta - rdtsc_overhead : 0;
+    cycles = delta > UINT32_MAX ? UINT32_MAX : (uint32_t)delta;
+
+    s->count++;
+    s->total_cycles += cycles;
+    if (cycles > s->max_cycles)
+        s->max_cycles = cycles;
+    s->histogram[irqstats_bucket(cycles)]++;
+
+    if ((entry - s->window_start) >> IRQSTATS_STORM_WINDOW_SHIFT) {
+        s->window_start = entry;
+        s->window_count = 0;
+    }
+    return ++s->window_count == IRQSTATS_STORM_THRESHOLD;
+}
+
+void irqstats_init(void) {
+    uint32_t best = UINT32_MAX;
+
+    /* Smallest rdtsc-to-rdtsc distance is the floor of every sample */
+    for (int i = 0; i < 64; i++) {
+        uint64_t a = rdtsc();
+        uint64_t b = rdtsc();
+        if ((uint32_t)(b - a) < best)
+            best = (uint32_t)(b - a);
+    }
+    rdtsc_overhead = best;
+
+    /* Time the bookkeeping on vector 255 (the spurious vector, never accounted) */
+    best = UINT32_MAX;
+    for (int i = 0; i < 64; i++) {
+        uint64_t a = rdtsc();
+        irqstats_record(0xFF, a, a);
+        uint64_t b = rdtsc();
+        if ((uint32_t)(b - a) < best)
+            best = (uint32_t)(b - a);
+    }
+    account_cycles = best > rdtsc_overhead ? best - rdtsc_overhead : 0;
+
+    irqstats_reset();
+    irqstats_enabled = 1;
+}
+
+void irqstats_set_enabled(int enabled) {
+    irqstats_enabled = enabled;
+}
+
+void irqstats_account(interrupt_frame_t *frame, uint64_t entry) {
+    if (!irqstats_enabled)
+        return;
+
+    uint8_t vector = (uint8_t)frame->int_no;
+    if (!irqstats_record(vector, entry, rdtsc()))
+        return;
+
+    /* Only legacy lines can be masked individually */
+    if (vector >= 32 && vector < 32 + IRQ_NUM_LINES) {
+        irq_set_mask(vector - 32);
+        irqstats[cpu_id()][vector].storms++;
+        kprintf("irqstats: IRQ %u storm, line masked\n", vector - 32);
+    }
+}
+
+void irqstats_get(uint8_t vector, irqstats_vector_t *sum) {
+    *sum = (irqstats_vector_t){ 0 };
+
+    for (uint32_t cpu = 0; cpu < MAX_CPUS; cpu++) {
+        irqstats_vector_t s;
+
+        /* Snapshot so the local CPU's counters are consistent */
+        uint32_t flags = irq_save();
+        s = irqstats[cpu][vector];
+        irq_restore(flags);
+
+        sum->count += s.count;
+        sum->total_cycles += s.total_cycles;
+        if (s.max_cycles > sum->max_cycles)
+            sum->max_cycles = s.max_cycles;
+        for (int b = 0; b < IRQSTATS_BUCKETS; b++)
+            sum->histogram[b] += s.histogram[b];
+        sum->window_count += s.window_count;
+        sum->storms += s.storms;
+    }
+}
+
+void irqstats_reset(void) {
+    uint32_t flags = irq_save();
+    for (uint32_t cpu = 0; cpu < MAX_CPUS; cpu++) {
+        for (int v = 0; v < IRQSTATS_NUM_VECTORS; v++) {
+            irqstats_vector_t *s = &irqstats[cpu][v];
+            s->count = 0;
+            s->total_cycles = 0;
+            s->max_cycles = 0;
+            for (int b = 0; b < IRQSTATS_BUCKETS; b++)
+                s->histogram[b] = 0;
+            s->window_start = 0;
+            s->window_count = 0;
+            s->storms = 0;
+        }
+    }
+    irq_restore(flags);
+}
+
+void irqstats_dump(void) {
+    kprintf("irqstats: rdtsc overhead %u cycles, accounting %u cycles/irq\n",
+            rdtsc_overhead, account_cycles);
+    kprintf("vec      count        avg        max storms\n");
+
+    for (int v = 0; v < IRQSTATS_NUM_VECTORS; v++) {
+        irqstats_vector_t s;
+
+        irqstats_get((uint8_t)v, &s);
+        if (!s.count)
+            continue;
+
+        /* 32-bit average keeps libgcc's 64-bit division off this path */
+        uint32_t avg = s.total_cycles >> 32 ? UINT32_MAX
+                     : (uint32_t)s.total_cycles / (uint32_t)s.count;
+        kprintf("%3d %10llu %10u %10u %6u\n    log2:", v, s.count, avg,
+                s.max_cycles, s.storms);
+        for (int b = 0; b < IRQSTATS_BUCKETS; b++)
+            if (s.histogram[b])
+                kprintf(" %d:%u", b, s.histogram[b]);
+        kprintf("\n");
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef IRQSTATS_H
+#define IRQSTATS_H
+
+#include <stdint.h>
+
+#include "idt.h"
+
+/**
+ * IRQSTATS_NUM_VECTORS - Vectors tracked (the whole IDT)
+ */
+#define IRQSTATS_NUM_VECTORS        256
+
+/**
+ * IRQSTATS_BUCKETS - Latency histogram buckets, bucket n counts
+ * handlers that took [2^n, 2^(n+1)) cycles
+ */
+#define IRQSTATS_BUCKETS            32
+
+/**
+ * IRQSTATS_STORM_WINDOW_SHIFT - Storm detection window, 2^27 cycles
+ * (about 50-130 ms on 1-3 GHz parts)
+ */
+#define IRQSTATS_STORM_WINDOW_SHIFT 27
+
+/**
+ * IRQSTATS_STORM_THRESHOLD - Interrupts per window on one legacy line
+ * before the line is masked as a storm
+ */
+#define IRQSTATS_STORM_THRESHOLD    20000
+
+/**
+ * IRQSTATS_DUMP_SCANCODE - F12 make code, dumps the statistics
+ */
+#define IRQSTATS_DUMP_SCANCODE      0x58
+
+/**
+ * struct irqstats_vector_t - Counters for one vector
+ * @count: Interrupts taken
+ * @total_cycles: Handler cycles summed over @count
+ * @max_cycles: Slowest handler run
+ * @histogram: log2 latency histogram (see IRQSTATS_BUCKETS)
+ * @window_start: Timestamp the current storm window opened
+ * @window_count: Interrupts seen in the current storm window
+ * @storms: Times the line was masked for storming
+ */
+typedef struct {
+    uint64_t count;
+    uint64_t total_cycles;
+    uint32_t max_cycles;
+    uint32_t histogram[IRQSTATS_BUCKETS];
+    uint64_t window_start;
+    uint32_t window_count;
+    uint32_t storms;
+} irqstats_vector_t;
+
+/**
+ * irqstats_init - Calibrate measurement overhead and enable accounting
+ *
+ * Return: Nothing
+ */
+void irqstats_init(void);
+
+/**
+ * irqstats_set_enabled - Turn accounting on or off
+ * @enabled: Non-zero to account interrupts
+ *
+ * Return: Nothing
+ */
+void irqstats_set_enabled(int enabled);
+
+/**
+ * irqstats_account - Record one handled interrupt
+ * @frame: Interrupt frame (for the vector)
+ * @entry: Timestamp taken by the stub right after saving registers
+ *
+ * Called from the ISR/IRQ stubs once the handler returns. Masks a
+ * legacy line whose rate crosses IRQSTATS_STORM_THRESHOLD.
+ *
+ * Return: Nothing
+ */
+void irqstats_account(interrupt_frame_t *frame, uint64_t entry);
+
+/**
+ * irqstats_get - Counters for a vector, summed over all CPUs
+ * @vector: Interrupt vector
+ * @sum: Filled in with the totals; @max_cycles is the largest of any
+ *       CPU and @window_start is left 0
+ *
+ * Each CPU counts its own interrupts, so storm detection is per CPU too.
+ * Return: Nothing
+ */
+void irqstats_get(uint8_t vector, irqstats_vector_t *sum);
+
+/**
+ * irqstats_reset - Clear all counters
+ *
+ * Counts other CPUs record while it runs may survive.
+ *
+ * Return: Nothing
+ */
+void irqstats_reset(void);
+
+/**
+ * irqstats_dump - Print counters for every vector that fired to serial
+ *
+ * Return: Nothing
+ */
+void irqstats_dump(void);
+
+#endif
@@ -2,6 +2,36 @@ bits 32
 
 extern exception_handler
 extern irq_handler
+extern irq_exit
+extern irqstats_account
+extern syscall_dispatch
+extern syscall_interrupt
+
+GDT_KERNEL_DATA equ 0x10
+GDT_USER_CODE   equ 0x18
+GDT_USER_DATA   equ 0x20
+GDT_PERCPU      equ 0x30
+EFLAGS_IF       equ 0x200
+
+; Save the data segments of the interrupted context and load the kernel's.
+; Ring 3 code may hold any selector, and its gs never has the per-CPU base.
+; Argument: 16-bit scratch register
+%macro kernel_segments_enter 1
+    push ds
+    push es
+    push gs
+    mov %1, GDT_KERNEL_DATA
+    mov ds, %1
+    mov es, %1
+    mov %1, GDT_PERCPU
+    mov gs, %1
+%endmacro
+
+%macro kernel_segments_exit 0
+    pop gs
+    pop es
+    pop ds
+%endmacro
 
 ; Macro for ISRs that don't push an error code
 ; We push: dummy err_code, then int_no
@@ -32,12 +62,25 @@ irq_stub_%+%1:
 %endmacro
 
 ; Common handler for exceptions
+; ebx keeps the frame pointer and esi:edi the entry timestamp across the
+; calls (both callee-saved) for irqstats_account
 isr_handler_common:
     pushad                ; save all registers
+    kernel_segments_enter ax
     cld
-    push esp              ; pass pointer to stack frame as argument
+    lea ebx, [esp + 12]   ; pointer to stack frame, above the segments
+    rdtsc
+    mov esi, eax          ; entry timestamp, low
+    mov edi, edx          ; entry timestamp, high
+    push ebx              ; pass pointer to stack frame as argument
     call exception_handler
     add esp, 4            ; clean up argument
+    push edi              ; irqstats_account(frame, entry timestamp)
+    push esi
+    push ebx
+    call irqstats_account
+    add esp, 12
+    kernel_segments_exit
     popad
     add esp, 8            ; clean up error code and interrupt number
     iret
@@ -45,10 +88,22 @@ isr_handler_common:
 ; Common handler for IRQs
 irq_handler_common:
     pushad
+    kernel_segments_enter ax
     cld
-    push esp              ; pass pointer to stack frame as argument
+    lea ebx, [esp + 12]   ; pointer to stack frame
+    rdtsc
+    mov esi, eax          ; entry timestamp, low
+    mov edi, edx          ; entry timestamp, high
+    push ebx              ; pass pointer to stack frame as argument
     call irq_handler
     add esp, 4            ; clean up argument
+    push edi              ; irqstats_account(frame, entry timestamp)
+    push esi
+    push ebx
+    call irqstats_account
+    add esp, 12
+    call irq_exit         ; deferred work, outside the measured window
+    kernel_segments_exit
     popad
     add esp, 8
     iret
@@ -90,6 +145,104 @@ isr_no_err_stub 31
 ; IRQ stubs (mapped to vectors 0x20-0x2F)
 irq_stub 0, 32    ; Timer -> vector 0x20
 irq_stub 1, 33    ; Keyboard -> vector 0x21
+irq_stub 2, 34    ; Cascade -> vector 0x22
+irq_stub 3, 35    ; COM2 -> vector 0x23
+irq_stub 4, 36    ; COM1 -> vector 0x24
+irq_stub 5, 37    ; LPT2 -> vector 0x25
+irq_stub 6, 38    ; Floppy -> vector 0x26
+irq_stub 7, 39    ; LPT1 / spurious -> vector 0x27
+irq_stub 8, 40    ; CMOS RTC -> vector 0x28
+irq_stub 9, 41    ; Free -> vector 0x29
+irq_stub 10, 42   ; Free -> vector 0x2A
+irq_stub 11, 43   ; Free -> vector 0x2B
+irq_stub 12, 44   ; PS/2 mouse -> vector 0x2C
+irq_stub 13, 45   ; FPU -> vector 0x2D
+irq_stub 14, 46   ; Primary ATA -> vector 0x2E
+irq_stub 15, 47   ; Secondary ATA / spurious -> vector 0x2F
+
+; Local APIC interrupts (vectors above the legacy IRQ range)
+global irq_stub_lapic_timer
+irq_stub lapic_timer, 0xEF
+
+; Inter-processor interrupts
+global irq_stub_ipi_resched
+irq_stub ipi_resched, 0xF0
+global irq_stub_ipi_call
+irq_stub ipi_call, 0xF1
+
+; System call through int 0x80 (trap gate, DPL 3): the full register
+; frame of the generic stubs, kept as the portable and baseline path
+global syscall_int_stub
+syscall_int_stub:
+    push dword 0
+    push dword 0x80
+    pushad
+    kernel_segments_enter ax
+    cld
+    lea ebx, [esp + 12]
+    push ebx
+    call syscall_interrupt  ; stores the result in the frame's eax
+    add esp, 4
+    kernel_segments_exit
+    popad
+    add esp, 8
+    iret
+
+; System call through SYSENTER. The CPU loads cs/ss from the MSRs, clears
+; IF and starts on this CPU's SYSENTER stack, whose top word points at the
+; TSS esp0 field. User side passes the return eip in edx and its esp in
+; ecx; see syscall.h for the ABI.
+global sysenter_entry
+sysenter_entry:
+    mov esp, [esp]          ; TSS esp0 field
+    mov esp, [esp]          ; ring 0 stack of the current thread
+    push ecx                ; user esp
+    push edx                ; user eip
+    kernel_segments_enter cx
+    cld                     ; SYSENTER keeps ring 3's DF, C code expects it clear
+    sti
+    push edi                ; syscall_dispatch(nr, ebx, esi, edi)
+    push esi
+    push ebx
+    push eax
+    call syscall_dispatch
+    add esp, 16
+    cli
+    kernel_segments_exit
+    pop edx
+    pop ecx
+    sti                     ; takes effect after sysexit
+    sysexit
+
+; Enter ring 3 for the first time: user_enter(eip, esp)
+global user_enter
+user_enter:
+    cli                     ; iret enables interrupts again in ring 3
+    mov eax, [esp + 4]      ; eip
+    mov ecx, [esp + 8]      ; esp
+    mov dx, GDT_USER_DATA | 3
+    mov ds, dx
+    mov es, dx
+    mov fs, dx
+    mov gs, dx
+    push dword GDT_USER_DATA | 3  ; ss
+    push ecx                      ; esp
+    push dword EFLAGS_IF          ; eflags
+    push dword GDT_USER_CODE | 3  ; cs
+    push eax                      ; eip
+    xor eax, eax            ; leave no kernel values behind
+    xor ebx, ebx
+    xor ecx, ecx
+    xor edx, edx
+    xor esi, esi
+    xor edi, edi
+    xor ebp, ebp
+    iret
+
+; Local APIC spurious interrupt (vector 0xFF): no handler and no EOI
+global apic_spurious_stub
+apic_spurious_stub:
+    iret
 
 ; Table of ISR stub addresses
 global isr_stub_table
@@ -102,5 +255,8 @@ isr_stub_table:
 
 global irq_stub_table
 irq_stub_table:
-    dd irq_stub_0
-    dd irq_stub_1
+%assign i 0
+%rep 16
+    dd irq_stub_%+i
+%assign i i+1
+%endrep
@@ -0,0 +1,143 @@
+#include <stddef.h>
+
+#include "mptable.h"
+#include "../memory/paging.h"
+
+/**
+ * checksum_ok - Check that a firmware structure sums to zero
+ * @data: Start of the structure
+ * @length: Length in bytes
+ *
+ * Return: 1 if the checksum is valid, 0 otherwise
+ */
+static int checksum_ok(const void* data, uint32_t length) {
+    const uint8_t* bytes = data;
+    uint8_t sum = 0;
+    for (uint32_t i = 0; i < length; i++)
+        sum += bytes[i];
+    return sum == 0;
+}
+
+/**
+ * find_floating - Search a physical range for the MP floating pointer
+ * @start: Start address (16-byte aligned, identity mapped)
+ * @end: End address (exclusive)
+ *
+ * Return: Pointer to the floating pointer, or NULL if not found
+ */
+static const mp_floating_t* find_floating(uint32_t start, uint32_t end) {
+    for (uint32_t addr = start; addr + sizeof(mp_floating_t) <= end; addr += 16) {
+        const mp_floating_t* mp = (const mp_floating_t*)(uintptr_t)addr;
+        if (mp->signature[0] == '_' && mp->signature[1] == 'M' &&
+            mp->signature[2] == 'P' && mp->signature[3] == '_' &&
+            checksum_ok(mp, mp->length * 16))
+            return mp;
+    }
+    return NULL;
+}
+
+/**
+ * find_ioapic - Look up an I/O APIC by ID
+ * @config: Configuration being filled
+ * @id: I/O APIC ID
+ *
+ * Return: I/O APIC, or NULL if unknown
+ */
+static const ioapic_t* find_ioapic(const apic_config_t* config, uint8_t id) {
+    for (uint32_t i = 0; i < config->num_ioapics; i++) {
+        if (config->ioapics[i].id == id)
+            return &config->ioapics[i];
+    }
+    return NULL;
+}
+
+int mptable_parse(apic_config_t* config) {
+    uint32_t ebda = (uint32_t)(*(volatile uint16_t*)MP_EBDA_SEGMENT_PTR) << 4;
+    const mp_floating_t* mp = NULL;
+    if (ebda)
+        mp = find_floating(ebda, ebda + 1024);
+    if (!mp)
+        mp = find_floating(MP_BASE_MEMORY_END - 1024, MP_BASE_MEMORY_END);
+    if (!mp)
+        mp = find_floating(MP_BIOS_START, MP_BIOS_END);
+
+    /* Default configurations (no table) are not supported */
+    if (!mp || !mp->config_address || mp->features[0])
+        return -1;
+
+    /* Peek at the header, then map the whole table over the same pages */
+    const mp_config_t* table = map_phys(mp->config_address, sizeof(mp_config_t), 0);
+    if (!table)
+        return -1;
+    mp_config_t header = *table;
+    unmap_phys(table, sizeof(mp_config_t));
+    if (header.signature[0] != 'P' || header.signature[1] != 'C' ||
+        header.signature[2] != 'M' || header.signature[3] != 'P' ||
+        header.length < sizeof(mp_config_t))
+        return -1;
+
+    table = map_phys(mp->config_address, header.length, 0);
+    if (!table)
+        return -1;
+    if (!checksum_ok(table, header.length)) {
+        unmap_phys(table, header.length);
+        return -1;
+    }
+
+    config->lapic_paddr = table->lapic_address;
+    config->imcr_present = (mp->features[1] & MP_FEATURE2_IMCRP) != 0;
+
+    uint8_t isa_bus[MP_MAX_BUSES] = {0};
+    int ret = 0;
+    const uint8_t* entry = (const uint8_t*)(table + 1);
+    const uint8_t* end = (const uint8_t*)table + table->length;
+    for (uint32_t i = 0; i < table->entry_count && entry < end; i++) {
+        switch (entry[0]) {
+        case MP_ENTRY_PROCESSOR: {
+            const mp_processor_t* cpu = (const mp_processor_t*)entry;
+            if (cpu->flags & 0x01)
+                apic_add_cpu(config, cpu->lapic_id);
+            entry += sizeof(mp_processor_t);
+            break;
+        }
+        case MP_ENTRY_BUS: {
+            const mp_bus_t* bus = (const mp_bus_t*)entry;
+            if (bus->bus_id < MP_MAX_BUSES)
+                isa_bus[bus->bus_id] = bus->bus_type[0] == 'I' && bus->bus_type[1] == 'S' &&
+                                       bus->bus_type[2] == 'A';
+            entry += sizeof(mp_bus_t);
+            break;
+        }
+        case MP_ENTRY_IOAPIC: {
+            const mp_ioapic_t* ioapic = (const mp_ioapic_t*)entry;
+            if (ioapic->flags & 0x01)
+                apic_add_ioapic(config, ioapic->ioapic_id, ioapic->address, IOAPIC_GSI_AUTO);
+            entry += sizeof(mp_ioapic_t);
+            break;
+        }
+        case MP_ENTRY_IO_INTERRUPT: {
+            const mp_interrupt_t* irq = (const mp_interrupt_t*)entry;
+            const ioapic_t* ioapic = find_ioapic(config, irq->dest_apic_id);
+
+            /* Only vectored (INT) interrupts from the ISA bus are routed */
+            if (irq->interrupt_type == 0 && ioapic && irq->source_bus < MP_MAX_BUSES &&
+                isa_bus[irq->source_bus])
+                apic_add_isa_irq(config, irq->source_irq, ioapic->gsi_base + irq->dest_pin, irq->flags);
+            entry += sizeof(mp_interrupt_t);
+            break;
+        }
+        case MP_ENTRY_LOCAL_INTERRUPT:
+            entry += sizeof(mp_interrupt_t);
+            break;
+        default:
+            /* Unknown entry sizes cannot be skipped, stop here */
+            ret = config->num_ioapics ? 0 : -1;
+            entry = end;
+            break;
+        }
+    }
+
+    /* Everything is copied into @config */
+    unmap_phys(table, header.length);
+    return ret;
+}
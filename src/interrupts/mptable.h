@@ -0,0 +1,149 @@
+#ifndef MPTABLE_H
+#define MPTABLE_H
+
+#include <stdint.h>
+
+#include "apic.h"
+
+/**
+ * MP_EBDA_SEGMENT_PTR - BIOS data area word holding the EBDA segment
+ */
+#define MP_EBDA_SEGMENT_PTR     0x040E
+
+/**
+ * MP_BASE_MEMORY_END - Last KiB of base memory is searched if there is no EBDA
+ */
+#define MP_BASE_MEMORY_END      0x000A0000
+
+/**
+ * MP_BIOS_START - Start of the BIOS ROM searched for the floating pointer
+ */
+#define MP_BIOS_START           0x000F0000
+
+/**
+ * MP_BIOS_END - End (exclusive) of the BIOS ROM
+ */
+#define MP_BIOS_END             0x00100000
+
+/**
+ * MP_FEATURE2_IMCRP - Feature byte 2 flag: IMCR present, PIC mode implemented
+ */
+#define MP_FEATURE2_IMCRP       0x80
+
+/* MP configuration table entry types */
+#define MP_ENTRY_PROCESSOR      0
+#define MP_ENTRY_BUS            1
+#define MP_ENTRY_IOAPIC         2
+#define MP_ENTRY_IO_INTERRUPT   3
+#define MP_ENTRY_LOCAL_INTERRUPT 4
+
+/**
+ * MP_MAX_BUSES - Bus IDs tracked to recognise the ISA bus
+ */
+#define MP_MAX_BUSES            32
+
+/**
+ * struct mp_floating_t - MP floating pointer structure
+ * @signature: "_MP_"
+ * @config_address: Physical address of the configuration table
+ * @length: Length in 16-byte units
+ * @revision: MP specification revision
+ * @checksum: Bytes of the structure sum to zero
+ * @features: Feature bytes 1-5 (non-zero byte 1 means a default config)
+ */
+typedef struct {
+    char signature[4];
+    uint32_t config_address;
+    uint8_t length;
+    uint8_t revision;
+    uint8_t checksum;
+    uint8_t features[5];
+} __attribute__((packed)) mp_floating_t;
+
+/**
+ * struct mp_config_t - MP configuration table header
+ * @signature: "PCMP"
+ * @length: Length of the base table including entries
+ * @revision: MP specification revision
+ * @checksum: Bytes of the base table sum to zero
+ * @oem_id: OEM identifier
+ * @product_id: Product identifier
+ * @oem_table: Physical address of the OEM table
+ * @oem_table_size: Size of the OEM table
+ * @entry_count: Number of base table entries
+ * @lapic_address: Physical address of the local APICs
+ * @ext_length: Length of the extended table
+ * @ext_checksum: Checksum of the extended table
+ * @reserved: Reserved
+ */
+typedef struct {
+    char signature[4];
+    uint16_t length;
+    uint8_t revision;
+    uint8_t checksum;
+    char oem_id[8];
+    char product_id[12];
+    uint32_t oem_table;
+    uint16_t oem_table_size;
+    uint16_t entry_count;
+    uint32_t lapic_address;
+    uint16_t ext_length;
+    uint8_t ext_checksum;
+    uint8_t reserved;
+} __attribute__((packed)) mp_config_t;
+
+/**
+ * struct mp_processor_t - Processor entry (20 bytes)
+ */
+typedef struct {
+    uint8_t type;
+    uint8_t lapic_id;
+    uint8_t lapic_version;
+    uint8_t flags;
+    uint32_t signature;
+    uint32_t feature_flags;
+    uint32_t reserved[2];
+} __attribute__((packed)) mp_processor_t;
+
+/**
+ * struct mp_bus_t - Bus entry (8 bytes)
+ */
+typedef struct {
+    uint8_t type;
+    uint8_t bus_id;
+    char bus_type[6];
+} __attribute__((packed)) mp_bus_t;
+
+/**
+ * struct mp_ioapic_t - I/O APIC entry (8 bytes)
+ */
+typedef struct {
+    uint8_t type;
+    uint8_t ioapic_id;
+    uint8_t version;
+    uint8_t flags;
+    uint32_t address;
+} __attribute__((packed)) mp_ioapic_t;
+
+/**
+ * struct mp_interrupt_t - I/O or local interrupt assignment entry (8 bytes)
+ */
+typedef struct {
+    uint8_t type;
+    uint8_t interrupt_type;
+    uint16_t flags;
+    uint8_t source_bus;
+    uint8_t source_irq;
+    uint8_t dest_apic_id;
+    uint8_t dest_pin;
+} __attribute__((packed)) mp_interrupt_t;
+
+/**
+ * mptable_parse - Fill @config from the Intel MP configuration table
+ * @config: Configuration to fill
+ *
+ * Return: 0 on success, -1 if no usable MP table was found
+ */
+int mptable_parse(apic_config_t *config);
+
+#endif
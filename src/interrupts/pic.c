@@ -30,9 +30,9 @@ void pic_remap(int offset1, int offset2) {
     outb(PIC2_DATA, ICW4_8086);
     io_wait();
 
-    /* Unmask both PICs */
-    outb(PIC1_DATA, 0);
-    outb(PIC2_DATA, 0);
+    /* Mask every line except the cascade; irq_register() unmasks on demand */
+    outb(PIC1_DATA, (uint8_t)~(1 << CASCADE_IRQ));
+    outb(PIC2_DATA, 0xFF);
 }
 
 void pic_send_eoi(uint8_t irq) {
@@ -48,7 +48,7 @@ void pic_disable(void) {
     outb(PIC2_DATA, 0xFF);
 }
 
-void irq_set_mask(uint8_t irq) {
+void pic_set_mask(uint8_t irq) {
     uint16_t port;
     uint8_t mask;
 
@@ -63,7 +63,7 @@ void irq_set_mask(uint8_t irq) {
     outb(port, mask);
 }
 
-void irq_clear_mask(uint8_t irq) {
+void pic_clear_mask(uint8_t irq) {
     uint16_t port;
     uint8_t mask;
 
@@ -97,3 +97,24 @@ uint16_t pic_get_irr(void) {
 uint16_t pic_get_isr(void) {
     return __pic_get_irq_reg(PIC_READ_ISR);
 }
+
+int pic_is_spurious(uint8_t irq) {
+    if (irq != 7 && irq != 15)
+        return 0;
+
+    if (pic_get_isr() & (1 << irq))
+        return 0;
+
+    /* The master still saw the cascade line fire for a slave spurious IRQ */
+    if (irq == 15)
+        pic_send_eoi(CASCADE_IRQ);
+    return 1;
+}
+
+const irqchip_t pic_chip = {
+    .name     = "8259 PIC",
+    .eoi      = pic_send_eoi,
+    .mask     = pic_set_mask,
+    .unmask   = pic_clear_mask,
+    .spurious = pic_is_spurious,
+};
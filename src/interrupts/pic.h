@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+#include "irqchip.h"
+
 #define PIC1		    0x20		/* IO base address for master PIC */
 #define PIC2		    0xA0		/* IO base address for slave PIC */
 #define PIC1_COMMAND	PIC1
@@ -56,6 +58,7 @@ void pic_send_eoi(uint8_t irq);
  * @offset2: New vector offset for slave PIC
  *
  * Remaps the PIC interrupt vectors without full reinitialization.
+ * Leaves every line masked except the cascade (IRQ2).
  */
 void pic_remap(int offset1, int offset2);
 
@@ -67,20 +70,36 @@ void pic_remap(int offset1, int offset2);
 void pic_disable(void);
 
 /**
- * irq_set_mask - Mask a specific IRQ
+ * pic_set_mask - Mask a specific IRQ on the PIC
  * @irq: The IRQ number to mask
  *
  * Prevents the specified IRQ from generating interrupts.
  */
-void irq_set_mask(uint8_t irq);
+void pic_set_mask(uint8_t irq);
 
 /**
- * irq_clear_mask - Unmask a specific IRQ
+ * pic_clear_mask - Unmask a specific IRQ on the PIC
  * @irq: The IRQ number to unmask
  *
  * Allows the specified IRQ to generate interrupts.
  */
-void irq_clear_mask(uint8_t irq);
+void pic_clear_mask(uint8_t irq);
+
+/**
+ * pic_is_spurious - Check for a spurious IRQ7/IRQ15
+ * @irq: The IRQ number that was delivered
+ *
+ * A spurious IRQ has no in-service bit set. For IRQ15 the master still
+ * needs an EOI for the cascade line, which is sent here.
+ *
+ * Return: 1 if the IRQ was spurious, 0 otherwise
+ */
+int pic_is_spurious(uint8_t irq);
+
+/**
+ * pic_chip - 8259 PIC interrupt controller operations
+ */
+extern const irqchip_t pic_chip;
 
 /**
  * pic_get_irr - Get combined value of IRQ request register
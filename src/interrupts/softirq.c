@@ -0,0 +1,71 @@
+#include "softirq.h"
+#include "../cpu/cpu.h"
+
+/**
+ * softirq_rings - Deferred work ring of each CPU
+ */
+static softirq_ring_t softirq_rings[MAX_CPUS];
+
+/**
+ * softirq_stats - Deferred work counters
+ */
+static softirq_stats_t softirq_stats;
+
+int softirq_raise(softirq_fn_t fn, void *arg) {
+    softirq_ring_t *ring = &softirq_rings[cpu_id()];
+    uint32_t head = ring->head;
+
+    if (head - ring->tail >= SOFTIRQ_RING_SIZE) {
+        softirq_stats.dropped++;
+        return -1;
+    }
+
+    softirq_work_t *work = &ring->work[head & (SOFTIRQ_RING_SIZE - 1)];
+    work->fn = fn;
+    work->arg = arg;
+
+    /* Publish the slot only after it is filled in */
+    barrier();
+    ring->head = head + 1;
+    softirq_stats.raised++;
+    return 0;
+}
+
+int softirq_pending(void) {
+    softirq_ring_t *ring = &softirq_rings[cpu_id()];
+    return ring->head != ring->tail;
+}
+
+int softirq_running(void) {
+    return softirq_rings[cpu_id()].running;
+}
+
+void softirq_run(void) {
+    softirq_ring_t *ring = &softirq_rings[cpu_id()];
+
+    if (ring->running)
+        return;
+
+    ring->running = 1;
+    while (ring->tail != ring->head) {
+        softirq_work_t work = ring->work[ring->tail & (SOFTIRQ_RING_SIZE - 1)];
+
+        /* Free the slot before running so handlers may queue more work */
+        barrier();
+        ring->tail++;
+
+        __asm__ volatile ("sti" : : : "memory");
+        work.fn(work.arg);
+        __asm__ volatile ("cli" : : : "memory");
+    }
+    ring->running = 0;
+}
+
+void softirq_account_irq_off(uint64_t cycles) {
+    if (cycles > softirq_stats.irq_off_max_cycles)
+        softirq_stats.irq_off_max_cycles = cycles;
+}
+
+const softirq_stats_t *softirq_get_stats(void) {
+    return &softirq_stats;
+}
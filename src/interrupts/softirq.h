@@ -0,0 +1,108 @@
+#ifndef SOFTIRQ_H
+#define SOFTIRQ_H
+
+#include <stdint.h>
+
+/**
+ * SOFTIRQ_RING_SIZE - Deferred work slots per CPU (power of two)
+ */
+#define SOFTIRQ_RING_SIZE   64
+
+/**
+ * softirq_fn_t - Deferred work function
+ * @arg: Argument given to softirq_raise()
+ *
+ * Runs with interrupts enabled, outside of the interrupt that queued it.
+ */
+typedef void (*softirq_fn_t)(void *arg);
+
+/**
+ * struct softirq_work_t - One queued unit of deferred work
+ * @fn: Function to run
+ * @arg: Argument passed to @fn
+ */
+typedef struct {
+    softirq_fn_t fn;
+    void *arg;
+} softirq_work_t;
+
+/**
+ * struct softirq_ring_t - Per-CPU single-producer single-consumer work ring
+ * @work: Ring slots
+ * @head: Next slot to fill, only advanced by interrupt handlers
+ * @tail: Next slot to run, only advanced by softirq_run()
+ * @running: Non-zero while softirq_run() is draining the ring
+ *
+ * Interrupt gates do not nest, so at most one producer is active at a
+ * time and the ring needs no lock.
+ */
+typedef struct {
+    softirq_work_t work[SOFTIRQ_RING_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t running;
+} softirq_ring_t;
+
+/**
+ * struct softirq_stats_t - Deferred work counters
+ * @raised: Work items queued
+ * @dropped: Work items lost because the ring was full
+ * @irq_off_max_cycles: Longest measured span from IRQ dispatch to EOI
+ */
+typedef struct {
+    uint64_t raised;
+    uint64_t dropped;
+    uint64_t irq_off_max_cycles;
+} softirq_stats_t;
+
+/**
+ * softirq_raise - Queue work to run after the current interrupt
+ * @fn: Function to run
+ * @arg: Argument passed to @fn
+ *
+ * Must be called with interrupts disabled (e.g. from an IRQ handler).
+ * Return: 0 on success, -1 if the ring is full
+ */
+int softirq_raise(softirq_fn_t fn, void *arg);
+
+/**
+ * softirq_pending - Check whether the current CPU has queued work
+ *
+ * Return: Non-zero if work is pending
+ */
+int softirq_pending(void);
+
+/**
+ * softirq_running - Check whether the current CPU is inside softirq_run()
+ *
+ * Return: Non-zero while deferred work is being drained
+ */
+int softirq_running(void);
+
+/**
+ * softirq_run - Run queued work for the current CPU
+ *
+ * Must be called with interrupts disabled. Interrupts are enabled while
+ * each work item runs and disabled again on return. Nested calls (from an
+ * interrupt taken while draining) return immediately.
+ *
+ * Return: Nothing
+ */
+void softirq_run(void);
+
+/**
+ * softirq_account_irq_off - Record the interrupts-off time of one IRQ
+ * @cycles: TSC cycles from dispatch to EOI
+ *
+ * Return: Nothing
+ */
+void softirq_account_irq_off(uint64_t cycles);
+
+/**
+ * softirq_get_stats - Get the deferred work counters
+ *
+ * Return: Pointer to the counters
+ */
+const softirq_stats_t *softirq_get_stats(void);
+
+#endif
@@ -0,0 +1,83 @@
+bits 32
+
+; Null system call benchmark, run in ring 3. Copied to a user page, so it
+; must be position independent. Entered with the address of the results
+; block (syscall_bench_t in syscall.h) on top of the stack.
+
+SYS_NULL equ 0
+SYS_EXIT equ 1
+
+EFLAGS_TF equ 0x100
+
+BENCH_ITERATIONS   equ 0
+BENCH_USE_SYSENTER equ 4
+BENCH_DONE         equ 8
+BENCH_STEPPED      equ 12
+BENCH_SYSENTER     equ 16
+BENCH_INT          equ 24
+
+global sysbench_user_start
+global sysbench_user_end
+
+sysbench_user_start:
+    mov ebp, [esp]              ; results block
+    call .base
+.base:
+    pop esi
+    add esi, .sysenter_ret - .base  ; SYSEXIT return address, kept in esi
+
+    cmp dword [ebp + BENCH_USE_SYSENTER], 0
+    je .int_bench
+
+    mov edi, [ebp + BENCH_ITERATIONS]
+    rdtsc
+    mov [ebp + BENCH_SYSENTER], eax
+    mov [ebp + BENCH_SYSENTER + 4], edx
+.sysenter_loop:
+    mov eax, SYS_NULL
+    mov edx, esi
+    mov ecx, esp
+    sysenter
+.sysenter_ret:
+    dec edi
+    jnz .sysenter_loop
+    rdtsc
+    sub eax, [ebp + BENCH_SYSENTER]
+    sbb edx, [ebp + BENCH_SYSENTER + 4]
+    mov [ebp + BENCH_SYSENTER], eax
+    mov [ebp + BENCH_SYSENTER + 4], edx
+
+    ; One SYSENTER with TF set: the kernel takes the single-step trap on
+    ; its entry and must come back here with TF clear
+    mov eax, SYS_NULL
+    lea edx, [esi + .step_ret - .sysenter_ret]
+    mov ecx, esp
+    pushfd
+    or dword [esp], EFLAGS_TF
+    popfd
+    sysenter
+.step_ret:
+    mov dword [ebp + BENCH_STEPPED], 1
+
+.int_bench:
+    mov edi, [ebp + BENCH_ITERATIONS]
+    rdtsc
+    mov [ebp + BENCH_INT], eax
+    mov [ebp + BENCH_INT + 4], edx
+.int_loop:
+    mov eax, SYS_NULL
+    int 0x80
+    dec edi
+    jnz .int_loop
+    rdtsc
+    sub eax, [ebp + BENCH_INT]
+    sbb edx, [ebp + BENCH_INT + 4]
+    mov [ebp + BENCH_INT], eax
+    mov [ebp + BENCH_INT + 4], edx
+
+    mov dword [ebp + BENCH_DONE], 1
+    mov eax, SYS_EXIT
+    int 0x80
+    jmp $
+
+sysbench_user_end:
@@ -0,0 +1,310 @@
+#include <stddef.h>
+
+#include "syscall.h"
+#include "../cpu/cpu.h"
+#include "../cpu/gdt.h"
+#include "../lib/mem.h"
+#include "../lib/printf.h"
+#include "../memory/falloc.h"
+#include "../memory/paging.h"
+#include "../sched/sched.h"
+#include "../time/clockevent.h"
+#include "../utils.h"
+
+extern void sysenter_entry(void);
+extern void syscall_int_stub(void);
+extern uint8_t sysbench_user_start[];
+extern uint8_t sysbench_user_end[];
+
+/**
+ * syscall_table - Handlers indexed by system call number
+ */
+static syscall_fn_t syscall_table[SYSCALL_MAX];
+
+/**
+ * syscall_counts - Calls per CPU and system call number
+ */
+static uint64_t syscall_counts[MAX_CPUS][SYSCALL_MAX];
+
+/**
+ * sysenter_enabled - Non-zero if the CPU supports SYSENTER/SYSEXIT
+ */
+static int sysenter_enabled;
+
+/**
+ * sysenter_stacks - Stack each CPU's SYSENTER starts on; the top word
+ * points at the CPU's TSS esp0 field
+ */
+static uint32_t sysenter_stacks[MAX_CPUS][SYSENTER_STACK_SIZE / sizeof(uint32_t)] __attribute__((aligned(16)));
+
+/**
+ * bench_thread - Thread that runs the benchmark when woken
+ */
+static thread_t *bench_thread;
+
+/**
+ * bench_mapped - Non-zero once the benchmark's user pages exist
+ */
+static int bench_mapped;
+
+/**
+ * bench_start - Entry of the benchmark's user thread
+ */
+static user_start_t bench_start = {
+    .eip = SYSCALL_BENCH_CODE,
+    .esp = SYSCALL_BENCH_DATA + PAGE_SIZE - sizeof(uint32_t),
+};
+
+/**
+ * sys_null - SYS_NULL handler
+ * @arg1: Unused
+ * @arg2: Unused
+ * @arg3: Unused
+ *
+ * Return: 0
+ */
+static int32_t sys_null(uint32_t arg1, uint32_t arg2, uint32_t arg3) {
+    (void)arg1;
+    (void)arg2;
+    (void)arg3;
+    return 0;
+}
+
+/**
+ * sys_exit - SYS_EXIT handler
+ * @arg1: Unused
+ * @arg2: Unused
+ * @arg3: Unused
+ *
+ * Return: Does not return
+ */
+static int32_t sys_exit(uint32_t arg1, uint32_t arg2, uint32_t arg3) {
+    (void)arg1;
+    (void)arg2;
+    (void)arg3;
+    thread_exit();
+}
+
+/**
+ * sys_write - SYS_WRITE handler
+ * @arg1: User buffer
+ * @arg2: Length in bytes
+ * @arg3: Unused
+ *
+ * Pages of the buffer not loaded yet are faulted in before it is copied.
+ * Return: @arg2 on success, -1 if the buffer is not mapped user memory
+ */
+static int32_t sys_write(uint32_t arg1, uint32_t arg2, uint32_t arg3) {
+    char chunk[128];
+    (void)arg3;
+
+    if (arg2 > SYSCALL_WRITE_MAX || user_fault_in(arg1, arg2) == -1)
+        return -1;
+
+    for (uint32_t done = 0; done < arg2; ) {
+        uint32_t len = arg2 - done;
+        if (len > sizeof(chunk) - 1)
+            len = sizeof(chunk) - 1;
+
+        kmemcpy(chunk, (const void *)(uintptr_t)(arg1 + done), len);
+        chunk[len] = '\0';
+        kprintf("%s", chunk);
+        done += len;
+    }
+
+    return (int32_t)arg2;
+}
+
+/**
+ * sysenter_detect - Check for working SYSENTER/SYSEXIT
+ *
+ * Early Pentium Pro parts set the SEP bit without implementing it.
+ * Return: Non-zero if usable
+ */
+static int sysenter_detect(void) {
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(1, &eax, &ebx, &ecx, &edx);
+
+    uint32_t family = (eax >> 8) & 0xF;
+    uint32_t model = (eax >> 4) & 0xF;
+    uint32_t stepping = eax & 0xF;
+    if (family == 6 && model < 3 && stepping < 3)
+        return 0;
+    return (edx & CPUID_EDX_SEP) != 0;
+}
+
+/**
+ * bench_map_page - Back one benchmark page with a fresh user frame
+ * @vaddr: User address
+ *
+ * Return: 0 on success, -1 on failure
+ */
+static int bench_map_page(uint32_t vaddr) {
+    uint32_t frame;
+
+    if (fallocate(&frame) == -1)
+        return -1;
+    if (map(vaddr, frame, PG_FLAG_RW | PG_FLAG_USER) == -1) {
+        ffree(frame);
+        return -1;
+    }
+    kmemset((void *)(uintptr_t)vaddr, 0, PAGE_SIZE);
+    return 0;
+}
+
+/**
+ * bench_map - Map the benchmark's code and data pages
+ *
+ * The pages stay mapped for later runs.
+ * Return: 0 on success, -1 on failure
+ */
+static int bench_map(void) {
+    if (bench_map_page(SYSCALL_BENCH_CODE) == -1 || bench_map_page(SYSCALL_BENCH_DATA) == -1)
+        return -1;
+
+    kmemcpy((void *)(uintptr_t)SYSCALL_BENCH_CODE, sysbench_user_start,
+            (uint32_t)(sysbench_user_end - sysbench_user_start));
+    bench_mapped = 1;
+    return 0;
+}
+
+/**
+ * bench_run - Benchmark thread
+ * @arg: Unused
+ *
+ * Return: Does not return
+ */
+static void bench_run(void *arg) {
+    syscall_bench_t *results = (syscall_bench_t *)(uintptr_t)SYSCALL_BENCH_DATA;
+    (void)arg;
+
+    while (1) {
+        thread_block();
+
+        if (!bench_mapped && bench_map() == -1) {
+            kprintf("sysbench: could not map user pages\n");
+            continue;
+        }
+
+        results->iterations = SYSCALL_BENCH_ITERATIONS;
+        results->use_sysenter = (uint32_t)sysenter_enabled;
+        results->sysenter_cycles = 0;
+        results->int_cycles = 0;
+        results->done = 0;
+        results->stepped = 0;
+        *(uint32_t *)(uintptr_t)bench_start.esp = SYSCALL_BENCH_DATA;
+
+        if (!thread_create("sysbench-user", user_thread, &bench_start, SCHED_DEFAULT_PRIORITY)) {
+            kprintf("sysbench: could not start user thread\n");
+            continue;
+        }
+        while (!results->done)
+            thread_sleep_ns(NSEC_PER_SEC / 100);
+
+        if (sysenter_enabled) {
+            kprintf("sysbench: sysenter %llu cycles/call\n",
+                    results->sysenter_cycles / SYSCALL_BENCH_ITERATIONS);
+            kprintf("sysbench: single-step into sysenter %s\n", results->stepped ? "survived" : "failed");
+        } else
+            kprintf("sysbench: no SYSENTER support\n");
+        kprintf("sysbench: int 0x80 %llu cycles/call\n", results->int_cycles / SYSCALL_BENCH_ITERATIONS);
+
+        for (uint32_t nr = 0; nr < SYSCALL_MAX; nr++) {
+            uint64_t count = syscall_count(nr);
+            if (count)
+                kprintf("sysbench: syscall %u called %llu times\n", nr, count);
+        }
+    }
+}
+
+/**
+ * sysenter_debug - #DB handler
+ * @frame: Saved registers
+ *
+ * Ring 3 can set TF right before SYSENTER, which traps on the first
+ * instruction of sysenter_entry while still on the SYSENTER stack. Clear
+ * TF in the saved EFLAGS and resume the entry; SYSEXIT then returns with
+ * TF clear. Any other #DB is unhandled.
+ */
+static void sysenter_debug(interrupt_frame_t *frame) {
+    if (frame->eip != (uint32_t)(uintptr_t)sysenter_entry)
+        exception_unhandled(frame);
+
+    frame->eflags &= ~EFLAGS_TF;
+}
+
+void syscall_init_cpu(void) {
+    uint32_t cpu = cpu_id();
+    uint32_t *top = &sysenter_stacks[cpu][SYSENTER_STACK_SIZE / sizeof(uint32_t) - 1];
+
+    if (!sysenter_enabled)
+        return;
+
+    /* SYSENTER starts on a pointer to the TSS esp0 field; the words below absorb a #DB on entry */
+    *top = (uint32_t)(uintptr_t)tss_esp0_slot(cpu);
+    wrmsr(SYSENTER_CS_MSR, GDT_KERNEL_CODE);
+    wrmsr(SYSENTER_ESP_MSR, (uint32_t)(uintptr_t)top);
+    wrmsr(SYSENTER_EIP_MSR, (uint32_t)(uintptr_t)sysenter_entry);
+}
+
+void syscall_init(void) {
+    sysenter_enabled = sysenter_detect();
+
+    syscall_register(SYS_NULL, sys_null);
+    syscall_register(SYS_EXIT, sys_exit);
+    syscall_register(SYS_WRITE, sys_write);
+
+    /* Trap gate with DPL 3: reachable from ring 3, interrupts stay enabled */
+    idt_set_descriptor(SYSCALL_VECTOR, syscall_int_stub, 0xEF);
+    if (sysenter_enabled)
+        exception_register(SYSCALL_DEBUG_VECTOR, sysenter_debug);
+    syscall_init_cpu();
+
+    bench_thread = thread_create("sysbench", bench_run, NULL, SCHED_DEFAULT_PRIORITY);
+    if (!bench_thread)
+        panic("Error: could not start syscall benchmark thread");
+}
+
+int syscall_register(uint32_t nr, syscall_fn_t fn) {
+    if (nr >= SYSCALL_MAX || syscall_table[nr])
+        return -1;
+
+    syscall_table[nr] = fn;
+    return 0;
+}
+
+int32_t syscall_dispatch(uint32_t nr, uint32_t arg1, uint32_t arg2, uint32_t arg3) {
+    if (nr >= SYSCALL_MAX || !syscall_table[nr])
+        return -1;
+
+    syscall_counts[cpu_id()][nr]++;
+    return syscall_table[nr](arg1, arg2, arg3);
+}
+
+void syscall_interrupt(interrupt_frame_t *frame) {
+    frame->eax = (uint32_t)syscall_dispatch(frame->eax, frame->ebx, frame->esi, frame->edi);
+}
+
+uint64_t syscall_count(uint32_t nr) {
+    uint64_t total = 0;
+
+    if (nr >= SYSCALL_MAX)
+        return 0;
+    for (uint32_t cpu = 0; cpu < MAX_CPUS; cpu++)
+        total += syscall_counts[cpu][nr];
+    return total;
+}
+
+int syscall_sysenter_enabled(void) {
+    return sysenter_enabled;
+}
+
+void user_thread(void *arg) {
+    user_start_t *start = arg;
+    user_enter(start->eip, start->esp);
+}
+
+void syscall_bench(void) {
+    if (bench_thread)
+        thread_wake(bench_thread);
+}
@@ -0,0 +1,223 @@
+#ifndef SYSCALL_H
+#define SYSCALL_H
+
+#include <stdint.h>
+
+#include "idt.h"
+
+/*
+ * System call ABI (both entry paths):
+ *   eax     system call number, result on return
+ *   ebx     first argument
+ *   esi     second argument
+ *   edi     third argument
+ *   ecx/edx clobbered; the SYSENTER path takes the user esp in ecx and
+ *           the return eip in edx
+ * ebx, esi, edi, ebp and esp are preserved.
+ */
+
+/**
+ * SYSCALL_VECTOR - Interrupt vector of the int 0x80 entry path
+ */
+#define SYSCALL_VECTOR              0x80
+
+/**
+ * SYSCALL_MAX - Size of the dispatch table
+ */
+#define SYSCALL_MAX                 32
+
+/**
+ * SYS_NULL - Does nothing, returns 0 (for measuring entry cost)
+ */
+#define SYS_NULL                    0
+
+/**
+ * SYS_EXIT - Terminate the calling thread
+ */
+#define SYS_EXIT                    1
+
+/**
+ * SYS_WRITE - Write a user buffer to the console (buf, len), returns len
+ */
+#define SYS_WRITE                   2
+
+/**
+ * SYSCALL_WRITE_MAX - Longest buffer SYS_WRITE accepts
+ */
+#define SYSCALL_WRITE_MAX           4096
+
+/**
+ * SYSENTER_CS_MSR - IA32_SYSENTER_CS: kernel cs, ss is cs + 8; SYSEXIT
+ * returns to cs + 16 and ss + 24
+ */
+#define SYSENTER_CS_MSR             0x174
+
+/**
+ * SYSENTER_ESP_MSR - IA32_SYSENTER_ESP: esp after SYSENTER
+ */
+#define SYSENTER_ESP_MSR            0x175
+
+/**
+ * SYSENTER_EIP_MSR - IA32_SYSENTER_EIP: entry point of SYSENTER
+ */
+#define SYSENTER_EIP_MSR            0x176
+
+/**
+ * SYSENTER_STACK_SIZE - Bytes of the per-CPU stack SYSENTER starts on,
+ * enough for a #DB frame taken on the first instruction of the entry
+ */
+#define SYSENTER_STACK_SIZE         1024
+
+/**
+ * SYSCALL_DEBUG_VECTOR - #DB, raised on sysenter_entry when ring 3 enters
+ * with TF set
+ */
+#define SYSCALL_DEBUG_VECTOR        1
+
+/**
+ * SYSCALL_BENCH_SCANCODE - F7 make code, runs the null system call benchmark
+ */
+#define SYSCALL_BENCH_SCANCODE      0x41
+
+/**
+ * SYSCALL_BENCH_ITERATIONS - Calls timed per entry path
+ */
+#define SYSCALL_BENCH_ITERATIONS    100000
+
+/**
+ * SYSCALL_BENCH_CODE - User address of the benchmark code page
+ */
+#define SYSCALL_BENCH_CODE          0x40000000
+
+/**
+ * SYSCALL_BENCH_DATA - User address of the benchmark results and stack page
+ */
+#define SYSCALL_BENCH_DATA          0x40001000
+
+/**
+ * syscall_fn_t - System call handler
+ */
+typedef int32_t (*syscall_fn_t)(uint32_t arg1, uint32_t arg2, uint32_t arg3);
+
+/**
+ * struct user_start_t - Where a user thread enters ring 3
+ * @eip: Entry point
+ * @esp: Initial stack pointer
+ */
+typedef struct {
+    uint32_t eip;
+    uint32_t esp;
+} user_start_t;
+
+/**
+ * struct syscall_bench_t - Results block shared with the ring 3 benchmark
+ * @iterations: Calls per entry path (set by the kernel)
+ * @use_sysenter: Non-zero to time SYSENTER (set by the kernel)
+ * @done: Set by the benchmark when both loops are finished
+ * @stepped: Set by the benchmark once a SYSENTER made with TF set returned
+ * @sysenter_cycles: TSC cycles for all SYSENTER calls
+ * @int_cycles: TSC cycles for all int 0x80 calls
+ *
+ * Offsets are fixed by sysbench.asm.
+ */
+typedef struct {
+    uint32_t iterations;
+    uint32_t use_sysenter;
+    volatile uint32_t done;
+    uint32_t stepped;
+    uint64_t sysenter_cycles;
+    uint64_t int_cycles;
+} syscall_bench_t;
+
+/**
+ * syscall_init - Install both entry paths and the built-in system calls
+ *
+ * Call after sched_init() and before smp_init().
+ *
+ * Return: Nothing
+ */
+void syscall_init(void);
+
+/**
+ * syscall_init_cpu - Program the SYSENTER MSRs of the executing CPU
+ *
+ * Return: Nothing
+ */
+void syscall_init_cpu(void);
+
+/**
+ * syscall_register - Install a system call handler
+ * @nr: System call number
+ * @fn: Handler
+ *
+ * Return: 0 on success, -1 if @nr is out of range or taken
+ */
+int syscall_register(uint32_t nr, syscall_fn_t fn);
+
+/**
+ * syscall_dispatch - Run a system call
+ * @nr: System call number
+ * @arg1: First argument
+ * @arg2: Second argument
+ * @arg3: Third argument
+ *
+ * Called from both entry stubs with interrupts enabled.
+ * Return: Handler result, -1 for an unknown number
+ */
+int32_t syscall_dispatch(uint32_t nr, uint32_t arg1, uint32_t arg2, uint32_t arg3);
+
+/**
+ * syscall_interrupt - C side of the int 0x80 entry path
+ * @frame: Interrupt frame; eax receives the result
+ *
+ * Return: Nothing
+ */
+void syscall_interrupt(interrupt_frame_t *frame);
+
+/**
+ * syscall_count - Calls of one system call on all CPUs
+ * @nr: System call number
+ *
+ * Return: Number of calls
+ */
+uint64_t syscall_count(uint32_t nr);
+
+/**
+ * syscall_sysenter_enabled - Check whether the SYSENTER path is in use
+ *
+ * Return: Non-zero if the CPU supports SYSENTER/SYSEXIT
+ */
+int syscall_sysenter_enabled(void);
+
+/**
+ * user_enter - Drop to ring 3
+ * @eip: User entry point
+ * @esp: User stack pointer
+ *
+ * Implemented in isr.asm. The TSS esp0 of the executing CPU must point
+ * at the current thread's kernel stack, which schedule() takes care of.
+ *
+ * Return: Does not return
+ */
+void user_enter(uint32_t eip, uint32_t esp) __attribute__((noreturn));
+
+/**
+ * user_thread - Thread function that drops to ring 3
+ * @arg: user_start_t, must stay valid until the thread runs
+ *
+ * Return: Does not return
+ */
+void user_thread(void *arg) __attribute__((noreturn));
+
+/**
+ * syscall_bench - Wake the benchmark thread
+ *
+ * Times SYSCALL_BENCH_ITERATIONS null system calls from ring 3 through
+ * SYSENTER and through int 0x80, then prints cycles per call and the
+ * per-syscall counters to the debug console.
+ *
+ * Return: Nothing
+ */
+void syscall_bench(void);
+
+#endif
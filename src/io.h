@@ -24,6 +24,26 @@ static inline uint8_t inb(uint16_t port) {
     return ret;
 }
 
+/**
+ * insw - Read words from an I/O port into memory
+ * @port: I/O port to read from
+ * @buf: Destination buffer
+ * @count: Number of 16-bit words to read
+ */
+static inline void insw(uint16_t port, void *buf, uint32_t count) {
+    __asm__ volatile ("rep insw" : "+D"(buf), "+c"(count) : "d"(port) : "memory");
+}
+
+/**
+ * outsw - Write words from memory to an I/O port
+ * @port: I/O port to write to
+ * @buf: Source buffer
+ * @count: Number of 16-bit words to write
+ */
+static inline void outsw(uint16_t port, const void *buf, uint32_t count) {
+    __asm__ volatile ("rep outsw" : "+S"(buf), "+c"(count) : "d"(port) : "memory");
+}
+
 /**
  * io_wait - Wait for I/O operation to complete
  *
@@ -0,0 +1,67 @@
+#include "lz4.h"
+
+/**
+ * read_length - Add the extension bytes of a length nibble
+ * @ip: Input cursor, advanced past the bytes read
+ * @end: End of input
+ * @len: Length from the nibble
+ *
+ * A nibble of LZ4_RUN_MASK is followed by bytes that are added to it
+ * until one is below 255.
+ * Return: Full length, or UINT32_MAX if the input ends first
+ */
+static uint32_t read_length(const uint8_t **ip, const uint8_t *end, uint32_t len) {
+    if (len != LZ4_RUN_MASK)
+        return len;
+
+    uint8_t b;
+    do {
+        if (*ip >= end)
+            return UINT32_MAX;
+        b = *(*ip)++;
+        len += b;
+    } while (b == 255);
+    return len;
+}
+
+int32_t lz4_decompress(const void *src, uint32_t src_size, void *dst, uint32_t dst_size) {
+    const uint8_t *ip = src;
+    const uint8_t *ip_end = ip + src_size;
+    uint8_t *op = dst;
+    uint8_t *op_end = op + dst_size;
+
+    while (ip < ip_end) {
+        uint8_t token = *ip++;
+
+        /* Literals */
+        uint32_t len = read_length(&ip, ip_end, token >> 4);
+        if (len > (uint32_t)(ip_end - ip) || len > (uint32_t)(op_end - op))
+            return -1;
+        for (uint32_t i = 0; i < len; i++)
+            *op++ = *ip++;
+
+        /* The last sequence has literals only */
+        if (ip == ip_end)
+            break;
+
+        /* Match: 16-bit little-endian distance back into the output */
+        if (ip_end - ip < 2)
+            return -1;
+        uint32_t offset = ip[0] | ((uint32_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (uint32_t)(op - (uint8_t *)dst))
+            return -1;
+
+        len = read_length(&ip, ip_end, token & LZ4_RUN_MASK);
+        if (len == UINT32_MAX || len + LZ4_MIN_MATCH > (uint32_t)(op_end - op))
+            return -1;
+        len += LZ4_MIN_MATCH;
+
+        /* Byte by byte: a match may overlap the bytes it produces */
+        const uint8_t *match = op - offset;
+        for (uint32_t i = 0; i < len; i++)
+            *op++ = *match++;
+    }
+
+    return (int32_t)(op - (uint8_t *)dst);
+}
@@ -0,0 +1,33 @@
+#ifndef LZ4_H
+#define LZ4_H
+
+#include <stdint.h>
+
+/**
+ * LZ4_MIN_MATCH - Shortest match a sequence can encode, added to the
+ * match length nibble
+ */
+#define LZ4_MIN_MATCH       4
+
+/**
+ * LZ4_RUN_MASK - Length nibble value meaning "more length bytes follow"
+ */
+#define LZ4_RUN_MASK        15
+
+/**
+ * lz4_decompress - Expand one LZ4 block
+ * @src: Compressed block, raw LZ4 block format without a frame header
+ * @src_size: Bytes in @src
+ * @dst: Output buffer
+ * @dst_size: Bytes available at @dst
+ *
+ * Needs nothing from the kernel, so the boot unpack stub can link it on
+ * its own. Every read and write is bounds-checked: a corrupt block
+ * fails instead of writing past @dst.
+ *
+ * Return: Bytes written to @dst, -1 if the block is malformed or does
+ * not fit
+ */
+int32_t lz4_decompress(const void *src, uint32_t src_size, void *dst, uint32_t dst_size);
+
+#endif
@@ -0,0 +1,239 @@
+#include <stddef.h>
+
+#include "mem.h"
+
+#ifndef TEST
+#include "../cpu/cpu.h"
+#include "../cpu/fpu.h"
+#else
+/* Host tests own the FPU outright */
+static inline uint32_t kernel_fpu_begin(void) { return 0; }
+static inline void kernel_fpu_end(uint32_t flags) { (void)flags; }
+static inline int kernel_fpu_busy(void) { return 0; }
+#endif
+
+/**
+ * MEM_NT_BLOCK - Bytes written per non-temporal loop iteration
+ */
+#define MEM_NT_BLOCK        64
+
+/**
+ * features - MEM_FEAT_* flags given to mem_init()
+ */
+static uint32_t features;
+
+/**
+ * sse_usable - Check whether the SSE2 paths may run
+ *
+ * Not inside another kernel FPU section, which a fault taken halfway
+ * through one of them would be; its xmm registers must survive.
+ * Return: Non-zero if they may
+ */
+static inline int sse_usable(void) {
+    return (features & MEM_FEAT_SSE2) && !kernel_fpu_busy();
+}
+
+/**
+ * rep_stosb - Fill @n bytes with @c
+ */
+static inline void rep_stosb(void *dst, uint8_t c, uintptr_t n) {
+    __asm__ volatile ("rep stosb" : "+D"(dst), "+c"(n) : "a"(c) : "memory");
+}
+
+/**
+ * rep_stosw - Fill @n 16-bit words with @v
+ */
+static inline void rep_stosw(void *dst, uint16_t v, uintptr_t n) {
+    __asm__ volatile ("rep stosw" : "+D"(dst), "+c"(n) : "a"(v) : "memory");
+}
+
+/**
+ * rep_stosl - Fill @n 32-bit words with @v
+ */
+static inline void rep_stosl(void *dst, uint32_t v, uintptr_t n) {
+    __asm__ volatile ("rep stosl" : "+D"(dst), "+c"(n) : "a"(v) : "memory");
+}
+
+/**
+ * rep_movsb - Copy @n bytes
+ */
+static inline void rep_movsb(void *dst, const void *src, uintptr_t n) {
+    __asm__ volatile ("rep movsb" : "+D"(dst), "+S"(src), "+c"(n) : : "memory");
+}
+
+/**
+ * rep_movsl - Copy @n 32-bit words
+ */
+static inline void rep_movsl(void *dst, const void *src, uintptr_t n) {
+    __asm__ volatile ("rep movsl" : "+D"(dst), "+S"(src), "+c"(n) : : "memory");
+}
+
+/**
+ * nt_set - Fill 64-byte blocks with non-temporal stores
+ * @dst: 16-byte aligned destination
+ * @pattern: Four copies of the 32-bit fill value
+ * @blocks: Number of MEM_NT_BLOCK blocks
+ *
+ * Must run inside kernel_fpu_begin()/kernel_fpu_end().
+ * Return: Nothing
+ */
+__attribute__((target("sse2")))
+static void nt_set(uint8_t *dst, const uint32_t pattern[4], uint32_t blocks) {
+    __asm__ volatile ("movdqu (%0), %%xmm0" : : "r"(pattern) : "xmm0");
+    for (; blocks; blocks--, dst += MEM_NT_BLOCK) {
+        __asm__ volatile (
+            "movntdq %%xmm0, 0(%0)\n"
+            "movntdq %%xmm0, 16(%0)\n"
+            "movntdq %%xmm0, 32(%0)\n"
+            "movntdq %%xmm0, 48(%0)\n"
+            : : "r"(dst) : "memory");
+    }
+    /* Weakly ordered stores must be visible before anyone reads the memory */
+    __asm__ volatile ("sfence" : : : "memory");
+}
+
+/**
+ * nt_copy - Copy 64-byte blocks with non-temporal stores
+ * @dst: 16-byte aligned destination
+ * @src: Source, any alignment
+ * @blocks: Number of MEM_NT_BLOCK blocks
+ *
+ * Must run inside kernel_fpu_begin()/kernel_fpu_end().
+ * Return: Nothing
+ */
+__attribute__((target("sse2")))
+static void nt_copy(uint8_t *dst, const uint8_t *src, uint32_t blocks) {
+    for (; blocks; blocks--, dst += MEM_NT_BLOCK, src += MEM_NT_BLOCK) {
+        __asm__ volatile (
+            "movdqu 0(%1), %%xmm0\n"
+            "movdqu 16(%1), %%xmm1\n"
+            "movdqu 32(%1), %%xmm2\n"
+            "movdqu 48(%1), %%xmm3\n"
+            "movntdq %%xmm0, 0(%0)\n"
+            "movntdq %%xmm1, 16(%0)\n"
+            "movntdq %%xmm2, 32(%0)\n"
+            "movntdq %%xmm3, 48(%0)\n"
+            : : "r"(dst), "r"(src) : "xmm0", "xmm1", "xmm2", "xmm3", "memory");
+    }
+    __asm__ volatile ("sfence" : : : "memory");
+}
+
+void mem_init(uint32_t feat) {
+    features = feat;
+}
+
+#ifndef TEST
+uint32_t mem_detect(void) {
+    uint32_t eax, ebx, ecx, edx;
+    uint32_t feat = fpu_has_sse2() ? MEM_FEAT_SSE2 : 0;
+
+    cpuid(0, &eax, &ebx, &ecx, &edx);
+    if (eax >= 7) {
+        cpuid(7, &eax, &ebx, &ecx, &edx);
+        if (ebx & CPUID_EBX7_ERMSB)
+            feat |= MEM_FEAT_ERMSB;
+    }
+    return feat;
+}
+#endif
+
+void *kmemset(void *dst, int c, uint32_t n) {
+    uint8_t *d = dst;
+    uint32_t v = (uint8_t)c * 0x01010101U;
+
+    if (features & MEM_FEAT_ERMSB) {
+        /* Fast strings pick their own store width and protocol */
+    } else if (n >= MEM_NT_THRESHOLD && sse_usable()) {
+        uint32_t head = (uint32_t)(-(uintptr_t)d & 15);
+        uint32_t pattern[4] = { v, v, v, v };
+
+        rep_stosb(d, (uint8_t)c, head);
+        d += head;
+        n -= head;
+
+        uint32_t flags = kernel_fpu_begin();
+        nt_set(d, pattern, n / MEM_NT_BLOCK);
+        kernel_fpu_end(flags);
+        d += n & ~(MEM_NT_BLOCK - 1);
+        n &= MEM_NT_BLOCK - 1;
+    } else if (n >= 16) {
+        /* Align the destination so each dword store stays in one cache line */
+        uint32_t head = (uint32_t)(-(uintptr_t)d & 3);
+        rep_stosb(d, (uint8_t)c, head);
+        d += head;
+        n -= head;
+
+        rep_stosl(d, v, n / 4);
+        d += n & ~3U;
+        n &= 3;
+    }
+
+    rep_stosb(d, (uint8_t)c, n);
+    return dst;
+}
+
+uint16_t *kmemset16(uint16_t *dst, uint16_t value, uint32_t count) {
+    rep_stosw(dst, value, count);
+    return dst;
+}
+
+void *kmemcpy(void *dst, const void *src, uint32_t n) {
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+
+    if (features & MEM_FEAT_ERMSB) {
+        /* Fast strings pick their own store width and protocol */
+    } else if (n >= MEM_NT_THRESHOLD && sse_usable()) {
+        uint32_t head = (uint32_t)(-(uintptr_t)d & 15);
+        rep_movsb(d, s, head);
+        d += head;
+        s += head;
+        n -= head;
+
+        uint32_t flags = kernel_fpu_begin();
+        nt_copy(d, s, n / MEM_NT_BLOCK);
+        kernel_fpu_end(flags);
+        d += n & ~(MEM_NT_BLOCK - 1);
+        s += n & ~(MEM_NT_BLOCK - 1);
+        n &= MEM_NT_BLOCK - 1;
+    } else if (n >= 16) {
+        uint32_t head = (uint32_t)(-(uintptr_t)d & 3);
+        rep_movsb(d, s, head);
+        d += head;
+        s += head;
+        n -= head;
+
+        rep_movsl(d, s, n / 4);
+        d += n & ~3U;
+        s += n & ~3U;
+        n &= 3;
+    }
+
+    rep_movsb(d, s, n);
+    return dst;
+}
+
+void page_zero(void *page) {
+    if (features & MEM_FEAT_ERMSB) {
+        rep_stosb(page, 0, MEM_PAGE_SIZE);
+    } else if (sse_usable()) {
+        static const uint32_t zero[4];
+        uint32_t flags = kernel_fpu_begin();
+        nt_set(page, zero, MEM_PAGE_SIZE / MEM_NT_BLOCK);
+        kernel_fpu_end(flags);
+    } else {
+        rep_stosl(page, 0, MEM_PAGE_SIZE / 4);
+    }
+}
+
+#ifndef TEST
+/* The compiler may emit calls to these for large struct copies and initializers */
+
+void *memset(void *dst, int c, size_t n) {
+    return kmemset(dst, c, n);
+}
+
+void *memcpy(void *dst, const void *src, size_t n) {
+    return kmemcpy(dst, src, n);
+}
+#endif
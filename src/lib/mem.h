@@ -0,0 +1,94 @@
+#ifndef MEM_H
+#define MEM_H
+
+#include <stdint.h>
+
+/**
+ * MEM_PAGE_SIZE - Size of a block cleared by page_zero()
+ */
+#define MEM_PAGE_SIZE       4096
+
+/**
+ * MEM_NT_THRESHOLD - Smallest kmemset()/kmemcpy() that uses non-temporal
+ * stores. Below this the destination is likely to be read back soon and
+ * should stay in cache.
+ */
+#define MEM_NT_THRESHOLD    (256 * 1024)
+
+/**
+ * MEM_FEAT_SSE2 - SSE2 is enabled, non-temporal stores are available
+ */
+#define MEM_FEAT_SSE2       0x01
+
+/**
+ * MEM_FEAT_ERMSB - Enhanced rep movsb/stosb: the microcoded byte string
+ * ops beat non-temporal SSE2 loops at every size
+ */
+#define MEM_FEAT_ERMSB      0x02
+
+/**
+ * mem_init - Select the implementation for this CPU
+ * @features: MEM_FEAT_* flags
+ *
+ * Until called, only the rep stosl/movsl paths are used.
+ *
+ * Return: Nothing
+ */
+void mem_init(uint32_t features);
+
+#ifndef TEST
+/**
+ * mem_detect - Probe the CPU for MEM_FEAT_* flags
+ *
+ * Call after fpu_init() so SSE2 is only reported once it is enabled.
+ *
+ * Return: MEM_FEAT_* flags for mem_init()
+ */
+uint32_t mem_detect(void);
+#endif
+
+/**
+ * kmemset - Fill memory with a byte
+ * @dst: Destination
+ * @c: Byte value
+ * @n: Number of bytes
+ *
+ * Return: @dst
+ */
+void *kmemset(void *dst, int c, uint32_t n);
+
+/**
+ * kmemset16 - Fill memory with a 16-bit value
+ * @dst: Destination
+ * @value: Value to store
+ * @count: Number of 16-bit elements
+ *
+ * Suitable for VGA text memory: stores are always 16 bits wide.
+ *
+ * Return: @dst
+ */
+uint16_t *kmemset16(uint16_t *dst, uint16_t value, uint32_t count);
+
+/**
+ * kmemcpy - Copy non-overlapping memory
+ * @dst: Destination
+ * @src: Source
+ * @n: Number of bytes
+ *
+ * Return: @dst
+ */
+void *kmemcpy(void *dst, const void *src, uint32_t n);
+
+/**
+ * page_zero - Zero a page-aligned MEM_PAGE_SIZE block
+ * @page: Page to clear
+ *
+ * Uses rep stosb with ERMSB, otherwise non-temporal stores when SSE2 is
+ * available so clearing a frame does not evict the working set. Inside
+ * a kernel FPU section, as from a page fault, it uses rep stosl.
+ *
+ * Return: Nothing
+ */
+void page_zero(void *page);
+
+#endif
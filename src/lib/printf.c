@@ -0,0 +1,208 @@
+#include "printf.h"
+
+#ifndef TEST
+#include "../cpu/spinlock.h"
+#include "../drivers/serial.h"
+#endif
+
+/**
+ * struct out_t - Output cursor for kvsnprintf
+ * @buf: Output buffer
+ * @size: Size of @buf
+ * @len: Characters produced so far (may exceed @size)
+ */
+typedef struct {
+    char *buf;
+    uint32_t size;
+    uint32_t len;
+} out_t;
+
+/**
+ * emit - Append one character, dropping it if the buffer is full
+ * @out: Output cursor
+ * @c: Character
+ *
+ * Return: Nothing
+ */
+static void emit(out_t *out, char c) {
+    if (out->len + 1 < out->size)
+        out->buf[out->len] = c;
+    out->len++;
+}
+
+/**
+ * emit_number - Append an unsigned number
+ * @out: Output cursor
+ * @value: Value to format
+ * @base: 10 or 16
+ * @upper: Use upper-case hex digits
+ * @width: Minimum field width
+ * @pad: Padding character ('0' or ' ')
+ * @negative: Prefix a minus sign
+ *
+ * Return: Nothing
+ */
+static void emit_number(out_t *out, uint64_t value, uint32_t base, int upper,
+                        uint32_t width, char pad, int negative) {
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char tmp[24];
+    uint32_t n = 0;
+
+    /* Stay in 32-bit arithmetic when possible; 64-bit division is slow on i686 */
+    do {
+        if (value >> 32) {
+            tmp[n++] = digits[value % base];
+            value /= base;
+        } else {
+            uint32_t small = (uint32_t)value;
+            tmp[n++] = digits[small % base];
+            value = small / base;
+        }
+    } while (value);
+
+    uint32_t total = n + (negative ? 1 : 0);
+    if (negative && pad == '0')
+        emit(out, '-');
+    for (; total < width; total++)
+        emit(out, pad);
+    if (negative && pad != '0')
+        emit(out, '-');
+    while (n)
+        emit(out, tmp[--n]);
+}
+
+/**
+ * kvsnprintf - Format a string into a buffer
+ * @buf: Output buffer
+ * @size: Size of @buf in bytes (output is always NUL-terminated if non-zero)
+ * @fmt: Format string
+ * @args: Arguments
+ *
+ * Return: Number of characters the full output would need (excluding NUL)
+ */
+int kvsnprintf(char *buf, uint32_t size, const char *fmt, va_list args) {
+    out_t out = { buf, size, 0 };
+
+    for (; *fmt; fmt++) {
+        if (*fmt != '%') {
+            emit(&out, *fmt);
+            continue;
+        }
+
+        fmt++;
+        char pad = ' ';
+        if (*fmt == '0') {
+            pad = '0';
+            fmt++;
+        }
+
+        uint32_t width = 0;
+        while (*fmt >= '0' && *fmt <= '9')
+            width = width * 10 + (uint32_t)(*fmt++ - '0');
+
+        int longs = 0;
+        while (*fmt == 'l') {
+            longs++;
+            fmt++;
+        }
+
+        switch (*fmt) {
+        case 'd': {
+            int64_t value = longs >= 2 ? va_arg(args, long long) :
+                            longs == 1 ? va_arg(args, long) : va_arg(args, int);
+            uint64_t magnitude = value < 0 ? (uint64_t)0 - (uint64_t)value : (uint64_t)value;
+            emit_number(&out, magnitude, 10, 0, width, pad, value < 0);
+            break;
+        }
+        case 'u':
+        case 'x':
+        case 'X': {
+            uint64_t value = longs >= 2 ? va_arg(args, unsigned long long) :
+                             longs == 1 ? va_arg(args, unsigned long) : va_arg(args, unsigned int);
+            emit_number(&out, value, *fmt == 'u' ? 10 : 16, *fmt == 'X', width, pad, 0);
+            break;
+        }
+        case 'p':
+            emit(&out, '0');
+            emit(&out, 'x');
+            emit_number(&out, (uintptr_t)va_arg(args, void *), 16, 0, sizeof(void *) * 2, '0', 0);
+            break;
+        case 's': {
+            const char *str = va_arg(args, const char *);
+            if (!str)
+                str = "(null)";
+            uint32_t len = 0;
+            while (str[len])
+                len++;
+            for (; len < width; width--)
+                emit(&out, ' ');
+            while (*str)
+                emit(&out, *str++);
+            break;
+        }
+        case 'c':
+            emit(&out, (char)va_arg(args, int));
+            break;
+        case '%':
+            emit(&out, '%');
+            break;
+        case '\0':
+            fmt--;
+            break;
+        default:
+            emit(&out, '%');
+            emit(&out, *fmt);
+            break;
+        }
+    }
+
+    if (size)
+        buf[out.len < size ? out.len : size - 1] = '\0';
+    return (int)out.len;
+}
+
+/**
+ * ksnprintf - Format a string into a buffer
+ * @buf: Output buffer
+ * @size: Size of @buf in bytes
+ * @fmt: Format string
+ *
+ * Return: Number of characters the full output would need (excluding NUL)
+ */
+int ksnprintf(char *buf, uint32_t size, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int len = kvsnprintf(buf, size, fmt, args);
+    va_end(args);
+    return len;
+}
+
+#ifndef TEST
+/**
+ * kprintf_lock - Keeps lines from different CPUs from interleaving
+ */
+static spinlock_t kprintf_lock = SPINLOCK_INIT("kprintf");
+
+/**
+ * kprintf - Format a string and write it to the serial debug channel
+ * @fmt: Format string
+ *
+ * Lines longer than KPRINTF_BUFFER_SIZE - 1 are truncated.
+ * Return: Number of characters written
+ */
+int kprintf(const char *fmt, ...) {
+    char buf[KPRINTF_BUFFER_SIZE];
+    va_list args;
+    va_start(args, fmt);
+    int len = kvsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    if (len > KPRINTF_BUFFER_SIZE - 1)
+        len = KPRINTF_BUFFER_SIZE - 1;
+
+    uint32_t flags = spin_lock_irqsave(&kprintf_lock);
+    serial_write(buf, (uint32_t)len);
+    spin_unlock_irqrestore(&kprintf_lock, flags);
+    return len;
+}
+#endif
@@ -0,0 +1,46 @@
+#ifndef PRINTF_H
+#define PRINTF_H
+
+#include <stdarg.h>
+#include <stdint.h>
+
+/**
+ * KPRINTF_BUFFER_SIZE - Longest line kprintf() formats in one call
+ */
+#define KPRINTF_BUFFER_SIZE     256
+
+/**
+ * kvsnprintf - Format a string into a buffer
+ * @buf: Output buffer
+ * @size: Size of @buf in bytes (output is always NUL-terminated if non-zero)
+ * @fmt: Format string
+ * @args: Arguments
+ *
+ * Supports %d, %u, %x, %X, %s, %c, %p and %% with an optional '0' flag,
+ * field width and 'l' / 'll' length modifiers.
+ *
+ * Return: Number of characters the full output would need (excluding NUL)
+ */
+int kvsnprintf(char *buf, uint32_t size, const char *fmt, va_list args);
+
+/**
+ * ksnprintf - Format a string into a buffer
+ * @buf: Output buffer
+ * @size: Size of @buf in bytes
+ * @fmt: Format string
+ *
+ * Return: Number of characters the full output would need (excluding NUL)
+ */
+int ksnprintf(char *buf, uint32_t size, const char *fmt, ...);
+
+#ifndef TEST
+/**
+ * kprintf - Format a string and write it to the serial debug channel
+ * @fmt: Format string
+ *
+ * Return: Number of characters written
+ */
+int kprintf(const char *fmt, ...);
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+#include <stddef.h>
+
+#include "wsdeque.h"
+
+/**
+ * WSDEQUE_MASK - Slot index mask
+ */
+#define WSDEQUE_MASK        (WSDEQUE_SIZE - 1)
+
+void wsdeque_init(wsdeque_t *deque) {
+    deque->top = 0;
+    deque->bottom = 0;
+    for (uint32_t i = 0; i < WSDEQUE_SIZE; i++)
+        deque->slots[i] = NULL;
+}
+
+int wsdeque_push(wsdeque_t *deque, void *item) {
+    int32_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+    int32_t top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+
+    if (bottom - top >= WSDEQUE_SIZE)
+        return -1;
+
+    /* The item must be visible before thieves can see the new bottom */
+    __atomic_store_n(&deque->slots[bottom & WSDEQUE_MASK], item, __ATOMIC_RELAXED);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void *wsdeque_pop(wsdeque_t *deque) {
+    int32_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+
+    /* Claim the slot before looking at top, or a thief could take it too */
+    __atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int32_t top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+
+    if (top > bottom) {
+        /* Empty */
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    void *item = __atomic_load_n(&deque->slots[bottom & WSDEQUE_MASK], __ATOMIC_RELAXED);
+    if (top == bottom) {
+        /* Last item: race the thieves for it */
+        if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, 0,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+            item = NULL;
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    }
+    return item;
+}
+
+void *wsdeque_steal(wsdeque_t *deque) {
+    int32_t top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int32_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+
+    if (top >= bottom)
+        return NULL;
+
+    void *item = __atomic_load_n(&deque->slots[top & WSDEQUE_MASK], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, 0,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        return NULL;
+    return item;
+}
+
+int32_t wsdeque_size(const wsdeque_t *deque) {
+    int32_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+    int32_t top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+    return bottom > top ? bottom - top : 0;
+}
@@ -0,0 +1,69 @@
+#ifndef WSDEQUE_H
+#define WSDEQUE_H
+
+#include <stdint.h>
+
+/**
+ * WSDEQUE_SIZE - Slots per deque (power of two)
+ */
+#define WSDEQUE_SIZE        256
+
+/**
+ * struct wsdeque_t - Chase-Lev work-stealing deque
+ * @top: Next slot thieves take from, only advanced by compare-and-swap
+ * @bottom: Next slot the owner pushes to, only written by the owner
+ * @slots: Ring of items
+ *
+ * The owner pushes and pops at the bottom without atomic read-modify-write
+ * operations; thieves take from the top. Only the last item is contended,
+ * and a compare-and-swap on @top settles who gets it. The ring does not
+ * grow: a push into a full deque fails.
+ */
+typedef struct {
+    volatile int32_t top;
+    volatile int32_t bottom;
+    void *volatile slots[WSDEQUE_SIZE];
+} wsdeque_t;
+
+/**
+ * wsdeque_init - Make a deque empty
+ * @deque: Deque
+ *
+ * Return: Nothing
+ */
+void wsdeque_init(wsdeque_t *deque);
+
+/**
+ * wsdeque_push - Add an item at the bottom (owner only)
+ * @deque: Deque
+ * @item: Non-NULL item
+ *
+ * Return: 0 on success, -1 if the deque is full
+ */
+int wsdeque_push(wsdeque_t *deque, void *item);
+
+/**
+ * wsdeque_pop - Take the most recently pushed item (owner only)
+ * @deque: Deque
+ *
+ * Return: Item, or NULL if empty or a thief took the last one
+ */
+void *wsdeque_pop(wsdeque_t *deque);
+
+/**
+ * wsdeque_steal - Take the oldest item (any CPU)
+ * @deque: Deque
+ *
+ * Return: Item, or NULL if empty or another CPU won the race
+ */
+void *wsdeque_steal(wsdeque_t *deque);
+
+/**
+ * wsdeque_size - Estimate the number of items
+ * @deque: Deque
+ *
+ * Return: Items at the time of reading, never negative
+ */
+int32_t wsdeque_size(const wsdeque_t *deque);
+
+#endif
@@ -1,6 +1,7 @@
 #include <stddef.h>
 
 #include "falloc.h"
+#include "../cpu/spinlock.h"
 #include "../utils.h"
 
 /**
@@ -8,6 +9,11 @@
  */
 static frame_allocator falloc;
 
+/**
+ * falloc_lock - Protects the bitmap once other CPUs run
+ */
+static spinlock_t falloc_lock = SPINLOCK_INIT("falloc_lock");
+
 /**
  * reserve - Mark a physical address range as used
  * @start: Start physical address (inclusive)
@@ -64,18 +70,21 @@ void falloc_init(const mmap_t *map) {
  * Return: 0 on success, -1 on failure
  */
 int fallocate(uint32_t *paddr) {
+    uint32_t flags = spin_lock_irqsave(&falloc_lock);
     for (uint32_t i = 0; i < BITMAP_SIZE; i++) {
         if (falloc.bitmap[i] != 0xFFFFFFFF) {
             for (uint32_t j = 0; j < WORD_SIZE; j++) {
                 uint32_t mask = 1U << j;
                 if (!(falloc.bitmap[i] & mask)) {
                     falloc.bitmap[i] |= mask;
+                    spin_unlock_irqrestore(&falloc_lock, flags);
                     *paddr = (i * WORD_SIZE + j) * PAGE_SIZE;
                     return 0;
                 }
             }
         }
     }
+    spin_unlock_irqrestore(&falloc_lock, flags);
     return -1;
 }
 
@@ -89,5 +98,8 @@ void ffree(uint32_t paddr) {
     uint32_t page_number = paddr / PAGE_SIZE;
     uint32_t index = page_number / WORD_SIZE;
     uint32_t bit = page_number % WORD_SIZE;
+
+    uint32_t flags = spin_lock_irqsave(&falloc_lock);
     falloc.bitmap[index] &= ~(1U << bit);
+    spin_unlock_irqrestore(&falloc_lock, flags);
 }
@@ -1,4 +1,5 @@
 #include "mmap.h"
+#include "../boot/multiboot.h"
 
 #include "../utils.h"
 
@@ -38,4 +39,76 @@ void mmap_init(mmap_t *map) {
 
     /* Free memory */
     register_section(map, ADDR_FREE_START, ADDR_FREE_END, SECTION_FREE);
-}
\ No newline at end of file
+}
+
+/**
+ * next_available - Find the first available RAM at or after an address
+ * @entries: Memory map entries
+ * @length: Bytes of @entries
+ * @addr: Address to search from
+ * @start: Set to the start of the range, at least @addr
+ * @end: Set to the end of the range (exclusive)
+ *
+ * Of the ranges starting at the same address, the longest wins.
+ * Return: 0 on success, -1 if no RAM is reported past @addr
+ */
+static int next_available(const void *entries, uint32_t length, uint64_t addr,
+                          uint64_t *start, uint64_t *end) {
+    int found = -1;
+    uint32_t offset = 0;
+
+    while (offset + sizeof(multiboot_mmap_entry_t) <= length) {
+        const multiboot_mmap_entry_t *entry =
+            (const multiboot_mmap_entry_t *)((const uint8_t *)entries + offset);
+        offset += entry->size + sizeof(entry->size);
+
+        if (entry->type != MULTIBOOT_MEMORY_AVAILABLE || entry->addr + entry->len <= addr)
+            continue;
+
+        uint64_t entry_start = entry->addr < addr ? addr : entry->addr;
+        uint64_t entry_end = entry->addr + entry->len;
+        if (found == -1 || entry_start < *start || (entry_start == *start && entry_end > *end)) {
+            *start = entry_start;
+            *end = entry_end;
+            found = 0;
+        }
+    }
+    return found;
+}
+
+/**
+ * mmap_init_multiboot - Initialize the memory map from a Multiboot loader
+ * @map: Pointer to the memory map to initialize
+ * @entries: Memory map entries (multiboot_mmap_entry_t) the loader passed
+ * @length: Bytes of @entries
+ *
+ * Return: Nothing
+ */
+void mmap_init_multiboot(mmap_t *map, const void *entries, uint32_t length) {
+    uint64_t limit = (uint64_t)ADDR_FREE_END + 1;
+    uint64_t addr = ADDR_FREE_START;
+    uint64_t start, end, next_start, next_end;
+
+    map->count = 0;
+    register_section(map, ADDR_IO_START, ADDR_IO_END, SECTION_IO);
+    register_section(map, ADDR_KERNEL_START, ADDR_KERNEL_END, SECTION_KERNEL);
+
+    while (addr < limit) {
+        if (next_available(entries, length, addr, &start, &end) == -1 || start >= limit) {
+            register_section(map, (uint32_t)addr, ADDR_FREE_END, SECTION_RESERVED);
+            break;
+        }
+
+        /* Adjacent and overlapping entries make one section */
+        while (end < limit && next_available(entries, length, end, &next_start, &next_end) == 0 &&
+               next_start == end)
+            end = next_end;
+        if (end > limit)
+            end = limit;
+
+        if (start > addr)
+            register_section(map, (uint32_t)addr, (uint32_t)(start - 1), SECTION_RESERVED);
+        register_section(map, (uint32_t)start, (uint32_t)(end - 1), SECTION_FREE);
+        addr = end;
+    }
+}
@@ -6,7 +6,7 @@
 /**
  * MAX_MEM_SECTIONS - Maximum number of memory sections
  */
-#define MAX_MEM_SECTIONS 16
+#define MAX_MEM_SECTIONS 32
 
 /**
  * ADDR_IO_START - I/O memory start
@@ -43,11 +43,13 @@
  * @SECTION_IO: I/O memory
  * @SECTION_KERNEL: Kernel memory
  * @SECTION_FREE: Free memory
+ * @SECTION_RESERVED: Memory the firmware reserves, or no RAM at all
  */
 typedef enum {
     SECTION_IO,
     SECTION_KERNEL,
-    SECTION_FREE
+    SECTION_FREE,
+    SECTION_RESERVED
 } mtype_t;
 
 /**
@@ -85,4 +87,18 @@ extern mmap_t mmap;
  */
 void mmap_init(mmap_t *map);
 
+/**
+ * mmap_init_multiboot - Initialize the memory map from a Multiboot loader
+ * @map: Pointer to the memory map to initialize
+ * @entries: Memory map entries (multiboot_mmap_entry_t) the loader passed
+ * @length: Bytes of @entries
+ *
+ * The I/O and kernel sections are the same as with mmap_init(). Above
+ * them only RAM the loader reports as available is free, everything else
+ * up to 4 GiB is reserved.
+ *
+ * Return: Nothing
+ */
+void mmap_init_multiboot(mmap_t *map, const void *entries, uint32_t length);
+
 #endif
\ No newline at end of file
@@ -1,8 +1,16 @@
+#include <stddef.h>
+
 #include "falloc.h"
 #include "paging.h"
 
 #include "../utils.h"
+#include "../cpu/smp.h"
+#include "../cpu/spinlock.h"
+#include "../lib/mem.h"
+#include "../lib/printf.h"
 #include "../drivers/vga.h"
+#include "../interrupts/idt.h"
+#include "../sched/sched.h"
 
 /**
  * pg_dir - Page directory
@@ -10,6 +18,41 @@
 __attribute__((aligned(PAGE_SIZE)))
 static pg_dir_entry_t pg_dir[NUM_PAGE_ENTRIES];
 
+/**
+ * paging_enabled - Non-zero once CR0.PG is set
+ *
+ * Page tables live in frames that are not identity mapped, so once paging
+ * is on they are only reachable through the recursive page directory slot.
+ */
+static int paging_enabled;
+
+/**
+ * zero_frame - Physical address of the shared read-only zero frame
+ */
+static uint32_t zero_frame;
+
+/**
+ * mmio_next - Next free virtual address in the map_phys() window
+ */
+static uint32_t mmio_next = ADDR_MMIO_START;
+
+/**
+ * scratch_base - Per-CPU pages in the map_phys() window for frame_zero()
+ */
+static uint32_t scratch_base;
+
+/**
+ * pg_lock - Protects pg_dir, the page tables and mmio_next
+ *
+ * Taken before falloc's lock when a new page table is needed.
+ */
+static spinlock_t pg_lock = SPINLOCK_INIT("pg_lock");
+
+/**
+ * fault_fn - Resolver for not-present faults, see page_fault_register()
+ */
+static page_fault_fn_t fault_fn;
+
 /**
  * pg_dir_entry_zero - Zero out a page directory entry
  * @entry: Page directory entry to zero
@@ -74,44 +117,132 @@ static int mmap_find_kernel_section(const mmap_t *mmap, msection_t *msection) {
  * Return: Nothing
  */
 static void pg_dir_zero(pg_dir_entry_t *pg_dir_entry) {
-    for (uint32_t i = 0; i < NUM_PAGE_ENTRIES; i++)
-        pg_dir_entry_zero(&pg_dir_entry[i]);
+    page_zero(pg_dir_entry);
 }
 
 /**
- * get_paddr - Get the physical address of a virtual address
+ * get_pg_table - Get an accessible pointer to a page table
+ * @pg_dir_index: Index of the page directory entry referencing the table
+ *
+ * Return: Physical address before paging is enabled, recursive mapping after
+ */
+static pg_table_entry_t *get_pg_table(uint32_t pg_dir_index) {
+    if (paging_enabled)
+        return (pg_table_entry_t *)(uintptr_t)(ADDR_PG_TABLES + pg_dir_index * PAGE_SIZE);
+
+    return (pg_table_entry_t *)(uintptr_t)((uint32_t)pg_dir[pg_dir_index].address << 12);
+}
+
+/**
+ * get_pg_table_entry - Look up the page table entry for a virtual address
  * @vaddr: Virtual address
- * @paddr: On success, set to the physical address
  *
- * Return: 0 on success, -1 if not mapped
+ * Return: Pointer to the entry, or NULL if no page table covers @vaddr
  */
-int get_paddr(uint32_t vaddr, uint32_t *paddr) {
+static pg_table_entry_t *get_pg_table_entry(uint32_t vaddr) {
     uint32_t pg_dir_index = (vaddr >> 22) & 0x3FF;
     uint32_t pg_table_index = (vaddr >> 12) & 0x3FF;
 
-    pg_dir_entry_t *pg_dir_entry = &pg_dir[pg_dir_index];
-    if (!pg_dir_entry->present)
-        return -1;
+    if (!pg_dir[pg_dir_index].present)
+        return NULL;
 
-    pg_table_entry_t *pg_table = (pg_table_entry_t *)(uintptr_t)(pg_dir_entry->address << 12);
-    pg_table_entry_t *pg_table_entry = &pg_table[pg_table_index];
-    if (!pg_table_entry->present)
+    return &get_pg_table(pg_dir_index)[pg_table_index];
+}
+
+/**
+ * get_paddr - Get the physical address of a virtual address
+ * @vaddr: Virtual address
+ * @paddr: On success, set to the physical address
+ *
+ * Return: 0 on success, -1 if not mapped
+ */
+int get_paddr(uint32_t vaddr, uint32_t *paddr) {
+    pg_table_entry_t *pg_table_entry = get_pg_table_entry(vaddr);
+    if (!pg_table_entry || !pg_table_entry->present)
         return -1;
 
-    *paddr = (pg_table_entry->address << 12) | (vaddr & 0xFFF);
+    *paddr = ((uint32_t)pg_table_entry->address << 12) | (vaddr & 0xFFF);
     return 0;
 }
 
 /**
- * map - Map one virtual page to a physical frame
+ * flush_remote - smp_call_others() callback dropping a stale translation
+ * @arg: Virtual address
+ *
+ * Return: Nothing
+ */
+static void flush_remote(void *arg) {
+    invalidate_tlb((uint32_t)(uintptr_t)arg);
+}
+
+/**
+ * tlb_shootdown - Invalidate a translation on every online CPU
+ * @vaddr: Virtual address whose PTE lost or changed its frame
+ *
+ * Must be called without pg_lock held, see smp_call_others().
+ * Return: Nothing
+ */
+static void tlb_shootdown(uint32_t vaddr) {
+    invalidate_tlb(vaddr);
+    if (smp_num_online() > 1)
+        smp_call_others(flush_remote, (void *)(uintptr_t)vaddr);
+}
+
+/**
+ * struct tlb_range_t - Range of pages for flush_range()
+ * @vaddr: First page
+ * @num_pages: Number of pages
+ */
+typedef struct {
+    uint32_t vaddr;
+    uint32_t num_pages;
+} tlb_range_t;
+
+/**
+ * flush_range - Drop the translations of a range of pages on this CPU
+ * @arg: tlb_range_t
+ *
+ * Return: Nothing
+ */
+static void flush_range(void *arg) {
+    const tlb_range_t *range = arg;
+
+    if (range->num_pages > TLB_FLUSH_ALL_PAGES) {
+        write_cr3(read_cr3());
+        return;
+    }
+    for (uint32_t i = 0; i < range->num_pages; i++)
+        invalidate_tlb(range->vaddr + i * PAGE_SIZE);
+}
+
+/**
+ * tlb_shootdown_range - Invalidate a range of translations on every online CPU
+ * @vaddr: First page
+ * @num_pages: Number of pages
+ *
+ * One cross-CPU call for the whole range. Must be called without pg_lock held.
+ * Return: Nothing
+ */
+static void tlb_shootdown_range(uint32_t vaddr, uint32_t num_pages) {
+    tlb_range_t range = { .vaddr = vaddr, .num_pages = num_pages };
+
+    flush_range(&range);
+    if (smp_num_online() > 1)
+        smp_call_others(flush_range, &range);
+}
+
+/**
+ * map_locked - Map one virtual page to a physical frame
  * @vaddr: Virtual address (page-aligned)
  * @paddr: Physical address (page-aligned)
- * @flags: PG_FLAG_RW, PG_FLAG_USER, or 0
+ * @flags: PG_FLAG_RW, PG_FLAG_USER, PG_FLAG_NOCACHE, or 0
  *
- * Allocates a page table for the directory entry if needed. Invalidates TLB for @vaddr.
+ * Must be called with pg_lock held. Only a non-present PTE is filled,
+ * so no other CPU can have the page cached and a local invalidation is
+ * enough.
  * Return: 0 on success, -1 on failure
  */
-int map(uint32_t vaddr, uint32_t paddr, uint32_t flags) {
+static int map_locked(uint32_t vaddr, uint32_t paddr, uint32_t flags) {
     if ((vaddr & 0xFFFFF000) != vaddr)
         return -1;
 
@@ -120,27 +251,30 @@ int map(uint32_t vaddr, uint32_t paddr, uint32_t flags) {
 
     uint32_t rw = (flags & PG_FLAG_RW) ? 1 : 0;
     uint32_t user = (flags & PG_FLAG_USER) ? 1 : 0;
+    uint32_t nocache = (flags & PG_FLAG_NOCACHE) ? 1 : 0;
     uint32_t pg_dir_index = (vaddr >> 22) & 0x3FF;
     pg_dir_entry_t *pg_dir_entry = &pg_dir[pg_dir_index];
     if (!pg_dir_entry->present) {
         uint32_t allocated;
         if (fallocate(&allocated) == -1)
             return -1;
-        
-        pg_table_entry_t *new = (pg_table_entry_t *)(uintptr_t)allocated;
-        for (uint32_t i = 0; i < NUM_PAGE_ENTRIES; i++)
-            pg_table_entry_zero(&new[i]);
-        
+
+        /* Permissions are enforced per page, so the directory entry stays writable */
         pg_dir_entry_zero(pg_dir_entry);
         pg_dir_entry->present = 1;
-        pg_dir_entry->rw = rw;
+        pg_dir_entry->rw = 1;
         pg_dir_entry->user = user;
         pg_dir_entry->address = allocated >> 12;
+
+        pg_table_entry_t *new = get_pg_table(pg_dir_index);
+        if (paging_enabled)
+            invalidate_tlb((uint32_t)(uintptr_t)new);
+
+        page_zero(new);
     }
-    
+
     uint32_t pg_table_index = (vaddr >> 12) & 0x3FF;
-    pg_table_entry_t *pg_table = (pg_table_entry_t *)(uintptr_t)(pg_dir_entry->address << 12);
-    pg_table_entry_t *pg_table_entry = &pg_table[pg_table_index];
+    pg_table_entry_t *pg_table_entry = &get_pg_table(pg_dir_index)[pg_table_index];
     if (pg_table_entry->present)
         return -1;
 
@@ -152,36 +286,433 @@ int map(uint32_t vaddr, uint32_t paddr, uint32_t flags) {
     pg_table_entry->present = 1;
     pg_table_entry->rw = rw;
     pg_table_entry->user = user;
+    pg_table_entry->pwt = nocache;
+    pg_table_entry->pcd = nocache;
     pg_table_entry->address = paddr >> 12;
 
     invalidate_tlb(vaddr);
     return 0;
 }
 
+/**
+ * frame_zero - Zero a frame that is not mapped yet
+ * @paddr: Physical address of the frame
+ *
+ * Goes through the executing CPU's scratch page. No other CPU touches
+ * it, so a local invalidation is enough. Must be called with pg_lock held.
+ * Return: Nothing
+ */
+static void frame_zero(uint32_t paddr) {
+    uint32_t scratch = scratch_base + cpu_id() * PAGE_SIZE;
+
+    if (map_locked(scratch, paddr, PG_FLAG_RW) == -1)
+        panic("Error: could not map the scratch page");
+
+    page_zero((void *)(uintptr_t)scratch);
+    pg_table_entry_zero(get_pg_table_entry(scratch));
+    invalidate_tlb(scratch);
+}
+
+/**
+ * map - Map one virtual page to a physical frame
+ * @vaddr: Virtual address (page-aligned)
+ * @paddr: Physical address (page-aligned)
+ * @flags: PG_FLAG_RW, PG_FLAG_USER, PG_FLAG_NOCACHE, or 0
+ *
+ * Allocates a page table for the directory entry if needed. Invalidates TLB for @vaddr.
+ * Return: 0 on success, -1 on failure
+ */
+int map(uint32_t vaddr, uint32_t paddr, uint32_t flags) {
+    uint32_t lock_flags = spin_lock_irqsave(&pg_lock);
+    int ret = map_locked(vaddr, paddr, flags);
+    spin_unlock_irqrestore(&pg_lock, lock_flags);
+    return ret;
+}
+
+/**
+ * protect - Change the permissions of one mapped page
+ * @vaddr: Virtual address (page-aligned)
+ * @flags: PG_FLAG_RW, PG_FLAG_USER, or 0
+ *
+ * Invalidates TLB for @vaddr on every CPU. Must not be called with a spinlock held.
+ * Return: 0 on success, -1 if not mapped
+ */
+int protect(uint32_t vaddr, uint32_t flags) {
+    if ((vaddr & 0xFFFFF000) != vaddr)
+        return -1;
+
+    uint32_t lock_flags = spin_lock_irqsave(&pg_lock);
+    pg_table_entry_t *pg_table_entry = get_pg_table_entry(vaddr);
+    if (!pg_table_entry || !pg_table_entry->present) {
+        spin_unlock_irqrestore(&pg_lock, lock_flags);
+        return -1;
+    }
+
+    pg_table_entry->rw = (flags & PG_FLAG_RW) ? 1 : 0;
+    pg_table_entry->user = (flags & PG_FLAG_USER) ? 1 : 0;
+    spin_unlock_irqrestore(&pg_lock, lock_flags);
+
+    tlb_shootdown(vaddr);
+    return 0;
+}
+
+/**
+ * map_phys - Map a physical range into the kernel MMIO window
+ * @paddr: Physical address (need not be page-aligned)
+ * @size: Size of the range in bytes
+ * @flags: PG_FLAG_RW, PG_FLAG_NOCACHE, or 0
+ *
+ * The window is handed out by a bump pointer, see unmap_phys().
+ * Return: Virtual address corresponding to @paddr, or NULL on failure
+ */
+void *map_phys(uint32_t paddr, uint32_t size, uint32_t flags) {
+    uint64_t start = get_lower_alignment(paddr, PAGE_SIZE);
+    uint64_t end = get_upper_alignment((uint64_t)paddr + size, PAGE_SIZE);
+    uint32_t num_pages = (uint32_t)((end - start) / PAGE_SIZE);
+
+    uint32_t lock_flags = spin_lock_irqsave(&pg_lock);
+    if (num_pages > (ADDR_MMIO_END - mmio_next) / PAGE_SIZE) {
+        spin_unlock_irqrestore(&pg_lock, lock_flags);
+        return NULL;
+    }
+
+    /* Reserve first so a partial failure never hands out the same pages twice */
+    uint32_t vaddr = mmio_next;
+    mmio_next += num_pages * PAGE_SIZE;
+    for (uint32_t i = 0; i < num_pages; i++) {
+        if (map_locked(vaddr + i * PAGE_SIZE, (uint32_t)start + i * PAGE_SIZE, flags & ~PG_FLAG_USER) == -1) {
+            spin_unlock_irqrestore(&pg_lock, lock_flags);
+            return NULL;
+        }
+    }
+    spin_unlock_irqrestore(&pg_lock, lock_flags);
+
+    return (void *)(uintptr_t)(vaddr + (paddr - (uint32_t)start));
+}
+
+/**
+ * unmap_phys - Remove a map_phys() mapping
+ * @vaddr: Address map_phys() returned
+ * @size: Size passed to map_phys()
+ *
+ * The pages go back to the window if nothing was mapped after them, so a
+ * short-lived mapping such as a table header peek costs nothing. Must
+ * not be called with a spinlock held.
+ * Return: Nothing
+ */
+void unmap_phys(const void *vaddr, uint32_t size) {
+    uint32_t start = (uint32_t)get_lower_alignment((uintptr_t)vaddr, PAGE_SIZE);
+    uint32_t end = (uint32_t)get_upper_alignment((uint64_t)(uintptr_t)vaddr + size, PAGE_SIZE);
+
+    for (uint32_t page = start; page < end; page += PAGE_SIZE)
+        unmap(page);
+
+    uint32_t flags = spin_lock_irqsave(&pg_lock);
+    if (end == mmio_next)
+        mmio_next = start;
+    spin_unlock_irqrestore(&pg_lock, flags);
+}
+
 /**
  * unmap - Remove mapping for one virtual page
  * @vaddr: Virtual address (page-aligned)
  *
- * Clears the PTE. Invalidates TLB for @vaddr.
+ * Clears the PTE. Invalidates TLB for @vaddr on every CPU, so the frame
+ * may be freed once this returns. Must not be called with a spinlock held.
  * Return: 0 on success, -1 on failure
  */ 
 int unmap(uint32_t vaddr) {
     if ((vaddr & 0xFFFFF000) != vaddr)
         return -1;
 
-    uint32_t pg_dir_index = (vaddr >> 22) & 0x3FF;
-    pg_dir_entry_t *pg_dir_entry = &pg_dir[pg_dir_index];
-    if (!pg_dir_entry->present)
-        return -1;
-    
-    uint32_t pg_table_index = (vaddr >> 12) & 0x3FF;
-    pg_table_entry_t *pg_table = (pg_table_entry_t *)(uintptr_t)(pg_dir_entry->address << 12);
-    pg_table_entry_t *pg_table_entry = &pg_table[pg_table_index];
-    if (!pg_table_entry->present)
+    uint32_t flags = spin_lock_irqsave(&pg_lock);
+    pg_table_entry_t *pg_table_entry = get_pg_table_entry(vaddr);
+    if (!pg_table_entry || !pg_table_entry->present) {
+        spin_unlock_irqrestore(&pg_lock, flags);
         return -1;
+    }
 
     pg_table_entry_zero(pg_table_entry);
-    invalidate_tlb(vaddr);
+    spin_unlock_irqrestore(&pg_lock, flags);
+
+    tlb_shootdown(vaddr);
+    return 0;
+}
+
+/**
+ * range_check - Check that a range is fully mapped and another fully unmapped
+ * @from: Range that must be mapped (page-aligned)
+ * @to: Range that must not be mapped (page-aligned)
+ * @num_pages: Length of both ranges in pages
+ *
+ * Must be called with pg_lock held.
+ * Return: 0 if both hold, -1 otherwise
+ */
+static int range_check(uint32_t from, uint32_t to, uint32_t num_pages) {
+    if ((from & 0xFFF) || (to & 0xFFF) || num_pages == 0)
+        return -1;
+    if (num_pages > (0xFFFFFFFF - from) / PAGE_SIZE + 1 || num_pages > (0xFFFFFFFF - to) / PAGE_SIZE + 1)
+        return -1;
+
+    for (uint32_t i = 0; i < num_pages; i++) {
+        pg_table_entry_t *src = get_pg_table_entry(from + i * PAGE_SIZE);
+        pg_table_entry_t *dst = get_pg_table_entry(to + i * PAGE_SIZE);
+        if (!src || !src->present || (dst && dst->present))
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * move_pages - Move the frames of a mapped range to another range
+ * @from: Source address (page-aligned), every page mapped
+ * @to: Destination address (page-aligned), no page mapped
+ * @num_pages: Number of pages
+ *
+ * The page table entries move unchanged, permissions included; no data
+ * is copied. TLBs are flushed once for the whole source range. Must not
+ * be called with a spinlock held.
+ * Return: 0 on success, -1 on failure (both ranges are left as they were)
+ */
+int move_pages(uint32_t from, uint32_t to, uint32_t num_pages) {
+    uint32_t lock_flags = spin_lock_irqsave(&pg_lock);
+    if (range_check(from, to, num_pages) == -1) {
+        spin_unlock_irqrestore(&pg_lock, lock_flags);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < num_pages; i++) {
+        pg_table_entry_t *src = get_pg_table_entry(from + i * PAGE_SIZE);
+        uint32_t flags = (src->rw ? PG_FLAG_RW : 0) | (src->user ? PG_FLAG_USER : 0);
+
+        /* map_locked() creates the page table; the entry is then copied whole */
+        if (map_locked(to + i * PAGE_SIZE, (uint32_t)src->address << 12, flags) == -1) {
+            while (i--) {
+                pg_table_entry_t *dst = get_pg_table_entry(to + i * PAGE_SIZE);
+                *get_pg_table_entry(from + i * PAGE_SIZE) = *dst;
+                pg_table_entry_zero(dst);
+                invalidate_tlb(to + i * PAGE_SIZE);
+            }
+            spin_unlock_irqrestore(&pg_lock, lock_flags);
+            tlb_shootdown_range(from, num_pages);
+            return -1;
+        }
+
+        *get_pg_table_entry(to + i * PAGE_SIZE) = *src;
+        pg_table_entry_zero(src);
+    }
+    spin_unlock_irqrestore(&pg_lock, lock_flags);
+
+    tlb_shootdown_range(from, num_pages);
+    return 0;
+}
+
+/**
+ * share_pages - Map the frames of a mapped range at a second range too
+ * @from: Source address (page-aligned), every page mapped
+ * @to: Destination address (page-aligned), no page mapped
+ * @num_pages: Number of pages
+ *
+ * The second mapping is read-only and user-accessible only if the source
+ * is. Frames stay owned by the source; drop the copy with unmap_pages().
+ * Return: 0 on success, -1 on failure (nothing is mapped)
+ */
+int share_pages(uint32_t from, uint32_t to, uint32_t num_pages) {
+    uint32_t lock_flags = spin_lock_irqsave(&pg_lock);
+    if (range_check(from, to, num_pages) == -1) {
+        spin_unlock_irqrestore(&pg_lock, lock_flags);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < num_pages; i++) {
+        pg_table_entry_t *src = get_pg_table_entry(from + i * PAGE_SIZE);
+        if (map_locked(to + i * PAGE_SIZE, (uint32_t)src->address << 12, src->user ? PG_FLAG_USER : 0) == -1) {
+            while (i--)
+                pg_table_entry_zero(get_pg_table_entry(to + i * PAGE_SIZE));
+            spin_unlock_irqrestore(&pg_lock, lock_flags);
+            tlb_shootdown_range(to, num_pages);
+            return -1;
+        }
+    }
+    spin_unlock_irqrestore(&pg_lock, lock_flags);
+    return 0;
+}
+
+/**
+ * unmap_pages - Remove the mappings of a range without freeing the frames
+ * @vaddr: Virtual address (page-aligned)
+ * @num_pages: Number of pages
+ *
+ * Pages that are not mapped are skipped. TLBs are flushed once for the
+ * whole range. Must not be called with a spinlock held.
+ * Return: Nothing
+ */
+void unmap_pages(uint32_t vaddr, uint32_t num_pages) {
+    if ((vaddr & 0xFFF) || num_pages == 0)
+        return;
+
+    uint32_t lock_flags = spin_lock_irqsave(&pg_lock);
+    for (uint32_t i = 0; i < num_pages; i++) {
+        pg_table_entry_t *pg_table_entry = get_pg_table_entry(vaddr + i * PAGE_SIZE);
+        if (pg_table_entry && pg_table_entry->present)
+            pg_table_entry_zero(pg_table_entry);
+    }
+    spin_unlock_irqrestore(&pg_lock, lock_flags);
+
+    tlb_shootdown_range(vaddr, num_pages);
+}
+
+/**
+ * map_anon - Map zero-filled anonymous memory backed by the shared zero frame
+ * @vaddr: Virtual address (page-aligned)
+ * @num_pages: Number of pages to map
+ * @flags: PG_FLAG_RW, PG_FLAG_USER, or 0
+ *
+ * Every page initially maps the zero frame read-only. Writable regions are
+ * tagged with PG_AVL_ZERO so the first write fault swaps in a private frame.
+ * Return: 0 on success, -1 on failure (no pages are left mapped)
+ */
+int map_anon(uint32_t vaddr, uint32_t num_pages, uint32_t flags) {
+    for (uint32_t i = 0; i < num_pages; i++) {
+        uint32_t page = vaddr + i * PAGE_SIZE;
+        uint32_t lock_flags = spin_lock_irqsave(&pg_lock);
+        if (map_locked(page, zero_frame, flags & PG_FLAG_USER) == -1) {
+            spin_unlock_irqrestore(&pg_lock, lock_flags);
+            unmap_anon(vaddr, i);
+            return -1;
+        }
+
+        if (flags & PG_FLAG_RW)
+            get_pg_table_entry(page)->avl |= PG_AVL_ZERO;
+        spin_unlock_irqrestore(&pg_lock, lock_flags);
+    }
+
+    return 0;
+}
+
+/**
+ * unmap_anon - Remove an anonymous mapping created by map_anon()
+ * @vaddr: Virtual address (page-aligned)
+ * @num_pages: Number of pages to unmap
+ *
+ * Frees the private frames of pages that were written to.
+ * Return: Nothing
+ */
+void unmap_anon(uint32_t vaddr, uint32_t num_pages) {
+    for (uint32_t i = 0; i < num_pages; i++) {
+        uint32_t page = vaddr + i * PAGE_SIZE;
+        uint32_t paddr;
+        if (get_paddr(page, &paddr) == -1)
+            continue;
+
+        unmap(page);
+        if (paddr != zero_frame)
+            ffree(paddr);
+    }
+}
+
+/**
+ * page_fault_handler - Handle a page fault (vector 14)
+ * @frame: Pointer to interrupt stack frame
+ *
+ * Resolves write faults on zero-frame mappings by installing a private
+ * zeroed frame, and not-present faults through the registered resolver.
+ * Other faults kill the thread if they came from ring 3 and are fatal otherwise.
+ * Return: Nothing
+ */
+void page_fault_handler(interrupt_frame_t *frame) {
+    uint32_t vaddr;
+    __asm__ volatile ("mov %%cr2, %0" : "=r"(vaddr));
+
+    uint32_t write_to_present = PF_ERR_PRESENT | PF_ERR_WRITE;
+    if ((frame->err_code & write_to_present) == write_to_present) {
+        uint32_t page = vaddr & 0xFFFFF000;
+        uint32_t flags = spin_lock_irqsave(&pg_lock);
+        pg_table_entry_t *pg_table_entry = get_pg_table_entry(vaddr);
+        if (pg_table_entry && pg_table_entry->present && (pg_table_entry->avl & PG_AVL_ZERO)) {
+            uint32_t allocated;
+            if (fallocate(&allocated) == -1)
+                panic("Error: frame allocation failed on zero page write");
+
+            /* Zero before publishing, so no CPU can see the old contents */
+            frame_zero(allocated);
+            pg_table_entry->avl &= ~PG_AVL_ZERO;
+            pg_table_entry->rw = 1;
+            pg_table_entry->address = allocated >> 12;
+            spin_unlock_irqrestore(&pg_lock, flags);
+
+            /* Other CPUs may still read the zero frame through this page */
+            tlb_shootdown(page);
+            return;
+        }
+
+        /* Another CPU resolved the fault first; the fault flushed the stale entry */
+        int resolved = pg_table_entry && pg_table_entry->present && pg_table_entry->rw;
+        spin_unlock_irqrestore(&pg_lock, flags);
+        if (resolved)
+            return;
+    }
+
+    if (!(frame->err_code & PF_ERR_PRESENT) && fault_fn) {
+        /* The resolver may wait for the disk, keep interrupts as the faulting code had them */
+        irq_restore(frame->eflags);
+        int ret = fault_fn(vaddr, frame->err_code);
+        irq_save();
+        if (ret == 0)
+            return;
+    }
+
+    /* A system call handed the kernel a bad user pointer, the caller pays for it */
+    int user_addr = vaddr >= ADDR_USER_START && vaddr < ADDR_USER_END;
+    if ((frame->err_code & PF_ERR_USER) || (user_addr && thread_can_block())) {
+        kprintf("paging: %s faulted at %x (eip %x, err %x), killed\n",
+                thread_current()->name, vaddr, frame->eip, frame->err_code);
+        thread_exit();
+    }
+
+    exception_panic(frame);
+}
+
+/**
+ * user_fault_in - Make sure a user buffer can be accessed from ring 3
+ * @vaddr: Start of the buffer
+ * @len: Bytes
+ *
+ * Pages not loaded yet are filled in by the registered resolver, as if
+ * ring 3 had touched them.
+ * Return: 0 if every page is mapped for ring 3, -1 otherwise
+ */
+int user_fault_in(uint32_t vaddr, uint32_t len) {
+    if (len == 0)
+        return 0;
+    if (vaddr < ADDR_USER_START || vaddr > ADDR_USER_END - len)
+        return -1;
+
+    /* The end cannot wrap, it is at most ADDR_USER_END */
+    for (uint32_t page = vaddr & 0xFFFFF000; page < vaddr + len; page += PAGE_SIZE) {
+        pg_table_entry_t *pg_table_entry = get_pg_table_entry(page);
+        if (pg_table_entry && pg_table_entry->present) {
+            if (!pg_table_entry->user)
+                return -1;
+            continue;
+        }
+        if (!fault_fn || fault_fn(page, PF_ERR_USER) == -1)
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * page_fault_register - Install the resolver for not-present faults
+ * @fn: Resolver
+ *
+ * Return: 0 on success, -1 if one is already installed
+ */
+int page_fault_register(page_fault_fn_t fn) {
+    if (fault_fn)
+        return -1;
+
+    fault_fn = fn;
     return 0;
 }
 
@@ -227,9 +758,8 @@ static void paging_kernel_space(const mmap_t *mmap) {
             panic("Error: frame allocation failed");
 
         pg_table_entry_t *pg_table = (pg_table_entry_t *)(uintptr_t)allocated;
-        for (uint32_t i = 0; i < NUM_PAGE_ENTRIES; i++)
-            pg_table_entry_zero(&pg_table[i]);
-        
+        page_zero(pg_table);
+
         for (uint32_t i = 0; i < NUM_PAGE_ENTRIES && addr < end_aligned; i++) {
             pg_table_entry_t *pg_table_entry = &pg_table[i];
             pg_table_entry->present = 1;
@@ -257,14 +787,32 @@ void paging_init(const mmap_t *mmap) {
     /* Identity map the kernel space */
     paging_kernel_space(mmap);
 
-    /* Load CR3 and enable paging */
+    /* Map the page directory into itself so page tables stay reachable */
+    pg_dir_entry_t *recursive = &pg_dir[PG_RECURSIVE_INDEX];
+    recursive->present = 1;
+    recursive->rw = 1;
+    recursive->address = (uint32_t)(uintptr_t)pg_dir >> 12;
+
+    /* Shared zero frame for anonymous memory */
+    if (fallocate(&zero_frame) == -1)
+        panic("Error: frame allocation failed");
+
+    page_zero((void *)(uintptr_t)zero_frame);
+
+    exception_register(14, page_fault_handler);
+
+    /* Load CR3 and enable paging; CR0.WP makes read-only pages fault in ring 0 too */
     __asm__ volatile (
         "mov %%eax, %%cr3\n"
         "mov %%cr0, %%eax\n"
-        "or $0x80000001, %%eax\n"
+        "or $0x80010001, %%eax\n"
         "mov %%eax, %%cr0\n"
         :
         : "a"(&pg_dir)
         : "memory"
     );
+    paging_enabled = 1;
+
+    scratch_base = mmio_next;
+    mmio_next += MAX_CPUS * PAGE_SIZE;
 }
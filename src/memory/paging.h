@@ -4,6 +4,7 @@
 #include <stdint.h>
 
 #include "mmap.h"
+#include "../interrupts/idt.h"
 
 /**
  * PAGE_SIZE - System page size in bytes
@@ -30,6 +31,86 @@
  */
 #define PG_FLAG_USER            0x02
 
+/**
+ * PG_FLAG_NOCACHE - Disable caching (PCD and PWT), for memory-mapped I/O
+ */
+#define PG_FLAG_NOCACHE         0x04
+
+/**
+ * ADDR_KSTACK_START - Start of the kernel thread stack region
+ */
+#define ADDR_KSTACK_START       0xFF400000
+
+/**
+ * ADDR_KSTACK_END - End (exclusive) of the kernel thread stack region
+ */
+#define ADDR_KSTACK_END         0xFF800000
+
+/**
+ * ADDR_MMIO_START - Start of the kernel window used by map_phys()
+ */
+#define ADDR_MMIO_START         0xFF800000
+
+/**
+ * ADDR_MMIO_END - End (exclusive) of the kernel window used by map_phys()
+ */
+#define ADDR_MMIO_END           0xFFC00000
+
+/**
+ * ADDR_USER_START - Start of the range user programs are loaded into
+ */
+#define ADDR_USER_START         0x08000000
+
+/**
+ * ADDR_USER_END - End (exclusive) of the user program range
+ */
+#define ADDR_USER_END           0xC0000000
+
+/**
+ * PG_RECURSIVE_INDEX - Page directory slot that maps the page directory itself
+ */
+#define PG_RECURSIVE_INDEX      1023
+
+/**
+ * ADDR_PG_TABLES - Virtual address of page table 0 through the recursive slot
+ */
+#define ADDR_PG_TABLES          ((uint32_t)PG_RECURSIVE_INDEX << 22)
+
+/**
+ * PG_AVL_ZERO - PTE avl bit marking a writable page still backed by the zero frame
+ */
+#define PG_AVL_ZERO             0x01
+
+/**
+ * TLB_FLUSH_ALL_PAGES - Above this many pages a shootdown reloads CR3 instead of using invlpg
+ */
+#define TLB_FLUSH_ALL_PAGES     32
+
+/**
+ * PF_ERR_PRESENT - Page fault error code bit: fault on a present page
+ */
+#define PF_ERR_PRESENT          0x01
+
+/**
+ * PF_ERR_WRITE - Page fault error code bit: faulting access was a write
+ */
+#define PF_ERR_WRITE            0x02
+
+/**
+ * PF_ERR_USER - Page fault error code bit: fault happened in ring 3
+ */
+#define PF_ERR_USER             0x04
+
+/**
+ * page_fault_fn_t - Resolver for faults on pages that are not present
+ * @vaddr: Faulting address
+ * @err_code: Page fault error code
+ *
+ * Called with interrupts enabled if the faulting code had them enabled.
+ * Return: 0 if the page is now mapped, -1 if @vaddr is not the resolver's
+ */
+typedef int (*page_fault_fn_t)(uint32_t vaddr, uint32_t err_code);
+
 /**
  * struct pg_dir_entry_t - Page directory entry structure
  * @present: Present bit
@@ -97,13 +178,45 @@ int get_paddr(uint32_t vaddr, uint32_t *paddr);
  * map - Map one virtual page to a physical frame
  * @vaddr: Virtual address (page-aligned)
  * @paddr: Physical address (page-aligned)
- * @flags: PG_FLAG_RW, PG_FLAG_USER, or 0
+ * @flags: PG_FLAG_RW, PG_FLAG_USER, PG_FLAG_NOCACHE, or 0
  *
  * Allocates a page table for the directory entry if needed. Invalidates TLB for @vaddr.
  * Return: 0 on success, -1 on failure
  */
 int map(uint32_t vaddr, uint32_t paddr, uint32_t flags);
 
+/**
+ * protect - Change the permissions of one mapped page
+ * @vaddr: Virtual address (page-aligned)
+ * @flags: PG_FLAG_RW, PG_FLAG_USER, or 0
+ *
+ * Invalidates TLB for @vaddr on every CPU. Must not be called with a spinlock held.
+ * Return: 0 on success, -1 if not mapped
+ */
+int protect(uint32_t vaddr, uint32_t flags);
+
+/**
+ * map_phys - Map a physical range into the kernel MMIO window
+ * @paddr: Physical address (need not be page-aligned)
+ * @size: Size of the range in bytes
+ * @flags: PG_FLAG_RW, PG_FLAG_NOCACHE, or 0
+ *
+ * The window is handed out by a bump pointer, see unmap_phys().
+ * Return: Virtual address corresponding to @paddr, or NULL on failure
+ */
+void *map_phys(uint32_t paddr, uint32_t size, uint32_t flags);
+
+/**
+ * unmap_phys - Remove a map_phys() mapping
+ * @vaddr: Address map_phys() returned
+ * @size: Size passed to map_phys()
+ *
+ * The pages go back to the window only if nothing was mapped after
+ * them. Must not be called with a spinlock held.
+ * Return: Nothing
+ */
+void unmap_phys(const void *vaddr, uint32_t size);
+
 /**
  * unmap - Remove mapping for one virtual page
  * @vaddr: Virtual address (page-aligned)
@@ -113,6 +226,91 @@ int map(uint32_t vaddr, uint32_t paddr, uint32_t flags);
  */ 
 int unmap(uint32_t vaddr);
 
+/**
+ * move_pages - Move the frames of a mapped range to another range
+ * @from: Source address (page-aligned), every page mapped
+ * @to: Destination address (page-aligned), no page mapped
+ * @num_pages: Number of pages
+ *
+ * The page table entries move unchanged, permissions included; no data
+ * is copied. TLBs are flushed once for the whole source range. Must not
+ * be called with a spinlock held.
+ * Return: 0 on success, -1 on failure (both ranges are left as they were)
+ */
+int move_pages(uint32_t from, uint32_t to, uint32_t num_pages);
+
+/**
+ * share_pages - Map the frames of a mapped range at a second range too
+ * @from: Source address (page-aligned), every page mapped
+ * @to: Destination address (page-aligned), no page mapped
+ * @num_pages: Number of pages
+ *
+ * The second mapping is read-only and user-accessible only if the source
+ * is. Frames stay owned by the source; drop the copy with unmap_pages().
+ * Return: 0 on success, -1 on failure (nothing is mapped)
+ */
+int share_pages(uint32_t from, uint32_t to, uint32_t num_pages);
+
+/**
+ * unmap_pages - Remove the mappings of a range without freeing the frames
+ * @vaddr: Virtual address (page-aligned)
+ * @num_pages: Number of pages
+ *
+ * Pages that are not mapped are skipped. TLBs are flushed once for the
+ * whole range. Must not be called with a spinlock held.
+ * Return: Nothing
+ */
+void unmap_pages(uint32_t vaddr, uint32_t num_pages);
+
+/**
+ * map_anon - Map zero-filled anonymous memory backed by the shared zero frame
+ * @vaddr: Virtual address (page-aligned)
+ * @num_pages: Number of pages to map
+ * @flags: PG_FLAG_RW, PG_FLAG_USER, or 0
+ *
+ * Pages cost no frame until their first write.
+ * Return: 0 on success, -1 on failure
+ */
+int map_anon(uint32_t vaddr, uint32_t num_pages, uint32_t flags);
+
+/**
+ * unmap_anon - Remove an anonymous mapping created by map_anon()
+ * @vaddr: Virtual address (page-aligned)
+ * @num_pages: Number of pages to unmap
+ *
+ * Return: Nothing
+ */
+void unmap_anon(uint32_t vaddr, uint32_t num_pages);
+
+/**
+ * page_fault_handler - Handle a page fault (vector 14)
+ * @frame: Pointer to interrupt stack frame
+ *
+ * Return: Nothing
+ */
+void page_fault_handler(interrupt_frame_t *frame);
+
+/**
+ * user_fault_in - Make sure a user buffer can be accessed from ring 3
+ * @vaddr: Start of the buffer
+ * @len: Bytes
+ *
+ * For system calls, before they touch a buffer ring 3 passed in. Pages
+ * not loaded yet are filled in by the registered resolver. A kernel
+ * fault on a user address still kills the calling thread rather than
+ * the kernel, should the buffer go away meanwhile.
+ * Return: 0 if every page is mapped for ring 3, -1 otherwise
+ */
+int user_fault_in(uint32_t vaddr, uint32_t len);
+
+/**
+ * page_fault_register - Install the resolver for not-present faults
+ * @fn: Resolver
+ *
+ * Return: 0 on success, -1 if one is already installed
+ */
+int page_fault_register(page_fault_fn_t fn);
+
 /**
  * invalidate_tlb - Invalidate TLB entry for one virtual address
  * @vaddr: Virtual address
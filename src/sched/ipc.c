@@ -0,0 +1,283 @@
+#include <stddef.h>
+
+#include "ipc.h"
+#include "../lib/printf.h"
+#include "../memory/falloc.h"
+#include "../memory/paging.h"
+#include "../time/clockevent.h"
+#include "../time/clocksource.h"
+#include "../utils.h"
+
+/**
+ * IPC_BENCH_WINDOW_PAGES - Size of each benchmark window in pages
+ */
+#define IPC_BENCH_WINDOW_PAGES  (IPC_BENCH_MAX_SIZE / PAGE_SIZE)
+
+/**
+ * ping_port - Benchmark messages towards the pong thread
+ */
+static ipc_port_t ping_port;
+
+/**
+ * pong_port - Benchmark replies towards the benchmark thread
+ */
+static ipc_port_t pong_port;
+
+/**
+ * bench_thread - Thread that runs the benchmark when woken
+ */
+static thread_t *bench_thread;
+
+/**
+ * ipc_transfer - Hand a message over from a sender to a receiver
+ * @from: Sender's message
+ * @to: Receiver's buffer
+ * @window: Receiver's window
+ * @window_pages: Size of @window in pages
+ *
+ * Return: 0 on success, -1 if the pages could not be mapped in @window
+ */
+static int ipc_transfer(const ipc_msg_t *from, ipc_msg_t *to, uint32_t window, uint32_t window_pages) {
+    for (uint32_t i = 0; i < IPC_MSG_WORDS; i++)
+        to->words[i] = from->words[i];
+    to->addr = 0;
+    to->num_pages = 0;
+    to->flags = from->flags;
+
+    if (!from->num_pages)
+        return 0;
+    if (from->num_pages > window_pages)
+        return -1;
+
+    int ret = (from->flags & IPC_MSG_SHARE) ? share_pages(from->addr, window, from->num_pages)
+                                           : move_pages(from->addr, window, from->num_pages);
+    if (ret == -1)
+        return -1;
+
+    to->addr = window;
+    to->num_pages = from->num_pages;
+    return 0;
+}
+
+/**
+ * ipc_complete - Finish a blocked waiter's side of a rendezvous
+ * @waiter: Waiter taken off its port's queue
+ * @status: Result to return to it
+ *
+ * Return: Nothing
+ */
+static void ipc_complete(ipc_waiter_t *waiter, int status) {
+    thread_t *thread = waiter->thread;
+
+    /* The waiter lives on the blocked thread's stack until the wake-up */
+    waiter->status = status;
+    thread_wake(thread);
+}
+
+/**
+ * ipc_block - Queue the current thread on a port and sleep until completed
+ * @port: Port, locked by the caller with spin_lock_irqsave()
+ * @queue: Port queue to join
+ * @self: Waiter on the caller's stack, @msg and the window filled in
+ * @flags: EFLAGS returned by spin_lock_irqsave()
+ *
+ * Return: Status set by the thread that completed the rendezvous
+ */
+static int ipc_block(ipc_port_t *port, ipc_waiter_t **queue, ipc_waiter_t *self, uint32_t flags) {
+    self->thread = thread_current();
+    self->status = -1;
+    self->next = NULL;
+    while (*queue)
+        queue = &(*queue)->next;
+    *queue = self;
+
+    /* Blocked before the lock is dropped, so an early wake-up is not lost */
+    self->thread->state = THREAD_BLOCKED;
+    spin_unlock(&port->lock);
+    schedule();
+    irq_restore(flags);
+    return self->status;
+}
+
+void ipc_port_init(ipc_port_t *port, const char *name) {
+    spin_lock_init(&port->lock, name);
+    port->senders = NULL;
+    port->receivers = NULL;
+}
+
+int ipc_send(ipc_port_t *port, const ipc_msg_t *msg) {
+    uint32_t flags = spin_lock_irqsave(&port->lock);
+    ipc_waiter_t *receiver = port->receivers;
+
+    if (receiver) {
+        port->receivers = receiver->next;
+        spin_unlock_irqrestore(&port->lock, flags);
+
+        int ret = ipc_transfer(msg, receiver->msg, receiver->window, receiver->window_pages);
+        ipc_complete(receiver, ret);
+        return ret;
+    }
+
+    ipc_waiter_t self = { .msg = (ipc_msg_t *)msg };
+    return ipc_block(port, &port->senders, &self, flags);
+}
+
+int ipc_recv(ipc_port_t *port, ipc_msg_t *msg, uint32_t window, uint32_t window_pages) {
+    uint32_t flags = spin_lock_irqsave(&port->lock);
+    ipc_waiter_t *sender = port->senders;
+
+    if (sender) {
+        port->senders = sender->next;
+        spin_unlock_irqrestore(&port->lock, flags);
+
+        int ret = ipc_transfer(sender->msg, msg, window, window_pages);
+        ipc_complete(sender, ret);
+        return ret;
+    }
+
+    ipc_waiter_t self = { .msg = msg, .window = window, .window_pages = window_pages };
+    return ipc_block(port, &port->receivers, &self, flags);
+}
+
+/**
+ * pong_run - Benchmark partner: bounce every message back
+ * @arg: Unused
+ *
+ * Increments the first inline word and the first word of the pages so
+ * the benchmark can check what came back.
+ * Return: Does not return
+ */
+static void pong_run(void *arg) {
+    ipc_msg_t msg;
+    (void)arg;
+
+    while (1) {
+        if (ipc_recv(&ping_port, &msg, IPC_BENCH_PONG_ADDR, IPC_BENCH_WINDOW_PAGES) == -1)
+            continue;
+
+        msg.words[0]++;
+        if (msg.num_pages)
+            (*(volatile uint32_t *)(uintptr_t)msg.addr)++;
+        ipc_send(&pong_port, &msg);
+    }
+}
+
+/**
+ * bench_free - Unmap and free the benchmark buffer
+ * @num_pages: Pages mapped at IPC_BENCH_PING_ADDR
+ *
+ * Return: Nothing
+ */
+static void bench_free(uint32_t num_pages) {
+    for (uint32_t i = 0; i < num_pages; i++) {
+        uint32_t page = IPC_BENCH_PING_ADDR + i * PAGE_SIZE;
+        uint32_t paddr;
+        if (get_paddr(page, &paddr) == -1)
+            continue;
+
+        unmap(page);
+        ffree(paddr);
+    }
+}
+
+/**
+ * bench_alloc - Back the benchmark buffer with frames
+ * @num_pages: Pages to map at IPC_BENCH_PING_ADDR
+ *
+ * Return: 0 on success, -1 on failure (nothing is left mapped)
+ */
+static int bench_alloc(uint32_t num_pages) {
+    for (uint32_t i = 0; i < num_pages; i++) {
+        uint32_t frame;
+        if (fallocate(&frame) == -1) {
+            bench_free(i);
+            return -1;
+        }
+        if (map(IPC_BENCH_PING_ADDR + i * PAGE_SIZE, frame, PG_FLAG_RW) == -1) {
+            ffree(frame);
+            bench_free(i);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * bench_size - Ping-pong messages of one size and print the results
+ * @size: Message size in bytes
+ *
+ * Messages that fit the inline words carry no pages.
+ * Return: Nothing
+ */
+static void bench_size(uint32_t size) {
+    volatile uint32_t *buf = (volatile uint32_t *)(uintptr_t)IPC_BENCH_PING_ADDR;
+    uint32_t num_pages = size <= sizeof(((ipc_msg_t *)0)->words) ? 0 : (size + PAGE_SIZE - 1) / PAGE_SIZE;
+    uint32_t rounds = IPC_BENCH_BYTES / size;
+    uint32_t errors = 0;
+    ipc_msg_t msg = { 0 };
+    ipc_msg_t reply;
+
+    if (rounds > IPC_BENCH_MAX_ROUNDS)
+        rounds = IPC_BENCH_MAX_ROUNDS;
+    if (num_pages && bench_alloc(num_pages) == -1) {
+        kprintf("ipcbench: %u bytes: out of memory\n", size);
+        return;
+    }
+
+    uint64_t start = clock_monotonic_ns();
+    for (uint32_t round = 0; round < rounds; round++) {
+        msg.words[0] = round;
+        msg.addr = IPC_BENCH_PING_ADDR;
+        msg.num_pages = num_pages;
+        if (num_pages)
+            *buf = round;
+
+        if (ipc_send(&ping_port, &msg) == -1 ||
+            ipc_recv(&pong_port, &reply, IPC_BENCH_PING_ADDR, num_pages) == -1) {
+            errors++;
+            break;
+        }
+        if (reply.words[0] != round + 1 || (num_pages && *buf != round + 1))
+            errors++;
+    }
+    uint64_t ns = clock_monotonic_ns() - start;
+    if (!ns)
+        ns = 1;
+
+    kprintf("ipcbench: %u bytes: %llu ns one-way, %llu MB/s%s\n", size,
+            ns / (2 * (uint64_t)rounds), 2 * (uint64_t)size * rounds * 1000 / ns,
+            errors ? " (errors)" : "");
+
+    bench_free(num_pages);
+}
+
+/**
+ * bench_run - Benchmark thread
+ * @arg: Unused
+ *
+ * Return: Does not return
+ */
+static void bench_run(void *arg) {
+    (void)arg;
+
+    while (1) {
+        thread_block();
+
+        for (uint32_t size = IPC_BENCH_MIN_SIZE; size <= IPC_BENCH_MAX_SIZE; size *= 16)
+            bench_size(size);
+    }
+}
+
+void ipc_init(void) {
+    ipc_port_init(&ping_port, "ipc_port");
+    ipc_port_init(&pong_port, "ipc_port");
+
+    bench_thread = thread_create("ipcbench", bench_run, NULL, SCHED_DEFAULT_PRIORITY);
+    if (!bench_thread || !thread_create("ipcbench-pong", pong_run, NULL, SCHED_DEFAULT_PRIORITY))
+        panic("Error: could not start IPC benchmark threads");
+}
+
+void ipc_bench(void) {
+    if (bench_thread)
+        thread_wake(bench_thread);
+}
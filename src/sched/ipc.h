@@ -0,0 +1,153 @@
+#ifndef IPC_H
+#define IPC_H
+
+#include <stdint.h>
+
+#include "sched.h"
+#include "../cpu/spinlock.h"
+
+/**
+ * IPC_MSG_WORDS - Words of a message carried inline, like register arguments
+ */
+#define IPC_MSG_WORDS           4
+
+/**
+ * IPC_MSG_SHARE - Message flag: share the pages read-only instead of moving them
+ */
+#define IPC_MSG_SHARE           0x1
+
+/**
+ * IPC_BENCH_SCANCODE - F5 make code, runs the IPC ping-pong benchmark
+ */
+#define IPC_BENCH_SCANCODE      0x3F
+
+/**
+ * IPC_BENCH_MIN_SIZE - Smallest benchmark message, fits in the inline words
+ */
+#define IPC_BENCH_MIN_SIZE      16
+
+/**
+ * IPC_BENCH_MAX_SIZE - Largest benchmark message (16 MiB)
+ */
+#define IPC_BENCH_MAX_SIZE      0x1000000
+
+/**
+ * IPC_BENCH_BYTES - Bytes moved per message size, bounds the round count
+ */
+#define IPC_BENCH_BYTES         0x10000000
+
+/**
+ * IPC_BENCH_MAX_ROUNDS - Round trips per message size at most
+ */
+#define IPC_BENCH_MAX_ROUNDS    10000
+
+/**
+ * IPC_BENCH_PING_ADDR - Kernel window of the benchmark's pinging side
+ */
+#define IPC_BENCH_PING_ADDR     0xD0000000
+
+/**
+ * IPC_BENCH_PONG_ADDR - Kernel window of the benchmark's ponging side
+ */
+#define IPC_BENCH_PONG_ADDR     0xD2000000
+
+/**
+ * struct ipc_msg_t - A message
+ * @words: Inline payload, copied; enough for small messages
+ * @addr: Sender: first page to transfer. Receiver: where the pages landed
+ * @num_pages: Pages to transfer, 0 for an inline-only message
+ * @flags: IPC_MSG_SHARE, or 0 to move the pages
+ *
+ * Pages are never copied. Moved pages leave the sender's range and
+ * appear in the receiver's window; shared ones appear read-only in the
+ * window and stay with the sender.
+ */
+typedef struct {
+    uint32_t words[IPC_MSG_WORDS];
+    uint32_t addr;
+    uint32_t num_pages;
+    uint32_t flags;
+} ipc_msg_t;
+
+/**
+ * struct ipc_waiter_t - A thread blocked on a port
+ * @thread: Blocked thread
+ * @msg: Message to send, or buffer to receive into
+ * @window: Receiver: page-aligned address for incoming pages
+ * @window_pages: Receiver: size of @window in pages
+ * @status: 0 once the rendezvous completed, -1 if it failed
+ * @next: Next waiter on the same port
+ */
+typedef struct ipc_waiter_t {
+    thread_t *thread;
+    ipc_msg_t *msg;
+    uint32_t window;
+    uint32_t window_pages;
+    volatile int status;
+    struct ipc_waiter_t *next;
+} ipc_waiter_t;
+
+/**
+ * struct ipc_port_t - Rendezvous point between senders and receivers
+ * @lock: Protects the queues
+ * @senders: Senders waiting for a receiver, oldest first
+ * @receivers: Receivers waiting for a sender, oldest first
+ *
+ * Transfers are synchronous: whichever side arrives second moves the
+ * message and wakes the other, so no message is ever buffered.
+ */
+typedef struct {
+    spinlock_t lock;
+    ipc_waiter_t *senders;
+    ipc_waiter_t *receivers;
+} ipc_port_t;
+
+/**
+ * ipc_port_init - Initialize a port with no waiters
+ * @port: Port
+ * @name: Lock class name
+ *
+ * Return: Nothing
+ */
+void ipc_port_init(ipc_port_t *port, const char *name);
+
+/**
+ * ipc_send - Send a message, blocking until a receiver takes it
+ * @port: Port
+ * @msg: Message; its pages must be mapped
+ *
+ * Return: 0 on success, -1 if the receiver's window could not take the
+ * pages (the sender keeps them)
+ */
+int ipc_send(ipc_port_t *port, const ipc_msg_t *msg);
+
+/**
+ * ipc_recv - Receive a message, blocking until one is sent
+ * @port: Port
+ * @msg: Filled in with the message
+ * @window: Page-aligned address for incoming pages, unmapped
+ * @window_pages: Size of @window in pages
+ *
+ * Return: 0 on success, -1 if the message's pages did not fit @window
+ */
+int ipc_recv(ipc_port_t *port, ipc_msg_t *msg, uint32_t window, uint32_t window_pages);
+
+/**
+ * ipc_init - Start the benchmark threads
+ *
+ * Return: Nothing
+ */
+void ipc_init(void);
+
+/**
+ * ipc_bench - Wake the benchmark thread
+ *
+ * Ping-pongs messages of IPC_BENCH_MIN_SIZE to IPC_BENCH_MAX_SIZE bytes
+ * between two threads and prints the one-way latency and the bandwidth
+ * for each size to the debug console.
+ *
+ * Return: Nothing
+ */
+void ipc_bench(void);
+
+#endif
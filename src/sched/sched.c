@@ -0,0 +1,450 @@
+#include <stddef.h>
+
+#include "sched.h"
+#include "task.h"
+#include "../cpu/gdt.h"
+#include "../cpu/smp.h"
+#include "../interrupts/softirq.h"
+#include "../memory/falloc.h"
+#include "../time/clocksource.h"
+#include "../utils.h"
+
+/**
+ * threads - Thread pool; slot n owns stack slot n
+ */
+static thread_t threads[MAX_THREADS];
+
+/**
+ * runqueues - Per-CPU scheduler state
+ */
+static runqueue_t runqueues[MAX_CPUS] = {
+    [0 ... MAX_CPUS - 1] = { .lock = SPINLOCK_INIT("runqueue") },
+};
+
+/**
+ * next_id - Next thread id
+ */
+static uint32_t next_id;
+
+/**
+ * pool_lock - Protects slot allocation in threads and next_id
+ */
+static spinlock_t pool_lock = SPINLOCK_INIT("thread_pool");
+
+/**
+ * enqueue - Append a thread to its priority queue
+ * @rq: Run queue
+ * @thread: Ready thread
+ *
+ * Must be called with @rq locked.
+ * Return: Nothing
+ */
+static void enqueue(runqueue_t *rq, thread_t *thread) {
+    uint32_t prio = thread->priority;
+
+    thread->next = NULL;
+    if (rq->queues[prio].tail)
+        rq->queues[prio].tail->next = thread;
+    else
+        rq->queues[prio].head = thread;
+    rq->queues[prio].tail = thread;
+    rq->bitmap |= 1U << prio;
+}
+
+/**
+ * pick_next - Remove the highest-priority ready thread
+ * @rq: Run queue
+ *
+ * O(1): one bit scan finds the level, the queue head is the thread.
+ * Must be called with @rq locked.
+ * Return: Thread, or NULL if none is ready
+ */
+static thread_t *pick_next(runqueue_t *rq) {
+    if (!rq->bitmap)
+        return NULL;
+
+    uint32_t prio = __builtin_ctz(rq->bitmap);
+    thread_t *thread = rq->queues[prio].head;
+
+    rq->queues[prio].head = thread->next;
+    if (!thread->next) {
+        rq->queues[prio].tail = NULL;
+        rq->bitmap &= ~(1U << prio);
+    }
+    thread->next = NULL;
+    return thread;
+}
+
+/**
+ * slice_expired - End of the current thread's time slice
+ * @timer: Run queue slice timer
+ *
+ * Return: Nothing
+ */
+static void slice_expired(hrtimer_t *timer) {
+    runqueue_t *rq = timer->arg;
+    rq->need_resched = 1;
+}
+
+/**
+ * stack_free - Unmap a thread stack and release its frames
+ * @thread: Thread that owns the stack
+ *
+ * Return: Nothing
+ */
+static void stack_free(thread_t *thread) {
+    uint32_t base = thread->stack_top - THREAD_STACK_PAGES * PAGE_SIZE;
+
+    for (uint32_t page = base; page < thread->stack_top; page += PAGE_SIZE) {
+        uint32_t paddr;
+        if (get_paddr(page, &paddr) == 0) {
+            unmap(page);
+            ffree(paddr);
+        }
+    }
+}
+
+/**
+ * stack_alloc - Map a thread's stack at the top of its slot
+ * @thread: Thread from the pool
+ *
+ * Return: 0 on success, -1 if out of memory
+ */
+static int stack_alloc(thread_t *thread) {
+    uint32_t slot = (uint32_t)(thread - threads);
+    uint32_t top = ADDR_KSTACK_START + (slot + 1) * THREAD_SLOT_SIZE;
+
+    thread->stack_top = top;
+    for (uint32_t page = top - THREAD_STACK_PAGES * PAGE_SIZE; page < top; page += PAGE_SIZE) {
+        uint32_t paddr;
+        if (fallocate(&paddr) == -1 || map(page, paddr, PG_FLAG_RW) == -1) {
+            stack_free(thread);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * finish_switch - Clean up after switching away from a thread
+ *
+ * Runs on the new thread's stack, so an exited thread's stack can go.
+ * No lock is held here, as unmapping the stack waits for other CPUs.
+ * Return: Nothing
+ */
+static void finish_switch(void) {
+    runqueue_t *rq = &runqueues[cpu_id()];
+    thread_t *dead = rq->dead;
+
+    if (dead && dead != rq->current) {
+        rq->dead = NULL;
+        stack_free(dead);
+        fpu_release(&dead->fpu);
+        dead->state = THREAD_UNUSED;
+    }
+}
+
+/**
+ * thread_bootstrap - First code a new thread runs
+ *
+ * Reached through the return address switch_context() pops, with
+ * interrupts still disabled from schedule().
+ * Return: Does not return
+ */
+static void thread_bootstrap(void) {
+    finish_switch();
+    __asm__ volatile ("sti");
+
+    thread_t *self = thread_current();
+    self->entry(self->arg);
+    thread_exit();
+}
+
+void schedule(void) {
+    uint32_t flags = irq_save();
+    runqueue_t *rq = &runqueues[cpu_id()];
+    spin_lock(&rq->lock);
+    thread_t *prev = rq->current;
+
+    rq->need_resched = 0;
+    if (prev->state == THREAD_RUNNING && prev != rq->idle) {
+        prev->state = THREAD_READY;
+        enqueue(rq, prev);
+    }
+
+    thread_t *next = pick_next(rq);
+    if (!next)
+        next = rq->idle;
+
+    next->state = THREAD_RUNNING;
+    if (next == prev) {
+        spin_unlock(&rq->lock);
+        irq_restore(flags);
+        return;
+    }
+
+    uint64_t now = clock_monotonic_ns();
+    prev->runtime_ns += now - prev->switched_in_ns;
+    next->switched_in_ns = now;
+    rq->current = next;
+    rq->switches++;
+
+    /* Only this CPU dequeues, so prev cannot run elsewhere before the switch */
+    spin_unlock(&rq->lock);
+    fpu_switch(&next->fpu);
+
+    /* The idle thread runs until something wakes up, no slice needed */
+    if (next == rq->idle)
+        hrtimer_cancel(&rq->slice_timer);
+    else
+        hrtimer_start(&rq->slice_timer, now + SCHED_SLICE_NS);
+
+    /* Interrupts and SYSENTER from ring 3 land on the next thread's stack */
+    if (next->stack_top)
+        tss_set_esp0(next->stack_top);
+
+    switch_context(&prev->esp, next->esp);
+    finish_switch();
+    irq_restore(flags);
+}
+
+/**
+ * wake_timer_expired - End of a thread_sleep_ns()
+ * @timer: Sleeping thread's wake timer
+ *
+ * Return: Nothing
+ */
+static void wake_timer_expired(hrtimer_t *timer) {
+    thread_wake(timer->arg);
+}
+
+/**
+ * thread_alloc - Claim a free slot of the thread pool
+ *
+ * Return: Thread in THREAD_BLOCKED state with a fresh id, or NULL
+ */
+static thread_t *thread_alloc(void) {
+    thread_t *thread = NULL;
+
+    uint32_t flags = spin_lock_irqsave(&pool_lock);
+    for (int i = 0; i < MAX_THREADS; i++) {
+        if (threads[i].state == THREAD_UNUSED) {
+            thread = &threads[i];
+            thread->state = THREAD_BLOCKED;
+            thread->id = next_id++;
+#ifdef LOCKDEP
+            thread->held_locks.depth = 0;
+#endif
+            break;
+        }
+    }
+    spin_unlock_irqrestore(&pool_lock, flags);
+    return thread;
+}
+
+/**
+ * pick_cpu - Choose the run queue of a new thread
+ *
+ * Return: Online CPU with the fewest threads, preferring the executing one
+ */
+static uint32_t pick_cpu(void) {
+    uint32_t online = smp_online_mask();
+    uint32_t best = cpu_id();
+
+    for (uint32_t cpu = 0; cpu < MAX_CPUS; cpu++) {
+        if ((online & (1U << cpu)) && runqueues[cpu].nr_threads < runqueues[best].nr_threads)
+            best = cpu;
+    }
+    return best;
+}
+
+thread_t *thread_create(const char *name, void (*entry)(void *arg), void *arg, uint32_t priority) {
+    if (priority >= SCHED_PRIORITIES)
+        return NULL;
+
+    thread_t *thread = thread_alloc();
+    if (!thread)
+        return NULL;
+
+    if (stack_alloc(thread) == -1) {
+        thread->state = THREAD_UNUSED;
+        return NULL;
+    }
+
+    thread->name = name;
+    thread->priority = priority;
+    thread->entry = entry;
+    thread->arg = arg;
+    thread->next = NULL;
+    thread->runtime_ns = 0;
+    fpu_state_init(&thread->fpu);
+    hrtimer_init(&thread->wake_timer, wake_timer_expired, thread);
+
+    /* Frame popped by switch_context(): edi, esi, ebx, ebp, return address */
+    uint32_t *sp = (uint32_t *)thread->stack_top;
+    *--sp = 0;                              /* Fake return address ends backtraces */
+    *--sp = (uint32_t)(uintptr_t)thread_bootstrap;
+    *--sp = 0;                              /* ebp */
+    *--sp = 0;                              /* ebx */
+    *--sp = 0;                              /* esi */
+    *--sp = 0;                              /* edi */
+    thread->esp = (uint32_t)(uintptr_t)sp;
+
+    thread->cpu = pick_cpu();
+    __atomic_add_fetch(&runqueues[thread->cpu].nr_threads, 1, __ATOMIC_RELAXED);
+    thread_wake(thread);
+    return thread;
+}
+
+thread_t *thread_current(void) {
+    return runqueues[cpu_id()].current;
+}
+
+int thread_can_block(void) {
+    runqueue_t *rq = &runqueues[cpu_id()];
+    return rq->current && rq->current != rq->idle;
+}
+
+void thread_yield(void) {
+    schedule();
+}
+
+void thread_block(void) {
+    uint32_t flags = irq_save();
+    thread_current()->state = THREAD_BLOCKED;
+    schedule();
+    irq_restore(flags);
+}
+
+void thread_wake(thread_t *thread) {
+    runqueue_t *rq = &runqueues[thread->cpu];
+    int kick = 0;
+
+    uint32_t flags = spin_lock_irqsave(&rq->lock);
+    if (thread->state == THREAD_BLOCKED) {
+        thread->state = THREAD_READY;
+        enqueue(rq, thread);
+
+        /* Lower number is more urgent; idle loses to everything */
+        if (rq->current == rq->idle || thread->priority < rq->current->priority) {
+            rq->need_resched = 1;
+            kick = thread->cpu != cpu_id();
+        }
+    }
+    spin_unlock_irqrestore(&rq->lock, flags);
+
+    if (kick)
+        smp_send_resched(thread->cpu);
+}
+
+void thread_sleep_ns(uint64_t ns) {
+    thread_t *self = thread_current();
+    uint32_t flags = irq_save();
+
+    hrtimer_start(&self->wake_timer, clock_monotonic_ns() + ns);
+    self->state = THREAD_BLOCKED;
+    schedule();
+    irq_restore(flags);
+}
+
+void thread_exit(void) {
+    __asm__ volatile ("cli");
+    runqueue_t *rq = &runqueues[cpu_id()];
+    thread_t *self = rq->current;
+
+    if (self == rq->idle)
+        panic("Error: idle thread exited");
+
+    hrtimer_cancel(&self->wake_timer);
+    self->state = THREAD_DEAD;
+    rq->dead = self;
+    __atomic_sub_fetch(&rq->nr_threads, 1, __ATOMIC_RELAXED);
+    schedule();
+
+    /* Dead threads are never picked again */
+    while (1);
+}
+
+int sched_need_resched(void) {
+    return runqueues[cpu_id()].need_resched;
+}
+
+runqueue_t *sched_get_runqueue(uint32_t cpu) {
+    return &runqueues[cpu];
+}
+
+/**
+ * idle_setup - Fill in the fields of an idle thread
+ * @idle: Thread from the pool
+ *
+ * Return: Nothing
+ */
+static void idle_setup(thread_t *idle) {
+    idle->name = "idle";
+    idle->priority = SCHED_PRIORITIES - 1;
+    idle->next = NULL;
+    idle->runtime_ns = 0;
+    fpu_state_init(&idle->fpu);
+}
+
+thread_t *sched_create_idle(void) {
+    thread_t *idle = thread_alloc();
+    if (!idle)
+        return NULL;
+
+    if (stack_alloc(idle) == -1) {
+        idle->state = THREAD_UNUSED;
+        return NULL;
+    }
+
+    idle_setup(idle);
+    return idle;
+}
+
+void sched_init_cpu(thread_t *idle) {
+    uint32_t flags = irq_save();
+    runqueue_t *rq = &runqueues[cpu_id()];
+
+    idle->cpu = cpu_id();
+    idle->state = THREAD_RUNNING;
+    idle->switched_in_ns = clock_monotonic_ns();
+    fpu_switch(&idle->fpu);
+
+    rq->idle = idle;
+    rq->current = idle;
+    hrtimer_init(&rq->slice_timer, slice_expired, rq);
+    irq_restore(flags);
+}
+
+void sched_init(void) {
+    thread_t *idle = &threads[0];
+
+    /* The boot context keeps its stack and becomes the idle thread */
+    idle->id = next_id++;
+    idle->stack_top = 0;
+    idle_setup(idle);
+    sched_init_cpu(idle);
+}
+
+void sched_idle(void) {
+    task_t *task;
+
+    while (1) {
+        /* Drain deferred work, run ready threads, help with tasks, or sleep until the next interrupt */
+        __asm__ volatile ("cli");
+        if (softirq_pending()) {
+            softirq_run();
+            __asm__ volatile ("sti");
+        } else if (sched_need_resched()) {
+            task_idle_exit();
+            schedule();
+            __asm__ volatile ("sti");
+        } else if ((task = task_steal_idle())) {
+            __asm__ volatile ("sti");
+            task_run(task);
+        } else {
+            /* sti takes effect after hlt, so no wakeup is lost */
+            __asm__ volatile ("sti; hlt");
+        }
+    }
+}
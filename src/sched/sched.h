@@ -0,0 +1,268 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+
+#include "../cpu/cpu.h"
+#include "../cpu/fpu.h"
+#include "../cpu/spinlock.h"
+#include "../memory/paging.h"
+#include "../time/hrtimer.h"
+
+/**
+ * MAX_THREADS - Kernel threads that can exist at once (including idle)
+ */
+#define MAX_THREADS             64
+
+/**
+ * THREAD_STACK_PAGES - Mapped pages per kernel stack (16 KiB)
+ */
+#define THREAD_STACK_PAGES      4
+
+/**
+ * THREAD_SLOT_SIZE - Stack region reserved per thread; everything below
+ * the mapped stack is left unmapped as a guard
+ */
+#define THREAD_SLOT_SIZE        ((ADDR_KSTACK_END - ADDR_KSTACK_START) / MAX_THREADS)
+
+/**
+ * SCHED_PRIORITIES - Priority levels, 0 is the highest
+ */
+#define SCHED_PRIORITIES        32
+
+/**
+ * SCHED_DEFAULT_PRIORITY - Priority of ordinary kernel threads
+ */
+#define SCHED_DEFAULT_PRIORITY  16
+
+/**
+ * SCHED_SLICE_NS - Time a thread runs before equal-priority threads get a turn
+ */
+#define SCHED_SLICE_NS          10000000ULL
+
+/**
+ * enum thread_state_t - Thread life cycle
+ * @THREAD_UNUSED: Pool slot is free
+ * @THREAD_READY: On a run queue
+ * @THREAD_RUNNING: Executing on a CPU
+ * @THREAD_BLOCKED: Waiting for thread_wake()
+ * @THREAD_DEAD: Exited, stack freed after the next switch
+ */
+typedef enum {
+    THREAD_UNUSED = 0,
+    THREAD_READY,
+    THREAD_RUNNING,
+    THREAD_BLOCKED,
+    THREAD_DEAD,
+} thread_state_t;
+
+/**
+ * struct thread_t - Kernel thread
+ * @esp: Saved stack pointer (must stay first, used by switch_context)
+ * @id: Thread id
+ * @name: Name for diagnostics
+ * @cpu: CPU whose run queue the thread belongs to
+ * @state: Life cycle state
+ * @priority: Scheduling priority (0 highest)
+ * @entry: Thread function
+ * @arg: Argument for @entry
+ * @stack_top: Highest address of the stack, 0 for the boot stack
+ * @next: Run queue link
+ * @runtime_ns: CPU time consumed
+ * @switched_in_ns: When the thread last started running
+ * @wake_timer: Timer used by thread_sleep_ns()
+ * @fpu: Lazily switched FPU/SSE state
+ * @held_locks: Locks taken by this thread, for lock-order checking (LOCKDEP)
+ */
+typedef struct thread_t {
+    uint32_t esp;
+    uint32_t id;
+    const char *name;
+    uint32_t cpu;
+    volatile thread_state_t state;
+    uint32_t priority;
+    void (*entry)(void *arg);
+    void *arg;
+    uint32_t stack_top;
+    struct thread_t *next;
+    uint64_t runtime_ns;
+    uint64_t switched_in_ns;
+    hrtimer_t wake_timer;
+    fpu_state_t fpu;
+#ifdef LOCKDEP
+    lockdep_held_t held_locks;
+#endif
+} thread_t;
+
+/**
+ * struct runqueue_t - Per-CPU scheduler state
+ * @lock: Protects the queues, @current and @need_resched against other
+ *        CPUs waking threads here; only the owning CPU dequeues
+ * @queues: FIFO of ready threads per priority (head, tail)
+ * @bitmap: Bit n set while priority n has ready threads
+ * @current: Running thread
+ * @idle: Thread run when nothing else is ready
+ * @dead: Exited thread whose stack is freed once switched away from
+ * @need_resched: Non-zero when schedule() should run at the next safe point
+ * @slice_timer: Ends the current thread's time slice
+ * @switches: Context switches performed
+ * @nr_threads: Threads placed on this CPU, idle excluded
+ */
+typedef struct {
+    spinlock_t lock;
+    struct {
+        thread_t *head;
+        thread_t *tail;
+    } queues[SCHED_PRIORITIES];
+    uint32_t bitmap;
+    thread_t *current;
+    thread_t *idle;
+    thread_t *dead;
+    volatile int need_resched;
+    hrtimer_t slice_timer;
+    uint64_t switches;
+    volatile uint32_t nr_threads;
+} runqueue_t;
+
+/**
+ * sched_init - Turn the boot context into the idle thread and start scheduling
+ *
+ * Call once paging, the FPU and the clock event device are up.
+ *
+ * Return: Nothing
+ */
+void sched_init(void);
+
+/**
+ * sched_create_idle - Prepare the idle thread of an application processor
+ *
+ * Allocates the thread and its stack, on which the AP starts running.
+ *
+ * Return: Idle thread, or NULL if out of threads or memory
+ */
+thread_t *sched_create_idle(void);
+
+/**
+ * sched_init_cpu - Turn the executing CPU's boot context into its idle thread
+ * @idle: Thread from sched_create_idle() whose stack the CPU runs on
+ *
+ * Return: Nothing
+ */
+void sched_init_cpu(thread_t *idle);
+
+/**
+ * sched_idle - Run the idle loop of the executing CPU
+ *
+ * Drains deferred work, runs ready threads, steals tasks from busy
+ * CPUs, or halts until the next interrupt. Enables interrupts.
+ *
+ * Return: Does not return
+ */
+void sched_idle(void) __attribute__((noreturn));
+
+/**
+ * thread_create - Start a kernel thread
+ * @name: Name for diagnostics
+ * @entry: Thread function; returning from it exits the thread
+ * @arg: Argument for @entry
+ * @priority: Scheduling priority (0 highest, below SCHED_PRIORITIES)
+ *
+ * The thread is placed on the online CPU with the fewest threads and
+ * stays there.
+ *
+ * Return: New thread, or NULL if out of threads or memory
+ */
+thread_t *thread_create(const char *name, void (*entry)(void *arg), void *arg, uint32_t priority);
+
+/**
+ * thread_current - Get the running thread
+ *
+ * Return: Current thread
+ */
+thread_t *thread_current(void);
+
+/**
+ * thread_can_block - Check whether the running code may sleep
+ *
+ * The idle thread, which also runs the boot code, must always be ready.
+ * Return: Non-zero if a blocking wait is allowed
+ */
+int thread_can_block(void);
+
+/**
+ * thread_yield - Give the CPU to another ready thread of equal or higher priority
+ *
+ * Return: Nothing
+ */
+void thread_yield(void);
+
+/**
+ * thread_block - Sleep until thread_wake()
+ *
+ * Return: Nothing
+ */
+void thread_block(void);
+
+/**
+ * thread_wake - Make a blocked thread ready
+ * @thread: Thread to wake
+ *
+ * Safe from interrupt handlers and from any CPU. A higher-priority
+ * thread preempts the current one of its CPU at the next interrupt exit
+ * or scheduling point; a remote CPU is sent a reschedule IPI.
+ *
+ * Return: Nothing
+ */
+void thread_wake(thread_t *thread);
+
+/**
+ * thread_sleep_ns - Block for at least @ns nanoseconds
+ * @ns: Duration
+ *
+ * Return: Nothing
+ */
+void thread_sleep_ns(uint64_t ns);
+
+/**
+ * thread_exit - Terminate the current thread
+ *
+ * Return: Does not return
+ */
+void thread_exit(void) __attribute__((noreturn));
+
+/**
+ * schedule - Switch to the highest-priority ready thread
+ *
+ * A running thread is put back at the tail of its priority queue.
+ *
+ * Return: Nothing (returns when this thread runs again)
+ */
+void schedule(void);
+
+/**
+ * sched_need_resched - Check whether a reschedule is pending on this CPU
+ *
+ * Return: Non-zero if schedule() should run
+ */
+int sched_need_resched(void);
+
+/**
+ * sched_get_runqueue - Scheduler state of a CPU
+ * @cpu: CPU index
+ *
+ * Return: Run queue
+ */
+runqueue_t *sched_get_runqueue(uint32_t cpu);
+
+/**
+ * switch_context - Save the current context and resume another
+ * @prev_esp: Where to store the current stack pointer
+ * @next_esp: Stack pointer saved by a previous switch_context()
+ *
+ * Implemented in switch.asm. Call with interrupts disabled.
+ *
+ * Return: Nothing (returns when the saved context is resumed)
+ */
+void switch_context(uint32_t *prev_esp, uint32_t next_esp);
+
+#endif
@@ -0,0 +1,22 @@
+bits 32
+global switch_context
+
+; void switch_context(uint32_t *prev_esp, uint32_t next_esp)
+; Saves the callee-saved registers on the current stack, stores the stack
+; pointer in *prev_esp and resumes the context saved at next_esp. The
+; caller-saved registers are already dead across the call, and EFLAGS is
+; handled by the caller (interrupts stay disabled across the switch).
+switch_context:
+    mov eax, [esp + 4]    ; prev_esp
+    mov edx, [esp + 8]    ; next_esp
+    push ebp
+    push ebx
+    push esi
+    push edi
+    mov [eax], esp        ; save current stack pointer
+    mov esp, edx          ; switch stacks
+    pop edi
+    pop esi
+    pop ebx
+    pop ebp
+    ret                   ; into schedule(), or thread_bootstrap for new threads
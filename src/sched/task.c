@@ -0,0 +1,269 @@
+#include <stddef.h>
+
+#include "task.h"
+#include "sched.h"
+#include "../cpu/cpu.h"
+#include "../cpu/smp.h"
+#include "../lib/printf.h"
+#include "../lib/wsdeque.h"
+#include "../time/clocksource.h"
+#include "../utils.h"
+
+/**
+ * TASK_BENCH_START - First byte the benchmark checksums (kernel image)
+ */
+#define TASK_BENCH_START        0x00100000
+
+/**
+ * TASK_BENCH_END - End (exclusive) of the benchmark region, inside the
+ * identity map
+ */
+#define TASK_BENCH_END          0x00500000
+
+/**
+ * struct range_t - Arguments of one task_parallel_for() split
+ * @begin: First index
+ * @end: One past the last index
+ * @grain: Largest range run without splitting
+ * @fn: Body
+ * @arg: Argument for @fn
+ */
+typedef struct {
+    uint32_t begin;
+    uint32_t end;
+    uint32_t grain;
+    task_range_fn_t fn;
+    void *arg;
+} range_t;
+
+/**
+ * deques - Per-CPU task deques; only the owning CPU pushes and pops
+ */
+static wsdeque_t deques[MAX_CPUS];
+
+/**
+ * idle_mask - Bit n set while CPU n is idle and wants to be woken for tasks
+ */
+static volatile uint32_t idle_mask;
+
+/**
+ * bench_thread - Thread that runs task_bench_run() when woken
+ */
+static thread_t *bench_thread;
+
+/**
+ * bench_sums - Per-range partial checksums of the parallel benchmark
+ */
+static uint32_t bench_sums[(TASK_BENCH_END - TASK_BENCH_START) / TASK_BENCH_GRAIN];
+
+/**
+ * kick_idle - Wake one idle CPU other than the executing one
+ *
+ * Clearing the bit claims the CPU, so concurrent spawners wake
+ * different CPUs.
+ * Return: Nothing
+ */
+static void kick_idle(void) {
+    uint32_t self = 1U << cpu_id();
+
+    /* Pairs with the fence in task_steal_idle(): one side sees the other */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    uint32_t idle;
+    while ((idle = __atomic_load_n(&idle_mask, __ATOMIC_RELAXED) & ~self)) {
+        uint32_t cpu = (uint32_t)__builtin_ctz(idle);
+        uint32_t bit = 1U << cpu;
+        if (__atomic_fetch_and(&idle_mask, ~bit, __ATOMIC_RELAXED) & bit) {
+            smp_send_resched(cpu);
+            return;
+        }
+    }
+}
+
+/**
+ * steal_any - Steal a task from another CPU
+ * @self: Executing CPU
+ *
+ * Starts after @self so thieves spread over the victims.
+ * Return: Task, or NULL if nothing was stolen
+ */
+static task_t *steal_any(uint32_t self) {
+    uint32_t online = smp_online_mask();
+
+    for (uint32_t i = 1; i < MAX_CPUS; i++) {
+        uint32_t victim = (self + i) % MAX_CPUS;
+        if (!(online & (1U << victim)))
+            continue;
+
+        task_t *task = wsdeque_steal(&deques[victim]);
+        if (task)
+            return task;
+    }
+    return NULL;
+}
+
+/**
+ * range_task - Task body of task_parallel_for()
+ * @arg: range_t to process
+ *
+ * Return: Nothing
+ */
+static void range_task(void *arg) {
+    range_t *range = arg;
+
+    if (range->end - range->begin <= range->grain) {
+        range->fn(range->begin, range->end, range->arg);
+        return;
+    }
+
+    /* Offer the right half to thieves and keep the left half */
+    uint32_t mid = range->begin + (range->end - range->begin) / 2;
+    range_t right = { mid, range->end, range->grain, range->fn, range->arg };
+    range_t left = { range->begin, mid, range->grain, range->fn, range->arg };
+    task_t task;
+
+    task_spawn(&task, range_task, &right);
+    range_task(&left);
+    task_join(&task);
+}
+
+/**
+ * bench_checksum - Sum the 32-bit words of a range of bytes
+ * @begin: First address
+ * @end: End (exclusive) address, @begin plus a multiple of four
+ *
+ * Return: Wrapping sum
+ */
+static uint32_t bench_checksum(uint32_t begin, uint32_t end) {
+    const uint32_t *word = (const uint32_t *)(uintptr_t)begin;
+    uint32_t sum = 0;
+
+    while ((uint32_t)(uintptr_t)word < end)
+        sum += *word++;
+    return sum;
+}
+
+/**
+ * bench_range - task_parallel_for() body of the benchmark
+ * @begin: First address
+ * @end: End (exclusive) address, one grain
+ * @arg: Unused
+ *
+ * Return: Nothing
+ */
+static void bench_range(uint32_t begin, uint32_t end, void *arg) {
+    (void)arg;
+    bench_sums[(begin - TASK_BENCH_START) / TASK_BENCH_GRAIN] = bench_checksum(begin, end);
+}
+
+/**
+ * task_bench_run - Benchmark thread
+ * @arg: Unused
+ *
+ * Return: Does not return
+ */
+static void task_bench_run(void *arg) {
+    (void)arg;
+
+    while (1) {
+        thread_block();
+
+        uint64_t start = clock_monotonic_ns();
+        uint32_t serial = bench_checksum(TASK_BENCH_START, TASK_BENCH_END);
+        uint64_t serial_ns = clock_monotonic_ns() - start;
+
+        start = clock_monotonic_ns();
+        task_parallel_for(TASK_BENCH_START, TASK_BENCH_END, TASK_BENCH_GRAIN, bench_range, NULL);
+        uint64_t parallel_ns = clock_monotonic_ns() - start;
+
+        uint32_t parallel = 0;
+        for (uint32_t i = 0; i < sizeof(bench_sums) / sizeof(bench_sums[0]); i++)
+            parallel += bench_sums[i];
+
+        kprintf("taskbench: %u CPU(s), serial %llu ns, parallel %llu ns, speedup x%llu.%02llu%s\n",
+                smp_num_online(), serial_ns, parallel_ns,
+                serial_ns / (parallel_ns ? parallel_ns : 1),
+                serial_ns * 100 / (parallel_ns ? parallel_ns : 1) % 100,
+                serial == parallel ? "" : " (checksum mismatch)");
+    }
+}
+
+void task_init(void) {
+    for (uint32_t cpu = 0; cpu < MAX_CPUS; cpu++)
+        wsdeque_init(&deques[cpu]);
+
+    bench_thread = thread_create("taskbench", task_bench_run, NULL, SCHED_DEFAULT_PRIORITY);
+    if (!bench_thread)
+        panic("Error: could not start task benchmark thread");
+}
+
+void task_spawn(task_t *task, task_fn_t fn, void *arg) {
+    task->fn = fn;
+    task->arg = arg;
+    task->done = 0;
+
+    /* The owner side of the deque must not be interleaved with itself */
+    uint32_t flags = irq_save();
+    int queued = wsdeque_push(&deques[cpu_id()], task);
+    irq_restore(flags);
+
+    if (queued == -1)
+        task_run(task);
+    else
+        kick_idle();
+}
+
+void task_join(task_t *task) {
+    while (!__atomic_load_n(&task->done, __ATOMIC_ACQUIRE)) {
+        uint32_t flags = irq_save();
+        uint32_t self = cpu_id();
+        task_t *other = wsdeque_pop(&deques[self]);
+        irq_restore(flags);
+
+        /* Help with the newest local work first, then the oldest elsewhere */
+        if (!other)
+            other = steal_any(self);
+
+        if (other)
+            task_run(other);
+        else
+            cpu_relax();
+    }
+}
+
+void task_parallel_for(uint32_t begin, uint32_t end, uint32_t grain, task_range_fn_t fn, void *arg) {
+    range_t range = { begin, end, grain ? grain : 1, fn, arg };
+
+    if (begin < end)
+        range_task(&range);
+}
+
+task_t *task_steal_idle(void) {
+    uint32_t self = cpu_id();
+    uint32_t bit = 1U << self;
+
+    /* Publish idleness before looking, so a racing spawner kicks us */
+    __atomic_or_fetch(&idle_mask, bit, __ATOMIC_SEQ_CST);
+
+    task_t *task = steal_any(self);
+    if (task)
+        __atomic_and_fetch(&idle_mask, ~bit, __ATOMIC_RELAXED);
+    return task;
+}
+
+void task_idle_exit(void) {
+    uint32_t bit = 1U << cpu_id();
+
+    if (__atomic_load_n(&idle_mask, __ATOMIC_RELAXED) & bit)
+        __atomic_and_fetch(&idle_mask, ~bit, __ATOMIC_RELAXED);
+}
+
+void task_run(task_t *task) {
+    task->fn(task->arg);
+    __atomic_store_n(&task->done, 1, __ATOMIC_RELEASE);
+}
+
+void task_bench(void) {
+    if (bench_thread)
+        thread_wake(bench_thread);
+}
@@ -0,0 +1,124 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <stdint.h>
+
+/**
+ * TASK_BENCH_SCANCODE - F9 make code, runs the task scaling benchmark
+ */
+#define TASK_BENCH_SCANCODE     0x43
+
+/**
+ * TASK_BENCH_GRAIN - Bytes each benchmark task checksums
+ */
+#define TASK_BENCH_GRAIN        0x10000
+
+/**
+ * task_fn_t - Task function
+ */
+typedef void (*task_fn_t)(void *arg);
+
+/**
+ * task_range_fn_t - Body of task_parallel_for(), called on a sub-range
+ */
+typedef void (*task_range_fn_t)(uint32_t begin, uint32_t end, void *arg);
+
+/**
+ * struct task_t - Unit of work for the work-stealing runtime
+ * @fn: Function to run
+ * @arg: Argument for @fn
+ * @done: Set once @fn has returned
+ *
+ * Owned by the spawner, usually on its stack, and must stay valid until
+ * task_join() returns. Tasks run to completion on whichever CPU picks
+ * them up, in thread context with interrupts enabled, and must not
+ * block or sleep.
+ */
+typedef struct {
+    task_fn_t fn;
+    void *arg;
+    volatile uint32_t done;
+} task_t;
+
+/**
+ * task_init - Set up the per-CPU deques and the benchmark thread
+ *
+ * Call after smp_init().
+ *
+ * Return: Nothing
+ */
+void task_init(void);
+
+/**
+ * task_spawn - Queue a task on the executing CPU
+ * @task: Task to fill in and queue
+ * @fn: Function to run
+ * @arg: Argument for @fn
+ *
+ * Idle CPUs may steal it. Runs it right away if the deque is full.
+ *
+ * Return: Nothing
+ */
+void task_spawn(task_t *task, task_fn_t fn, void *arg);
+
+/**
+ * task_join - Wait for a spawned task to finish
+ * @task: Task passed to task_spawn()
+ *
+ * Runs local and stolen tasks while waiting instead of blocking.
+ *
+ * Return: Nothing
+ */
+void task_join(task_t *task);
+
+/**
+ * task_parallel_for - Run @fn over [@begin, @end) on all online CPUs
+ * @begin: First index
+ * @end: One past the last index
+ * @grain: Largest range handed to a single call of @fn
+ * @fn: Body
+ * @arg: Argument for @fn
+ *
+ * The range is split in halves until no larger than @grain; returns
+ * once every sub-range is done.
+ *
+ * Return: Nothing
+ */
+void task_parallel_for(uint32_t begin, uint32_t end, uint32_t grain, task_range_fn_t fn, void *arg);
+
+/**
+ * task_steal_idle - Find work for an idle CPU
+ *
+ * Call from the idle loop with interrupts disabled. The CPU is marked
+ * idle so spawners wake it; task_idle_exit() clears the mark.
+ *
+ * Return: Stolen task to pass to task_run(), or NULL
+ */
+task_t *task_steal_idle(void);
+
+/**
+ * task_idle_exit - Stop being woken for new tasks
+ *
+ * Return: Nothing
+ */
+void task_idle_exit(void);
+
+/**
+ * task_run - Run a task and mark it done
+ * @task: Task taken from a deque
+ *
+ * Return: Nothing
+ */
+void task_run(task_t *task);
+
+/**
+ * task_bench - Wake the benchmark thread
+ *
+ * Checksums the identity-mapped kernel region serially and with
+ * task_parallel_for(), and prints both times to the debug console.
+ *
+ * Return: Nothing
+ */
+void task_bench(void);
+
+#endif
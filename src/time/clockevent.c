@@ -0,0 +1,144 @@
+#include <stddef.h>
+
+#include "clockevent.h"
+#include "hrtimer.h"
+#include "clocksource.h"
+#include "vdso.h"
+#include "../cpu/cpu.h"
+
+volatile uint64_t timer_ticks = 0;
+
+/**
+ * device - Active clock event device of each CPU
+ */
+static const clockevent_t *device[MAX_CPUS];
+
+/**
+ * base_ns - Time at which each CPU's device was last programmed
+ */
+static uint64_t base_ns[MAX_CPUS];
+
+/**
+ * clockevent_calc_mult - Compute a fixed-point conversion factor
+ * @from: Source rate
+ * @to: Destination rate
+ *
+ * Return: Factor such that (value * factor) >> CLOCKEVENT_SHIFT converts
+ *         a count at rate @from into a count at rate @to
+ */
+uint64_t clockevent_calc_mult(uint64_t from, uint64_t to) {
+    return ((to << CLOCKEVENT_SHIFT) + from / 2) / from;
+}
+
+/**
+ * ktime_get_ns - Get monotonic time since the first device was registered
+ *
+ * Reads the TSC clocksource once it is enabled, else the device. Only
+ * the TSC is comparable across CPUs.
+ *
+ * Return: Nanoseconds
+ */
+uint64_t ktime_get_ns(void) {
+    if (clocksource_tsc_enabled())
+        return clock_monotonic_ns();
+
+    uint32_t flags = irq_save();
+    uint32_t cpu = cpu_id();
+    uint64_t now = base_ns[cpu];
+    if (device[cpu])
+        now += device[cpu]->elapsed_ns();
+    irq_restore(flags);
+    return now;
+}
+
+/**
+ * program - Arm the device for an absolute time
+ * @expires_ns: Absolute time of the next event
+ *
+ * Must be called with interrupts disabled.
+ * Return: Nothing
+ */
+static void program(uint64_t expires_ns) {
+    uint32_t cpu = cpu_id();
+    const clockevent_t *dev = device[cpu];
+    uint64_t now;
+
+    if (clocksource_tsc_enabled()) {
+        /* The TSC keeps time, so an idle device can stay quiet */
+        if (expires_ns == HRTIMER_NONE)
+            return;
+        now = clock_monotonic_ns();
+    } else {
+        now = base_ns[cpu] + dev->elapsed_ns();
+        base_ns[cpu] = now;
+    }
+
+    uint64_t delta = expires_ns > now ? expires_ns - now : 0;
+
+    if (delta < dev->min_delta_ns)
+        delta = dev->min_delta_ns;
+    if (delta > dev->max_delta_ns)
+        delta = dev->max_delta_ns;
+
+    dev->set_next_event(delta);
+}
+
+/**
+ * clockevent_reprogram - Program the device for the earliest pending hrtimer
+ *
+ * Without pending timers the device is left idle once the TSC keeps
+ * time; before that it is armed for its maximum delay so that elapsed
+ * time can still be tracked.
+ * Return: Nothing
+ */
+void clockevent_reprogram(void) {
+    uint32_t flags = irq_save();
+    if (device[cpu_id()])
+        program(hrtimer_next_expiry());
+    irq_restore(flags);
+}
+
+/**
+ * clockevent_handle - Process a clock event interrupt
+ *
+ * Return: Nothing
+ */
+void clockevent_handle(void) {
+    uint64_t now = ktime_get_ns();
+
+    /* One writer, so the 64-bit store is never torn against another */
+    if (cpu_id() == 0 && now / NSEC_PER_TICK != timer_ticks) {
+        timer_ticks = now / NSEC_PER_TICK;
+        vdso_set_ticks(timer_ticks);
+    }
+
+    hrtimer_run_expired(now);
+    clockevent_reprogram();
+}
+
+/**
+ * clockevent_register - Make @dev the executing CPU's clock event device
+ * @dev: Device to use from now on
+ *
+ * Return: Nothing
+ */
+void clockevent_register(const clockevent_t *dev) {
+    uint32_t flags = irq_save();
+    uint32_t cpu = cpu_id();
+    if (device[cpu])
+        base_ns[cpu] += device[cpu]->elapsed_ns();
+
+    device[cpu] = dev;
+    base_ns[cpu] -= dev->elapsed_ns();
+    program(hrtimer_next_expiry());
+    irq_restore(flags);
+}
+
+/**
+ * clockevent_get - Get the executing CPU's clock event device
+ *
+ * Return: Active device, or NULL before one is registered
+ */
+const clockevent_t *clockevent_get(void) {
+    return device[cpu_id()];
+}
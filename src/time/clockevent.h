@@ -0,0 +1,104 @@
+#ifndef CLOCKEVENT_H
+#define CLOCKEVENT_H
+
+#include <stdint.h>
+
+/**
+ * NSEC_PER_SEC - Nanoseconds per second
+ */
+#define NSEC_PER_SEC        1000000000ULL
+
+/**
+ * CLOCK_TICK_HZ - Rate at which timer_ticks advances
+ */
+#define CLOCK_TICK_HZ       1000
+
+/**
+ * NSEC_PER_TICK - Nanoseconds per timer_ticks increment
+ */
+#define NSEC_PER_TICK       (NSEC_PER_SEC / CLOCK_TICK_HZ)
+
+/**
+ * CLOCKEVENT_SHIFT - Fixed-point shift of clockevent_t conversion factors
+ */
+#define CLOCKEVENT_SHIFT    24
+
+/**
+ * struct clockevent_t - One-shot timer interrupt source
+ * @name: Device name
+ * @min_delta_ns: Shortest programmable delay
+ * @max_delta_ns: Longest programmable delay
+ * @set_next_event: Arm a single interrupt @delta_ns from now
+ * @elapsed_ns: Nanoseconds since the last set_next_event() call
+ *
+ * The device calls clockevent_handle() from its interrupt handler.
+ */
+typedef struct {
+    const char *name;
+    uint64_t min_delta_ns;
+    uint64_t max_delta_ns;
+    void (*set_next_event)(uint64_t delta_ns);
+    uint64_t (*elapsed_ns)(void);
+} clockevent_t;
+
+/**
+ * timer_ticks - Milliseconds since the first clock event device was registered
+ *
+ * Updated on the bootstrap CPU's clock events, so it may lag behind
+ * ktime_get_ns().
+ */
+extern volatile uint64_t timer_ticks;
+
+/**
+ * clockevent_register - Make @dev the executing CPU's clock event device
+ * @dev: Device to use from now on
+ *
+ * Each CPU has its own device, which serves that CPU's hrtimers. Time
+ * accumulated on the previous device is carried over.
+ */
+void clockevent_register(const clockevent_t *dev);
+
+/**
+ * clockevent_get - Get the executing CPU's clock event device
+ *
+ * Return: Active device, or NULL before one is registered
+ */
+const clockevent_t *clockevent_get(void);
+
+/**
+ * clockevent_handle - Process a clock event interrupt
+ *
+ * Updates the time, runs expired hrtimers and programs the next event.
+ * Called by the active device's interrupt handler.
+ */
+void clockevent_handle(void);
+
+/**
+ * clockevent_reprogram - Program the device for the earliest pending hrtimer
+ *
+ * Without pending timers the device is left idle once the TSC keeps
+ * time; before that it is armed for its maximum delay so that elapsed
+ * time can still be tracked.
+ */
+void clockevent_reprogram(void);
+
+/**
+ * clockevent_calc_mult - Compute a fixed-point conversion factor
+ * @from: Source rate
+ * @to: Destination rate
+ *
+ * Return: Factor such that (value * factor) >> CLOCKEVENT_SHIFT converts
+ *         a count at rate @from into a count at rate @to
+ */
+uint64_t clockevent_calc_mult(uint64_t from, uint64_t to);
+
+/**
+ * ktime_get_ns - Get monotonic time since the first device was registered
+ *
+ * Reads the TSC clocksource once it is enabled, else the device.
+ *
+ * Return: Nanoseconds
+ */
+uint64_t ktime_get_ns(void);
+
+#endif
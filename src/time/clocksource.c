@@ -0,0 +1,125 @@
+#include <stddef.h>
+
+#include "clocksource.h"
+#include "clockevent.h"
+#include "vdso.h"
+#include "../cpu/cpu.h"
+#include "../drivers/pit.h"
+
+/**
+ * clock - Active TSC conversion
+ */
+static clocksource_data_t clock;
+
+/**
+ * tsc_enabled - Non-zero once the TSC is the time source
+ */
+static volatile int tsc_enabled;
+
+/**
+ * tsc_hz - Calibrated TSC frequency
+ */
+static uint64_t tsc_hz;
+
+/**
+ * tsc_invariant - Check that the TSC exists and ticks at a constant rate
+ *
+ * Return: Non-zero if the TSC is usable as a clock
+ */
+static int tsc_invariant(void) {
+    uint32_t eax, ebx, ecx, edx;
+
+    cpuid(1, &eax, &ebx, &ecx, &edx);
+    if (!(edx & CPUID_EDX_TSC))
+        return 0;
+
+    cpuid(0x80000000, &eax, &ebx, &ecx, &edx);
+    if (eax < 0x80000007)
+        return 0;
+
+    cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx & CPUID_EDX_INVARIANT_TSC) != 0;
+}
+
+/**
+ * tsc_calibrate - Measure the TSC frequency against PIT channel 2
+ *
+ * Interrupts must be disabled so a handler cannot stretch a run.
+ * Return: Frequency in Hz
+ */
+static uint64_t tsc_calibrate(void) {
+    uint64_t best = UINT64_MAX;
+
+    for (int i = 0; i < CLOCKSOURCE_CALIBRATE_RUNS; i++) {
+        uint64_t start = rdtsc();
+        pit_wait(CLOCKSOURCE_CALIBRATE_COUNT);
+        uint64_t cycles = rdtsc() - start;
+        if (cycles < best)
+            best = cycles;
+    }
+    return best * PIT_FREQUENCY / CLOCKSOURCE_CALIBRATE_COUNT;
+}
+
+int clocksource_init(void) {
+    if (!tsc_invariant())
+        return -1;
+
+    uint32_t flags = irq_save();
+    uint64_t hz = tsc_calibrate();
+
+    /* Largest shift whose factor still fits in 32 bits */
+    uint32_t shift = 32;
+    uint64_t mult = (NSEC_PER_SEC << shift) / hz;
+    while (mult >> 32) {
+        shift--;
+        mult = (NSEC_PER_SEC << shift) / hz;
+    }
+
+    /* Continue from the clock event device's notion of time */
+    uint64_t now = ktime_get_ns();
+    clock.seq++;
+    barrier();
+    clock.base_cycles = rdtsc();
+    clock.base_ns = now;
+    clock.mult = (uint32_t)mult;
+    clock.shift = shift;
+    barrier();
+    clock.seq++;
+    vdso_set_clock(&clock);
+
+    tsc_hz = hz;
+    tsc_enabled = 1;
+    irq_restore(flags);
+    return 0;
+}
+
+int clocksource_tsc_enabled(void) {
+    return tsc_enabled;
+}
+
+uint64_t clocksource_tsc_hz(void) {
+    return tsc_hz;
+}
+
+uint64_t clock_monotonic_ns(void) {
+    if (!tsc_enabled)
+        return ktime_get_ns();
+
+    uint32_t seq;
+    uint64_t base_cycles, base_ns, cycles;
+    uint32_t mult, shift;
+
+    /* x86 does not reorder loads with loads, so compiler barriers suffice */
+    do {
+        seq = clock.seq;
+        barrier();
+        base_cycles = clock.base_cycles;
+        base_ns = clock.base_ns;
+        mult = clock.mult;
+        shift = clock.shift;
+        cycles = rdtsc();
+        barrier();
+    } while ((seq & 1) || seq != clock.seq);
+
+    return base_ns + clocksource_cyc2ns(cycles - base_cycles, mult, shift);
+}
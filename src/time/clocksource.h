@@ -0,0 +1,96 @@
+#ifndef CLOCKSOURCE_H
+#define CLOCKSOURCE_H
+
+#include <stdint.h>
+
+/**
+ * CPUID_EDX_TSC - CPUID.1:EDX bit for the time stamp counter
+ */
+#define CPUID_EDX_TSC               (1U << 4)
+
+/**
+ * CPUID_EDX_INVARIANT_TSC - CPUID.80000007h:EDX bit for a TSC that runs
+ * at a constant rate in every P-, C- and T-state
+ */
+#define CPUID_EDX_INVARIANT_TSC     (1U << 8)
+
+/**
+ * CLOCKSOURCE_CALIBRATE_COUNT - PIT ticks per calibration run (10 ms)
+ */
+#define CLOCKSOURCE_CALIBRATE_COUNT 11932
+
+/**
+ * CLOCKSOURCE_CALIBRATE_RUNS - Calibration runs; the shortest wins
+ */
+#define CLOCKSOURCE_CALIBRATE_RUNS  3
+
+/**
+ * struct clocksource_data_t - Cycle-to-nanosecond conversion
+ * @seq: Sequence count, odd while an update is in progress
+ * @base_cycles: TSC value at @base_ns
+ * @base_ns: Monotonic time at @base_cycles
+ * @mult: Fixed-point nanoseconds per cycle
+ * @shift: Fixed-point shift of @mult (at most 32)
+ *
+ * Readers retry while @seq is odd or changed across the read, so no lock
+ * is taken on the read side.
+ */
+typedef struct {
+    volatile uint32_t seq;
+    uint64_t base_cycles;
+    uint64_t base_ns;
+    uint32_t mult;
+    uint32_t shift;
+} clocksource_data_t;
+
+/**
+ * clocksource_init - Calibrate the TSC against the PIT and switch to it
+ *
+ * Requires a TSC that is invariant; otherwise time keeps coming from the
+ * clock event device. Time stays continuous across the switch.
+ *
+ * Return: 0 if the TSC is in use, -1 otherwise
+ */
+int clocksource_init(void);
+
+/**
+ * clocksource_tsc_enabled - Check whether time comes from the TSC
+ *
+ * Return: Non-zero once clocksource_init() succeeded
+ */
+int clocksource_tsc_enabled(void);
+
+/**
+ * clocksource_tsc_hz - Calibrated TSC frequency
+ *
+ * Return: Hz, or 0 if the TSC is not in use
+ */
+uint64_t clocksource_tsc_hz(void);
+
+/**
+ * clocksource_cyc2ns - Convert a cycle count with a fixed-point factor
+ * @cycles: Cycle count
+ * @mult: Fixed-point nanoseconds per cycle
+ * @shift: Fixed-point shift (at most 32)
+ *
+ * Splits @cycles so the product never overflows, using two 32x32-bit
+ * multiplies.
+ *
+ * Return: Nanoseconds
+ */
+static inline uint64_t clocksource_cyc2ns(uint64_t cycles, uint32_t mult, uint32_t shift) {
+    uint64_t low = (uint64_t)(uint32_t)cycles * mult;
+    uint64_t high = (uint64_t)(uint32_t)(cycles >> 32) * mult;
+    return (low >> shift) + (high << (32 - shift));
+}
+
+/**
+ * clock_monotonic_ns - Nanoseconds since boot
+ *
+ * Lock-free TSC read when the TSC is in use, else ktime_get_ns().
+ *
+ * Return: Nanoseconds
+ */
+uint64_t clock_monotonic_ns(void);
+
+#endif
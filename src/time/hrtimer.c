@@ -0,0 +1,166 @@
+#include <stddef.h>
+
+#include "hrtimer.h"
+#include "clockevent.h"
+#include "../cpu/cpu.h"
+#include "../cpu/spinlock.h"
+
+/**
+ * struct hrtimer_base_t - Timers of one CPU
+ * @lock: Protects @pending against hrtimer_cancel() from other CPUs
+ * @pending: Armed timers sorted by expiry
+ */
+typedef struct {
+    spinlock_t lock;
+    hrtimer_t *pending;
+} hrtimer_base_t;
+
+/**
+ * bases - Per-CPU timer lists, each served by that CPU's clock event device
+ */
+static hrtimer_base_t bases[MAX_CPUS] = {
+    [0 ... MAX_CPUS - 1] = { .lock = SPINLOCK_INIT("hrtimer_base") },
+};
+
+/**
+ * dequeue - Remove a timer from its CPU's pending list
+ * @base: Base of @timer->cpu, locked
+ * @timer: Timer to remove
+ *
+ * Return: 1 if the timer was pending, 0 otherwise
+ */
+static int dequeue(hrtimer_base_t *base, hrtimer_t *timer) {
+    if (!timer->queued)
+        return 0;
+
+    hrtimer_t **link = &base->pending;
+    while (*link != timer)
+        link = &(*link)->next;
+
+    *link = timer->next;
+    timer->next = NULL;
+    timer->queued = 0;
+    return 1;
+}
+
+/**
+ * remove - Remove a timer from whichever CPU's list holds it
+ * @timer: Timer to remove
+ *
+ * Must be called with interrupts disabled.
+ * Return: 1 if the timer was pending, 0 otherwise
+ */
+static int remove(hrtimer_t *timer) {
+    if (!timer->queued)
+        return 0;
+
+    hrtimer_base_t *base = &bases[timer->cpu];
+    spin_lock(&base->lock);
+    int was_pending = dequeue(base, timer);
+    spin_unlock(&base->lock);
+    return was_pending;
+}
+
+/**
+ * hrtimer_init - Prepare a timer for use
+ * @timer: Timer to initialize
+ * @fn: Callback to run on expiry
+ * @arg: Argument for @fn
+ *
+ * Return: Nothing
+ */
+void hrtimer_init(hrtimer_t *timer, void (*fn)(hrtimer_t *timer), void *arg) {
+    timer->expires_ns = 0;
+    timer->fn = fn;
+    timer->arg = arg;
+    timer->next = NULL;
+    timer->queued = 0;
+    timer->cpu = 0;
+}
+
+/**
+ * hrtimer_start - Arm a timer on the executing CPU, replacing any pending expiry
+ * @timer: Timer to arm
+ * @expires_ns: Absolute expiry time
+ *
+ * Return: Nothing
+ */
+void hrtimer_start(hrtimer_t *timer, uint64_t expires_ns) {
+    uint32_t flags = irq_save();
+    remove(timer);
+
+    uint32_t cpu = cpu_id();
+    hrtimer_base_t *base = &bases[cpu];
+    spin_lock(&base->lock);
+
+    hrtimer_t **link = &base->pending;
+    while (*link && (*link)->expires_ns <= expires_ns)
+        link = &(*link)->next;
+
+    timer->expires_ns = expires_ns;
+    timer->next = *link;
+    timer->cpu = cpu;
+    timer->queued = 1;
+    *link = timer;
+
+    int first = base->pending == timer;
+    spin_unlock(&base->lock);
+
+    /* A new earliest timer needs the device re-armed */
+    if (first)
+        clockevent_reprogram();
+    irq_restore(flags);
+}
+
+/**
+ * hrtimer_cancel - Disarm a timer
+ * @timer: Timer to disarm, pending on any CPU
+ *
+ * The device is not re-armed; an early event finds nothing to run.
+ * Return: 1 if the timer was pending, 0 otherwise
+ */
+int hrtimer_cancel(hrtimer_t *timer) {
+    uint32_t flags = irq_save();
+    int was_pending = remove(timer);
+    irq_restore(flags);
+    return was_pending;
+}
+
+/**
+ * hrtimer_next_expiry - Get the earliest expiry pending on the executing CPU
+ *
+ * Return: Absolute expiry time, or HRTIMER_NONE
+ */
+uint64_t hrtimer_next_expiry(void) {
+    uint32_t flags = irq_save();
+    hrtimer_base_t *base = &bases[cpu_id()];
+
+    spin_lock(&base->lock);
+    uint64_t expires = base->pending ? base->pending->expires_ns : HRTIMER_NONE;
+    spin_unlock(&base->lock);
+
+    irq_restore(flags);
+    return expires;
+}
+
+/**
+ * hrtimer_run_expired - Run the executing CPU's timers that expired at or before @now
+ * @now: Current time
+ *
+ * Callbacks run without the lock, so they may start or cancel timers.
+ * Return: Nothing
+ */
+void hrtimer_run_expired(uint64_t now) {
+    hrtimer_base_t *base = &bases[cpu_id()];
+
+    spin_lock(&base->lock);
+    while (base->pending && base->pending->expires_ns <= now) {
+        hrtimer_t *timer = base->pending;
+        dequeue(base, timer);
+        spin_unlock(&base->lock);
+
+        timer->fn(timer);
+        spin_lock(&base->lock);
+    }
+    spin_unlock(&base->lock);
+}
@@ -0,0 +1,70 @@
+#ifndef HRTIMER_H
+#define HRTIMER_H
+
+#include <stdint.h>
+
+/**
+ * HRTIMER_NONE - hrtimer_next_expiry() result when nothing is pending
+ */
+#define HRTIMER_NONE        UINT64_MAX
+
+/**
+ * struct hrtimer_t - High-resolution one-shot timer
+ * @expires_ns: Absolute expiry time (ktime_get_ns() clock)
+ * @fn: Callback, run from the clock event interrupt with interrupts disabled
+ * @arg: Argument passed to @fn
+ * @next: Next timer in expiry order
+ * @queued: Non-zero while the timer is pending
+ * @cpu: CPU whose list holds the timer while it is pending
+ *
+ * Timers fire on the CPU that armed them. Callbacks may re-arm their own
+ * timer with hrtimer_start().
+ */
+typedef struct hrtimer_t {
+    uint64_t expires_ns;
+    void (*fn)(struct hrtimer_t *timer);
+    void *arg;
+    struct hrtimer_t *next;
+    volatile int queued;
+    uint32_t cpu;
+} hrtimer_t;
+
+/**
+ * hrtimer_init - Prepare a timer for use
+ * @timer: Timer to initialize
+ * @fn: Callback to run on expiry
+ * @arg: Argument for @fn
+ */
+void hrtimer_init(hrtimer_t *timer, void (*fn)(hrtimer_t *timer), void *arg);
+
+/**
+ * hrtimer_start - Arm a timer on the executing CPU, replacing any pending expiry
+ * @timer: Timer to arm
+ * @expires_ns: Absolute expiry time
+ */
+void hrtimer_start(hrtimer_t *timer, uint64_t expires_ns);
+
+/**
+ * hrtimer_cancel - Disarm a timer
+ * @timer: Timer to disarm, pending on any CPU
+ *
+ * Return: 1 if the timer was pending, 0 otherwise
+ */
+int hrtimer_cancel(hrtimer_t *timer);
+
+/**
+ * hrtimer_next_expiry - Get the earliest expiry pending on the executing CPU
+ *
+ * Return: Absolute expiry time, or HRTIMER_NONE
+ */
+uint64_t hrtimer_next_expiry(void);
+
+/**
+ * hrtimer_run_expired - Run the executing CPU's timers that expired at or before @now
+ * @now: Current time
+ *
+ * Called from the clock event interrupt with interrupts disabled.
+ */
+void hrtimer_run_expired(uint64_t now);
+
+#endif
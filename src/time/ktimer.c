@@ -0,0 +1,319 @@
+#include <stddef.h>
+
+#include "ktimer.h"
+#include "../cpu/spinlock.h"
+
+#ifndef TEST
+#include "clockevent.h"
+#include "hrtimer.h"
+#include "../interrupts/softirq.h"
+#endif
+
+/**
+ * KTIMER_WHEEL_MASK - Slot index mask
+ */
+#define KTIMER_WHEEL_MASK   (KTIMER_WHEEL_SIZE - 1)
+
+/**
+ * struct ktimer_wheel_t - Hierarchical timer wheel
+ * @slots: Timer lists, indexed by level then slot
+ * @occupied: Bit n set while slot n of a level is non-empty
+ * @clk: Next tick to process
+ * @count: Pending timers
+ * @lock: Protects the wheel; callbacks run without it
+ */
+typedef struct {
+    ktimer_t *slots[KTIMER_WHEEL_LEVELS][KTIMER_WHEEL_SIZE];
+    uint64_t occupied[KTIMER_WHEEL_LEVELS];
+    uint64_t clk;
+    uint32_t count;
+    spinlock_t lock;
+} ktimer_wheel_t;
+
+/**
+ * wheel - The timer wheel
+ */
+static ktimer_wheel_t wheel = { .lock = SPINLOCK_INIT("ktimer_wheel") };
+
+#ifndef TEST
+static void ktimer_rearm(void);
+#else
+static inline void ktimer_rearm(void) { }
+#endif
+
+/**
+ * level_shift - Tick shift of a wheel level
+ * @level: Level
+ *
+ * Return: Shift
+ */
+static inline uint32_t level_shift(uint32_t level) {
+    return level * KTIMER_WHEEL_BITS;
+}
+
+/**
+ * enqueue - Hash a timer into the slot covering its expiry
+ * @timer: Timer with @expires set
+ *
+ * Must be called with the wheel lock held.
+ * Return: Nothing
+ */
+static void enqueue(ktimer_t *timer) {
+    uint64_t delta = timer->expires > wheel.clk ? timer->expires - wheel.clk : 0;
+    uint32_t level = 0;
+
+    if (delta > KTIMER_MAX_DELTA) {
+        timer->expires = wheel.clk + KTIMER_MAX_DELTA;
+        delta = KTIMER_MAX_DELTA;
+    }
+    while (delta >> level_shift(level + 1))
+        level++;
+
+    /* Past expiries go in the slot processed next */
+    uint64_t when = delta ? timer->expires : wheel.clk;
+    uint32_t slot = (uint32_t)(when >> level_shift(level)) & KTIMER_WHEEL_MASK;
+    ktimer_t **head = &wheel.slots[level][slot];
+
+    timer->next = *head;
+    if (*head)
+        (*head)->pprev = &timer->next;
+    timer->pprev = head;
+    *head = timer;
+    wheel.occupied[level] |= 1ULL << slot;
+    wheel.count++;
+}
+
+/**
+ * dequeue - Unlink a pending timer
+ * @timer: Timer to remove
+ *
+ * The timer may be on a wheel slot or on the local expiry list of
+ * ktimer_run(). Must be called with the wheel lock held.
+ * Return: 1 if the timer was pending, 0 otherwise
+ */
+static int dequeue(ktimer_t *timer) {
+    if (!timer->pprev)
+        return 0;
+
+    *timer->pprev = timer->next;
+    if (timer->next)
+        timer->next->pprev = timer->pprev;
+
+    /* Clear the occupancy bit if that was the slot's last timer */
+    uintptr_t link = (uintptr_t)timer->pprev;
+    uintptr_t slots = (uintptr_t)&wheel.slots[0][0];
+    if (link >= slots && link < (uintptr_t)(&wheel.slots[0][0] + KTIMER_WHEEL_LEVELS * KTIMER_WHEEL_SIZE)) {
+        uint32_t index = (uint32_t)((link - slots) / sizeof(ktimer_t *));
+        if (!*timer->pprev)
+            wheel.occupied[index / KTIMER_WHEEL_SIZE] &= ~(1ULL << (index % KTIMER_WHEEL_SIZE));
+    }
+
+    timer->next = NULL;
+    timer->pprev = NULL;
+    wheel.count--;
+    return 1;
+}
+
+/**
+ * take_slot - Detach a whole slot list
+ * @level: Level
+ * @slot: Slot index
+ *
+ * Return: The detached list, with pprev links still pointing into the slot
+ */
+static ktimer_t *take_slot(uint32_t level, uint32_t slot) {
+    ktimer_t *list = wheel.slots[level][slot];
+    wheel.slots[level][slot] = NULL;
+    wheel.occupied[level] &= ~(1ULL << slot);
+    return list;
+}
+
+/**
+ * cascade - Re-hash one slot of a coarse level into finer levels
+ * @level: Level to cascade from (1 or more)
+ *
+ * Return: Slot index that was cascaded
+ */
+static uint32_t cascade(uint32_t level) {
+    uint32_t slot = (uint32_t)(wheel.clk >> level_shift(level)) & KTIMER_WHEEL_MASK;
+    ktimer_t *timer = take_slot(level, slot);
+
+    while (timer) {
+        ktimer_t *next = timer->next;
+        wheel.count--;
+        enqueue(timer);
+        timer = next;
+    }
+    return slot;
+}
+
+void ktimer_init(ktimer_t *timer, void (*fn)(ktimer_t *timer), void *arg) {
+    timer->expires = 0;
+    timer->fn = fn;
+    timer->arg = arg;
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+void ktimer_add(ktimer_t *timer, uint64_t expires) {
+    uint32_t flags = spin_lock_irqsave(&wheel.lock);
+    dequeue(timer);
+    timer->expires = expires;
+    enqueue(timer);
+    spin_unlock_irqrestore(&wheel.lock, flags);
+
+    ktimer_rearm();
+}
+
+int ktimer_cancel(ktimer_t *timer) {
+    uint32_t flags = spin_lock_irqsave(&wheel.lock);
+    int ret = dequeue(timer);
+    spin_unlock_irqrestore(&wheel.lock, flags);
+    return ret;
+}
+
+/**
+ * next_tick - Earliest tick with work
+ *
+ * Must be called with the wheel lock held.
+ * Return: Tick, or KTIMER_NONE
+ */
+static uint64_t next_tick(void) {
+    if (!wheel.count)
+        return KTIMER_NONE;
+
+    uint64_t next = KTIMER_NONE;
+    uint32_t index = (uint32_t)wheel.clk & KTIMER_WHEEL_MASK;
+    uint64_t bits = wheel.occupied[0];
+
+    /* Rotate so bit 0 is the slot of wheel.clk */
+    if (bits) {
+        bits = index ? (bits >> index) | (bits << (KTIMER_WHEEL_SIZE - index)) : bits;
+        next = wheel.clk + __builtin_ctzll(bits);
+    }
+
+    /* Coarser timers cascade no earlier than the next level-0 wrap */
+    for (uint32_t level = 1; level < KTIMER_WHEEL_LEVELS; level++) {
+        if (wheel.occupied[level]) {
+            uint64_t wrap = (wheel.clk | KTIMER_WHEEL_MASK) + 1;
+            if (index == 0)
+                wrap = wheel.clk;
+            if (wrap < next)
+                next = wrap;
+            break;
+        }
+    }
+    return next;
+}
+
+uint64_t ktimer_next_tick(void) {
+    uint32_t flags = spin_lock_irqsave(&wheel.lock);
+    uint64_t next = next_tick();
+    spin_unlock_irqrestore(&wheel.lock, flags);
+    return next;
+}
+
+void ktimer_run(uint64_t now) {
+    uint32_t flags = spin_lock_irqsave(&wheel.lock);
+
+    while (wheel.clk <= now) {
+        /* Jump over ticks with nothing to expire or cascade */
+        uint64_t next = next_tick();
+        if (next > now) {
+            wheel.clk = now + 1;
+            break;
+        }
+        wheel.clk = next;
+
+        uint32_t index = (uint32_t)wheel.clk & KTIMER_WHEEL_MASK;
+        for (uint32_t level = 1; !index && level < KTIMER_WHEEL_LEVELS; level++)
+            index = cascade(level);
+
+        /* Callbacks may cancel or re-add timers still on the expiry list */
+        ktimer_t *expired = take_slot(0, (uint32_t)wheel.clk & KTIMER_WHEEL_MASK);
+        if (expired)
+            expired->pprev = &expired;
+        wheel.clk++;
+
+        while (expired) {
+            ktimer_t *timer = expired;
+            dequeue(timer);
+
+            spin_unlock_irqrestore(&wheel.lock, flags);
+            timer->fn(timer);
+            flags = spin_lock_irqsave(&wheel.lock);
+        }
+    }
+
+    spin_unlock_irqrestore(&wheel.lock, flags);
+}
+
+void ktimer_wheel_reset(uint64_t now) {
+    uint32_t flags = spin_lock_irqsave(&wheel.lock);
+    for (uint32_t level = 0; level < KTIMER_WHEEL_LEVELS; level++) {
+        for (uint32_t slot = 0; slot < KTIMER_WHEEL_SIZE; slot++)
+            wheel.slots[level][slot] = NULL;
+        wheel.occupied[level] = 0;
+    }
+    wheel.clk = now;
+    wheel.count = 0;
+    spin_unlock_irqrestore(&wheel.lock, flags);
+}
+
+#ifndef TEST
+/**
+ * wheel_timer - Fires at the next tick with wheel work
+ */
+static hrtimer_t wheel_timer;
+
+/**
+ * ktimer_softirq - Run expired timers outside the interrupt
+ * @arg: Unused
+ *
+ * Return: Nothing
+ */
+static void ktimer_softirq(void *arg) {
+    (void)arg;
+
+    /* timer_ticks only advances on the bootstrap CPU, which may be idle */
+    ktimer_run(ktime_get_ns() / NSEC_PER_TICK);
+    ktimer_rearm();
+}
+
+/**
+ * wheel_timer_fn - hrtimer callback, defers the wheel to softirq context
+ * @timer: wheel_timer
+ *
+ * Return: Nothing
+ */
+static void wheel_timer_fn(hrtimer_t *timer) {
+    /* Retry next tick rather than stall the wheel if the ring is full */
+    if (softirq_raise(ktimer_softirq, NULL) == -1) {
+        spin_lock(&wheel.lock);
+        hrtimer_start(timer, timer->expires_ns + NSEC_PER_TICK);
+        spin_unlock(&wheel.lock);
+    }
+}
+
+/**
+ * ktimer_rearm - Arm wheel_timer for the next tick with work
+ *
+ * Return: Nothing
+ */
+static void ktimer_rearm(void) {
+    /* The lock also keeps two CPUs from arming wheel_timer at once */
+    uint32_t flags = spin_lock_irqsave(&wheel.lock);
+    uint64_t next = next_tick();
+
+    if (next == KTIMER_NONE)
+        hrtimer_cancel(&wheel_timer);
+    else if (!wheel_timer.queued || wheel_timer.expires_ns != next * NSEC_PER_TICK)
+        hrtimer_start(&wheel_timer, next * NSEC_PER_TICK);
+    spin_unlock_irqrestore(&wheel.lock, flags);
+}
+
+void ktimer_subsys_init(void) {
+    hrtimer_init(&wheel_timer, wheel_timer_fn, NULL);
+    ktimer_wheel_reset(timer_ticks);
+}
+#endif
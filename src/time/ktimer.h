@@ -0,0 +1,131 @@
+#ifndef KTIMER_H
+#define KTIMER_H
+
+#include <stdint.h>
+
+/**
+ * KTIMER_WHEEL_BITS - log2 of the slots per wheel level
+ */
+#define KTIMER_WHEEL_BITS       6
+
+/**
+ * KTIMER_WHEEL_SIZE - Slots per wheel level
+ */
+#define KTIMER_WHEEL_SIZE       (1U << KTIMER_WHEEL_BITS)
+
+/**
+ * KTIMER_WHEEL_LEVELS - Wheel levels; level n has a granularity of
+ * 64^n ticks
+ */
+#define KTIMER_WHEEL_LEVELS     4
+
+/**
+ * KTIMER_MAX_DELTA - Longest timeout in ticks (about 4.6 hours at 1 kHz);
+ * later expiries are clamped
+ */
+#define KTIMER_MAX_DELTA        ((1ULL << (KTIMER_WHEEL_BITS * KTIMER_WHEEL_LEVELS)) - 1)
+
+/**
+ * KTIMER_NONE - ktimer_next_tick() result when nothing is pending
+ */
+#define KTIMER_NONE             UINT64_MAX
+
+/**
+ * struct ktimer_t - Tick-granularity timeout on the timer wheel
+ * @expires: Absolute expiry in timer_ticks
+ * @fn: Callback, run from deferred work with interrupts enabled
+ * @arg: Argument passed to @fn
+ * @next: Next timer in the slot
+ * @pprev: Link pointing at this timer, NULL when not pending
+ *
+ * Callbacks may re-add their own timer.
+ */
+typedef struct ktimer_t {
+    uint64_t expires;
+    void (*fn)(struct ktimer_t *timer);
+    void *arg;
+    struct ktimer_t *next;
+    struct ktimer_t **pprev;
+} ktimer_t;
+
+/**
+ * ktimer_init - Prepare a timer for use
+ * @timer: Timer to initialize
+ * @fn: Callback to run on expiry
+ * @arg: Argument for @fn
+ *
+ * Return: Nothing
+ */
+void ktimer_init(ktimer_t *timer, void (*fn)(ktimer_t *timer), void *arg);
+
+/**
+ * ktimer_add - Arm a timer, replacing any pending expiry
+ * @timer: Timer to arm
+ * @expires: Absolute expiry in timer_ticks; past values fire on the next tick
+ *
+ * O(1): the timer is hashed into the level that covers its distance.
+ *
+ * Return: Nothing
+ */
+void ktimer_add(ktimer_t *timer, uint64_t expires);
+
+/**
+ * ktimer_cancel - Disarm a timer
+ * @timer: Timer to disarm
+ *
+ * Return: 1 if the timer was pending, 0 otherwise
+ */
+int ktimer_cancel(ktimer_t *timer);
+
+/**
+ * ktimer_pending - Check whether a timer is armed
+ * @timer: Timer to check
+ *
+ * Return: Non-zero if pending
+ */
+static inline int ktimer_pending(const ktimer_t *timer) {
+    return timer->pprev != 0;
+}
+
+/**
+ * ktimer_run - Expire every timer due at or before @now
+ * @now: Current tick
+ *
+ * Empty stretches of the wheel are skipped using the slot occupancy
+ * bitmaps, so the cost is proportional to the timers that expire plus
+ * one cascade per 64 ticks, not to the number pending.
+ *
+ * Return: Nothing
+ */
+void ktimer_run(uint64_t now);
+
+/**
+ * ktimer_next_tick - Earliest tick at which ktimer_run() has work
+ *
+ * May be early (a cascade point) but is never late.
+ *
+ * Return: Tick, or KTIMER_NONE if no timer is pending
+ */
+uint64_t ktimer_next_tick(void);
+
+/**
+ * ktimer_wheel_reset - Empty the wheel and set its clock
+ * @now: Tick the wheel processes next
+ *
+ * Return: Nothing
+ */
+void ktimer_wheel_reset(uint64_t now);
+
+#ifndef TEST
+/**
+ * ktimer_subsys_init - Drive the wheel from an hrtimer and deferred work
+ *
+ * The hrtimer is only armed for ticks that have work, so an idle wheel
+ * costs no interrupts.
+ *
+ * Return: Nothing
+ */
+void ktimer_subsys_init(void);
+#endif
+
+#endif
@@ -0,0 +1,70 @@
+#include <stddef.h>
+
+#include "vdso.h"
+#include "clockevent.h"
+#include "../cpu/cpu.h"
+#include "../memory/paging.h"
+#include "../utils.h"
+
+_Static_assert(offsetof(vdso_data_t, ticks) == 8, "layout is shared with src/user/time.h");
+_Static_assert(offsetof(vdso_data_t, base_cycles) == 16, "layout is shared with src/user/time.h");
+_Static_assert(offsetof(vdso_data_t, base_ns) == 24, "layout is shared with src/user/time.h");
+_Static_assert(offsetof(vdso_data_t, mult) == 32, "layout is shared with src/user/time.h");
+_Static_assert(offsetof(vdso_data_t, ns_per_tick) == 40, "layout is shared with src/user/time.h");
+
+/**
+ * vdso_page - Kernel side of the time page; nothing else shares its frame
+ */
+__attribute__((aligned(PAGE_SIZE)))
+static union {
+    vdso_data_t data;
+    uint8_t bytes[PAGE_SIZE];
+} vdso_page;
+
+/**
+ * vdso_write_begin - Start an update of the time page
+ *
+ * Return: Nothing
+ */
+static void vdso_write_begin(void) {
+    vdso_page.data.seq++;
+    barrier();
+}
+
+/**
+ * vdso_write_end - Finish an update of the time page
+ *
+ * Return: Nothing
+ */
+static void vdso_write_end(void) {
+    barrier();
+    vdso_page.data.seq++;
+}
+
+void vdso_init(void) {
+    uint32_t paddr;
+
+    vdso_write_begin();
+    vdso_page.data.ns_per_tick = NSEC_PER_TICK;
+    vdso_write_end();
+
+    if (get_paddr((uint32_t)(uintptr_t)&vdso_page, &paddr) == -1 ||
+        map(VDSO_DATA_ADDR, paddr, PG_FLAG_USER) == -1)
+        panic("Error: could not map the vDSO time page");
+}
+
+void vdso_set_clock(const clocksource_data_t *clock) {
+    vdso_write_begin();
+    vdso_page.data.base_cycles = clock->base_cycles;
+    vdso_page.data.base_ns = clock->base_ns;
+    vdso_page.data.mult = clock->mult;
+    vdso_page.data.shift = clock->shift;
+    vdso_page.data.tsc_enabled = 1;
+    vdso_write_end();
+}
+
+void vdso_set_ticks(uint64_t ticks) {
+    vdso_write_begin();
+    vdso_page.data.ticks = ticks;
+    vdso_write_end();
+}
@@ -0,0 +1,68 @@
+#ifndef VDSO_H
+#define VDSO_H
+
+#include <stdint.h>
+
+#include "clocksource.h"
+
+/**
+ * VDSO_DATA_ADDR - User address of the read-only time page
+ */
+#define VDSO_DATA_ADDR          0xBFFE0000
+
+/**
+ * struct vdso_data_t - Time page shared read-only with ring 3
+ * @seq: Sequence count, odd while an update is in progress
+ * @tsc_enabled: Non-zero if the fields below the tick count are valid
+ * @ticks: timer_ticks as of the last clock event on the bootstrap CPU
+ * @base_cycles: TSC value at @base_ns
+ * @base_ns: Monotonic time at @base_cycles
+ * @mult: Fixed-point nanoseconds per cycle
+ * @shift: Fixed-point shift of @mult (at most 32)
+ * @ns_per_tick: Length of one tick
+ *
+ * Readers take a snapshot between two equal, even reads of @seq; the
+ * layout is fixed, user programs read it through src/user/time.h.
+ * With the TSC in use, time is base_ns + (rdtsc() - base_cycles) scaled
+ * by @mult and @shift; otherwise it is @ticks * @ns_per_tick.
+ */
+typedef struct {
+    volatile uint32_t seq;
+    uint32_t tsc_enabled;
+    uint64_t ticks;
+    uint64_t base_cycles;
+    uint64_t base_ns;
+    uint32_t mult;
+    uint32_t shift;
+    uint32_t ns_per_tick;
+} vdso_data_t;
+
+/**
+ * vdso_init - Map the time page into user space
+ *
+ * Call after paging_init().
+ *
+ * Return: Nothing
+ */
+void vdso_init(void);
+
+/**
+ * vdso_set_clock - Publish a new TSC conversion
+ * @clock: Conversion now used by clock_monotonic_ns()
+ *
+ * Must be called on the bootstrap CPU with interrupts disabled, the time
+ * page has a single writer.
+ * Return: Nothing
+ */
+void vdso_set_clock(const clocksource_data_t *clock);
+
+/**
+ * vdso_set_ticks - Publish the tick count
+ * @ticks: New value of timer_ticks
+ *
+ * Same calling rules as vdso_set_clock().
+ * Return: Nothing
+ */
+void vdso_set_ticks(uint64_t ticks);
+
+#endif
@@ -0,0 +1,123 @@
+#include "user.h"
+#include "time.h"
+
+/**
+ * INIT_TABLE_PAGES - Size of the initialized table, most of it never touched
+ */
+#define INIT_TABLE_PAGES    8
+
+/**
+ * INIT_BSS_PAGES - Size of the zeroed buffer, most of it never touched
+ */
+#define INIT_BSS_PAGES      64
+
+/**
+ * INIT_BAD_ADDR - User address nothing is mapped at, for the bad pointer check
+ */
+#define INIT_BAD_ADDR       0x40000000
+
+/**
+ * INIT_CLOCK_READS - Iterations timed for each way of reading the clock
+ */
+#define INIT_CLOCK_READS    1000
+
+/**
+ * table - File-backed data; only the pages read below come from the disk
+ */
+static volatile uint8_t table[INIT_TABLE_PAGES * 4096] = { 'i', 'n', 'i', 't' };
+
+/**
+ * buffer - Zero-filled data; only the page written below gets a frame
+ */
+static volatile uint8_t buffer[INIT_BSS_PAGES * 4096];
+
+/**
+ * strlen - Length of a string
+ * @s: String
+ *
+ * Return: Bytes before the terminator
+ */
+static uint32_t strlen(const char *s) {
+    uint32_t len = 0;
+    while (s[len])
+        len++;
+    return len;
+}
+
+/**
+ * puts - Write a string to the console
+ * @s: String
+ *
+ * Return: Nothing
+ */
+static void puts(const char *s) {
+    write(s, strlen(s));
+}
+
+/**
+ * put_u32 - Write a number to the console in decimal
+ * @value: Number
+ *
+ * Return: Nothing
+ */
+static void put_u32(uint32_t value) {
+    char digits[11];
+    uint32_t i = sizeof(digits);
+
+    do {
+        digits[--i] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    write(&digits[i], sizeof(digits) - i);
+}
+
+/**
+ * clock_bench - Compare reading the clock from the time page with a system call
+ *
+ * Return: Nothing
+ */
+static void clock_bench(void) {
+    volatile uint64_t sink = 0;
+
+    uint64_t start = rdtsc();
+    for (int i = 0; i < INIT_CLOCK_READS; i++)
+        sink += clock_ns();
+    uint32_t vdso_cycles = (uint32_t)(rdtsc() - start) / INIT_CLOCK_READS;
+
+    start = rdtsc();
+    for (int i = 0; i < INIT_CLOCK_READS; i++)
+        sink += (uint32_t)syscall2(SYS_NULL, 0, 0);
+    uint32_t syscall_cycles = (uint32_t)(rdtsc() - start) / INIT_CLOCK_READS;
+
+    puts("init: clock_ns() ");
+    put_u32(vdso_cycles);
+    puts(" cycles, null system call ");
+    put_u32(syscall_cycles);
+    puts(" cycles\n");
+}
+
+/**
+ * _start - Entry point
+ *
+ * Return: Does not return
+ */
+__attribute__((section(".text.start")))
+void _start(void) {
+    puts("init: running in ring 3\n");
+
+    buffer[0] = table[0];
+    if (buffer[0] == 'i' && table[sizeof(table) - 1] == 0)
+        puts("init: data and bss look right\n");
+    else
+        puts("init: data or bss is wrong\n");
+
+    /* The kernel must refuse the buffer, not fault on it */
+    if (write((const char *)INIT_BAD_ADDR, 16) == -1)
+        puts("init: bad write pointer rejected\n");
+    else
+        puts("init: bad write pointer accepted\n");
+
+    clock_bench();
+
+    exit();
+}
@@ -0,0 +1,65 @@
+#ifndef USER_TIME_H
+#define USER_TIME_H
+
+#include <stdint.h>
+
+/*
+ * Time page the kernel maps read-only at VDSO_DATA_ADDR, see
+ * src/time/vdso.h. Reading it takes no system call.
+ */
+#define VDSO_DATA_ADDR  0xBFFE0000
+
+/**
+ * struct vdso_data_t - Time page layout, must match src/time/vdso.h
+ */
+typedef struct {
+    volatile uint32_t seq;
+    uint32_t tsc_enabled;
+    uint64_t ticks;
+    uint64_t base_cycles;
+    uint64_t base_ns;
+    uint32_t mult;
+    uint32_t shift;
+    uint32_t ns_per_tick;
+} vdso_data_t;
+
+/**
+ * rdtsc - Read the time stamp counter
+ *
+ * Return: Cycle count
+ */
+static inline uint64_t rdtsc(void) {
+    uint32_t lo, hi;
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+/**
+ * clock_ns - Nanoseconds since boot, without entering the kernel
+ *
+ * Exact with the TSC in use, tick granularity otherwise.
+ * Return: Nanoseconds
+ */
+static inline uint64_t clock_ns(void) {
+    const vdso_data_t *vdso = (const vdso_data_t *)VDSO_DATA_ADDR;
+    uint32_t seq;
+    uint64_t ns;
+
+    do {
+        seq = vdso->seq;
+        __asm__ volatile ("" : : : "memory");
+        if (vdso->tsc_enabled) {
+            uint64_t cycles = rdtsc() - vdso->base_cycles;
+            uint64_t low = (uint64_t)(uint32_t)cycles * vdso->mult;
+            uint64_t high = (uint64_t)(uint32_t)(cycles >> 32) * vdso->mult;
+            ns = vdso->base_ns + (low >> vdso->shift) + (high << (32 - vdso->shift));
+        } else {
+            ns = vdso->ticks * vdso->ns_per_tick;
+        }
+        __asm__ volatile ("" : : : "memory");
+    } while ((seq & 1) || seq != vdso->seq);
+
+    return ns;
+}
+
+#endif
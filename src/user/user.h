@@ -0,0 +1,52 @@
+#ifndef USER_H
+#define USER_H
+
+#include <stdint.h>
+
+/*
+ * System call numbers and ABI, see src/interrupts/syscall.h. User
+ * programs are built without the kernel headers.
+ */
+#define SYS_NULL    0
+#define SYS_EXIT    1
+#define SYS_WRITE   2
+
+/**
+ * syscall2 - Make a system call through int 0x80
+ * @nr: System call number
+ * @arg1: First argument (ebx)
+ * @arg2: Second argument (esi)
+ *
+ * Return: The system call's result
+ */
+static inline int32_t syscall2(uint32_t nr, uint32_t arg1, uint32_t arg2) {
+    int32_t ret;
+    __asm__ volatile ("int $0x80"
+                      : "=a"(ret)
+                      : "a"(nr), "b"(arg1), "S"(arg2)
+                      : "ecx", "edx", "memory");
+    return ret;
+}
+
+/**
+ * write - Write a buffer to the console
+ * @buf: Bytes to write
+ * @len: Number of bytes
+ *
+ * Return: @len on success, -1 on failure
+ */
+static inline int32_t write(const char *buf, uint32_t len) {
+    return syscall2(SYS_WRITE, (uint32_t)(uintptr_t)buf, len);
+}
+
+/**
+ * exit - Terminate the calling thread
+ *
+ * Return: Does not return
+ */
+static inline __attribute__((noreturn)) void exit(void) {
+    syscall2(SYS_EXIT, 0, 0);
+    __builtin_unreachable();
+}
+
+#endif
@@ -0,0 +1,135 @@
+#ifdef TEST
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/lib/mem.h"
+
+/**
+ * BENCH_BYTES - Bytes moved per measurement, whatever the block size
+ */
+#define BENCH_BYTES     (256u * 1024 * 1024)
+
+/**
+ * BENCH_MAX_SIZE - Largest block size measured
+ */
+#define BENCH_MAX_SIZE  (16u * 1024 * 1024)
+
+/**
+ * now_ns - Read the host monotonic clock
+ *
+ * Return: Nanoseconds
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * loop_set - Element loop the kernel used before the mem library
+ */
+static void loop_set(void *dst, int c, uint32_t n) {
+    uint8_t *d = dst;
+    for (uint32_t i = 0; i < n; i++)
+        d[i] = (uint8_t)c;
+}
+
+/**
+ * loop_copy - Element loop the kernel used before the mem library
+ */
+static void loop_copy(void *dst, const void *src, uint32_t n) {
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+    for (uint32_t i = 0; i < n; i++)
+        d[i] = s[i];
+}
+
+/**
+ * report - Print throughput of one measurement
+ */
+static void report(const char *what, const char *how, uint32_t size, uint64_t ns) {
+    printf("%-10s %-6s %9u B %8.2f GB/s\n", what, how, size, (double)BENCH_BYTES / ns);
+}
+
+/**
+ * BENCH_CONFIGS - Implementations measured
+ */
+#define BENCH_CONFIGS   3
+
+/**
+ * configs - mem_init() flags for each implementation
+ */
+static const struct {
+    const char *name;
+    uint32_t features;
+} configs[BENCH_CONFIGS] = {
+    { "rep", 0 },
+    { "nt", MEM_FEAT_SSE2 },
+    { "ermsb", MEM_FEAT_SSE2 | MEM_FEAT_ERMSB },
+};
+
+/**
+ * main - Compare the element loops with both kmem* implementations
+ *
+ * Return: 0 on success, 1 on allocation failure
+ */
+int main(void) {
+    static const uint32_t sizes[] = { 4096, 64 * 1024, 1024 * 1024, BENCH_MAX_SIZE };
+    uint8_t *dst = aligned_alloc(MEM_PAGE_SIZE, BENCH_MAX_SIZE);
+    uint8_t *src = aligned_alloc(MEM_PAGE_SIZE, BENCH_MAX_SIZE);
+    if (!dst || !src)
+        return 1;
+
+    loop_set(src, 1, BENCH_MAX_SIZE);
+    loop_set(dst, 1, BENCH_MAX_SIZE);
+
+    for (uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        uint32_t size = sizes[i];
+        uint32_t reps = BENCH_BYTES / size;
+        uint64_t t;
+
+        t = now_ns();
+        for (uint32_t r = 0; r < reps; r++)
+            loop_set(dst, r, size);
+        report("set", "loop", size, now_ns() - t);
+
+        for (uint32_t c = 0; c < BENCH_CONFIGS; c++) {
+            mem_init(configs[c].features);
+            t = now_ns();
+            for (uint32_t r = 0; r < reps; r++)
+                kmemset(dst, r, size);
+            report("kmemset", configs[c].name, size, now_ns() - t);
+        }
+
+        t = now_ns();
+        for (uint32_t r = 0; r < reps; r++)
+            loop_copy(dst, src, size);
+        report("copy", "loop", size, now_ns() - t);
+
+        for (uint32_t c = 0; c < BENCH_CONFIGS; c++) {
+            mem_init(configs[c].features);
+            t = now_ns();
+            for (uint32_t r = 0; r < reps; r++)
+                kmemcpy(dst, src, size);
+            report("kmemcpy", configs[c].name, size, now_ns() - t);
+        }
+    }
+
+    for (uint32_t c = 0; c < BENCH_CONFIGS; c++) {
+        uint32_t pages = BENCH_MAX_SIZE / MEM_PAGE_SIZE;
+        mem_init(configs[c].features);
+        uint64_t t = now_ns();
+        for (uint32_t r = 0; r < BENCH_BYTES / BENCH_MAX_SIZE; r++)
+            for (uint32_t p = 0; p < pages; p++)
+                page_zero(dst + p * MEM_PAGE_SIZE);
+        report("page_zero", configs[c].name, MEM_PAGE_SIZE, now_ns() - t);
+    }
+
+    free(dst);
+    free(src);
+    return 0;
+}
+
+#endif
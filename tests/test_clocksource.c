@@ -0,0 +1,39 @@
+#include "test_clocksource.h"
+
+/**
+ * test_clocksource_cyc2ns - Test the overflow-free cycle conversion
+ *
+ * Compares against a 128-bit reference for TSC rates from 10 MHz to
+ * 5 GHz and cycle counts spanning years.
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_clocksource_cyc2ns(void) {
+    static const uint64_t rates[] = { 10000000ULL, 1193182ULL * 100, 1000000000ULL, 2893000000ULL, 5000000000ULL };
+    static const uint64_t counts[] = { 0, 1, 12345, 0xFFFFFFFFULL, 0x100000000ULL, 0x123456789ABCULL, 1ULL << 50 };
+
+    for (uint32_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        /* Same factor selection as clocksource_init() */
+        uint32_t shift = 32;
+        uint64_t mult = (1000000000ULL << shift) / rates[r];
+        while (mult >> 32) {
+            shift--;
+            mult = (1000000000ULL << shift) / rates[r];
+        }
+
+        for (uint32_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+            unsigned __int128 want = ((unsigned __int128)counts[c] * mult) >> shift;
+            uint64_t got = clocksource_cyc2ns(counts[c], (uint32_t)mult, shift);
+
+            /* The split drops at most one unit of rounding */
+            if (want > UINT64_MAX || got > (uint64_t)want || (uint64_t)want - got > 1)
+                return -1;
+        }
+
+        /* One second of cycles is one second, to within the factor's precision */
+        uint64_t ns = clocksource_cyc2ns(rates[r], (uint32_t)mult, shift);
+        if (ns > 1000000000ULL || 1000000000ULL - ns > 1000)
+            return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef TEST_CLOCKSOURCE_H
+#define TEST_CLOCKSOURCE_H
+
+#include <stdint.h>
+
+#include "../src/time/clocksource.h"
+
+/**
+ * test_clocksource_cyc2ns - Test the overflow-free cycle conversion
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_clocksource_cyc2ns(void);
+
+#endif
@@ -0,0 +1,136 @@
+#include <string.h>
+
+#include "test_elf.h"
+#include "../src/memory/paging.h"
+
+#define FILE_SIZE           0x20000
+#define TEXT_VADDR          0x08048000
+#define DATA_VADDR          0x08049000
+
+/**
+ * struct test_file_t - Headers of a two-segment executable
+ * @eh: File header
+ * @ph: Program headers: text, data, and a non-loadable one
+ */
+typedef struct {
+    elf_header_t eh;
+    elf_phdr_t ph[3];
+} __attribute__((packed)) test_file_t;
+
+static test_file_t file;
+static elf_image_t image;
+
+/**
+ * make_file - Build a valid executable like the one user.ld produces
+ *
+ * Return: Nothing
+ */
+static void make_file(void) {
+    memset(&file, 0, sizeof(file));
+    memcpy(file.eh.e_ident, "\x7f" "ELF", 4);
+    file.eh.e_ident[ELF_EI_CLASS] = ELF_CLASS_32;
+    file.eh.e_ident[ELF_EI_DATA] = ELF_DATA_LSB;
+    file.eh.e_ident[ELF_EI_VERSION] = ELF_VERSION_CURRENT;
+    file.eh.e_type = ELF_ET_EXEC;
+    file.eh.e_machine = ELF_EM_386;
+    file.eh.e_version = 1;
+    file.eh.e_entry = TEXT_VADDR;
+    file.eh.e_phoff = sizeof(elf_header_t);
+    file.eh.e_ehsize = sizeof(elf_header_t);
+    file.eh.e_phentsize = sizeof(elf_phdr_t);
+    file.eh.e_phnum = 3;
+
+    file.ph[0] = (elf_phdr_t){ ELF_PT_LOAD, 0x1000, TEXT_VADDR, TEXT_VADDR, 0xE3, 0xE3, ELF_PF_R | ELF_PF_X, 0x1000 };
+    file.ph[1] = (elf_phdr_t){ ELF_PT_LOAD, 0x2000, DATA_VADDR, DATA_VADDR, 0x8000, 0x48000, ELF_PF_R | ELF_PF_W, 0x1000 };
+    file.ph[2] = (elf_phdr_t){ 0x6474E551, 0, 0, 0, 0, 0, ELF_PF_R | ELF_PF_W, 0x10 };
+}
+
+/**
+ * parse - Parse the test file
+ *
+ * Return: Result of elf_parse()
+ */
+static int parse(void) {
+    return elf_parse(&file, sizeof(file), FILE_SIZE, &image);
+}
+
+int test_elf_parse(void) {
+    /* Valid file: two segments, page counts, permissions */
+    make_file();
+    if (parse() != 0)
+        return -1;
+    if (image.entry != TEXT_VADDR || image.num_segments != 2 || image.pages_total != 1 + 0x48)
+        return -1;
+    if (image.segments[0].flags != PG_FLAG_USER || image.segments[1].flags != (PG_FLAG_USER | PG_FLAG_RW))
+        return -1;
+    if (image.segments[1].offset != 0x2000 || image.segments[1].filesz != 0x8000)
+        return -1;
+
+    /* Wrong identification, type or machine */
+    make_file();
+    file.eh.e_ident[0] = 0;
+    if (parse() != -1)
+        return -1;
+    make_file();
+    file.eh.e_ident[ELF_EI_CLASS] = 2;
+    if (parse() != -1)
+        return -1;
+    make_file();
+    file.eh.e_type = 3;
+    if (parse() != -1)
+        return -1;
+    make_file();
+    file.eh.e_machine = 62;
+    if (parse() != -1)
+        return -1;
+
+    /* Program headers outside the buffer */
+    make_file();
+    file.eh.e_phnum = 4;
+    if (parse() != -1)
+        return -1;
+    make_file();
+    file.eh.e_phoff = 0xFFFFFFF0;
+    if (parse() != -1)
+        return -1;
+
+    /* File bytes past the end of the file, or more than the memory size */
+    make_file();
+    file.ph[1].p_offset = FILE_SIZE - 0x10;
+    if (parse() != -1)
+        return -1;
+    make_file();
+    file.ph[1].p_filesz = 0x50000;
+    if (parse() != -1)
+        return -1;
+
+    /* Kernel addresses and wrap-around */
+    make_file();
+    file.ph[0].p_vaddr = 0x00100000;
+    file.eh.e_entry = 0x00100000;
+    if (parse() != -1)
+        return -1;
+    make_file();
+    file.ph[1].p_vaddr = 0xBFFFF000;
+    if (parse() != -1)
+        return -1;
+
+    /* Segments sharing a page, or out of order */
+    make_file();
+    file.ph[1].p_vaddr = TEXT_VADDR + 0x800;
+    if (parse() != -1)
+        return -1;
+    make_file();
+    file.ph[0].p_vaddr = 0x09000000;
+    file.eh.e_entry = 0x09000000;
+    if (parse() != -1)
+        return -1;
+
+    /* Entry point outside the executable segment */
+    make_file();
+    file.eh.e_entry = DATA_VADDR;
+    if (parse() != -1)
+        return -1;
+
+    return 0;
+}
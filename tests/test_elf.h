@@ -0,0 +1,16 @@
+#ifndef TEST_ELF_H
+#define TEST_ELF_H
+
+#include <stdint.h>
+
+#include "../src/exec/elf.h"
+
+/**
+ * test_elf_parse - Test that valid executables yield their segments and
+ * malformed or misplaced ones are rejected
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_elf_parse(void);
+
+#endif
@@ -0,0 +1,151 @@
+#include "test_ktimer.h"
+
+/**
+ * TEST_KTIMER_COUNT - Timers spread across every wheel level
+ */
+#define TEST_KTIMER_COUNT   2000
+
+/**
+ * timers - Timers under test
+ */
+static ktimer_t timers[TEST_KTIMER_COUNT];
+
+/**
+ * fired_at - Tick each timer fired at, 0 if it has not fired
+ */
+static uint64_t fired_at[TEST_KTIMER_COUNT];
+
+/**
+ * current_tick - Tick passed to the running ktimer_run()
+ */
+static uint64_t current_tick;
+
+/**
+ * record - Callback storing the firing tick
+ * @timer: Expired timer
+ *
+ * Return: Nothing
+ */
+static void record(ktimer_t *timer) {
+    fired_at[timer - timers] = current_tick;
+}
+
+/**
+ * cancel_next - Callback cancelling the timer after it
+ * @timer: Expired timer
+ *
+ * Return: Nothing
+ */
+static void cancel_next(ktimer_t *timer) {
+    record(timer);
+    ktimer_cancel(timer + 1);
+}
+
+/**
+ * rearm - Callback re-adding its own timer 10 ticks later
+ * @timer: Expired timer
+ *
+ * Return: Nothing
+ */
+static void rearm(ktimer_t *timer) {
+    record(timer);
+    if (timer->arg) {
+        timer->arg = 0;
+        ktimer_add(timer, current_tick + 10);
+    }
+}
+
+/**
+ * advance - Run the wheel one tick at a time up to @until
+ * @until: Last tick to run
+ *
+ * Return: Nothing
+ */
+static void advance(uint64_t until) {
+    while (current_tick < until) {
+        current_tick++;
+        ktimer_run(current_tick);
+    }
+}
+
+/**
+ * expiry_of - Deterministic spread of expiries over all levels
+ * @i: Timer index
+ *
+ * Return: Expiry tick
+ */
+static uint64_t expiry_of(uint32_t i) {
+    return 1 + ((uint64_t)i * 2654435761u) % 300000;
+}
+
+/**
+ * test_ktimer_wheel - Test expiry order, cascading, cancel and
+ * re-arming on the timer wheel
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_ktimer_wheel(void) {
+    /* Every timer fires exactly on its tick, whichever level it started in */
+    current_tick = 0;
+    ktimer_wheel_reset(1);
+    for (uint32_t i = 0; i < TEST_KTIMER_COUNT; i++) {
+        fired_at[i] = 0;
+        ktimer_init(&timers[i], record, 0);
+        ktimer_add(&timers[i], expiry_of(i));
+    }
+
+    /* Cancel every tenth; they must never fire */
+    for (uint32_t i = 0; i < TEST_KTIMER_COUNT; i += 10)
+        if (ktimer_cancel(&timers[i]) != 1 || ktimer_pending(&timers[i]))
+            return -1;
+
+    advance(300000);
+    for (uint32_t i = 0; i < TEST_KTIMER_COUNT; i++) {
+        uint64_t want = (i % 10) ? expiry_of(i) : 0;
+        if (fired_at[i] != want || ktimer_pending(&timers[i]))
+            return -1;
+    }
+    if (ktimer_next_tick() != KTIMER_NONE)
+        return -1;
+
+    /* A late ktimer_run() catches up in one call */
+    ktimer_wheel_reset(1);
+    for (uint32_t i = 0; i < 3; i++) {
+        fired_at[i] = 0;
+        ktimer_init(&timers[i], record, 0);
+    }
+    ktimer_add(&timers[0], 5);
+    ktimer_add(&timers[1], 5000);
+    ktimer_add(&timers[2], 70000);
+    if (ktimer_next_tick() != 5)
+        return -1;
+    current_tick = 100000;
+    ktimer_run(current_tick);
+    if (!fired_at[0] || !fired_at[1] || !fired_at[2])
+        return -1;
+
+    /* Callbacks may cancel a sibling on the same tick and re-arm themselves */
+    current_tick = 0;
+    ktimer_wheel_reset(1);
+    for (uint32_t i = 0; i < 3; i++)
+        fired_at[i] = 0;
+    ktimer_init(&timers[0], cancel_next, 0);
+    ktimer_init(&timers[1], record, 0);
+    ktimer_init(&timers[2], rearm, (void *)1);
+    ktimer_add(&timers[1], 20);
+    ktimer_add(&timers[0], 20);
+    ktimer_add(&timers[2], 20);
+    advance(40);
+    if (fired_at[0] != 20 || fired_at[1] != 0 || fired_at[2] != 30)
+        return -1;
+
+    /* Expiries past the wheel range are clamped, not lost */
+    ktimer_wheel_reset(1);
+    ktimer_init(&timers[0], record, 0);
+    ktimer_add(&timers[0], KTIMER_MAX_DELTA * 4);
+    if (timers[0].expires != 1 + KTIMER_MAX_DELTA || !ktimer_pending(&timers[0]))
+        return -1;
+    ktimer_cancel(&timers[0]);
+
+    return 0;
+}
@@ -0,0 +1,16 @@
+#ifndef TEST_KTIMER_H
+#define TEST_KTIMER_H
+
+#include <stdint.h>
+
+#include "../src/time/ktimer.h"
+
+/**
+ * test_ktimer_wheel - Test expiry order, cascading, cancel and
+ * re-arming on the timer wheel
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_ktimer_wheel(void);
+
+#endif
@@ -0,0 +1,118 @@
+#include <stddef.h>
+
+#include "test_lock.h"
+
+int test_lock_rwlock(void) {
+    rwlock_t lock = RWLOCK_INIT("test_rw");
+
+    /* Readers share, writers wait for them */
+    read_lock(&lock);
+    if (!read_trylock(&lock) || write_trylock(&lock))
+        return -1;
+    read_unlock(&lock);
+    read_unlock(&lock);
+    if (lock.value != 0)
+        return -1;
+
+    /* A writer keeps everyone out */
+    write_lock(&lock);
+    if (lock.value != RWLOCK_WRITER || read_trylock(&lock) || write_trylock(&lock))
+        return -1;
+    write_unlock(&lock);
+    if (lock.value != 0 || !write_trylock(&lock))
+        return -1;
+    write_unlock(&lock);
+
+    /* A writer waiting for a reader already blocks new readers */
+    read_lock(&lock);
+    __atomic_or_fetch(&lock.value, RWLOCK_WRITER, __ATOMIC_RELAXED);
+    if (read_trylock(&lock))
+        return -1;
+    __atomic_and_fetch(&lock.value, ~RWLOCK_WRITER, __ATOMIC_RELAXED);
+    read_unlock(&lock);
+
+    rwlock_init(&lock, "test_rw");
+    return lock.value == 0 ? 0 : -1;
+}
+
+int test_lock_tracking(void) {
+    static spinlock_t a = SPINLOCK_INIT("test_a");
+    static spinlock_t b = SPINLOCK_INIT("test_b");
+    static spinlock_t c = SPINLOCK_INIT("test_c");
+    static rwlock_t rw = RWLOCK_INIT("test_rw_dep");
+    lock_stats_t stats;
+
+    /* Acquisitions, spins and holds land in the class of the name */
+    for (int i = 0; i < 3; i++) {
+        spin_lock(&a);
+        spin_unlock(&a);
+    }
+    lock_contended(lock_map_class(&a.map), 100);
+    lock_contended(lock_map_class(&a.map), 40);
+    if (lockstat_get("test_a", &stats) != 0 || lockstat_get("no_such_lock", &stats) != -1)
+        return -1;
+    lockstat_get("test_a", &stats);
+    if (stats.acquisitions != 3 || stats.contended != 2 ||
+        stats.spin_cycles != 140 || stats.max_spin_cycles != 100 ||
+        stats.max_hold_cycles > stats.hold_cycles)
+        return -1;
+    if (lock_class_get("test_a") != a.map.class || lock_class_get(NULL) != lock_class_get("(unnamed)"))
+        return -1;
+
+    /* a before b, then b before c, in properly nested sections */
+    spin_lock(&a);
+    spin_lock(&b);
+    spin_unlock(&b);
+    spin_unlock(&a);
+    spin_lock(&b);
+    spin_lock(&c);
+    spin_unlock(&c);
+    spin_unlock(&b);
+    if (lockdep_violations() != 0)
+        return -1;
+
+    /* b before a inverts the recorded order; reported once */
+    for (int i = 0; i < 2; i++) {
+        spin_lock(&b);
+        spin_lock(&a);
+        spin_unlock(&a);
+        spin_unlock(&b);
+    }
+    if (lockdep_violations() != 1)
+        return -1;
+
+    /* c before a closes the cycle a -> b -> c -> a */
+    spin_lock(&c);
+    spin_lock(&a);
+    spin_unlock(&a);
+    spin_unlock(&c);
+    if (lockdep_violations() != 2)
+        return -1;
+
+    /* Trylocks and nested readers are never reported */
+    spin_lock(&c);
+    if (!spin_trylock(&b))
+        return -1;
+    spin_unlock(&b);
+    spin_unlock(&c);
+    read_lock(&rw);
+    read_lock(&rw);
+    read_unlock(&rw);
+    read_unlock(&rw);
+    if (lockdep_violations() != 2)
+        return -1;
+
+    /* Taking a held spinlock again is */
+    spin_lock(&a);
+    if (spin_trylock(&a))
+        return -1;
+    lock_acquire(lock_map_class(&a.map), 0);
+    lock_release(lock_map_class(&a.map), 0);
+    spin_unlock(&a);
+    if (lockdep_violations() != 3)
+        return -1;
+
+    lockstat_reset();
+    lockstat_get("test_a", &stats);
+    return stats.acquisitions == 0 ? 0 : -1;
+}
@@ -0,0 +1,25 @@
+#ifndef TEST_LOCK_H
+#define TEST_LOCK_H
+
+#include <stdint.h>
+
+#include "../src/cpu/spinlock.h"
+#include "../src/cpu/rwlock.h"
+
+/**
+ * test_lock_rwlock - Test reader sharing, writer exclusion and writer
+ * preference of the reader-writer lock
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_lock_rwlock(void);
+
+/**
+ * test_lock_tracking - Test contention accounting and lock-order
+ * checking (built with LOCK_STAT and LOCKDEP)
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_lock_tracking(void);
+
+#endif
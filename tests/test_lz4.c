@@ -0,0 +1,90 @@
+#include <string.h>
+
+#include "test_lz4.h"
+
+static uint8_t out[1024];
+
+/**
+ * expect - Decompress a block and compare it with the expected output
+ * @src: Block
+ * @src_size: Bytes in @src
+ * @want: Expected output
+ * @want_size: Bytes in @want
+ *
+ * Return: 0 if the output matches, -1 otherwise
+ */
+static int expect(const uint8_t *src, uint32_t src_size, const uint8_t *want, uint32_t want_size) {
+    memset(out, 0xAA, sizeof(out));
+    if (lz4_decompress(src, src_size, out, sizeof(out)) != (int32_t)want_size)
+        return -1;
+    return memcmp(out, want, want_size) == 0 ? 0 : -1;
+}
+
+int test_lz4_decompress(void) {
+    uint8_t want[400];
+
+    /* Literals only */
+    static const uint8_t literals[] = { 0x50, 'h', 'e', 'l', 'l', 'o' };
+    if (expect(literals, sizeof(literals), (const uint8_t *)"hello", 5) != 0)
+        return -1;
+
+    /* Empty block */
+    static const uint8_t empty[] = { 0x00 };
+    if (expect(empty, sizeof(empty), want, 0) != 0)
+        return -1;
+
+    /* A match overlapping its own output repeats a run */
+    static const uint8_t run[] = { 0x24, 'a', 'b', 0x02, 0x00, 0x50, 'x', 'y', 'z', 'z', 'y' };
+    if (expect(run, sizeof(run), (const uint8_t *)"abababababxyzzy", 15) != 0)
+        return -1;
+
+    /* Length extension bytes: 300 literals, then a 19 + 255 + 4 byte match */
+    uint8_t block[320];
+    uint32_t n = 0;
+    block[n++] = 0xFF;
+    block[n++] = 255;
+    block[n++] = 300 - 15 - 255;
+    for (uint32_t i = 0; i < 300; i++) {
+        block[n++] = (uint8_t)i;
+        want[i] = (uint8_t)i;
+    }
+    block[n++] = 1;
+    block[n++] = 0;
+    block[n++] = 255;
+    block[n++] = 4;
+    block[n++] = 0x00;
+    uint32_t size = 300 + 15 + 255 + 4 + LZ4_MIN_MATCH;
+    if (lz4_decompress(block, n, out, sizeof(out)) != (int32_t)size)
+        return -1;
+    if (memcmp(out, want, 300) != 0)
+        return -1;
+    for (uint32_t i = 300; i < size; i++) {
+        if (out[i] != 299 % 256)
+            return -1;
+    }
+
+    /* Output that does not fit */
+    if (lz4_decompress(block, n, out, size - 1) != -1)
+        return -1;
+    if (lz4_decompress(literals, sizeof(literals), out, 4) != -1)
+        return -1;
+
+    /* Offset of zero or before the start of the output */
+    static const uint8_t zero_offset[] = { 0x10, 'a', 0x00, 0x00, 0x00 };
+    if (lz4_decompress(zero_offset, sizeof(zero_offset), out, sizeof(out)) != -1)
+        return -1;
+    static const uint8_t far_offset[] = { 0x10, 'a', 0x02, 0x00, 0x00 };
+    if (lz4_decompress(far_offset, sizeof(far_offset), out, sizeof(out)) != -1)
+        return -1;
+
+    /* Truncated literals, offset and length extension */
+    if (lz4_decompress(literals, sizeof(literals) - 1, out, sizeof(out)) != -1)
+        return -1;
+    if (lz4_decompress(run, 4, out, sizeof(out)) != -1)
+        return -1;
+    static const uint8_t open_length[] = { 0xF0, 255 };
+    if (lz4_decompress(open_length, sizeof(open_length), out, sizeof(out)) != -1)
+        return -1;
+
+    return 0;
+}
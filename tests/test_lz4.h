@@ -0,0 +1,16 @@
+#ifndef TEST_LZ4_H
+#define TEST_LZ4_H
+
+#include <stdint.h>
+
+#include "../src/lib/lz4.h"
+
+/**
+ * test_lz4_decompress - Test that valid blocks expand to the expected
+ * bytes and malformed or oversized ones are rejected
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_lz4_decompress(void);
+
+#endif
@@ -0,0 +1,127 @@
+#include <stdlib.h>
+
+#include "test_mem.h"
+
+/**
+ * TEST_MEM_SIZE - Buffer size, large enough to reach the non-temporal path
+ */
+#define TEST_MEM_SIZE   (MEM_NT_THRESHOLD + 3 * MEM_PAGE_SIZE)
+
+/**
+ * check_set - Fill part of a buffer and verify it and the guard bytes
+ * @buf: Buffer of TEST_MEM_SIZE bytes
+ * @off: Start offset
+ * @n: Bytes to fill
+ *
+ * Return: 0 on success, -1 on failure
+ */
+static int check_set(uint8_t *buf, uint32_t off, uint32_t n) {
+    for (uint32_t i = 0; i < TEST_MEM_SIZE; i++)
+        buf[i] = 0xEE;
+
+    if (kmemset(buf + off, 0x5A, n) != buf + off)
+        return -1;
+
+    for (uint32_t i = 0; i < TEST_MEM_SIZE; i++) {
+        uint8_t want = (i >= off && i < off + n) ? 0x5A : 0xEE;
+        if (buf[i] != want)
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * check_copy - Copy between offsets and verify it and the guard bytes
+ * @dst: Destination buffer of TEST_MEM_SIZE bytes
+ * @src: Source buffer of TEST_MEM_SIZE bytes
+ * @doff: Destination offset
+ * @soff: Source offset
+ * @n: Bytes to copy
+ *
+ * Return: 0 on success, -1 on failure
+ */
+static int check_copy(uint8_t *dst, const uint8_t *src, uint32_t doff, uint32_t soff, uint32_t n) {
+    for (uint32_t i = 0; i < TEST_MEM_SIZE; i++)
+        dst[i] = 0xEE;
+
+    if (kmemcpy(dst + doff, src + soff, n) != dst + doff)
+        return -1;
+
+    for (uint32_t i = 0; i < TEST_MEM_SIZE; i++) {
+        uint8_t want = (i >= doff && i < doff + n) ? src[i - doff + soff] : 0xEE;
+        if (dst[i] != want)
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * check_all - Run every check with the current implementation
+ * @dst: Destination buffer of TEST_MEM_SIZE bytes
+ * @src: Source buffer of TEST_MEM_SIZE bytes
+ *
+ * Return: 0 on success, -1 on failure
+ */
+static int check_all(uint8_t *dst, const uint8_t *src) {
+    static const uint32_t sizes[] = { 0, 1, 3, 15, 16, 17, 63, 4096, 4099, MEM_NT_THRESHOLD, MEM_NT_THRESHOLD + 77 };
+    static const uint32_t offs[] = { 0, 1, 3, 8 };
+
+    for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        for (uint32_t o = 0; o < sizeof(offs) / sizeof(offs[0]); o++) {
+            if (check_set(dst, offs[o], sizes[s]) != 0)
+                return -1;
+            if (check_copy(dst, src, offs[o], offs[(o + 1) % 4], sizes[s]) != 0)
+                return -1;
+        }
+    }
+
+    /* 16-bit fill leaves neighbours alone */
+    uint16_t cells[8] = { 0 };
+    kmemset16(&cells[1], 0x0F20, 6);
+    if (cells[0] != 0 || cells[1] != 0x0F20 || cells[6] != 0x0F20 || cells[7] != 0)
+        return -1;
+
+    /* Page zero on a page-aligned block inside the buffer */
+    uint8_t *page = (uint8_t *)(((uintptr_t)dst + MEM_PAGE_SIZE - 1) & ~(uintptr_t)(MEM_PAGE_SIZE - 1));
+    for (uint32_t i = 0; i < 2 * MEM_PAGE_SIZE; i++)
+        page[i] = 0xEE;
+    page_zero(page);
+    for (uint32_t i = 0; i < 2 * MEM_PAGE_SIZE; i++)
+        if (page[i] != (i < MEM_PAGE_SIZE ? 0 : 0xEE))
+            return -1;
+
+    return 0;
+}
+
+/**
+ * test_mem_ops - Test kmemset, kmemset16, kmemcpy and page_zero on the
+ * rep string, SSE2 non-temporal and ERMSB paths
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_mem_ops(void) {
+    uint8_t *dst = malloc(TEST_MEM_SIZE);
+    uint8_t *src = malloc(TEST_MEM_SIZE);
+    int ret = -1;
+
+    if (!dst || !src)
+        goto out;
+
+    for (uint32_t i = 0; i < TEST_MEM_SIZE; i++)
+        src[i] = (uint8_t)(i * 7 + (i >> 8));
+
+    /* Exercised regardless of the host CPU; x86-64 always has SSE2 */
+    static const uint32_t configs[] = { 0, MEM_FEAT_SSE2, MEM_FEAT_SSE2 | MEM_FEAT_ERMSB };
+    for (uint32_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++) {
+        mem_init(configs[c]);
+        if (check_all(dst, src) != 0)
+            goto out;
+    }
+
+    ret = 0;
+out:
+    mem_init(0);
+    free(dst);
+    free(src);
+    return ret;
+}
@@ -0,0 +1,16 @@
+#ifndef TEST_MEM_H
+#define TEST_MEM_H
+
+#include <stdint.h>
+
+#include "../src/lib/mem.h"
+
+/**
+ * test_mem_ops - Test kmemset, kmemset16, kmemcpy and page_zero on the
+ * rep string, SSE2 non-temporal and ERMSB paths
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_mem_ops(void);
+
+#endif
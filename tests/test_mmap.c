@@ -1,4 +1,7 @@
+#include <string.h>
+
 #include "test_mmap.h"
+#include "../src/boot/multiboot.h"
 
 #include "../src/utils.h"
 
@@ -29,3 +32,64 @@ int test_mmap_init(void) {
     return 0;
 }
 
+/**
+ * expect_section - Check one section of a memory map
+ * @map: Memory map
+ * @i: Section index
+ * @start: Expected start
+ * @end: Expected end
+ * @type: Expected type
+ *
+ * Return: 0 if it matches, -1 otherwise
+ */
+static int expect_section(const mmap_t *map, uint32_t i, uint32_t start, uint32_t end, mtype_t type) {
+    if (i >= map->count)
+        return -1;
+    const msection_t *section = &map->sections[i];
+    return section->start == start && section->end == end && section->type == type ? 0 : -1;
+}
+
+int test_mmap_multiboot(void) {
+    static mmap_t map;
+    /* Out of order, touching and overlapping, like some firmware reports */
+    static const multiboot_mmap_entry_t entries[] = {
+        { 20, 0x00100000, 0x03F00000, MULTIBOOT_MEMORY_AVAILABLE },
+        { 20, 0x00000000, 0x0009FC00, MULTIBOOT_MEMORY_AVAILABLE },
+        { 20, 0x0009FC00, 0x00000400, 2 },
+        { 20, 0x04000000, 0x02000000, MULTIBOOT_MEMORY_AVAILABLE },
+        { 20, 0x05000000, 0x02FE0000, MULTIBOOT_MEMORY_AVAILABLE },
+        { 20, 0x07FE0000, 0x00020000, 2 },
+        { 20, 0x10000000, 0x00001000, 3 },
+        { 20, 0x20000000, 0x10000000, MULTIBOOT_MEMORY_AVAILABLE },
+        { 20, 0xFFFC0000, 0x00040000, 2 },
+        { 20, 0x100000000ULL, 0x40000000, MULTIBOOT_MEMORY_AVAILABLE },
+    };
+
+    mmap_init_multiboot(&map, entries, sizeof(entries));
+    if (map.count != 6)
+        return -1;
+    if (expect_section(&map, 0, ADDR_IO_START, ADDR_IO_END, SECTION_IO) != 0 ||
+        expect_section(&map, 1, ADDR_KERNEL_START, ADDR_KERNEL_END, SECTION_KERNEL) != 0 ||
+        expect_section(&map, 2, ADDR_FREE_START, 0x07FDFFFF, SECTION_FREE) != 0 ||
+        expect_section(&map, 3, 0x07FE0000, 0x1FFFFFFF, SECTION_RESERVED) != 0 ||
+        expect_section(&map, 4, 0x20000000, 0x2FFFFFFF, SECTION_FREE) != 0 ||
+        expect_section(&map, 5, 0x30000000, ADDR_FREE_END, SECTION_RESERVED) != 0)
+        return -1;
+
+    /* Entries larger than the structure, RAM up to 4 GiB */
+    static uint8_t padded[2 * 28];
+    multiboot_mmap_entry_t entry = { 24, 0x00000000, 0x100000000ULL, MULTIBOOT_MEMORY_AVAILABLE };
+    memcpy(padded, &entry, sizeof(entry));
+    entry = (multiboot_mmap_entry_t){ 24, 0x00000000, 0x00001000, 2 };
+    memcpy(padded + 28, &entry, sizeof(entry));
+    mmap_init_multiboot(&map, padded, sizeof(padded));
+    if (map.count != 3 || expect_section(&map, 2, ADDR_FREE_START, ADDR_FREE_END, SECTION_FREE) != 0)
+        return -1;
+
+    /* No map at all: nothing above the kernel is free */
+    mmap_init_multiboot(&map, entries, 0);
+    if (map.count != 3 || expect_section(&map, 2, ADDR_FREE_START, ADDR_FREE_END, SECTION_RESERVED) != 0)
+        return -1;
+
+    return 0;
+}
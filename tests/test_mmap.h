@@ -12,4 +12,12 @@
  */
 int test_mmap_init(void);
 
+/**
+ * test_mmap_multiboot - Test that a Multiboot memory map frees only the
+ * available RAM above the kernel, merging touching entries
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_mmap_multiboot(void);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "test_printf.h"
+
+/**
+ * str_equal - Compare two NUL-terminated strings
+ * @a: First string
+ * @b: Second string
+ *
+ * Return: 1 if equal, 0 otherwise
+ */
+static int str_equal(const char *a, const char *b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+/**
+ * test_printf_format - Test kvsnprintf conversions and truncation
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_printf_format(void) {
+    char buf[64];
+
+    ksnprintf(buf, sizeof(buf), "%d %u %x %X", -42, 42u, 0xbeefu, 0xbeefu);
+    if (!str_equal(buf, "-42 42 beef BEEF"))
+        return -1;
+
+    ksnprintf(buf, sizeof(buf), "[%08x] [%5d] [%03d]", 0x1234u, -7, -7);
+    if (!str_equal(buf, "[00001234] [   -7] [-07]"))
+        return -1;
+
+    ksnprintf(buf, sizeof(buf), "%llu %llx", 18446744073709551615ULL, 0x123456789ABCDEFULL);
+    if (!str_equal(buf, "18446744073709551615 123456789abcdef"))
+        return -1;
+
+    ksnprintf(buf, sizeof(buf), "%s|%4s|%c|%%", "abc", "z", 'q');
+    if (!str_equal(buf, "abc|   z|q|%"))
+        return -1;
+
+    /* Truncated output stays terminated and reports the full length */
+    int len = ksnprintf(buf, 6, "%s", "truncated");
+    if (len != 9 || !str_equal(buf, "trunc"))
+        return -1;
+
+    return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef TEST_PRINTF_H
+#define TEST_PRINTF_H
+
+#include <stdint.h>
+
+#include "../src/lib/printf.h"
+
+/**
+ * test_printf_format - Test kvsnprintf conversions and truncation
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_printf_format(void);
+
+#endif
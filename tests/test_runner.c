@@ -5,6 +5,15 @@
 
 #include "test_falloc.h"
 #include "test_mmap.h"
+#include "test_printf.h"
+#include "test_mem.h"
+#include "test_ktimer.h"
+#include "test_clocksource.h"
+#include "test_spinlock.h"
+#include "test_wsdeque.h"
+#include "test_lock.h"
+#include "test_elf.h"
+#include "test_lz4.h"
 
 /**
  * panic - Provide panic for code under test
@@ -40,6 +49,83 @@ static int run(void) {
         fprintf(stdout, "PASS: test_mmap_init\n");
     }
 
+    if (test_mmap_multiboot() != 0) {
+        fprintf(stderr, "FAIL: test_mmap_multiboot\n");
+        failed = 1;
+    } else {
+        fprintf(stdout, "PASS: test_mmap_multiboot\n");
+    }
+
+    if (test_printf_format() != 0) {
+        fprintf(stderr, "FAIL: test_printf_format\n");
+        failed = 1;
+    } else {
+        fprintf(stdout, "PASS: test_printf_format\n");
+    }
+
+    if (test_mem_ops() != 0) {
+        fprintf(stderr, "FAIL: test_mem_ops\n");
+        failed = 1;
+    } else {
+        fprintf(stdout, "PASS: test_mem_ops\n");
+    }
+
+    if (test_ktimer_wheel() != 0) {
+        fprintf(stderr, "FAIL: test_ktimer_wheel\n");
+        failed = 1;
+    } else {
+        fprintf(stdout, "PASS: test_ktimer_wheel\n");
+    }
+
+    if (test_clocksource_cyc2ns() != 0) {
+        fprintf(stderr, "FAIL: test_clocksource_cyc2ns\n");
+        failed = 1;
+    } else {
+        fprintf(stdout, "PASS: test_clocksource_cyc2ns\n");
+    }
+
+    if (test_spinlock_tickets() != 0) {
+        fprintf(stderr, "FAIL: test_spinlock_tickets\n");
+        failed = 1;
+    } else {
+        fprintf(stdout, "PASS: test_spinlock_tickets\n");
+    }
+
+    if (test_wsdeque_steal() != 0) {
+        fprintf(stderr, "FAIL: test_wsdeque_steal\n");
+        failed = 1;
+    } else {
+        fprintf(stdout, "PASS: test_wsdeque_steal\n");
+    }
+
+    if (test_lock_rwlock() != 0) {
+        fprintf(stderr, "FAIL: test_lock_rwlock\n");
+        failed = 1;
+    } else {
+        fprintf(stdout, "PASS: test_lock_rwlock\n");
+    }
+
+    if (test_lock_tracking() != 0) {
+        fprintf(stderr, "FAIL: test_lock_tracking\n");
+        failed = 1;
+    } else {
+        fprintf(stdout, "PASS: test_lock_tracking\n");
+    }
+
+    if (test_elf_parse() != 0) {
+        fprintf(stderr, "FAIL: test_elf_parse\n");
+        failed = 1;
+    } else {
+        fprintf(stdout, "PASS: test_elf_parse\n");
+    }
+
+    if (test_lz4_decompress() != 0) {
+        fprintf(stderr, "FAIL: test_lz4_decompress\n");
+        failed = 1;
+    } else {
+        fprintf(stdout, "PASS: test_lz4_decompress\n");
+    }
+
     return failed;
 }
 
@@ -0,0 +1,46 @@
+#include "test_spinlock.h"
+
+/**
+ * test_spinlock_tickets - Test ticket hand-out, trylock and wraparound
+ *
+ * A waiter is simulated by taking a ticket by hand: trylock must then
+ * refuse the lock even after the holder releases it, since taking it
+ * would jump the queue.
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_spinlock_tickets(void) {
+    spinlock_t lock = SPINLOCK_INIT("test");
+
+    if (spin_is_locked(&lock) || !spin_trylock(&lock))
+        return -1;
+    if (!spin_is_locked(&lock) || spin_trylock(&lock))
+        return -1;
+    spin_unlock(&lock);
+    if (spin_is_locked(&lock))
+        return -1;
+
+    /* Holder plus one queued waiter */
+    spin_lock(&lock);
+    uint16_t waiter = __atomic_fetch_add(&lock.next, 1, __ATOMIC_RELAXED);
+    spin_unlock(&lock);
+    if (lock.owner != waiter || spin_trylock(&lock))
+        return -1;
+    spin_unlock(&lock);
+    if (spin_is_locked(&lock))
+        return -1;
+
+    /* Tickets are 16 bits and must survive wrapping */
+    spin_lock_init(&lock, "test");
+    lock.owner = 0xFFFF;
+    lock.next = 0xFFFF;
+    spin_lock(&lock);
+    if (lock.next != 0 || !spin_is_locked(&lock))
+        return -1;
+    spin_unlock(&lock);
+    if (lock.owner != 0 || spin_is_locked(&lock) || !spin_trylock(&lock))
+        return -1;
+    spin_unlock(&lock);
+
+    return 0;
+}
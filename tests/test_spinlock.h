@@ -0,0 +1,15 @@
+#ifndef TEST_SPINLOCK_H
+#define TEST_SPINLOCK_H
+
+#include <stdint.h>
+
+#include "../src/cpu/spinlock.h"
+
+/**
+ * test_spinlock_tickets - Test ticket hand-out, trylock and wraparound
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_spinlock_tickets(void);
+
+#endif
@@ -0,0 +1,103 @@
+#include <pthread.h>
+#include <stddef.h>
+
+#include "test_wsdeque.h"
+
+#define STRESS_ITEMS        200000
+#define STRESS_THIEVES      3
+
+static wsdeque_t deque;
+static uint8_t taken[STRESS_ITEMS + 1];
+static volatile int done;
+
+/**
+ * take - Record that an item was consumed
+ * @item: Item, an index into taken[] offset by one
+ *
+ * Return: Nothing
+ */
+static void take(void *item) {
+    __atomic_fetch_add(&taken[(uintptr_t)item], 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * thief - Steal until the owner is finished and the deque is empty
+ * @arg: Unused
+ *
+ * Return: NULL
+ */
+static void *thief(void *arg) {
+    (void)arg;
+    while (!__atomic_load_n(&done, __ATOMIC_ACQUIRE) || wsdeque_size(&deque)) {
+        void *item = wsdeque_steal(&deque);
+        if (item)
+            take(item);
+    }
+    return NULL;
+}
+
+int test_wsdeque_steal(void) {
+    /* Owner pops LIFO, thieves steal FIFO */
+    wsdeque_init(&deque);
+    if (wsdeque_pop(&deque) || wsdeque_steal(&deque))
+        return -1;
+    for (uintptr_t i = 1; i <= 3; i++) {
+        if (wsdeque_push(&deque, (void *)i) != 0)
+            return -1;
+    }
+    if (wsdeque_size(&deque) != 3)
+        return -1;
+    if (wsdeque_steal(&deque) != (void *)1 || wsdeque_pop(&deque) != (void *)3)
+        return -1;
+    if (wsdeque_pop(&deque) != (void *)2 || wsdeque_pop(&deque) || wsdeque_steal(&deque))
+        return -1;
+
+    /* Full deque refuses, and indices keep working after wrapping the ring */
+    for (uintptr_t i = 1; i <= WSDEQUE_SIZE; i++) {
+        if (wsdeque_push(&deque, (void *)i) != 0)
+            return -1;
+    }
+    if (wsdeque_push(&deque, (void *)1) != -1)
+        return -1;
+    for (uintptr_t i = 1; i <= WSDEQUE_SIZE; i++) {
+        if (wsdeque_steal(&deque) != (void *)i || wsdeque_push(&deque, (void *)i) != 0)
+            return -1;
+    }
+    while (wsdeque_pop(&deque))
+        ;
+    if (wsdeque_size(&deque) != 0)
+        return -1;
+
+    /* Owner pushes and pops while thieves race it for the same items */
+    pthread_t thieves[STRESS_THIEVES];
+    wsdeque_init(&deque);
+    done = 0;
+    for (int i = 0; i < STRESS_THIEVES; i++) {
+        if (pthread_create(&thieves[i], NULL, thief, NULL) != 0)
+            return -1;
+    }
+
+    uintptr_t next = 1;
+    while (next <= STRESS_ITEMS) {
+        for (int i = 0; i < 8 && next <= STRESS_ITEMS; i++) {
+            if (wsdeque_push(&deque, (void *)next) == 0)
+                next++;
+        }
+        void *item = wsdeque_pop(&deque);
+        if (item)
+            take(item);
+    }
+    void *item;
+    while ((item = wsdeque_pop(&deque)))
+        take(item);
+
+    __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < STRESS_THIEVES; i++)
+        pthread_join(thieves[i], NULL);
+
+    for (uint32_t i = 1; i <= STRESS_ITEMS; i++) {
+        if (taken[i] != 1)
+            return -1;
+    }
+    return 0;
+}
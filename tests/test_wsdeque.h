@@ -0,0 +1,16 @@
+#ifndef TEST_WSDEQUE_H
+#define TEST_WSDEQUE_H
+
+#include <stdint.h>
+
+#include "../src/lib/wsdeque.h"
+
+/**
+ * test_wsdeque_steal - Test owner/thief ordering, overflow, and that
+ * concurrent stealing hands out every item exactly once
+ *
+ * Return: 0 on success, -1 on failure
+ */
+int test_wsdeque_steal(void);
+
+#endif